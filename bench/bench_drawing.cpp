@@ -0,0 +1,447 @@
+#include <portal/drawing/algorithm.hpp>
+#include <portal/drawing/composite.hpp>
+#include <portal/drawing/convolution.hpp>
+#include <portal/drawing/image.hpp>
+#include <portal/drawing/netpbm.hpp>
+#include <portal/drawing/noise.hpp>
+#include <portal/drawing/packed.hpp>
+#include <portal/drawing/parallel.hpp>
+#include <portal/drawing/png.hpp>
+#include <portal/drawing/pyramid.hpp>
+#include <portal/drawing/qoi.hpp>
+#include <portal/drawing/resample.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <sstream>
+#include <string>
+
+using namespace portal::drawing;
+
+namespace {
+using rgba8 = basic_rgba<std::uint8_t>;
+using rgbf  = basic_rgb<float, color_encoding::linear>;
+
+template <typename Allocator>
+void BM_ImageAlloc(benchmark::State &state) {
+  const auto width  = static_cast<std::size_t>(state.range(0));
+  const auto height = static_cast<std::size_t>(state.range(1));
+  for (auto _ : state) {
+    basic_image<rgba8, Allocator> img(width, height);
+    benchmark::DoNotOptimize(img.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename P, bool Member>
+void BM_Fill(benchmark::State &state) {
+  // basic_image::fill against the fill() algorithm on a square of range(0) pixels a side
+  const auto size = static_cast<std::size_t>(state.range(0));
+  basic_image<P> img(size, size);
+  const auto pixel = convert_pixel<P>(basic_rgba<std::uint8_t>{10, 120, 240, 255});
+  for (auto _ : state) {
+    if constexpr (Member)
+      img.fill(pixel);
+    else
+      fill(img, pixel);
+    benchmark::DoNotOptimize(img.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * img.size());
+  state.SetBytesProcessed(state.iterations() * img.size() * sizeof(P));
+}
+
+template <typename Layout>
+void BM_ColumnWalk(benchmark::State &state) {
+  // column by column, the access pattern of a vertical filter pass
+  const auto size = static_cast<std::size_t>(state.range(0));
+  basic_image<basic_g<float>, aligned_allocator<basic_g<float>>, Layout> img(size, size);
+  fill(img, {1.f});
+  for (auto _ : state) {
+    float acc = 0;
+    for (std::size_t x = 0; x < size; ++x)
+      for (std::size_t y = 0; y < size; ++y)
+        acc += img(x, y).gray;
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+template <typename From, typename To, bool Kernel>
+void BM_Convert(benchmark::State &state) {
+  basic_image<From> src(1920, 1080);
+  basic_image<To> dst(1920, 1080);
+  fill(src, convert_pixel<From>(basic_rgba<std::uint8_t>{10, 120, 240, 255}));
+  for (auto _ : state) {
+    if constexpr (Kernel)
+      convert(src, dst);
+    else
+      convert(src, dst, [](const From &p) { return convert_pixel<To>(p); });
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+  state.SetBytesProcessed(state.iterations() * src.size() * (sizeof(From) + sizeof(To)));
+}
+
+template <typename From, typename To, bool Kernel>
+void BM_Srgb(benchmark::State &state) {
+  // the naive conversion evaluates the exact curve with std::pow on each sample
+  using mid = rebind_color_t<From, float>;
+  basic_image<From> src(1920, 1080);
+  basic_image<To> dst(1920, 1080);
+  for (std::size_t y = 0; y < 1080; ++y)
+    for (std::size_t x = 0; x < 1920; ++x)
+      src(x, y) = convert_pixel<From>(basic_rgba<std::uint8_t>{std::uint8_t(x), std::uint8_t(y), std::uint8_t(x + y), 255});
+  const auto naive = [](const From &p) {
+    auto f = convert_pixel<mid>(p);
+    for (float *c : {&f.red, &f.green, &f.blue})
+      *c = encoding_v<To> == color_encoding::linear ? srgb_to_linear(*c) : linear_to_srgb(*c);
+    return convert_pixel<To>(std::bit_cast<with_encoding_t<mid, encoding_v<To>>>(f));
+  };
+  for (auto _ : state) {
+    if constexpr (Kernel)
+      convert(src, dst);
+    else
+      convert(src, dst, naive);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template <typename P, alpha_mode M, bool Kernel>
+void BM_CompositeOver(benchmark::State &state) {
+  // range(0): 0 translucent everywhere, 1 an overlay, mostly transparent with opaque panels
+  basic_image<P> src(1920, 1080), dst(1920, 1080);
+  for (std::size_t y = 0; y < 1080; ++y) {
+    for (std::size_t x = 0; x < 1920; ++x) {
+      const bool panel = (x / 256 + y / 256) % 4 == 0;
+      const auto alpha = state.range(0) == 0 ? std::uint8_t(x * 7 + y) : panel ? std::uint8_t(255) : std::uint8_t(0);
+      src(x, y)        = convert_pixel<P>(premultiply(basic_rgba<std::uint8_t>{std::uint8_t(x), std::uint8_t(y), 200, alpha}));
+    }
+  }
+  fill(dst, convert_pixel<P>(basic_rgba<std::uint8_t>{0, 40, 80, 255}));
+  for (auto _ : state) {
+    if constexpr (Kernel) {
+      composite<composite_op::over, M>(src, dst);
+    } else {
+      for (std::size_t y = 0; y < 1080; ++y)
+        for (std::size_t x = 0; x < 1920; ++x)
+          dst(x, y) = composite_pixel<composite_op::over, M>(src(x, y), dst(x, y));
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template <typename From, typename To>
+void BM_ParallelConvert(benchmark::State &state) {
+  // range(0): participants, 0 for a serial convert
+  basic_image<From> src(3840, 2160);
+  basic_image<To> dst(3840, 2160);
+  fill(src, convert_pixel<From>(basic_rgba<std::uint8_t>{10, 120, 240, 255}));
+  portal::thread_pool pool(std::max<std::size_t>(1, state.range(0)));
+  for (auto _ : state) {
+    if (state.range(0) == 0)
+      convert(src, dst);
+    else
+      parallel_transform(src, dst, 0, pool);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template <typename P>
+void BM_FillNoise(benchmark::State &state) {
+  basic_image<P> img(1920, 1080);
+  for (auto _ : state) {
+    fill_noise(img);
+    benchmark::DoNotOptimize(img.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * img.size());
+  state.SetBytesProcessed(state.iterations() * img.size() * sizeof(P));
+}
+
+void BM_Pipeline(benchmark::State &state) {
+  // a full frame: noise, an overlay composited in linear float, encoded to 8 bit sRGB
+  using linear = basic_rgba<float, color_encoding::linear>;
+  const auto width  = static_cast<std::size_t>(state.range(0));
+  const auto height = static_cast<std::size_t>(state.range(1));
+  basic_image<linear> frame(width, height), overlay(width, height);
+  basic_image<rgba8> out(width, height);
+  fill(overlay, linear{0.25f, 0.f, 0.f, 0.5f});
+  for (auto _ : state) {
+    fill_noise(frame);
+    composite<composite_op::over, alpha_mode::premultiplied>(overlay, frame);
+    convert(frame, out);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * out.size());
+  state.SetBytesProcessed(state.iterations() * out.size() * (3 * sizeof(linear) + sizeof(rgba8)));
+}
+
+template <typename File, typename P>
+void BM_DecodeNetpbm(benchmark::State &state) {
+  // a 4K frame already in memory, the cost on top of reading the file
+  basic_image<File> frame(3840, 2160);
+  fill_noise(frame);
+  std::ostringstream out;
+  write_netpbm(out, frame);
+  const auto file = out.str();
+  for (auto _ : state) {
+    auto img = decode_netpbm<P>(std::as_bytes(std::span(file.data(), file.size())));
+    benchmark::DoNotOptimize(img.data());
+  }
+  state.SetItemsProcessed(state.iterations() * frame.size());
+  state.SetBytesProcessed(state.iterations() * file.size());
+}
+
+basic_image<rgba8> encode_frame() {
+  // a 4K frame of gradients, hard edges and faint noise, closer to a render than pure noise
+  basic_image<rgba8> frame(3840, 2160);
+  basic_image<basic_g<std::uint8_t>> grain(3840, 2160);
+  fill_noise(grain);
+  for (std::size_t y = 0; y < 2160; ++y)
+    for (std::size_t x = 0; x < 3840; ++x) {
+      const auto n = static_cast<std::uint8_t>(grain(x, y).gray >> 5);
+      frame(x, y)  = {static_cast<std::uint8_t>(x * 255 / 3840 + n), static_cast<std::uint8_t>(y * 255 / 2160), static_cast<std::uint8_t>((x / 256 + y / 256) % 2 * 160 + n), 255};
+    }
+  return frame;
+}
+
+template <typename Write>
+void encode(benchmark::State &state, Write write) {
+  const auto frame = encode_frame();
+  std::ostringstream out;
+  for (auto _ : state) {
+    out.seekp(0);
+    write(out, frame);
+  }
+  state.SetItemsProcessed(state.iterations() * frame.size());
+  state.SetBytesProcessed(state.iterations() * frame.size() * sizeof(rgba8));
+  state.counters["ratio"] = static_cast<double>(out.tellp()) / static_cast<double>(frame.size() * sizeof(rgba8));
+}
+
+void BM_EncodeRaw(benchmark::State &state) {
+  // the baseline: a PAM file is the pixels as they are
+  encode(state, [](std::ostream &out, const auto &frame) { write_netpbm(out, frame); });
+}
+
+void BM_EncodeQoi(benchmark::State &state) {
+  encode(state, [](std::ostream &out, const auto &frame) { write_qoi(out, frame); });
+}
+
+void BM_EncodePng(benchmark::State &state) {
+  // range(0): level, range(1): participants
+  portal::thread_pool pool(static_cast<std::size_t>(state.range(1)));
+  encode(state, [&](std::ostream &out, const auto &frame) { write_png(out, frame, static_cast<int>(state.range(0)), pool); });
+}
+
+template <bool Png>
+void BM_DecodeEncoded(benchmark::State &state) {
+  const auto frame = encode_frame();
+  std::ostringstream out;
+  if constexpr (Png)
+    write_png(out, frame);
+  else
+    write_qoi(out, frame);
+  const auto file  = out.str();
+  const auto bytes = std::as_bytes(std::span(file.data(), file.size()));
+  for (auto _ : state) {
+    auto img = Png ? decode_png<rgba8>(bytes) : decode_qoi<rgba8>(bytes);
+    benchmark::DoNotOptimize(img.data());
+  }
+  state.SetItemsProcessed(state.iterations() * frame.size());
+  state.SetBytesProcessed(state.iterations() * frame.size() * sizeof(rgba8));
+}
+
+template <typename P>
+void BM_BoxBlur(benchmark::State &state) {
+  // range(0): radius, the time should not grow with it
+  basic_image<P> src(1920, 1080), dst(1920, 1080);
+  fill_noise(src);
+  for (auto _ : state) {
+    box_blur(src, dst, static_cast<std::size_t>(state.range(0)));
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template <typename P>
+void BM_GaussianBlur(benchmark::State &state) {
+  // range(0): sigma, a sampled kernel below 2, three boxes from 2
+  basic_image<P> src(1920, 1080), dst(1920, 1080);
+  fill_noise(src);
+  for (auto _ : state) {
+    gaussian_blur(src, dst, static_cast<float>(state.range(0)));
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template <typename P>
+void BM_Resize(benchmark::State &state) {
+  // 1080p to range(1) pixels wide by resample_filter range(0) on range(2) threads
+  const auto filter = static_cast<resample_filter>(state.range(0));
+  const auto width  = static_cast<std::size_t>(state.range(1));
+  basic_image<P> src(1920, 1080), dst(width, width * 9 / 16);
+  fill_noise(src);
+  portal::thread_pool pool(static_cast<std::size_t>(state.range(2)));
+  const resampler resample(1920, 1080, dst.get_width(), dst.get_height(), filter);
+  for (auto _ : state) {
+    resample(src, dst, pool);
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * dst.size());
+}
+
+void BM_ResizeNaive(benchmark::State &state) {
+  // per-pixel bicubic: 4 x 4 taps, weights and conversions for every pixel
+  const auto width = static_cast<std::size_t>(state.range(0));
+  basic_image<rgba8> src(1920, 1080), dst(width, width * 9 / 16);
+  fill_noise(src);
+  const float sx = 1920.0f / static_cast<float>(dst.get_width()), sy = 1080.0f / static_cast<float>(dst.get_height());
+  for (auto _ : state) {
+    for (std::size_t y = 0; y < dst.get_height(); ++y)
+      for (std::size_t x = 0; x < dst.get_width(); ++x) {
+        const float cx = (static_cast<float>(x) + 0.5f) * sx - 0.5f, cy = (static_cast<float>(y) + 0.5f) * sy - 0.5f;
+        const auto x0 = static_cast<std::ptrdiff_t>(std::floor(cx)), y0 = static_cast<std::ptrdiff_t>(std::floor(cy));
+        basic_rgba<float> sum{0.0f, 0.0f, 0.0f, 0.0f};
+        for (std::ptrdiff_t j = -1; j <= 2; ++j)
+          for (std::ptrdiff_t i = -1; i <= 2; ++i) {
+            const float w = resample_weight(resample_filter::bicubic, cx - static_cast<float>(x0 + i)) *
+                            resample_weight(resample_filter::bicubic, cy - static_cast<float>(y0 + j));
+            const auto p  = convert_pixel<basic_rgba<float>>(src(static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(x0 + i, 0, 1919)),
+                                                                  static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(y0 + j, 0, 1079))));
+            sum.red += w * p.red;
+            sum.green += w * p.green;
+            sum.blue += w * p.blue;
+            sum.alpha += w * p.alpha;
+          }
+        dst(x, y) = convert_pixel<rgba8>(sum);
+      }
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * dst.size());
+}
+
+template <typename P>
+void BM_PyramidBuild(benchmark::State &state) {
+  // full chain of a square of range(0) pixels a side
+  const auto size = static_cast<std::size_t>(state.range(0));
+  basic_image<P> img(size, size);
+  fill_noise(img);
+  basic_image_pyramid<P> mips(img);
+  for (auto _ : state) {
+    mips.build();
+    benchmark::DoNotOptimize(mips.data());
+  }
+  state.SetItemsProcessed(state.iterations() * img.size());
+}
+
+void BM_PyramidUpdate(benchmark::State &state) {
+  // a range(0) pixel square written into level 0 of 4096 x 4096, then propagated
+  const auto edit = static_cast<std::size_t>(state.range(0));
+  basic_image<rgba8> img(4096, 4096);
+  fill_noise(img);
+  basic_image_pyramid<rgba8> mips(img);
+  std::size_t x = 0;
+  for (auto _ : state) {
+    x = (x + 1237) % (4096 - edit);
+    mips.level(0)(x, x) = {1, 2, 3, 4};
+    mips.invalidate(x, x, edit, edit);
+    mips.update();
+    benchmark::DoNotOptimize(mips.data());
+  }
+  state.SetItemsProcessed(state.iterations() * edit * edit);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ImageAlloc, aligned_allocator<rgba8>)->Args({1920, 1080})->Args({256, 256});
+BENCHMARK_TEMPLATE(BM_ImageAlloc, pool_allocator<rgba8>)->Args({1920, 1080})->Args({256, 256});
+BENCHMARK_TEMPLATE(BM_Fill, rgba8, true)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Fill, rgba8, false)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Fill, basic_rgb<std::uint8_t>, true)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Fill, basic_rgb<std::uint8_t>, false)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Fill, basic_rgba<float>, true)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Fill, basic_rgba<float>, false)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_ColumnWalk, row_major)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_ColumnWalk, tiled<64>)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_ColumnWalk, morton<64>)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Convert, basic_bgra<std::uint8_t>, rgba8, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_bgra<std::uint8_t>, rgba8, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgb<std::uint8_t>, rgba8, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgb<std::uint8_t>, rgba8, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_rgb<std::uint8_t>, false);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_rgb<std::uint8_t>, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_g<std::uint8_t>, false);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_g<std::uint8_t>, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_g<std::uint8_t>, rgba8, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_g<std::uint8_t>, rgba8, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_rgba<float>, false);
+BENCHMARK_TEMPLATE(BM_Convert, rgba8, basic_rgba<float>, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<float>, rgba8, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<float>, rgba8, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<float>, basic_rgba<portal::half>, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<float>, basic_rgba<portal::half>, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<portal::half>, basic_rgba<float>, false);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<portal::half>, basic_rgba<float>, true);
+BENCHMARK_TEMPLATE(BM_Convert, basic_rgba<float>, rgb10a2, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgbf, rgb9e5, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgb9e5, rgbf, true);
+BENCHMARK_TEMPLATE(BM_Convert, rgbf, r11g11b10f, true);
+BENCHMARK_TEMPLATE(BM_Convert, r11g11b10f, rgbf, true);
+BENCHMARK_TEMPLATE(BM_Srgb, rgba8, basic_rgba<float, color_encoding::linear>, false);
+BENCHMARK_TEMPLATE(BM_Srgb, rgba8, basic_rgba<float, color_encoding::linear>, true);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<float, color_encoding::linear>, rgba8, false);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<float, color_encoding::linear>, rgba8, true);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<std::uint16_t>, basic_rgba<std::uint16_t, color_encoding::linear>, false);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<std::uint16_t>, basic_rgba<std::uint16_t, color_encoding::linear>, true);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<float, color_encoding::linear>, basic_rgba<float>, false);
+BENCHMARK_TEMPLATE(BM_Srgb, basic_rgba<float, color_encoding::linear>, basic_rgba<float>, true);
+BENCHMARK_TEMPLATE(BM_CompositeOver, rgba8, alpha_mode::premultiplied, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, rgba8, alpha_mode::premultiplied, true)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, basic_rgba<std::uint16_t>, alpha_mode::premultiplied, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, basic_rgba<std::uint16_t>, alpha_mode::premultiplied, true)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, basic_rgba<float>, alpha_mode::premultiplied, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, basic_rgba<float>, alpha_mode::premultiplied, true)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, rgba8, alpha_mode::straight, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CompositeOver, rgba8, alpha_mode::straight, true)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ParallelConvert, rgba8, basic_rgba<float, color_encoding::linear>)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelConvert, basic_rgba<float>, basic_rgba<portal::half>)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FillNoise, rgba8);
+BENCHMARK_TEMPLATE(BM_FillNoise, basic_rgba<float>);
+BENCHMARK_TEMPLATE(BM_DecodeNetpbm, basic_rgb<std::uint8_t>, basic_rgb<std::uint8_t>);
+BENCHMARK_TEMPLATE(BM_DecodeNetpbm, basic_rgb<std::uint8_t>, rgba8);
+BENCHMARK_TEMPLATE(BM_DecodeNetpbm, basic_rgb<std::uint16_t>, basic_rgb<std::uint16_t>);
+BENCHMARK_TEMPLATE(BM_DecodeNetpbm, rgbf, rgbf);
+BENCHMARK(BM_EncodeRaw)->UseRealTime();
+BENCHMARK(BM_EncodeQoi)->UseRealTime();
+BENCHMARK(BM_EncodePng)->Args({1, 1})->Args({6, 1})->Args({9, 1})->Args({6, 2})->Args({6, 4})->Args({6, 8})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_DecodeEncoded, true);
+BENCHMARK_TEMPLATE(BM_DecodeEncoded, false);
+BENCHMARK_TEMPLATE(BM_BoxBlur, rgba8)->Arg(1)->Arg(8)->Arg(64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BoxBlur, basic_g<std::uint8_t>)->Arg(1)->Arg(8)->Arg(64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BoxBlur, basic_rgba<float>)->Arg(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GaussianBlur, rgba8)->Arg(1)->Arg(2)->Arg(8)->Arg(32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Resize, rgba8)
+    ->ArgsProduct({{static_cast<int>(resample_filter::bilinear), static_cast<int>(resample_filter::bicubic), static_cast<int>(resample_filter::lanczos3),
+                    static_cast<int>(resample_filter::area)},
+                   {480, 3840},
+                   {1}})
+    ->Args({static_cast<int>(resample_filter::bicubic), 3840, 4})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Resize, basic_rgba<float>)->Args({static_cast<int>(resample_filter::bicubic), 480, 1})->Args({static_cast<int>(resample_filter::bicubic), 3840, 1});
+BENCHMARK(BM_ResizeNaive)->Arg(480)->Arg(3840);
+BENCHMARK_TEMPLATE(BM_PyramidBuild, rgba8)->Arg(1024)->Arg(4096)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PyramidBuild, basic_g<std::uint8_t>)->Arg(4096)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PyramidBuild, basic_rgba<float>)->Arg(1024)->UseRealTime();
+BENCHMARK(BM_PyramidUpdate)->Arg(16)->Arg(256)->UseRealTime();
+BENCHMARK(BM_Pipeline)->Args({1920, 1080})->Args({3840, 2160});
@@ -0,0 +1,498 @@
+#include <portal/math/fs_vector.hpp>
+#include <portal/math/fs_vector_soa.hpp>
+#include <portal/math/fs_vector_expr.hpp>
+#include <portal/math/fs_matrix.hpp>
+#include <portal/math/fast.hpp>
+#include <portal/math/lut.hpp>
+#include <portal/random.hpp>
+#include <portal/random_engine.hpp>
+#include <portal/sampler.hpp>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace portal::math;
+
+namespace {
+/**
+ * @brief scalar reference of fs_vector (the plain loops fs_vector used before simd kernels)
+ *
+ * @tparam T type
+ * @tparam N size
+ */
+template <typename T, std::size_t N>
+struct scalar_vector {
+  using value_type = T;
+  T elem[N]        = {};
+
+  T *data() noexcept {
+    return elem;
+  }
+  std::size_t size() const noexcept {
+    return N;
+  }
+
+  scalar_vector &operator+=(const scalar_vector &vec) noexcept {
+    for (std::size_t i = 0; i < N; ++i)
+      elem[i] += vec.elem[i];
+    return *this;
+  }
+  scalar_vector &operator*=(const T &scal) noexcept {
+    for (auto &p : elem)
+      p *= scal;
+    return *this;
+  }
+  friend T dot(const scalar_vector &lhs, const scalar_vector &rhs) noexcept {
+    T res = {};
+    for (std::size_t i = 0; i < N; ++i)
+      res += lhs.elem[i] * rhs.elem[i];
+    return res;
+  }
+  friend scalar_vector max_peram(const scalar_vector &lhs, const scalar_vector &rhs) noexcept {
+    scalar_vector res = lhs;
+    for (std::size_t i = 0; i < N; ++i)
+      res.elem[i] = std::max<T>(res.elem[i], rhs.elem[i]);
+    return res;
+  }
+};
+
+template <typename Vec>
+std::vector<Vec> make_input(std::size_t count) {
+  std::vector<Vec> res(count);
+  std::size_t seed = 1;
+  for (auto &v : res)
+    for (std::size_t i = 0; i < v.size(); ++i)
+      v.data()[i] = static_cast<typename Vec::value_type>((seed = seed * 1103515245 + 12345) % 1000) / 1000;
+  return res;
+}
+
+constexpr std::size_t count = 4096;
+
+template <typename Vec>
+void BM_AddScale(benchmark::State &state) {
+  auto input = make_input<Vec>(count);
+  for (auto _ : state) {
+    Vec acc{};
+    for (const auto &v : input) {
+      acc += v;
+      acc *= static_cast<typename Vec::value_type>(0.5);
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Vec>
+void BM_Dot(benchmark::State &state) {
+  auto input = make_input<Vec>(count);
+  for (auto _ : state) {
+    typename Vec::value_type acc = 0;
+    for (std::size_t i = 1; i < input.size(); ++i)
+      acc += dot(input[i - 1], input[i]);
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * (count - 1));
+}
+
+template <typename Vec>
+void BM_MaxPeram(benchmark::State &state) {
+  auto input = make_input<Vec>(count);
+  for (auto _ : state) {
+    Vec acc = input[0];
+    for (const auto &v : input)
+      acc = max_peram(acc, v);
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Vec>
+void BM_Arithmetic(benchmark::State &state) {
+  // the binary operators, a - b * s + c / s, on vectors of range(0) elements
+  const auto size = static_cast<std::size_t>(state.range(0));
+  auto input      = make_input<Vec>(size + 2);
+  std::vector<Vec> output(size);
+  const auto s = static_cast<typename Vec::value_type>(2);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < size; ++i)
+      output[i] = input[i] - input[i + 1] * s + input[i + 2] / s;
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() * size * 4 * sizeof(Vec));
+}
+
+template <typename Vec>
+void BM_Normalize(benchmark::State &state) {
+  auto input = make_input<Vec>(count);
+  std::vector<Vec> output(count);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < count; ++i)
+      output[i] = normalized(input[i]);
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <std::size_t W>
+void BM_DotSoa(benchmark::State &state) {
+  auto input = make_input<fs_vector<float, 3>>(count);
+  std::vector<fs_vector_soa<float, 3, W>> packets;
+  for (std::size_t i = 0; i < count; i += W)
+    packets.emplace_back(std::span<const fs_vector<float, 3>>(input).subspan(i, W));
+  for (auto _ : state) {
+    fs_vector<float, W> acc;
+    for (std::size_t i = 1; i < packets.size(); ++i)
+      acc += dot(packets[i - 1], packets[i]);
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * (count - W));
+}
+
+template <bool Lazy>
+void BM_Chain16(benchmark::State &state) {
+  using vec  = fs_vector<float, 16>;
+  auto input = make_input<vec>(count);
+  std::vector<vec> output(count);
+  for (auto _ : state) {
+    for (std::size_t i = 2; i < count; ++i) {
+      if constexpr (Lazy)
+        output[i] = lazy(input[i]) + lazy(input[i - 1]) * 0.5f - input[i - 2];
+      else
+        output[i] = input[i] + input[i - 1] * 0.5f - input[i - 2];
+    }
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (count - 2));
+}
+
+template <bool Batched>
+void BM_TransformPoints(benchmark::State &state) {
+  const auto size = static_cast<std::size_t>(state.range(0));
+  auto src        = make_input<fs_vector<float, 3>>(size);
+  std::vector<fs_vector<float, 3>> dst(size);
+  const auto m = fs_matrix<float, 4, 4>{fs_vector<float, 4>{0, -1, 0, 1}, fs_vector<float, 4>{2, 0, 0, 2}, fs_vector<float, 4>{0, 0, 1, 3}, fs_vector<float, 4>{0, 0, 0, 1}};
+  for (auto _ : state) {
+    if constexpr (Batched) {
+      transform_points(m, src, dst);
+    } else {
+      for (std::size_t i = 0; i < size; ++i) {
+        const auto p = m * fs_vector<float, 4>{src[i][0], src[i][1], src[i][2], 1};
+        dst[i]       = fs_vector<float, 3>{p[0], p[1], p[2]};
+      }
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() * size * 2 * sizeof(fs_vector<float, 3>));
+}
+
+enum class transcendental { sin, exp, log, pow, sqrt };
+
+template <transcendental F, fast::precision P, bool Std = false>
+void BM_Transcendental(benchmark::State &state) {
+  std::vector<float> src(count), dst(count);
+  for (std::size_t i = 0; i < count; ++i)
+    src[i] = 0.01f + static_cast<float>(i) / count * 10;
+  for (auto _ : state) {
+    if constexpr (Std) {
+      for (std::size_t i = 0; i < count; ++i) {
+        if constexpr (F == transcendental::sin)
+          dst[i] = std::sin(src[i]);
+        else if constexpr (F == transcendental::exp)
+          dst[i] = std::exp(src[i]);
+        else if constexpr (F == transcendental::log)
+          dst[i] = std::log(src[i]);
+        else
+          dst[i] = std::pow(src[i], 2.2f);
+      }
+    } else {
+      const std::span<const float> in(src);
+      const std::span<float> out(dst);
+      if constexpr (F == transcendental::sin)
+        fast::sin<P>(in, out);
+      else if constexpr (F == transcendental::exp)
+        fast::exp<P>(in, out);
+      else if constexpr (F == transcendental::log)
+        fast::log<P>(in, out);
+      else
+        fast::pow<P>(in, 2.2f, out);
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <transcendental F, typename T>
+void BM_Slow(benchmark::State &state) {
+  // the slow_* functions at run time, where they forward to the standard library
+  std::vector<T> src(count), dst(count);
+  for (std::size_t i = 0; i < count; ++i)
+    src[i] = T(0.01) + static_cast<T>(i) / count * 10;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < count; ++i) {
+      if constexpr (F == transcendental::sin)
+        dst[i] = slow_sin(src[i]);
+      else if constexpr (F == transcendental::exp)
+        dst[i] = slow_exp(src[i]);
+      else if constexpr (F == transcendental::log)
+        dst[i] = slow_log(src[i]);
+      else if constexpr (F == transcendental::pow)
+        dst[i] = slow_pow(src[i], T(2.2));
+      else
+        dst[i] = slow_sqrt(src[i]);
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <int Table>
+void BM_SinTable(benchmark::State &state) {
+  static constexpr auto linear = make_lut<1024>([](float x) { return slow_sin(x); }, 0.f, 2 * std::numbers::pi_v<float>);
+  static constexpr auto cubic  = make_lut<1024, interpolation::cubic>([](float x) { return slow_sin(x); }, 0.f, 2 * std::numbers::pi_v<float>);
+  std::vector<float> src(count), dst(count);
+  for (std::size_t i = 0; i < count; ++i)
+    src[i] = static_cast<float>(i) / count * 6;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < count; ++i) {
+      if constexpr (Table == 0)
+        dst[i] = std::sin(src[i]);
+      else if constexpr (Table == 1)
+        dst[i] = linear(src[i]);
+      else
+        dst[i] = cubic(src[i]);
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Engine>
+void BM_Engine(benchmark::State &state) {
+  // range(0): 0 raw values, 1 doubles in [0, 1)
+  Engine engine(1);
+  std::uniform_real_distribution<double> dist;
+  std::uint64_t bits = 0;
+  double sum         = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      if (state.range(0) == 0)
+        bits += engine();
+      else
+        sum += dist(engine);
+    }
+  }
+  benchmark::DoNotOptimize(bits);
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * 1024);
+  state.counters["state_bytes"] = sizeof(Engine);
+}
+
+template <typename Dist, bool Bulk>
+void BM_Generate(benchmark::State &state) {
+  // a buffer of uniform values, one call per value against generate()
+  using T = typename Dist::result_type;
+  std::vector<T> buf(1 << 16);
+  const Dist dist(T(0), T(100));
+  for (auto _ : state) {
+    if constexpr (Bulk) {
+      dist.generate(buf);
+    } else {
+      for (auto &x : buf)
+        x = dist();
+    }
+    benchmark::DoNotOptimize(buf.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * buf.size());
+  state.SetBytesProcessed(state.iterations() * buf.size() * sizeof(T));
+}
+
+template <int Kind>
+void BM_Integrate(benchmark::State &state) {
+  // Kind: 0 white noise, 1 Sobol, 2 Halton, 3 R2, 4 blue noise; range(0) samples per pixel
+  // the rms error over 4096 pixels of a disk's area by 2D sampling, lower is less noise at equal count
+  const auto spp = static_cast<std::uint32_t>(state.range(0));
+  const portal::sobol_sampler sobol(1);
+  const portal::halton_sampler halton(1);
+  const portal::r2_sampler r2(2, 1);
+  static const portal::blue_noise_mask mask;
+  const auto sample = [&](std::uint32_t pixel, std::uint32_t i, std::uint32_t dim) -> float {
+    if constexpr (Kind == 1)
+      return sobol(pixel, i, dim);
+    else if constexpr (Kind == 2)
+      return halton(pixel, i, dim);
+    else if constexpr (Kind == 3)
+      return r2(pixel, i, dim);
+    else if constexpr (Kind == 4)
+      return mask(pixel % 64, pixel / 64, i, dim);
+    else
+      return portal::unit_float(static_cast<std::uint32_t>(portal::mix64(std::uint64_t{pixel} << 33 | std::uint64_t{i} << 1 | dim)));
+  };
+  double error = 0;
+  for (auto _ : state) {
+    error = 0;
+    for (std::uint32_t pixel = 0; pixel < 4096; ++pixel) {
+      std::uint32_t inside = 0;
+      for (std::uint32_t i = 0; i < spp; ++i) {
+        const float x = sample(pixel, i, 0) - 0.5f, y = sample(pixel, i, 1) - 0.5f;
+        inside += x * x + y * y < 0.25f;
+      }
+      const double e = static_cast<double>(inside) / spp - 3.14159265358979323846 / 4;
+      error += e * e;
+    }
+  }
+  state.counters["rmse"] = std::sqrt(error / 4096);
+  state.SetItemsProcessed(state.iterations() * 4096 * spp * 2);
+}
+
+template <typename Sampler, bool Batch>
+void BM_Sampler(benchmark::State &state) {
+  // 4096 consecutive samples of a dimension, one by one or with generate()
+  const Sampler sampler(1);
+  std::vector<float> buf(4096);
+  for (auto _ : state) {
+    if constexpr (Batch) {
+      sampler.generate(3, 0, 0, buf);
+    } else {
+      for (std::uint32_t i = 0; i < buf.size(); ++i)
+        buf[i] = sampler(3, i, 0);
+    }
+    benchmark::DoNotOptimize(buf.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * buf.size());
+}
+
+template <bool Batch>
+void BM_BlueNoise(benchmark::State &state) {
+  // 4096 consecutive samples of a pixel, one by one or with generate()
+  static const portal::blue_noise_mask mask;
+  std::vector<float> buf(4096);
+  for (auto _ : state) {
+    if constexpr (Batch) {
+      mask.generate(3, 5, 0, 0, buf);
+    } else {
+      for (std::uint32_t i = 0; i < buf.size(); ++i)
+        buf[i] = mask(3, 5, i, 0);
+    }
+    benchmark::DoNotOptimize(buf.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * buf.size());
+}
+
+template <bool Locked>
+void BM_Random(benchmark::State &state) {
+  // a mutex around one shared engine, as calling one generator from several threads needs, against the thread engines
+  static std::mutex mutex;
+  static std::mt19937 shared_engine;
+  double sum = 0;
+  for (auto _ : state) {
+    if constexpr (Locked) {
+      std::lock_guard lock(mutex);
+      sum += std::uniform_real_distribution<double>()(shared_engine);
+    } else {
+      sum += portal::random<double>();
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_AddScale, scalar_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_AddScale, fs_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_AddScale, scalar_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_AddScale, fs_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_AddScale, scalar_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_AddScale, fs_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_Dot, scalar_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_Dot, fs_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_Dot, scalar_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_Dot, fs_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_Dot, scalar_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_Dot, fs_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, scalar_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, fs_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, scalar_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, fs_vector<double, 2>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, scalar_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_MaxPeram, fs_vector<double, 4>);
+BENCHMARK_TEMPLATE(BM_Dot, fs_vector<float, 3>);
+BENCHMARK_TEMPLATE(BM_Arithmetic, fs_vector<float, 4>)->Arg(64)->Arg(4096)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Arithmetic, fs_vector<float, 16>)->Arg(64)->Arg(4096)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Arithmetic, fs_vector<double, 4>)->Arg(64)->Arg(4096)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Arithmetic, fs_vector<int, 4>)->Arg(64)->Arg(4096)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Normalize, fs_vector<float, 3>);
+BENCHMARK_TEMPLATE(BM_Normalize, fs_vector<float, 4>);
+BENCHMARK_TEMPLATE(BM_Normalize, fs_vector<double, 3>);
+BENCHMARK_TEMPLATE(BM_DotSoa, 4);
+BENCHMARK_TEMPLATE(BM_DotSoa, 8);
+BENCHMARK_TEMPLATE(BM_Chain16, false);
+BENCHMARK_TEMPLATE(BM_Chain16, true);
+BENCHMARK_TEMPLATE(BM_TransformPoints, false)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_TransformPoints, true)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::sin, fast::precision::high, true);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::sin, fast::precision::medium);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::sin, fast::precision::low);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::exp, fast::precision::high, true);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::exp, fast::precision::medium);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::exp, fast::precision::low);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::log, fast::precision::high, true);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::log, fast::precision::medium);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::log, fast::precision::low);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::pow, fast::precision::high, true);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::pow, fast::precision::medium);
+BENCHMARK_TEMPLATE(BM_Transcendental, transcendental::pow, fast::precision::low);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::sqrt, float);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::sqrt, double);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::sin, float);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::sin, double);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::exp, float);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::exp, double);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::log, float);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::log, double);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::pow, float);
+BENCHMARK_TEMPLATE(BM_Slow, transcendental::pow, double);
+BENCHMARK_TEMPLATE(BM_SinTable, 0);
+BENCHMARK_TEMPLATE(BM_SinTable, 1);
+BENCHMARK_TEMPLATE(BM_SinTable, 2);
+BENCHMARK_TEMPLATE(BM_Random, true)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Random, false)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Engine, std::mt19937)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, std::mt19937_64)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, portal::splitmix64)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, portal::pcg32)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, portal::xoshiro128p)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, portal::xoshiro256pp)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Engine, portal::philox4x32)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_real_distribution<float>, false);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_real_distribution<float>, true);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_real_distribution<double>, false);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_real_distribution<double>, true);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_int_distribution<int>, false);
+BENCHMARK_TEMPLATE(BM_Generate, portal::uniform_int_distribution<int>, true);
+BENCHMARK_TEMPLATE(BM_Integrate, 0)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Integrate, 1)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Integrate, 2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Integrate, 3)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Integrate, 4)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::sobol_sampler, false);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::sobol_sampler, true);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::halton_sampler, false);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::halton_sampler, true);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::r2_sampler, false);
+BENCHMARK_TEMPLATE(BM_Sampler, portal::r2_sampler, true);
+BENCHMARK_TEMPLATE(BM_BlueNoise, false);
+BENCHMARK_TEMPLATE(BM_BlueNoise, true);
@@ -0,0 +1,807 @@
+/**
+ * @file deflate.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief DEFLATE and zlib streams, CRC-32 and Adler-32
+ * @version 0.1
+ * @date 2022-04-20
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DEFLATE_HPP
+#define PORTAL_DEFLATE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief table of the reflected CRC-32 polynomial 0xedb88320, one per byte
+ *
+ */
+inline constexpr auto crc32_table = [] {
+  std::array<std::uint32_t, 256> res{};
+  for (std::uint32_t i = 0; i < 256; ++i) {
+    std::uint32_t c = i;
+    for (int k = 0; k < 8; ++k)
+      c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    res[i] = c;
+  }
+  return res;
+}();
+
+/**
+ * @brief CRC-32 of PNG, zip and gzip
+ *
+ * @param[in] bytes bytes
+ * @param[in] crc CRC of the preceding bytes, to continue it
+ * @return Returns the CRC
+ */
+[[nodiscard]] constexpr std::uint32_t crc32(std::span<const std::byte> bytes, std::uint32_t crc = 0) noexcept {
+  crc = ~crc;
+  for (const auto b : bytes)
+    crc = crc32_table[(crc ^ static_cast<std::uint32_t>(b)) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+/**
+ * @brief Adler-32 of zlib
+ *
+ * @param[in] bytes bytes
+ * @param[in] adler checksum of the preceding bytes, to continue it
+ * @return Returns the checksum
+ */
+[[nodiscard]] constexpr std::uint32_t adler32(std::span<const std::byte> bytes, std::uint32_t adler = 1) noexcept {
+  constexpr std::uint32_t mod = 65521;
+  std::uint32_t a = adler & 0xffff, b = adler >> 16;
+  // 5552 is the most bytes before b can overflow
+  while (!bytes.empty()) {
+    const std::size_t n = std::min<std::size_t>(bytes.size(), 5552);
+    for (std::size_t i = 0; i < n; ++i) {
+      a += static_cast<std::uint32_t>(bytes[i]);
+      b += a;
+    }
+    a %= mod;
+    b %= mod;
+    bytes = bytes.subspan(n);
+  }
+  return b << 16 | a;
+}
+
+/**
+ * @brief Adler-32 of two concatenated byte sequences
+ *
+ * @param[in] first checksum of the first sequence
+ * @param[in] second checksum of the second sequence
+ * @param[in] second_size size of the second sequence
+ * @return Returns the checksum of both
+ */
+[[nodiscard]] constexpr std::uint32_t adler32_combine(std::uint32_t first, std::uint32_t second, std::size_t second_size) noexcept {
+  constexpr std::uint64_t mod = 65521;
+  const std::uint64_t n       = second_size % mod;
+  const std::uint64_t a1 = first & 0xffff, b1 = first >> 16;
+  const std::uint64_t a2 = second & 0xffff, b2 = second >> 16;
+  const std::uint64_t a = (a1 + a2 + mod - 1) % mod;
+  const std::uint64_t b = (b1 + b2 + n * a1 + mod - n) % mod;
+  return static_cast<std::uint32_t>(b << 16 | a);
+}
+
+/**
+ * @brief length and distance codes of DEFLATE
+ *
+ */
+struct deflate_codes {
+  static constexpr std::array<std::uint16_t, 29> length_base = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258}; //!< @brief first length of a code
+  static constexpr std::array<std::uint8_t, 29> length_extra  = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};                                 //!< @brief extra bits of a length code
+  static constexpr std::array<std::uint16_t, 30> dist_base    = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577}; //!< @brief first distance of a code
+  static constexpr std::array<std::uint8_t, 30> dist_extra    = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};                    //!< @brief extra bits of a distance code
+  static constexpr std::array<std::uint8_t, 19> code_order    = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};                                                   //!< @brief order of the code length code lengths
+
+  //! @brief length code - 257 of lengths 3 to 258
+  static constexpr auto length_code = [] {
+    std::array<std::uint8_t, 256> res{};
+    for (std::size_t code = 0; code < 29; ++code)
+      for (std::size_t len = length_base[code]; len < length_base[code] + (std::size_t{1} << length_extra[code]) && len <= 258; ++len)
+        res[len - 3] = static_cast<std::uint8_t>(code);
+    return res;
+  }();
+
+  //! @brief distance codes of distances 1 to 256, then of (distance - 1) >> 7 for longer ones
+  static constexpr auto dist_code = [] {
+    std::array<std::uint8_t, 512> res{};
+    for (std::size_t code = 0; code < 30; ++code) {
+      for (std::size_t d = dist_base[code]; d < dist_base[code] + (std::size_t{1} << dist_extra[code]); ++d) {
+        if (d <= 256)
+          res[d - 1] = static_cast<std::uint8_t>(code);
+        else
+          res[256 + ((d - 1) >> 7)] = static_cast<std::uint8_t>(code);
+      }
+    }
+    return res;
+  }();
+
+  /**
+   * @brief distance code of a distance
+   *
+   * @param[in] dist distance, 1 to 32768
+   * @return Returns the code
+   */
+  [[nodiscard]] static constexpr unsigned distance(unsigned dist) noexcept {
+    return dist <= 256 ? dist_code[dist - 1] : dist_code[256 + ((dist - 1) >> 7)];
+  }
+};
+
+/**
+ * @brief DEFLATE compressor
+ *
+ * LZ77 over hash chains with one step of lazy matching, blocks of
+ * dynamic Huffman codes or stored when smaller. The window does not reach
+ * back across calls, so pieces of a stream compress independently, one
+ * per thread:
+ * @code
+ * // all but the last piece end on a byte boundary with an empty stored block
+ * deflate_encoder(6).compress(first_half, false, out);
+ * deflate_encoder(6).compress(second_half, true, out);
+ * @endcode
+ */
+class deflate_encoder {
+public:
+  /**
+   * @brief constructor
+   *
+   * @param[in] level 0 to store, 1 fastest to 9 smallest
+   *
+   * @exception std::invalid_argument if level is not in [0, 9]
+   */
+  explicit deflate_encoder(int level = 6)
+      : m_level(level) {
+    if (level < 0 || level > 9)
+      throw std::invalid_argument("level must be in [0, 9]");
+  }
+
+  /**
+   * @brief compress a piece of a stream
+   *
+   * @param[in] in bytes
+   * @param[in] last true for the last piece of the stream
+   * @param[in,out] out compressed bytes are appended
+   */
+  void compress(std::span<const std::byte> in, bool last, std::vector<std::byte> &out) {
+    bit_writer bits(out);
+    const auto *data     = reinterpret_cast<const std::uint8_t *>(in.data());
+    const std::size_t n  = in.size();
+    const bool lazy      = m_level >= 4;
+    const unsigned chain = std::array<unsigned, 10>{0, 4, 8, 16, 16, 32, 64, 128, 512, 4096}[static_cast<std::size_t>(m_level)];
+    const unsigned nice  = std::array<unsigned, 10>{0, 16, 32, 64, 32, 64, 128, 258, 258, 258}[static_cast<std::size_t>(m_level)];
+
+    if (m_level == 0) {
+      for (std::size_t pos = 0; pos < n; pos += 65535)
+        stored_block(bits, data + pos, std::min<std::size_t>(65535, n - pos), last && pos + 65535 >= n);
+    } else if (n != 0) {
+      m_head.assign(hash_size, -1);
+      m_prev.resize(window);
+      m_symbols.clear();
+      std::size_t block_start = 0;
+      const auto insert       = [this, data](std::size_t pos) {
+        const auto h = hash(data + pos);
+        m_prev[pos & (window - 1)] = m_head[h];
+        m_head[h]                  = static_cast<std::ptrdiff_t>(pos);
+      };
+      // longest match at pos, as (length, distance)
+      const auto find = [&](std::size_t pos, unsigned prev_length) -> std::pair<unsigned, unsigned> {
+        const unsigned max_length = static_cast<unsigned>(std::min<std::size_t>(258, n - pos));
+        if (prev_length >= max_length)
+          return {0, 0};
+        unsigned best = prev_length, best_dist = 0;
+        std::ptrdiff_t cand = m_head[hash(data + pos)];
+        for (unsigned steps = chain; cand >= 0 && pos - static_cast<std::size_t>(cand) <= window && steps > 0; --steps) {
+          const auto *p = data + cand;
+          if (p[best] == data[pos + best]) {
+            const unsigned length = match_length(p, data + pos, max_length);
+            if (length > best) {
+              best      = length;
+              best_dist = static_cast<unsigned>(pos - static_cast<std::size_t>(cand));
+              // nothing longer fits, and p[best] would be past the input
+              if (length >= std::min(nice, max_length))
+                break;
+            }
+          }
+          const auto next = m_prev[static_cast<std::size_t>(cand) & (window - 1)];
+          if (next >= cand)
+            break;
+          cand = next;
+        }
+        return {best_dist == 0 ? 0 : best, best_dist};
+      };
+
+      std::size_t pos = 0;
+      while (pos < n) {
+        unsigned length = 0, dist = 0;
+        if (pos + 4 <= n) {
+          std::tie(length, dist) = find(pos, 2);
+          insert(pos);
+          // a longer match at the next byte wins over this one unless it is
+          // much farther, distance bits cost about as much as 4 more bytes of
+          // match save; filtered images are full of short near repeats
+          if (lazy && length >= 3 && length < nice && pos + 5 <= n) {
+            const auto [next_length, next_dist] = find(pos + 1, length);
+            if (next_length > length && std::bit_width(next_dist) <= std::bit_width(dist) + (next_length - length) / 4) {
+              m_symbols.push_back({data[pos], 0});
+              ++pos;
+              insert(pos);
+              length = next_length;
+              dist   = next_dist;
+            }
+          }
+        }
+        if (length >= 3) {
+          m_symbols.push_back({static_cast<std::uint16_t>(length), static_cast<std::uint16_t>(dist)});
+          for (std::size_t end = pos + length, i = pos + 1; i < end; ++i)
+            if (i + 4 <= n)
+              insert(i);
+          pos += length;
+        } else {
+          m_symbols.push_back({data[pos], 0});
+          ++pos;
+        }
+        if (m_symbols.size() >= max_symbols || pos >= n) {
+          huffman_block(bits, data + block_start, pos - block_start, last && pos >= n);
+          m_symbols.clear();
+          block_start = pos;
+        }
+      }
+    }
+
+    if (!last) {
+      // sync: an empty stored block ends the piece on a byte boundary
+      stored_block(bits, data, 0, false);
+    } else if (n == 0) {
+      // an empty final block of fixed codes, the end of block code is 7 zero bits
+      bits.put(1, 1);
+      bits.put(1, 2);
+      bits.put(0, 7);
+    }
+    bits.flush();
+  }
+
+private:
+  static constexpr std::size_t window      = 32768;
+  static constexpr std::size_t hash_bits   = 15;
+  static constexpr std::size_t hash_size   = std::size_t{1} << hash_bits;
+  static constexpr std::size_t max_symbols = 1 << 16;
+
+  struct symbol {
+    std::uint16_t value; // a literal, or a length if dist is not 0
+    std::uint16_t dist;
+  };
+
+  class bit_writer {
+  public:
+    explicit bit_writer(std::vector<std::byte> &out) noexcept
+        : m_out(out) {
+    }
+
+    void put(std::uint32_t value, unsigned count) {
+      m_bits |= std::uint64_t{value} << m_count;
+      m_count += count;
+      if (m_count >= 32) {
+        for (int i = 0; i < 4; ++i)
+          m_out.push_back(static_cast<std::byte>(m_bits >> (8 * i)));
+        m_bits >>= 32;
+        m_count -= 32;
+      }
+    }
+
+    // pad to a byte boundary and write out the bits
+    void flush() {
+      for (; m_count > 0; m_count = m_count > 8 ? m_count - 8 : 0) {
+        m_out.push_back(static_cast<std::byte>(m_bits));
+        m_bits >>= 8;
+      }
+    }
+
+    // bytes after a flush
+    void append(const std::uint8_t *data, std::size_t size) {
+      flush();
+      const auto *bytes = reinterpret_cast<const std::byte *>(data);
+      m_out.insert(m_out.end(), bytes, bytes + size);
+    }
+
+  private:
+    std::vector<std::byte> &m_out;
+    std::uint64_t m_bits = 0;
+    unsigned m_count     = 0;
+  };
+
+  static std::uint32_t hash(const std::uint8_t *p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    return (v * 0x9e3779b1u) >> (32 - hash_bits);
+  }
+
+  static unsigned match_length(const std::uint8_t *a, const std::uint8_t *b, unsigned max_length) noexcept {
+    unsigned length = 0;
+    for (; length + 8 <= max_length; length += 8) {
+      std::uint64_t x, y;
+      std::memcpy(&x, a + length, 8);
+      std::memcpy(&y, b + length, 8);
+      if (x != y)
+        return length + static_cast<unsigned>(std::endian::native == std::endian::little ? std::countr_zero(x ^ y) : std::countl_zero(x ^ y)) / 8;
+    }
+    while (length < max_length && a[length] == b[length])
+      ++length;
+    return length;
+  }
+
+  // Huffman code lengths of at most max_bits from frequencies
+  template <std::size_t N>
+  static std::array<std::uint8_t, N> code_lengths(const std::array<std::uint32_t, N> &freq, unsigned max_bits) {
+    std::array<std::uint8_t, N> res{};
+    std::array<std::uint16_t, N> leaves;
+    std::size_t m = 0;
+    for (std::size_t i = 0; i < N; ++i)
+      if (freq[i] != 0)
+        leaves[m++] = static_cast<std::uint16_t>(i);
+    if (m == 0)
+      return res;
+    if (m == 1) {
+      res[leaves[0]] = 1;
+      return res;
+    }
+    std::stable_sort(leaves.begin(), leaves.begin() + m, [&freq](auto a, auto b) { return freq[a] < freq[b]; });
+    // two-queue Huffman on the sorted leaves, internal nodes come out in order
+    std::array<std::uint64_t, 2 * N> weight;
+    std::array<std::uint16_t, 2 * N> parent;
+    for (std::size_t i = 0; i < m; ++i)
+      weight[i] = freq[leaves[i]];
+    std::size_t leaf = 0, node = m;
+    for (std::size_t k = m; k < 2 * m - 1; ++k) {
+      std::size_t pick[2];
+      for (auto &p : pick)
+        p = leaf < m && (node >= k || weight[leaf] <= weight[node]) ? leaf++ : node++;
+      weight[k]         = weight[pick[0]] + weight[pick[1]];
+      parent[pick[0]]   = static_cast<std::uint16_t>(k);
+      parent[pick[1]]   = static_cast<std::uint16_t>(k);
+    }
+    std::array<std::uint8_t, 2 * N> depth;
+    depth[2 * m - 2] = 0;
+    std::array<std::size_t, 64> count{};
+    for (std::size_t k = 2 * m - 2; k-- > 0;) {
+      depth[k] = static_cast<std::uint8_t>(depth[parent[k]] + 1);
+      if (k < m)
+        ++count[std::min<unsigned>(depth[k], max_bits)];
+    }
+    // limit the lengths, then restore the Kraft sum to exactly 1
+    std::uint64_t total = 0;
+    for (unsigned i = 1; i <= max_bits; ++i)
+      total += std::uint64_t{count[i]} << (max_bits - i);
+    while (total > std::uint64_t{1} << max_bits) {
+      --count[max_bits];
+      for (unsigned i = max_bits - 1; i > 0; --i) {
+        if (count[i] != 0) {
+          --count[i];
+          count[i + 1] += 2;
+          break;
+        }
+      }
+      --total;
+    }
+    // the least frequent symbols get the longest codes
+    std::size_t next = 0;
+    for (unsigned len = max_bits; len > 0; --len)
+      for (std::size_t i = 0; i < count[len]; ++i)
+        res[leaves[next++]] = static_cast<std::uint8_t>(len);
+    return res;
+  }
+
+  // canonical codes, bit-reversed for the LSB-first stream
+  template <std::size_t N>
+  static std::array<std::uint16_t, N> codes(const std::array<std::uint8_t, N> &lengths) noexcept {
+    std::array<std::uint16_t, 16> count{}, next{};
+    for (auto l : lengths)
+      ++count[l];
+    count[0] = 0;
+    for (unsigned bits = 1, code = 0; bits < 16; ++bits) {
+      code       = (code + count[bits - 1]) << 1;
+      next[bits] = static_cast<std::uint16_t>(code);
+    }
+    std::array<std::uint16_t, N> res{};
+    for (std::size_t i = 0; i < N; ++i)
+      if (lengths[i] != 0)
+        res[i] = reverse(next[lengths[i]]++, lengths[i]);
+    return res;
+  }
+
+  static std::uint16_t reverse(unsigned code, unsigned length) noexcept {
+    unsigned res = 0;
+    for (unsigned i = 0; i < length; ++i, code >>= 1)
+      res = res << 1 | (code & 1);
+    return static_cast<std::uint16_t>(res);
+  }
+
+  static void stored_block(bit_writer &bits, const std::uint8_t *data, std::size_t size, bool final) {
+    bits.put(final ? 1 : 0, 3);
+    bits.flush();
+    bits.put(static_cast<std::uint32_t>(size | (~size & 0xffff) << 16), 32);
+    bits.append(data, size);
+  }
+
+  void huffman_block(bit_writer &bits, const std::uint8_t *data, std::size_t size, bool final) {
+    using codes_t = deflate_codes;
+    std::array<std::uint32_t, 286> lit_freq{};
+    std::array<std::uint32_t, 30> dist_freq{};
+    for (const auto &s : m_symbols) {
+      if (s.dist == 0) {
+        ++lit_freq[s.value];
+      } else {
+        ++lit_freq[257 + codes_t::length_code[s.value - 3]];
+        ++dist_freq[codes_t::distance(s.dist)];
+      }
+    }
+    lit_freq[256] = 1;
+    const auto lit_len = code_lengths(lit_freq, 15);
+    auto dist_len      = code_lengths(dist_freq, 15);
+    if (std::all_of(dist_len.begin(), dist_len.end(), [](auto l) { return l == 0; }))
+      dist_len[0] = 1;
+    std::size_t hlit = 286, hdist = 30;
+    while (lit_len[hlit - 1] == 0)
+      --hlit;
+    while (dist_len[hdist - 1] == 0)
+      --hdist;
+
+    // the code lengths, run-length coded with 16 (repeat), 17 and 18 (zeros)
+    std::array<std::uint8_t, 316> lens;
+    std::copy_n(lit_len.begin(), hlit, lens.begin());
+    std::copy_n(dist_len.begin(), hdist, lens.begin() + hlit);
+    const std::size_t total = hlit + hdist;
+    std::array<std::pair<std::uint8_t, std::uint8_t>, 316> rle;
+    std::size_t rle_size = 0;
+    std::array<std::uint32_t, 19> cl_freq{};
+    const auto push = [&](unsigned sym, unsigned extra) {
+      rle[rle_size++] = {static_cast<std::uint8_t>(sym), static_cast<std::uint8_t>(extra)};
+      ++cl_freq[sym];
+    };
+    for (std::size_t i = 0; i < total;) {
+      const unsigned l = lens[i];
+      std::size_t run  = 1;
+      while (i + run < total && lens[i + run] == l)
+        ++run;
+      if (l == 0 && run >= 3) {
+        run = std::min<std::size_t>(run, 138);
+        if (run >= 11)
+          push(18, static_cast<unsigned>(run - 11));
+        else
+          push(17, static_cast<unsigned>(run - 3));
+        i += run;
+      } else if (l != 0 && run >= 4) {
+        push(l, 0);
+        for (--run, ++i; run >= 3;) {
+          const std::size_t r = std::min<std::size_t>(run, 6);
+          push(16, static_cast<unsigned>(r - 3));
+          i += r;
+          run -= r;
+        }
+      } else {
+        push(l, 0);
+        ++i;
+      }
+    }
+    const auto cl_len = code_lengths(cl_freq, 7);
+    std::size_t hclen = 19;
+    while (hclen > 4 && cl_len[codes_t::code_order[hclen - 1]] == 0)
+      --hclen;
+
+    // stored instead when the codes do not pay off
+    std::uint64_t dynamic_bits = 3 + 14 + 3 * hclen;
+    for (std::size_t i = 0; i < 19; ++i)
+      dynamic_bits += std::uint64_t{cl_freq[i]} * (cl_len[i] + (i == 16 ? 2 : i == 17 ? 3 : i == 18 ? 7 : 0));
+    for (std::size_t i = 0; i < 286; ++i)
+      dynamic_bits += std::uint64_t{lit_freq[i]} * (lit_len[i] + (i > 256 ? codes_t::length_extra[i - 257] : 0));
+    for (std::size_t i = 0; i < 30; ++i)
+      dynamic_bits += std::uint64_t{dist_freq[i]} * (dist_len[i] + codes_t::dist_extra[i]);
+    const std::uint64_t stored_bits = (size + 5 * (size / 65535 + 1)) * 8 + 7;
+    if (stored_bits <= dynamic_bits) {
+      for (std::size_t pos = 0; pos == 0 || pos < size; pos += 65535)
+        stored_block(bits, data + pos, std::min<std::size_t>(65535, size - pos), final && pos + 65535 >= size);
+      return;
+    }
+
+    const auto lit_code  = codes(lit_len);
+    const auto dist_code = codes(dist_len);
+    const auto cl_code   = codes(cl_len);
+    bits.put(final ? 1 : 0, 1);
+    bits.put(2, 2);
+    bits.put(static_cast<std::uint32_t>(hlit - 257), 5);
+    bits.put(static_cast<std::uint32_t>(hdist - 1), 5);
+    bits.put(static_cast<std::uint32_t>(hclen - 4), 4);
+    for (std::size_t i = 0; i < hclen; ++i)
+      bits.put(cl_len[codes_t::code_order[i]], 3);
+    for (std::size_t i = 0; i < rle_size; ++i) {
+      const auto [sym, extra] = rle[i];
+      bits.put(cl_code[sym], cl_len[sym]);
+      if (sym >= 16)
+        bits.put(extra, sym == 16 ? 2 : sym == 17 ? 3 : 7);
+    }
+    for (const auto &s : m_symbols) {
+      if (s.dist == 0) {
+        bits.put(lit_code[s.value], lit_len[s.value]);
+      } else {
+        const unsigned lc = codes_t::length_code[s.value - 3];
+        bits.put(lit_code[257 + lc], lit_len[257 + lc]);
+        bits.put(s.value - codes_t::length_base[lc], codes_t::length_extra[lc]);
+        const unsigned dc = codes_t::distance(s.dist);
+        bits.put(dist_code[dc], dist_len[dc]);
+        bits.put(s.dist - codes_t::dist_base[dc], codes_t::dist_extra[dc]);
+      }
+    }
+    bits.put(lit_code[256], lit_len[256]);
+  }
+
+  int m_level;
+  std::vector<std::ptrdiff_t> m_head;
+  std::vector<std::ptrdiff_t> m_prev;
+  std::vector<symbol> m_symbols;
+};
+/**
+ * @brief DEFLATE decompressor
+ *
+ * @param[in] in compressed stream
+ * @param[in,out] out decompressed bytes are appended
+ * @param[in] max_size most bytes to append
+ * @return Returns the size of the stream in in
+ *
+ * @exception std::runtime_error if the stream is invalid, truncated or longer than max_size
+ */
+inline std::size_t inflate(std::span<const std::byte> in, std::vector<std::byte> &out, std::size_t max_size) {
+  using codes_t      = deflate_codes;
+  const auto invalid = [] { return std::runtime_error("invalid deflate data"); };
+  const auto *first  = reinterpret_cast<const std::uint8_t *>(in.data());
+  const auto *last   = first + in.size();
+  const auto *ptr    = first;
+  std::uint64_t bits = 0;
+  unsigned count     = 0;
+  std::size_t pad    = 0; // zero bytes read past the end
+  const auto refill  = [&] {
+    for (; count <= 56; count += 8) {
+      if (ptr != last)
+        bits |= std::uint64_t{*ptr++} << count;
+      else if (++pad > 8) // more than the buffer holds, so some were used
+        throw invalid();
+    }
+  };
+  const auto get = [&](unsigned n) {
+    if (count < n)
+      refill();
+    const auto res = static_cast<unsigned>(bits & ((std::uint64_t{1} << n) - 1));
+    bits >>= n;
+    count -= n;
+    return res;
+  };
+
+  // single-level tables of entries symbol << 4 | length, length 0 for no code
+  struct table {
+    std::vector<std::uint16_t> entries;
+    unsigned bits = 0;
+  };
+  const auto build = [&invalid](table &t, const std::uint8_t *lengths, std::size_t n) {
+    std::array<int, 16> num{};
+    for (std::size_t i = 0; i < n; ++i)
+      ++num[lengths[i]];
+    num[0]   = 0;
+    t.bits   = 0;
+    int left = 1;
+    for (unsigned len = 1; len < 16; ++len) {
+      left = (left << 1) - num[len];
+      if (left < 0)
+        throw invalid();
+      if (num[len] != 0)
+        t.bits = len;
+    }
+    t.entries.assign(std::size_t{1} << t.bits, 0);
+    std::array<unsigned, 16> next{};
+    for (unsigned len = 1, code = 0; len < 16; ++len) {
+      code      = (code + static_cast<unsigned>(num[len - 1])) << 1;
+      next[len] = code;
+    }
+    for (std::size_t sym = 0; sym < n; ++sym) {
+      const unsigned len = lengths[sym];
+      if (len == 0)
+        continue;
+      unsigned code = next[len]++, rev = 0;
+      for (unsigned i = 0; i < len; ++i, code >>= 1)
+        rev = rev << 1 | (code & 1);
+      for (std::size_t i = rev; i < t.entries.size(); i += std::size_t{1} << len)
+        t.entries[i] = static_cast<std::uint16_t>(sym << 4 | len);
+    }
+  };
+  const auto decode = [&](const table &t) -> unsigned {
+    if (count < t.bits)
+      refill();
+    const auto entry = t.entries.empty() ? 0 : t.entries[bits & ((std::uint64_t{1} << t.bits) - 1)];
+    if ((entry & 15) == 0)
+      throw invalid();
+    bits >>= entry & 15;
+    count -= entry & 15;
+    return entry >> 4;
+  };
+
+  const std::size_t start = out.size();
+  table lit, dist, cl;
+  for (bool final = false; !final;) {
+    final             = get(1) != 0;
+    const auto method = get(2);
+    if (method == 0) {
+      // whole bytes from here, the bits in the buffer are put back
+      get(count % 8);
+      ptr -= count / 8 - std::min<std::size_t>(pad, count / 8);
+      if (pad > count / 8)
+        throw invalid();
+      bits  = 0;
+      count = 0;
+      pad   = 0;
+      if (last - ptr < 4)
+        throw invalid();
+      const std::size_t len = ptr[0] | ptr[1] << 8, nlen = ptr[2] | ptr[3] << 8;
+      ptr += 4;
+      if (len != (~nlen & 0xffff) || static_cast<std::size_t>(last - ptr) < len)
+        throw invalid();
+      if (out.size() - start + len > max_size)
+        throw std::runtime_error("deflate data exceeds the expected size");
+      out.insert(out.end(), reinterpret_cast<const std::byte *>(ptr), reinterpret_cast<const std::byte *>(ptr + len));
+      ptr += len;
+      continue;
+    }
+    if (method == 1) {
+      std::array<std::uint8_t, 320> lengths;
+      std::fill_n(lengths.begin(), 144, 8);
+      std::fill_n(lengths.begin() + 144, 112, 9);
+      std::fill_n(lengths.begin() + 256, 24, 7);
+      std::fill_n(lengths.begin() + 280, 8, 8);
+      std::fill_n(lengths.begin() + 288, 32, 5);
+      build(lit, lengths.data(), 288);
+      build(dist, lengths.data() + 288, 32);
+    } else if (method == 2) {
+      const unsigned hlit = get(5) + 257, hdist = get(5) + 1, hclen = get(4) + 4;
+      std::array<std::uint8_t, 19> cl_len{};
+      for (unsigned i = 0; i < hclen; ++i)
+        cl_len[codes_t::code_order[i]] = static_cast<std::uint8_t>(get(3));
+      build(cl, cl_len.data(), 19);
+      std::array<std::uint8_t, 320> lengths{};
+      for (unsigned i = 0; i < hlit + hdist;) {
+        const unsigned sym = decode(cl);
+        unsigned repeat = 1, value = sym;
+        if (sym == 16) {
+          if (i == 0)
+            throw invalid();
+          value  = lengths[i - 1];
+          repeat = 3 + get(2);
+        } else if (sym == 17) {
+          value  = 0;
+          repeat = 3 + get(3);
+        } else if (sym == 18) {
+          value  = 0;
+          repeat = 11 + get(7);
+        }
+        if (i + repeat > hlit + hdist)
+          throw invalid();
+        std::fill_n(lengths.begin() + i, repeat, static_cast<std::uint8_t>(value));
+        i += repeat;
+      }
+      if (lengths[256] == 0)
+        throw invalid();
+      build(lit, lengths.data(), hlit);
+      build(dist, lengths.data() + hlit, hdist);
+    } else {
+      throw invalid();
+    }
+    for (;;) {
+      const unsigned sym = decode(lit);
+      if (sym < 256) {
+        if (out.size() - start >= max_size)
+          throw std::runtime_error("deflate data exceeds the expected size");
+        out.push_back(static_cast<std::byte>(sym));
+        continue;
+      }
+      if (sym == 256)
+        break;
+      const unsigned lc = sym - 257;
+      if (lc >= 29)
+        throw invalid();
+      const std::size_t len = codes_t::length_base[lc] + get(codes_t::length_extra[lc]);
+      const unsigned dc     = decode(dist);
+      if (dc >= 30)
+        throw invalid();
+      const std::size_t d = codes_t::dist_base[dc] + get(codes_t::dist_extra[dc]);
+      if (d > out.size() - start)
+        throw invalid();
+      if (out.size() - start + len > max_size)
+        throw std::runtime_error("deflate data exceeds the expected size");
+      const std::size_t pos = out.size();
+      out.resize(pos + len);
+      for (std::size_t i = 0; i < len; ++i)
+        out[pos + i] = out[pos + i - d];
+    }
+    if (pad * 8 > count)
+      throw invalid();
+  }
+  if (pad * 8 > count)
+    throw invalid();
+  return static_cast<std::size_t>(ptr - first) - (count / 8 - pad);
+}
+
+/**
+ * @brief zlib stream header
+ *
+ * @param[in] level compression level, recorded in the header
+ * @return Returns the two bytes
+ */
+[[nodiscard]] constexpr std::array<std::byte, 2> zlib_header(int level) noexcept {
+  // 32K window deflate, FLEVEL and the check bits that make the pair a multiple of 31
+  const unsigned flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+  unsigned flg          = flevel << 6;
+  flg += 31 - (0x78 * 256 + flg) % 31;
+  return {std::byte{0x78}, static_cast<std::byte>(flg)};
+}
+
+/**
+ * @brief compress into a zlib stream
+ *
+ * @param[in] in bytes
+ * @param[in] level 0 to store, 1 fastest to 9 smallest
+ * @return Returns the stream
+ *
+ * @exception std::invalid_argument if level is not in [0, 9]
+ */
+[[nodiscard]] inline std::vector<std::byte> zlib_compress(std::span<const std::byte> in, int level = 6) {
+  const auto header = zlib_header(level);
+  std::vector<std::byte> res(header.begin(), header.end());
+  deflate_encoder(level).compress(in, true, res);
+  const std::uint32_t adler = adler32(in);
+  for (int shift = 24; shift >= 0; shift -= 8)
+    res.push_back(static_cast<std::byte>(adler >> shift));
+  return res;
+}
+
+/**
+ * @brief decompress a zlib stream
+ *
+ * @param[in] in stream
+ * @param[in] max_size most bytes to decompress
+ * @return Returns the bytes
+ *
+ * @exception std::runtime_error if the stream is invalid, fails its checksum or is longer than max_size
+ */
+[[nodiscard]] inline std::vector<std::byte> zlib_decompress(std::span<const std::byte> in, std::size_t max_size) {
+  const auto invalid = [] { return std::runtime_error("invalid zlib data"); };
+  if (in.size() < 6)
+    throw invalid();
+  const auto cmf = static_cast<unsigned>(in[0]), flg = static_cast<unsigned>(in[1]);
+  if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (cmf * 256 + flg) % 31 != 0 || (flg & 0x20) != 0)
+    throw invalid();
+  std::vector<std::byte> res;
+  const std::size_t size = inflate(in.subspan(2), res, max_size) + 2;
+  if (in.size() - size < 4)
+    throw invalid();
+  std::uint32_t adler = 0;
+  for (std::size_t i = 0; i < 4; ++i)
+    adler = adler << 8 | static_cast<std::uint32_t>(in[size + i]);
+  if (adler != adler32(res))
+    throw std::runtime_error("zlib checksum mismatch");
+  return res;
+}
+} // namespace portal
+
+#endif // PORTAL_DEFLATE_HPP
@@ -0,0 +1,188 @@
+/**
+ * @file algorithm.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief image kernels
+ * @version 0.1
+ * @date 2022-04-09
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_ALGORITHM_HPP
+#define PORTAL_DRAWING_ALGORITHM_HPP
+
+#include "image_view.hpp"
+#include "packed.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace portal::drawing {
+/**
+ * @brief image or view with writable pixels
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept writable_image = image_like<T> && !std::is_const_v<typename view_t<T>::element_type>;
+
+/**
+ * @brief view of row-major pixels
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept row_major_view = std::same_as<typename std::remove_cvref_t<T>::layout_type, row_major>;
+
+/**
+ * @brief fill the pixels with specified value
+ *
+ * @param[in,out] dst image or view
+ * @param[in] pixel the pixel to assign to the elements
+ */
+template <writable_image Dst>
+void fill(Dst &&dst, const pixel_t<Dst> &pixel) {
+  // by value, the reference may alias the pixels and would be reloaded on each store
+  dst.view().for_each_run([pixel](auto *ptr, std::size_t, std::size_t, std::size_t count) {
+    std::fill_n(ptr, count, pixel);
+  });
+}
+
+/**
+ * @brief regions of a placement
+ *
+ * The source is placed with its top left corner at (x, y) of the
+ * destination and clipped to it.
+ *
+ * @param[in] src image or view
+ * @param[in] dst image or view
+ * @param[in] x left of the source in the destination
+ * @param[in] y top of the source in the destination
+ * @return Returns the overlapping subviews of src and dst, both empty if they do not overlap
+ */
+template <image_like Src, image_like Dst>
+[[nodiscard]] auto placement(const Src &src, Dst &&dst, std::ptrdiff_t x, std::ptrdiff_t y) {
+  const auto s    = src.view();
+  const auto d    = dst.view();
+  const auto clip = [](std::ptrdiff_t pos, std::size_t src_size, std::size_t dst_size, std::size_t &src_pos, std::size_t &dst_pos) -> std::size_t {
+    src_pos = pos < 0 ? static_cast<std::size_t>(-pos) : 0;
+    dst_pos = pos < 0 ? 0 : static_cast<std::size_t>(pos);
+    if (src_pos >= src_size || dst_pos >= dst_size)
+      return 0;
+    return std::min(src_size - src_pos, dst_size - dst_pos);
+  };
+  std::size_t sx, sy, dx, dy;
+  auto width  = clip(x, s.get_width(), d.get_width(), sx, dx);
+  auto height = clip(y, s.get_height(), d.get_height(), sy, dy);
+  if (width == 0 || height == 0) {
+    sx = sy = dx = dy = 0;
+    width = height = 0;
+  }
+  return std::pair(s.subview(sx, sy, width, height), d.subview(dx, dy, width, height));
+}
+
+/**
+ * @brief copy pixels into another image
+ *
+ * The source is placed with its top left corner at (x, y) of the
+ * destination and clipped to it. Source and destination may overlap when
+ * both are row_major, with other layouts they must not.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view
+ * @param[in] x left of the source in the destination
+ * @param[in] y top of the source in the destination
+ */
+template <image_like Src, writable_image Dst>
+requires std::same_as<pixel_t<Src>, pixel_t<Dst>>
+void blit(const Src &src, Dst &&dst, std::ptrdiff_t x = 0, std::ptrdiff_t y = 0) {
+  const auto [src_region, dst_region] = placement(src, dst, x, y);
+  if (dst_region.empty())
+    return;
+  const auto height = dst_region.get_height();
+  if constexpr (row_major_view<decltype(src_region)> && row_major_view<decltype(dst_region)>) {
+    // with overlap the rows are copied in the direction that reads before writing
+    const auto src_rows = src_region.rows();
+    const auto dst_rows = dst_region.rows();
+    const bool forward  = std::less<>()(dst_region.data(), src_region.data());
+    for (std::size_t i = 0; i < height; ++i) {
+      const auto j   = forward ? i : height - 1 - i;
+      const auto row = src_rows.begin()[j];
+      if (forward)
+        std::copy(row.begin(), row.end(), dst_rows.begin()[j].begin());
+      else
+        std::copy_backward(row.begin(), row.end(), dst_rows.begin()[j].end());
+    }
+  } else {
+    dst_region.for_each_run([&src_region](auto *ptr, std::size_t x, std::size_t y, std::size_t count) {
+      if constexpr (row_major_view<decltype(src_region)>)
+        std::copy_n(src_region.row(y) + x, count, ptr);
+      else
+        for (std::size_t i = 0; i < count; ++i)
+          ptr[i] = src_region(x + i, y);
+    });
+  }
+}
+
+/**
+ * @brief convert each pixel into another image
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] func conversion, called as func(src pixel) and returning the dst pixel
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <image_like Src, writable_image Dst, typename F>
+requires std::convertible_to<std::invoke_result_t<F &, const pixel_t<Src> &>, pixel_t<Dst>>
+void convert(const Src &src, Dst &&dst, F func) {
+  const auto s = src.view();
+  const auto d = dst.view();
+  if (s.get_width() != d.get_width() || s.get_height() != d.get_height())
+    throw std::invalid_argument("image sizes vary");
+  d.for_each_run([&s, &func](auto *ptr, std::size_t x, std::size_t y, std::size_t count) {
+    if constexpr (row_major_view<decltype(s)>) {
+      std::transform(s.row(y) + x, s.row(y) + x + count, ptr, func);
+    } else {
+      for (std::size_t i = 0; i < count; ++i)
+        ptr[i] = func(s(x + i, y));
+    }
+  });
+}
+
+/**
+ * @brief convert pixels into another format
+ *
+ * Each pixel is converted as by convert_pixel, rows of row_major sources
+ * go through the simd kernels of convert_pixels. Packed pixels are packed
+ * from and unpacked to their unpacked_type.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <image_like Src, writable_image Dst>
+requires format_color<pixel_t<Src>> && format_color<pixel_t<Dst>>
+void convert(const Src &src, Dst &&dst) {
+  using to_pixel = pixel_t<Dst>;
+  const auto s   = src.view();
+  const auto d   = dst.view();
+  if (s.get_width() != d.get_width() || s.get_height() != d.get_height())
+    throw std::invalid_argument("image sizes vary");
+  d.for_each_run([&s](auto *ptr, std::size_t x, std::size_t y, std::size_t count) {
+    if constexpr (row_major_view<decltype(s)>) {
+      convert_pixels(std::span<const pixel_t<Src>>(s.row(y) + x, count), std::span(ptr, count));
+    } else {
+      for (std::size_t i = 0; i < count; ++i)
+        ptr[i] = convert_pixel<to_pixel>(s(x + i, y));
+    }
+  });
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_ALGORITHM_HPP
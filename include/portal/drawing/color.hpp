@@ -18,81 +18,157 @@
  *
  */
 namespace portal::drawing {
+/**
+ * @brief transfer function of the color samples
+ *
+ * Alpha is linear in every encoding.
+ */
+enum class color_encoding {
+  srgb,  //!< @brief sRGB transfer curve, how images are usually stored and displayed
+  linear //!< @brief proportional to light intensity, where blending and filtering are correct
+};
+
 /**
  * @brief BGRA color
  *
  * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_bgra {
   using sample_type = T; //!< @brief sample type
-  sample_type blue;      //!< @brief blue
-  sample_type green;     //!< @brief green
-  sample_type red;       //!< @brief red
-  sample_type alpha;     //!< @brief alpha
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type blue;  //!< @brief blue
+  sample_type green; //!< @brief green
+  sample_type red;   //!< @brief red
+  sample_type alpha; //!< @brief alpha
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_bgra &, const basic_bgra &) = default;
 };
 
 /**
  * @brief RGBA color
  *
  * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_rgba {
   using sample_type = T; //!< @brief sample type
-  sample_type red;       //!< @brief red
-  sample_type green;     //!< @brief green
-  sample_type blue;      //!< @brief blue
-  sample_type alpha;     //!< @brief alpha
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type red;   //!< @brief red
+  sample_type green; //!< @brief green
+  sample_type blue;  //!< @brief blue
+  sample_type alpha; //!< @brief alpha
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_rgba &, const basic_rgba &) = default;
 };
 
 /**
  * @brief BGR color
  *
  * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_bgr {
   using sample_type = T; //!< @brief sample type
-  sample_type blue;      //!< @brief blue
-  sample_type green;     //!< @brief green
-  sample_type red;       //!< @brief red
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type blue;  //!< @brief blue
+  sample_type green; //!< @brief green
+  sample_type red;   //!< @brief red
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_bgr &, const basic_bgr &) = default;
 };
 
 /**
  * @brief RGB color
  *
  * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_rgb {
   using sample_type = T; //!< @brief sample type
-  sample_type red;       //!< @brief red
-  sample_type green;     //!< @brief green
-  sample_type blue;      //!< @brief blue
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type red;   //!< @brief red
+  sample_type green; //!< @brief green
+  sample_type blue;  //!< @brief blue
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_rgb &, const basic_rgb &) = default;
 };
 
 /**
  * @brief Grayscale and alpha
  *
- * @tparam T
+ * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_ga {
   using sample_type = T; //!< @brief sample type
-  sample_type gray;      //!< @brief gray
-  sample_type alpha;     //!< @brief alpha
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type gray;  //!< @brief gray
+  sample_type alpha; //!< @brief alpha
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_ga &, const basic_ga &) = default;
 };
 
 /**
  * @brief Grayscale
  *
- * @tparam T
+ * @tparam T sample type
+ * @tparam E encoding of the color samples
  */
-template <typename T>
+template <typename T, color_encoding E = color_encoding::srgb>
 struct basic_g {
   using sample_type = T; //!< @brief sample type
-  sample_type gray;      //!< @brief gray
+
+  static constexpr color_encoding encoding = E; //!< @brief encoding of the color samples
+
+  sample_type gray; //!< @brief gray
+
+  /**
+   * @brief equal to
+   *
+   * @return true if all samples are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const basic_g &, const basic_g &) = default;
 };
 
 /**
@@ -140,6 +216,70 @@ concept gray_color = requires(T &a) {
   a.gray;
 };
 
+/**
+ * @brief encoding of the color samples
+ *
+ * Colors without an encoding member are taken as sRGB.
+ *
+ * @tparam T color
+ */
+template <pixel_color T>
+inline constexpr color_encoding encoding_v = color_encoding::srgb;
+
+/**
+ * @brief encoding of the color samples
+ *
+ * @tparam T color with an encoding member
+ */
+template <pixel_color T>
+requires requires {
+  T::encoding;
+}
+inline constexpr color_encoding encoding_v<T> = T::encoding;
+
+/**
+ * @brief same color with other samples
+ *
+ * @tparam T color
+ * @tparam S sample type
+ * @tparam E encoding
+ */
+template <pixel_color T, typename S, color_encoding E>
+struct rebind_color;
+
+/**
+ * @brief same color with other samples
+ *
+ * @tparam C color template
+ * @tparam U sample type of C
+ * @tparam F encoding of C
+ * @tparam S sample type
+ * @tparam E encoding
+ */
+template <template <typename, color_encoding> typename C, typename U, color_encoding F, typename S, color_encoding E>
+struct rebind_color<C<U, F>, S, E> {
+  using type = C<S, E>; //!< @brief color with the samples S in E
+};
+
+/**
+ * @brief same color with other samples
+ *
+ * @tparam T color
+ * @tparam S sample type
+ * @tparam E encoding
+ */
+template <pixel_color T, typename S, color_encoding E = encoding_v<T>>
+using rebind_color_t = typename rebind_color<T, S, E>::type;
+
+/**
+ * @brief same color with another encoding
+ *
+ * @tparam T color
+ * @tparam E encoding
+ */
+template <pixel_color T, color_encoding E>
+using with_encoding_t = rebind_color_t<T, typename T::sample_type, E>;
+
 } // namespace portal::drawing
 
 #endif // PORTAL_DRAWING_COLOR_HPP
\ No newline at end of file
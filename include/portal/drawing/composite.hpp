@@ -0,0 +1,465 @@
+/**
+ * @file composite.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief alpha compositing
+ * @version 0.1
+ * @date 2022-04-12
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_COMPOSITE_HPP
+#define PORTAL_DRAWING_COMPOSITE_HPP
+
+#include "algorithm.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace portal::drawing {
+/**
+ * @brief compositing operator
+ *
+ * The Porter-Duff operators and the separable blend modes of the W3C
+ * compositing model. On premultiplied samples every operator is the same
+ * formula for the colors and the alpha, with s, d the source and
+ * destination samples and as, ad their alphas.
+ */
+enum class composite_op {
+  over,         //!< @brief s + d (1 - as)
+  in,           //!< @brief s ad
+  out,          //!< @brief s (1 - ad)
+  atop,         //!< @brief s ad + d (1 - as)
+  exclusive_or, //!< @brief s (1 - ad) + d (1 - as)
+  multiply,     //!< @brief s d + s (1 - ad) + d (1 - as)
+  screen,       //!< @brief s + d - s d
+  add           //!< @brief min(1, s + d)
+};
+
+/**
+ * @brief alpha representation
+ *
+ */
+enum class alpha_mode {
+  straight,     //!< @brief colors independent of the alpha
+  premultiplied //!< @brief colors multiplied by the alpha, at most the alpha
+};
+
+/**
+ * @brief color with an alpha that can be composited
+ *
+ * Half pixels are converted to float first, their samples do no arithmetic.
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept composite_color = alpha_color<T> && convertible_color<T> && !std::same_as<typename T::sample_type, half>;
+
+/**
+ * @brief the operator leaves the destination as it is under a fully transparent source
+ *
+ * @tparam Op operator
+ */
+template <composite_op Op>
+inline constexpr bool keeps_destination_v = Op != composite_op::in && Op != composite_op::out;
+
+/**
+ * @brief divide by the maximum sample value
+ *
+ * Rounds to nearest with shifts only, exact for x <= max * max.
+ *
+ * @tparam T integer sample type
+ * @param[in] x value
+ * @return Returns round(x / sample_max<T>)
+ */
+template <pixel_sample T>
+requires std::is_integral_v<T>
+[[nodiscard]] constexpr std::uint32_t div_max(std::uint32_t x) noexcept {
+  constexpr unsigned bits = sizeof(T) * 8;
+  x += 1u << (bits - 1);
+  return (x + (x >> bits)) >> bits;
+}
+
+/**
+ * @brief composite one premultiplied sample
+ *
+ * Integer samples are computed in fixed point with a single rounding.
+ * Results above the maximum saturate.
+ *
+ * @tparam Op operator
+ * @tparam T sample type
+ * @param[in] s source sample
+ * @param[in] d destination sample
+ * @param[in] as source alpha
+ * @param[in] ad destination alpha
+ * @return Returns the composited sample
+ */
+template <composite_op Op, pixel_sample T>
+[[nodiscard]] constexpr T composite_sample(T s, T d, T as, T ad) noexcept {
+  using enum composite_op;
+  if constexpr (std::is_floating_point_v<T>) {
+    if constexpr (Op == over)
+      return s + d * (1 - as);
+    else if constexpr (Op == in)
+      return s * ad;
+    else if constexpr (Op == out)
+      return s * (1 - ad);
+    else if constexpr (Op == atop)
+      return s * ad + d * (1 - as);
+    else if constexpr (Op == exclusive_or)
+      return s * (1 - ad) + d * (1 - as);
+    else if constexpr (Op == multiply)
+      return s * d + s * (1 - ad) + d * (1 - as);
+    else if constexpr (Op == screen)
+      return s + d - s * d;
+    else
+      return math::fast::select(s + d < 1, s + d, T(1));
+  } else {
+    constexpr std::uint32_t m = sample_max<T>;
+    const std::uint32_t xs    = s;
+    const std::uint32_t xd    = d;
+    const std::uint32_t ias   = m - as;
+    const std::uint32_t iad   = m - ad;
+    std::uint32_t res         = 0;
+    if constexpr (Op == over)
+      res = xs + div_max<T>(xd * ias);
+    else if constexpr (Op == in)
+      res = div_max<T>(xs * ad);
+    else if constexpr (Op == out)
+      res = div_max<T>(xs * iad);
+    else if constexpr (Op == atop)
+      res = div_max<T>(xs * ad + xd * ias);
+    else if constexpr (Op == exclusive_or)
+      res = div_max<T>(xs * iad + xd * ias);
+    else if constexpr (Op == multiply)
+      res = div_max<T>(xs * xd + xs * iad + xd * ias);
+    else if constexpr (Op == screen)
+      res = xs + xd - div_max<T>(xs * xd);
+    else
+      res = xs + xd;
+    return static_cast<T>(std::min(m, res));
+  }
+}
+
+/**
+ * @brief premultiply the colors by the alpha
+ *
+ * @tparam P color
+ * @param[in] pixel straight pixel
+ * @return Returns the premultiplied pixel
+ */
+template <composite_color P>
+[[nodiscard]] constexpr P premultiply(const P &pixel) noexcept {
+  using S         = typename P::sample_type;
+  const auto mult = [a = pixel.alpha](S c) -> S {
+    if constexpr (std::is_floating_point_v<S>)
+      return c * a;
+    else
+      return static_cast<S>(div_max<S>(std::uint32_t{c} * a));
+  };
+  P res = pixel;
+  if constexpr (true_color<P>) {
+    res.red   = mult(pixel.red);
+    res.green = mult(pixel.green);
+    res.blue  = mult(pixel.blue);
+  } else {
+    res.gray = mult(pixel.gray);
+  }
+  return res;
+}
+
+/**
+ * @brief divide the colors by the alpha
+ *
+ * @tparam P color
+ * @param[in] pixel premultiplied pixel
+ * @return Returns the straight pixel, colors of a transparent pixel are 0
+ */
+template <composite_color P>
+[[nodiscard]] constexpr P unpremultiply(const P &pixel) noexcept {
+  using S        = typename P::sample_type;
+  const auto div = [a = pixel.alpha](S c) -> S {
+    if (a == 0)
+      return 0;
+    if constexpr (std::is_floating_point_v<S>)
+      return c / a;
+    else
+      return static_cast<S>(std::min<std::uint32_t>(sample_max<S>, (std::uint32_t{c} * sample_max<S> + a / 2u) / a));
+  };
+  P res = pixel;
+  if constexpr (true_color<P>) {
+    res.red   = div(pixel.red);
+    res.green = div(pixel.green);
+    res.blue  = div(pixel.blue);
+  } else {
+    res.gray = div(pixel.gray);
+  }
+  return res;
+}
+
+/**
+ * @brief composite a pixel
+ *
+ * Straight pixels are composited in float and converted back, where the
+ * result is transparent the colors are 0. Under a fully transparent source
+ * the operators of keeps_destination_v leave the destination as it is in
+ * both modes.
+ *
+ * @tparam Op operator
+ * @tparam M alpha representation
+ * @tparam P color
+ * @param[in] src source pixel
+ * @param[in] dst destination pixel
+ * @return Returns src Op dst
+ */
+template <composite_op Op, alpha_mode M = alpha_mode::premultiplied, composite_color P>
+[[nodiscard]] constexpr P composite_pixel(const P &src, const P &dst) noexcept {
+  using S = typename P::sample_type;
+  P res{};
+  if constexpr (M == alpha_mode::premultiplied) {
+    const auto op = [as = src.alpha, ad = dst.alpha](S s, S d) { return composite_sample<Op>(s, d, as, ad); };
+    if constexpr (true_color<P>) {
+      res.red   = op(src.red, dst.red);
+      res.green = op(src.green, dst.green);
+      res.blue  = op(src.blue, dst.blue);
+    } else {
+      res.gray = op(src.gray, dst.gray);
+    }
+    res.alpha = op(src.alpha, dst.alpha);
+  } else {
+    // a transparent result has premultiplied colors 0, which stay 0 under the reciprocal of a tiny alpha
+    const float as  = convert_sample<float>(src.alpha);
+    const float ad  = convert_sample<float>(dst.alpha);
+    const float ao  = composite_sample<Op>(as, ad, as, ad);
+    const float inv = 1 / math::fast::select(ao > 0, ao, std::numeric_limits<float>::min());
+    const bool keep = keeps_destination_v<Op> && src.alpha == S(0);
+    const auto pick = [keep](S d, S c) -> S {
+      // a blend of the bits instead of keep ? d : c, which would sink the float math of c into a branch
+      if constexpr (std::is_floating_point_v<S>)
+        return math::fast::select(keep, d, c);
+      else
+        return static_cast<S>((d & -S(keep)) | (c & ~-S(keep)));
+    };
+    const auto op = [&](S s, S d) {
+      return pick(d, convert_sample<S>(composite_sample<Op>(convert_sample<float>(s) * as, convert_sample<float>(d) * ad, as, ad) * inv));
+    };
+    if constexpr (true_color<P>) {
+      res.red   = op(src.red, dst.red);
+      res.green = op(src.green, dst.green);
+      res.blue  = op(src.blue, dst.blue);
+    } else {
+      res.gray = op(src.gray, dst.gray);
+    }
+    res.alpha = pick(dst.alpha, convert_sample<S>(ao));
+  }
+  return res;
+}
+
+namespace simd {
+/**
+ * @brief composite premultiplied samples in 16 bit lanes
+ *
+ * @tparam Op operator
+ * @param[in] s source samples
+ * @param[in] d destination samples
+ * @param[in] as source alpha of each lane
+ * @param[in] ad destination alpha of each lane
+ * @param[in] max maximum sample value of each lane
+ * @param[in] mul product of two samples
+ * @param[in] sum sum of two products
+ * @param[in] div product divided by the maximum
+ * @return Returns the composited samples
+ */
+template <composite_op Op, typename Mul, typename Sum, typename Div>
+__m128i composite_lanes(__m128i s, __m128i d, __m128i as, __m128i ad, __m128i max, Mul mul, Sum sum, Div div) noexcept {
+  using enum composite_op;
+  const __m128i ias = _mm_sub_epi16(max, as);
+  const __m128i iad = _mm_sub_epi16(max, ad);
+  if constexpr (Op == over)
+    return _mm_adds_epu16(s, div(mul(d, ias)));
+  else if constexpr (Op == in)
+    return div(mul(s, ad));
+  else if constexpr (Op == out)
+    return div(mul(s, iad));
+  else if constexpr (Op == atop)
+    return div(sum(mul(s, ad), mul(d, ias)));
+  else if constexpr (Op == exclusive_or)
+    return div(sum(mul(s, iad), mul(d, ias)));
+  else if constexpr (Op == multiply)
+    return div(sum(mul(s, d), sum(mul(s, iad), mul(d, ias))));
+  else
+    return _mm_sub_epi16(_mm_add_epi16(s, d), div(mul(s, d)));
+}
+
+/**
+ * @brief composite premultiplied 8 or 16 bit 4 sample pixels
+ *
+ * The samples are in 16 bit lanes, two pixels per register, and the alphas
+ * are broadcast with word shuffles. 8 bit products fit a lane, 16 bit
+ * products are kept as a high and a low lane with the carries propagated
+ * by hand. Both divide with shifts, the same as div_max. Colors above the
+ * alpha may wrap instead of saturating.
+ *
+ * @tparam Op operator
+ * @tparam P color
+ * @param[in] src source pixels
+ * @param[in,out] dst destination pixels
+ * @param[in] count number of pixels
+ * @return Returns the number of pixels composited
+ */
+template <composite_op Op, composite_color P>
+std::size_t composite(const P *src, P *dst, std::size_t count) noexcept {
+  using S       = typename P::sample_type;
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+  if constexpr (channels_v<P> == 4 && std::is_integral_v<S>) {
+    constexpr int a    = offsetof(P, alpha) / sizeof(S);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max  = _mm_set1_epi16(static_cast<short>(sample_max<S>));
+    const auto alpha   = [](__m128i x) {
+      return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(a, a, a, a)), _MM_SHUFFLE(a, a, a, a));
+    };
+    const auto lanes = [&](__m128i s, __m128i d, auto mul, auto sum, auto div) {
+      return composite_lanes<Op>(s, d, alpha(s), alpha(d), max, mul, sum, div);
+    };
+    if constexpr (sizeof(S) == 1) {
+      const __m128i half = _mm_set1_epi16(128);
+      const auto mul     = [](__m128i x, __m128i y) { return _mm_mullo_epi16(x, y); };
+      const auto sum     = [](__m128i x, __m128i y) { return _mm_add_epi16(x, y); };
+      const auto div     = [&](__m128i x) {
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+      };
+      for (; i + 4 <= count; i += 4) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i res;
+        if constexpr (Op == composite_op::add)
+          res = _mm_adds_epu8(s, d);
+        else
+          res = _mm_packus_epi16(lanes(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), mul, sum, div),
+                                 lanes(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), mul, sum, div));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), res);
+      }
+    } else {
+      struct wide {
+        __m128i hi, lo;
+      };
+      const __m128i one  = _mm_set1_epi16(1);
+      const __m128i half = _mm_set1_epi16(static_cast<short>(0x8000));
+      const auto mul     = [](__m128i x, __m128i y) { return wide{_mm_mulhi_epu16(x, y), _mm_mullo_epi16(x, y)}; };
+      const auto sum     = [&](wide x, wide y) {
+        // the saturating sum differs from the wrapping one exactly where the low lane carries
+        const __m128i lo    = _mm_add_epi16(x.lo, y.lo);
+        const __m128i carry = _mm_add_epi16(_mm_cmpeq_epi16(_mm_adds_epu16(x.lo, y.lo), lo), one);
+        return wide{_mm_add_epi16(_mm_add_epi16(x.hi, y.hi), carry), lo};
+      };
+      const auto div = [&](wide x) {
+        x = sum(x, wide{zero, half});
+        return sum(x, wide{zero, x.hi}).hi;
+      };
+      for (; i + 2 <= count; i += 2) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i res;
+        if constexpr (Op == composite_op::add)
+          res = _mm_adds_epu16(s, d);
+        else
+          res = lanes(s, d, mul, sum, div);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), res);
+      }
+    }
+  }
+#endif
+  return i;
+}
+} // namespace simd
+
+/**
+ * @brief composite a row of pixels
+ *
+ * Same as composite_pixel on each pixel. The row is taken in spans of 64
+ * pixels, a span of fully transparent source is skipped when the operator
+ * keeps the destination and a fully opaque one is copied by over.
+ * Premultiplied 8 and 16 bit 4 sample pixels run a simd kernel, others a
+ * loop the compiler vectorizes.
+ *
+ * @tparam Op operator
+ * @tparam M alpha representation
+ * @tparam P color
+ * @param[in] src source pixels
+ * @param[in,out] dst destination pixels
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <composite_op Op, alpha_mode M = alpha_mode::premultiplied, composite_color P>
+void composite_pixels(std::span<const P> src, std::span<P> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  using S                    = typename P::sample_type;
+  using bits                 = std::conditional_t<sizeof(S) == 1, std::uint8_t, std::conditional_t<sizeof(S) == 2, std::uint16_t, std::uint32_t>>;
+  constexpr bits opaque      = std::bit_cast<bits>(sample_max<S>);
+  constexpr std::size_t span = 64;
+  for (std::size_t first = 0; first < src.size(); first += span) {
+    const auto n       = std::min(span, src.size() - first);
+    const P *s         = src.data() + first;
+    P *d               = dst.data() + first;
+
+    // or-reductions of the alpha bits, cheaper than counting compares
+    bits any    = 0;
+    bits uneven = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto a = std::bit_cast<bits>(s[i].alpha);
+      any |= a;
+      uneven |= a ^ opaque;
+    }
+    if (keeps_destination_v<Op> && any == 0)
+      continue;
+    if (Op == composite_op::over && uneven == 0) {
+      std::copy_n(s, n, d);
+      continue;
+    }
+    std::size_t i = 0;
+    if constexpr (M == alpha_mode::premultiplied)
+      i = simd::composite<Op>(s, d, n);
+    for (; i < n; ++i)
+      d[i] = composite_pixel<Op, M>(s[i], d[i]);
+  }
+}
+
+/**
+ * @brief composite an image onto another
+ *
+ * The source is placed with its top left corner at (x, y) of the
+ * destination and clipped to it, as by blit. Source and destination must
+ * not overlap.
+ *
+ * @tparam Op operator
+ * @tparam M alpha representation
+ * @param[in] src image or view
+ * @param[in,out] dst image or view
+ * @param[in] x left of the source in the destination
+ * @param[in] y top of the source in the destination
+ */
+template <composite_op Op, alpha_mode M = alpha_mode::premultiplied, image_like Src, writable_image Dst>
+requires std::same_as<pixel_t<Src>, pixel_t<Dst>> && composite_color<pixel_t<Dst>>
+void composite(const Src &src, Dst &&dst, std::ptrdiff_t x = 0, std::ptrdiff_t y = 0) {
+  const auto [src_region, dst_region] = placement(src, dst, x, y);
+  dst_region.for_each_run([&src_region](auto *ptr, std::size_t x, std::size_t y, std::size_t count) {
+    if constexpr (row_major_view<decltype(src_region)>) {
+      composite_pixels<Op, M>(std::span<const pixel_t<Dst>>(src_region.row(y) + x, count), std::span(ptr, count));
+    } else {
+      for (std::size_t i = 0; i < count; ++i)
+        ptr[i] = composite_pixel<Op, M>(src_region(x + i, y), ptr[i]);
+    }
+  });
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_COMPOSITE_HPP
@@ -0,0 +1,410 @@
+/**
+ * @file convolution.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief separable convolution and blur
+ * @version 0.1
+ * @date 2022-04-21
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_CONVOLUTION_HPP
+#define PORTAL_DRAWING_CONVOLUTION_HPP
+
+#include "../thread_pool.hpp"
+#include "algorithm.hpp"
+#include "color.hpp"
+#include "image.hpp"
+#include "parallel.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief pixels read outside of an image
+ *
+ */
+enum class edge_mode {
+  clamp,  //!< @brief the nearest edge pixel
+  mirror, //!< @brief reflected at the edge, the edge pixel repeated
+  wrap,   //!< @brief from the opposite edge
+};
+
+/**
+ * @brief index of the pixel read for an index outside of [0, size)
+ *
+ * @param[in] i index
+ * @param[in] size size, not 0
+ * @param[in] edge edge mode
+ * @return Returns the index in [0, size)
+ */
+[[nodiscard]] constexpr std::size_t edge_index(std::ptrdiff_t i, std::size_t size, edge_mode edge) noexcept {
+  const auto n = static_cast<std::ptrdiff_t>(size);
+  switch (edge) {
+  case edge_mode::clamp:
+    return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(i, 0, n - 1));
+  case edge_mode::mirror: {
+    const std::ptrdiff_t m = (i % (2 * n) + 2 * n) % (2 * n);
+    return static_cast<std::size_t>(m < n ? m : 2 * n - 1 - m);
+  }
+  default:
+    return static_cast<std::size_t>((i % n + n) % n);
+  }
+}
+
+/**
+ * @brief one-dimensional filter of a separable filter
+ *
+ */
+struct filter_pass {
+  std::size_t radius = 0;        //!< @brief radius, the filter takes 2 radius + 1 pixels
+  std::span<const float> weights; //!< @brief 2 radius + 1 weights, empty for a box of the radius
+};
+
+/**
+ * @brief run one-dimensional filters over lines of pixels
+ *
+ * The lines are taken in groups, interleaved so that each position of a
+ * group is one vector of all channels of all lines, and the filters run
+ * along the group with that vector: simd across channels and lines
+ * without gathers. Each result is stored as the pixels of the group at
+ * one position, which are contiguous in a transposed image, so both
+ * passes of a separable filter read along rows.
+ *
+ * @tparam C channels
+ * @param[in] length pixels per line
+ * @param[in] lines lines
+ * @param[in] passes filters, in order
+ * @param[in] edge edge mode
+ * @param[in] load called as load(line, scratch) from several threads, returns length pixels of C floats, in scratch or elsewhere
+ * @param[in] store called as store(first, count, result) from several threads, the pixels of count lines from first at position x are
+ * result[x * lanes, x * lanes + count * C) with lanes = C max(1, 32 / C)
+ * @param[in] pool pool
+ */
+template <std::size_t C, typename Load, typename Store>
+void filter_lines(std::size_t length, std::size_t lines, std::span<const filter_pass> passes, edge_mode edge, Load load, Store store, thread_pool &pool) {
+  // 32 floats per position: 8 lanes of 4 channels, 32 of 1
+  constexpr std::size_t group = std::max<std::size_t>(1, 32 / C);
+  constexpr std::size_t lanes = group * C;
+  std::size_t pad             = 0;
+  for (const auto &pass : passes)
+    pad = std::max(pad, pass.radius + 1);
+  const std::size_t groups = (lines + group - 1) / group;
+
+  pool.parallel_for(groups, 0, [&](std::size_t first, std::size_t last) {
+    std::vector<float> scratch(group * length * C);
+    std::vector<float> a((length + 2 * pad) * lanes), b(a.size());
+    float *in  = a.data() + pad * lanes;
+    float *out = b.data() + pad * lanes;
+    std::array<const float *, group> rows;
+    const auto fill_pad = [&](float *line) {
+      for (std::size_t i = 1; i <= pad; ++i) {
+        const auto before = -static_cast<std::ptrdiff_t>(i), after = static_cast<std::ptrdiff_t>(length - 1 + i);
+        std::copy_n(line + edge_index(before, length, edge) * lanes, lanes, line + before * static_cast<std::ptrdiff_t>(lanes));
+        std::copy_n(line + edge_index(after, length, edge) * lanes, lanes, line + after * static_cast<std::ptrdiff_t>(lanes));
+      }
+    };
+
+    for (std::size_t g = first; g < last; ++g) {
+      const std::size_t line0 = g * group;
+      const std::size_t count = std::min(group, lines - line0);
+      // transpose in the tile: lane r * C + c of position x is channel c of line0 + r at x
+      for (std::size_t r = 0; r < count; ++r)
+        rows[r] = load(line0 + r, scratch.data() + r * length * C);
+      for (std::size_t x = 0; x < length; ++x) {
+        float *dst = in + x * lanes;
+        for (std::size_t r = 0; r < count; ++r)
+          std::copy_n(rows[r] + x * C, C, dst + r * C);
+        std::fill(dst + count * C, dst + lanes, 0.0f);
+      }
+      fill_pad(in);
+
+      for (const auto &pass : passes) {
+        const auto r = static_cast<std::ptrdiff_t>(pass.radius);
+        if (pass.weights.empty()) {
+          // running sum, the same cost for any radius
+          const float scale = 1.0f / static_cast<float>(2 * r + 1);
+          std::array<float, lanes> sum{};
+          for (std::ptrdiff_t k = -r; k <= r; ++k)
+            for (std::size_t l = 0; l < lanes; ++l)
+              sum[l] += in[k * static_cast<std::ptrdiff_t>(lanes) + static_cast<std::ptrdiff_t>(l)];
+          for (std::size_t x = 0; x < length; ++x) {
+            const float *enter = in + (static_cast<std::ptrdiff_t>(x) + r + 1) * static_cast<std::ptrdiff_t>(lanes);
+            const float *leave = in + (static_cast<std::ptrdiff_t>(x) - r) * static_cast<std::ptrdiff_t>(lanes);
+            for (std::size_t l = 0; l < lanes; ++l) {
+              out[x * lanes + l] = sum[l] * scale;
+              sum[l] += enter[l] - leave[l];
+            }
+          }
+        } else {
+          for (std::size_t x = 0; x < length; ++x) {
+            std::array<float, lanes> acc{};
+            const float *window = in + (static_cast<std::ptrdiff_t>(x) - r) * static_cast<std::ptrdiff_t>(lanes);
+            for (std::size_t k = 0; k < pass.weights.size(); ++k)
+              for (std::size_t l = 0; l < lanes; ++l)
+                acc[l] += pass.weights[k] * window[k * lanes + l];
+            std::copy_n(acc.data(), lanes, out + x * lanes);
+          }
+        }
+        std::swap(in, out);
+        fill_pad(in);
+      }
+
+      store(line0, count, static_cast<const float *>(in));
+    }
+  });
+}
+
+/**
+ * @brief apply a separable filter
+ *
+ * Rows are filtered into a transposed float image and its rows, the
+ * columns, back into dst, each by filter_lines in parallel, so the
+ * vertical filters never read along columns. The samples are filtered as
+ * they are encoded, for blur in linear light convert to a linear format
+ * first; colors with alpha should be premultiplied. src and dst may be
+ * the same image.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] horizontal filters along rows, in order
+ * @param[in] vertical filters along columns, in order
+ * @param[in] edge edge mode
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ or the size of some weights is not 2 radius + 1
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void separable_filter(const Src &src, Dst &&dst, std::span<const filter_pass> horizontal, std::span<const filter_pass> vertical, edge_mode edge = edge_mode::clamp,
+                      thread_pool &pool = thread_pool::shared()) {
+  using S                     = pixel_t<Src>;
+  using D                     = pixel_t<Dst>;
+  using W                     = rebind_color_t<D, float>;
+  constexpr std::size_t C     = simd::channels_v<W>;
+  constexpr std::size_t group = std::max<std::size_t>(1, 32 / C);
+  constexpr std::size_t lanes = group * C;
+  const auto s                = src.view();
+  const auto d                = dst.view();
+  const std::size_t w         = s.get_width();
+  const std::size_t h         = s.get_height();
+  if (w != d.get_width() || h != d.get_height())
+    throw std::invalid_argument("image sizes vary");
+  for (const auto *passes : {&horizontal, &vertical})
+    for (const auto &pass : *passes)
+      if (!pass.weights.empty() && pass.weights.size() != 2 * pass.radius + 1)
+        throw std::invalid_argument("weights must be 2 radius + 1");
+  if (s.empty())
+    return;
+
+  // w rows of h pixels, column x of the image is row x
+  std::vector<float> transposed(w * h * C);
+  filter_lines<C>(
+      w, h, horizontal, edge,
+      [&s, w](std::size_t y, float *scratch) -> const float * {
+        auto *row = reinterpret_cast<W *>(scratch);
+        if constexpr (row_major_view<decltype(s)>)
+          convert_pixels(std::span<const S>(s.row(y), w), std::span(row, w));
+        else
+          for (std::size_t x = 0; x < w; ++x)
+            row[x] = convert_pixel<W>(s(x, y));
+        return scratch;
+      },
+      [&transposed, w, h](std::size_t y, std::size_t count, const float *result) {
+        for (std::size_t x = 0; x < w; ++x)
+          std::copy_n(result + x * lanes, count * C, transposed.data() + (x * h + y) * C);
+      },
+      pool);
+  filter_lines<C>(
+      h, w, vertical, edge, [&transposed, h](std::size_t x, float *) -> const float * { return transposed.data() + x * h * C; },
+      [&d, h](std::size_t x, std::size_t count, const float *result) {
+        // one conversion for the tile, then count pixels into each row
+        std::vector<D> pixels(h * group);
+        convert_pixels(std::span(reinterpret_cast<const W *>(result), h * group), std::span(pixels));
+        for (std::size_t y = 0; y < h; ++y) {
+          if constexpr (row_major_view<decltype(d)>)
+            std::copy_n(pixels.data() + y * group, count, d.row(y) + x);
+          else
+            for (std::size_t i = 0; i < count; ++i)
+              d(x + i, y) = pixels[y * group + i];
+        }
+      },
+      pool);
+}
+
+/**
+ * @brief convolve with a separable kernel
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] horizontal weights along rows, an odd number centered on the pixel
+ * @param[in] vertical weights along columns, an odd number centered on the pixel
+ * @param[in] edge edge mode
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ or the number of some weights is even
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void convolve(const Src &src, Dst &&dst, std::span<const float> horizontal, std::span<const float> vertical, edge_mode edge = edge_mode::clamp,
+              thread_pool &pool = thread_pool::shared()) {
+  if (horizontal.size() % 2 == 0 || vertical.size() % 2 == 0)
+    throw std::invalid_argument("kernel size must be odd");
+  const filter_pass h{horizontal.size() / 2, horizontal}, v{vertical.size() / 2, vertical};
+  separable_filter(src, dst, std::span(&h, 1), std::span(&v, 1), edge, pool);
+}
+
+/**
+ * @brief box blur
+ *
+ * The mean of the (2 radius + 1)^2 pixels around each pixel, by running
+ * sums, the cost does not depend on the radius.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] radius radius
+ * @param[in] edge edge mode
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void box_blur(const Src &src, Dst &&dst, std::size_t radius, edge_mode edge = edge_mode::clamp, thread_pool &pool = thread_pool::shared()) {
+  const filter_pass box{radius, {}};
+  separable_filter(src, dst, std::span(&box, 1), std::span(&box, 1), edge, pool);
+}
+
+/**
+ * @brief sampled Gaussian kernel
+ *
+ * @param[in] sigma standard deviation
+ * @return Returns 2 ceil(3 sigma) + 1 weights that sum to 1
+ *
+ * @exception std::invalid_argument if sigma is negative or not finite
+ */
+[[nodiscard]] inline std::vector<float> gaussian_kernel(float sigma) {
+  if (!(sigma >= 0.0f) || !std::isfinite(sigma))
+    throw std::invalid_argument("sigma must be non-negative");
+  const auto radius = static_cast<std::ptrdiff_t>(std::ceil(3.0f * sigma));
+  std::vector<float> res(static_cast<std::size_t>(2 * radius + 1));
+  double sum = 0;
+  for (std::ptrdiff_t i = -radius; i <= radius; ++i)
+    sum += res[static_cast<std::size_t>(i + radius)] = sigma == 0.0f ? 1.0f : std::exp(-0.5f * static_cast<float>(i * i) / (sigma * sigma));
+  for (auto &weight : res)
+    weight = static_cast<float>(weight / sum);
+  return res;
+}
+
+/**
+ * @brief radii of three boxes whose repeated blur approximates a Gaussian
+ *
+ * Widths around sqrt(4 sigma^2 + 1), two sizes mixed so that the variance
+ * is that of the Gaussian (Kovesi, "Fast Almost-Gaussian Filtering").
+ *
+ * @param[in] sigma standard deviation
+ * @return Returns the radii
+ *
+ * @exception std::invalid_argument if sigma is negative or not finite
+ */
+[[nodiscard]] inline std::array<std::size_t, 3> gaussian_boxes(float sigma) {
+  if (!(sigma >= 0.0f) || !std::isfinite(sigma))
+    throw std::invalid_argument("sigma must be non-negative");
+  constexpr int n  = 3;
+  const double var = 12.0 * sigma * sigma;
+  int lower        = static_cast<int>(std::sqrt(var / n + 1.0));
+  lower -= lower % 2 == 0 ? 1 : 0;
+  const int upper  = lower + 2;
+  const int lowers = static_cast<int>(std::lround((var - n * lower * lower - 4.0 * n * lower - 3.0 * n) / (-4.0 * lower - 4.0)));
+  std::array<std::size_t, 3> res;
+  for (int i = 0; i < n; ++i)
+    res[static_cast<std::size_t>(i)] = static_cast<std::size_t>(((i < lowers ? lower : upper) - 1) / 2);
+  return res;
+}
+
+/**
+ * @brief Gaussian blur
+ *
+ * A sampled kernel up to sigma 2, above it three box blurs of the same
+ * variance, the cost does not depend on sigma.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] sigma standard deviation in pixels
+ * @param[in] edge edge mode
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ or sigma is negative or not finite
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void gaussian_blur(const Src &src, Dst &&dst, float sigma, edge_mode edge = edge_mode::clamp, thread_pool &pool = thread_pool::shared()) {
+  if (sigma < 2.0f) {
+    const auto kernel = gaussian_kernel(sigma);
+    convolve(src, dst, kernel, kernel, edge, pool);
+  } else {
+    const auto radii                       = gaussian_boxes(sigma);
+    const std::array<filter_pass, 3> boxes = {filter_pass{radii[0], {}}, filter_pass{radii[1], {}}, filter_pass{radii[2], {}}};
+    separable_filter(src, dst, boxes, boxes, edge, pool);
+  }
+}
+
+/**
+ * @brief sharpen by unsharp masking
+ *
+ * dst = src + amount (src - gaussian_blur(src)), clamped as the
+ * conversion to the format of dst clamps.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] sigma standard deviation of the blur in pixels
+ * @param[in] amount strength, 0 for a copy
+ * @param[in] edge edge mode
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ or sigma is negative or not finite
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void unsharp_mask(const Src &src, Dst &&dst, float sigma, float amount, edge_mode edge = edge_mode::clamp, thread_pool &pool = thread_pool::shared()) {
+  using S                 = pixel_t<Src>;
+  using W                 = rebind_color_t<pixel_t<Dst>, float>;
+  constexpr std::size_t C = simd::channels_v<W>;
+  const auto s            = src.view();
+  const auto d            = dst.view();
+  if (s.get_width() != d.get_width() || s.get_height() != d.get_height())
+    throw std::invalid_argument("image sizes vary");
+  basic_image<W> blurred(s.get_width(), s.get_height());
+  gaussian_blur(s, blurred, sigma, edge, pool);
+  parallel_for_rows(
+      d,
+      [&](auto band, std::size_t top) {
+        std::vector<W> row(band.get_width());
+        for (std::size_t j = 0; j < band.get_height(); ++j) {
+          if constexpr (row_major_view<decltype(s)>)
+            convert_pixels(std::span<const S>(s.row(top + j), row.size()), std::span(row));
+          else
+            for (std::size_t x = 0; x < row.size(); ++x)
+              row[x] = convert_pixel<W>(s(x, top + j));
+          auto *sharp      = reinterpret_cast<float *>(row.data());
+          const auto *blur = reinterpret_cast<const float *>(blurred.row(top + j));
+          for (std::size_t i = 0; i < row.size() * C; ++i)
+            sharp[i] += amount * (sharp[i] - blur[i]);
+          if constexpr (row_major_view<decltype(band)>)
+            convert_pixels(std::span<const W>(row), std::span(band.row(j), row.size()));
+          else
+            for (std::size_t x = 0; x < row.size(); ++x)
+              band(x, j) = convert_pixel<pixel_t<Dst>>(row[x]);
+        }
+      },
+      0, pool);
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_CONVOLUTION_HPP
@@ -13,31 +13,238 @@
 #define PORTAL_DRAWING_IMAGE_HPP
 
 #include "color.hpp"
+#include "image_view.hpp"
+#include "layout.hpp"
+#include "storage.hpp"
+#include <algorithm>
 #include <concepts>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <cassert>
 #include <stdexcept>
 
 namespace portal::drawing {
 /**
  * @brief basic image
- * 
+ *
+ * With the default row_major layout, pixels are stored row by row. Rows
+ * are padded to a stride that keeps every row aligned to the allocator
+ * alignment (64 bytes by default), so row kernels can use aligned SIMD
+ * loads. With tiled or morton layouts the pixels are stored tile by tile,
+ * iterators and views then walk the image in layout order.
+ *
  * @tparam T type
+ * @tparam Allocator allocator, aligned_allocator or pool_allocator
+ * @tparam Layout layout, row_major, tiled or morton
  */
-template <pixel_color T>
+template <pixel_color T, typename Allocator = aligned_allocator<T>, typename Layout = row_major>
 class basic_image {
+  using alloc_traits = std::allocator_traits<Allocator>;
+
 public:
-  using value_type      = T;           //!< @brief value type
-  using pointer         = T *;         //!< @brief pointer
-  using const_pointer   = const T *;   //!< @brief const pointer
-  using reference       = T &;         //!< @brief reference
-  using const_reference = const T &;   //!< @brief const reference
-  using size_type       = std::size_t; //!< @brief size type
+  using value_type      = T;                        //!< @brief value type
+  using allocator_type  = Allocator;                //!< @brief allocator type
+  using layout_type     = Layout;                   //!< @brief layout type
+  using mapping_type    = typename Layout::mapping; //!< @brief mapping type
+  using pointer         = T *;                      //!< @brief pointer
+  using const_pointer   = const T *;                //!< @brief const pointer
+  using reference       = T &;                      //!< @brief reference
+  using const_reference = const T &;                //!< @brief const reference
+  using size_type       = std::size_t;              //!< @brief size type
+
+  using view_type              = basic_image_view<T, Layout>;           //!< @brief view type
+  using const_view_type        = basic_image_view<const T, Layout>;     //!< @brief read-only view type
+  using iterator               = typename view_type::iterator;          //!< @brief iterator
+  using const_iterator         = typename const_view_type::iterator;    //!< @brief const iterator
+  using reverse_iterator       = std::reverse_iterator<iterator>;       //!< @brief reverse iterator (row_major)
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>; //!< @brief const reverse iterator (row_major)
+
+  /**
+   * @brief row alignment in bytes
+   *
+   */
+  static constexpr size_type alignment = allocator_alignment_v<Allocator>;
+
+  /**
+   * @brief default constructor, empty image
+   *
+   */
+  basic_image() = default;
+
+  /**
+   * @brief constructor, empty image
+   *
+   * @param[in] alloc allocator
+   */
+  explicit basic_image(const allocator_type &alloc) noexcept
+      : m_alloc(alloc) {
+  }
 
-  using iterator               = pointer;                               //!< @brief iterator
-  using const_iterator         = const_pointer;                         //!< @brief const iterator
-  using reverse_iterator       = std::reverse_iterator<iterator>;       //!< @brief reverse iterator
-  using const_reverse_iterator = std::reverse_iterator<const_iterator>; //!< @brief const reverse iterator
+  /**
+   * @brief constructor, the pixels are default-initialized
+   *
+   * @param[in] width width
+   * @param[in] height height
+   * @param[in] alloc allocator
+   */
+  basic_image(size_type width, size_type height, const allocator_type &alloc = allocator_type())
+      : m_alloc(alloc) {
+    if constexpr (std::same_as<Layout, row_major>)
+      allocate(width, height, mapping_type(width, height, default_stride(width)));
+    else
+      allocate(width, height, mapping_type(width, height));
+  }
+
+  /**
+   * @brief constructor, the pixels are default-initialized
+   *
+   * @param[in] width width
+   * @param[in] height height
+   * @param[in] stride distance between rows in pixels, rows stay aligned only
+   * if stride * sizeof(T) is a multiple of alignment
+   * @param[in] alloc allocator
+   *
+   * @exception std::invalid_argument if stride < width
+   */
+  basic_image(size_type width, size_type height, size_type stride, const allocator_type &alloc = allocator_type())
+  requires std::same_as<Layout, row_major>
+      : m_alloc(alloc) {
+    if (stride < width)
+      throw std::invalid_argument("stride is less than width");
+    allocate(width, height, mapping_type(width, height, stride));
+  }
+
+  /**
+   * @brief copy constructor, a row_major copy gets the default stride
+   *
+   * @param[in] img image
+   */
+  basic_image(const basic_image &img)
+      : basic_image(img.get_width(), img.get_height(), alloc_traits::select_on_container_copy_construction(img.m_alloc)) {
+    copy_pixels(img);
+  }
+
+  /**
+   * @brief move constructor
+   *
+   * @param[in] img image, left empty
+   */
+  basic_image(basic_image &&img) noexcept
+      : m_width(std::exchange(img.m_width, 0))
+      , m_height(std::exchange(img.m_height, 0))
+      , m_map(std::exchange(img.m_map, mapping_type()))
+      , m_buf(std::exchange(img.m_buf, nullptr))
+      , m_alloc(img.m_alloc) {
+  }
+
+  /**
+   * @brief destructor
+   *
+   */
+  ~basic_image() {
+    release();
+  }
+
+  /**
+   * @brief copy assignment
+   *
+   * The storage is reused when the size is the same.
+   *
+   * @param[in] img image
+   * @return *this
+   */
+  basic_image &operator=(const basic_image &img) {
+    if (this != &img) {
+      if (get_width() != img.get_width() || get_height() != img.get_height())
+        *this = basic_image(img.get_width(), img.get_height(), m_alloc);
+      copy_pixels(img);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief move assignment
+   *
+   * @param[in] img image, left empty
+   * @return *this
+   */
+  basic_image &operator=(basic_image &&img) noexcept {
+    if (this != &img) {
+      release();
+      m_width  = std::exchange(img.m_width, 0);
+      m_height = std::exchange(img.m_height, 0);
+      m_map    = std::exchange(img.m_map, mapping_type());
+      m_buf    = std::exchange(img.m_buf, nullptr);
+      m_alloc  = img.m_alloc;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief default stride
+   *
+   * @param[in] width width
+   * @return smallest stride >= width keeping rows aligned
+   */
+  [[nodiscard]] static constexpr size_type default_stride(size_type width) noexcept
+  requires std::same_as<Layout, row_major> {
+    constexpr size_type step = alignment / std::gcd(alignment, sizeof(T));
+    return (width + step - 1) / step * step;
+  }
+
+  /**
+   * @brief allocator
+   *
+   * @return copy of the allocator
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return m_alloc;
+  }
+
+  /**
+   * @brief view
+   *
+   * @return view of all pixels
+   */
+  [[nodiscard]] view_type view() noexcept {
+    if constexpr (std::same_as<Layout, row_major>)
+      return view_type(data(), get_width(), get_height(), get_stride());
+    else
+      return view_type(data(), m_map, 0, 0, get_width(), get_height());
+  }
+
+  /**
+   * @brief view
+   *
+   * @return read-only view of all pixels
+   */
+  [[nodiscard]] const_view_type view() const noexcept {
+    if constexpr (std::same_as<Layout, row_major>)
+      return const_view_type(data(), get_width(), get_height(), get_stride());
+    else
+      return const_view_type(data(), m_map, 0, 0, get_width(), get_height());
+  }
+
+  /**
+   * @brief conversion to a view
+   *
+   * @return view of all pixels
+   */
+  operator view_type() noexcept {
+    return view();
+  }
+
+  /**
+   * @brief conversion to a view
+   *
+   * @return read-only view of all pixels
+   */
+  operator const_view_type() const noexcept {
+    return view();
+  }
 
   /**
    * @brief direct access to the underlying array
@@ -46,7 +253,7 @@ public:
    * For non-empty containers, the returned pointer compares equal to the address of the first element.
    */
   [[nodiscard]] pointer data() noexcept {
-    return m_buf.get();
+    return m_buf;
   }
 
   /**
@@ -56,7 +263,31 @@ public:
    * For non-empty containers, the returned pointer compares equal to the address of the first element.
    */
   [[nodiscard]] const_pointer data() const noexcept {
-    return m_buf.get();
+    return m_buf;
+  }
+
+  /**
+   * @brief row
+   *
+   * @param[in] y y position
+   * @return Pointer to the first pixel of row y
+   */
+  [[nodiscard]] pointer row(size_type y) noexcept
+  requires std::same_as<Layout, row_major> {
+    assert(y < get_height());
+    return data() + get_stride() * y;
+  }
+
+  /**
+   * @brief row
+   *
+   * @param[in] y y position
+   * @return Pointer to the first pixel of row y
+   */
+  [[nodiscard]] const_pointer row(size_type y) const noexcept
+  requires std::same_as<Layout, row_major> {
+    assert(y < get_height());
+    return data() + get_stride() * y;
   }
 
   /**
@@ -77,6 +308,25 @@ public:
     return m_height;
   }
 
+  /**
+   * @brief Get the stride object
+   *
+   * @return Return distance between rows in pixels, 0 for an empty image
+   */
+  [[nodiscard]] size_type get_stride() const noexcept
+  requires std::same_as<Layout, row_major> {
+    return m_map.stride();
+  }
+
+  /**
+   * @brief mapping
+   *
+   * @return mapping of the pixels to the storage
+   */
+  [[nodiscard]] const mapping_type &mapping() const noexcept {
+    return m_map;
+  }
+
   /**
    * @brief image size
    * 
@@ -96,7 +346,7 @@ public:
   [[nodiscard]] reference operator()(size_type x, size_type y) &noexcept {
     assert(x < get_width());
     assert(y < get_height());
-    return data() + get_width() * y + x;
+    return m_buf[m_map(x, y)];
   }
 
   /**
@@ -109,7 +359,7 @@ public:
   [[nodiscard]] const_reference operator()(size_type x, size_type y) const &noexcept {
     assert(x < get_width());
     assert(y < get_height());
-    return data() + get_width() * y + x;
+    return m_buf[m_map(x, y)];
   }
 
   /**
@@ -122,7 +372,7 @@ public:
   [[nodiscard]] value_type operator()(size_type x, size_type y) const &&noexcept {
     assert(x < get_width());
     assert(y < get_height());
-    return data() + get_width() * y + x;
+    return m_buf[m_map(x, y)];
   }
 
   /**
@@ -176,7 +426,7 @@ public:
    * @return Iterator to the first element.
    */
   [[nodiscard]] iterator begin() noexcept {
-    return data();
+    return view().begin();
   }
 
   /**
@@ -185,7 +435,7 @@ public:
    * @return Iterator to the first element.
    */
   [[nodiscard]] const_iterator begin() const noexcept {
-    return data();
+    return view().begin();
   }
 
   /**
@@ -194,7 +444,7 @@ public:
    * @return Iterator to the first element.
    */
   [[nodiscard]] const_iterator cbegin() const noexcept {
-    return data();
+    return begin();
   }
 
   /**
@@ -203,7 +453,7 @@ public:
    * @return Iterator to the element following the last element.
    */
   [[nodiscard]] iterator end() noexcept {
-    return data() + size();
+    return view().end();
   }
 
   /**
@@ -212,7 +462,7 @@ public:
    * @return Iterator to the element following the last element.
    */
   [[nodiscard]] const_iterator end() const noexcept {
-    return data() + size();
+    return view().end();
   }
 
   /**
@@ -221,7 +471,7 @@ public:
    * @return Iterator to the element following the last element.
    */
   [[nodiscard]] const_iterator cend() const noexcept {
-    return data() + size();
+    return end();
   }
 
   /**
@@ -229,7 +479,8 @@ public:
    *
    * @return Reverse iterator to the first element.
    */
-  [[nodiscard]] reverse_iterator rbegin() noexcept {
+  [[nodiscard]] reverse_iterator rbegin() noexcept
+  requires std::same_as<Layout, row_major> {
     return reverse_iterator(end());
   }
 
@@ -238,7 +489,8 @@ public:
    *
    * @return Reverse iterator to the first element.
    */
-  [[nodiscard]] const_reverse_iterator rbegin() const noexcept {
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+  requires std::same_as<Layout, row_major> {
     return const_reverse_iterator(end());
   }
 
@@ -247,7 +499,8 @@ public:
    *
    * @return Reverse iterator to the first element.
    */
-  [[nodiscard]] const_reverse_iterator crbegin() const noexcept {
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept
+  requires std::same_as<Layout, row_major> {
     return const_reverse_iterator(cend());
   }
 
@@ -256,7 +509,8 @@ public:
    *
    * @return Reverse iterator to the last element.
    */
-  [[nodiscard]] reverse_iterator rend() noexcept {
+  [[nodiscard]] reverse_iterator rend() noexcept
+  requires std::same_as<Layout, row_major> {
     return reverse_iterator(begin());
   }
 
@@ -265,7 +519,8 @@ public:
    *
    * @return Reverse iterator to the last element.
    */
-  [[nodiscard]] const_reverse_iterator rend() const noexcept {
+  [[nodiscard]] const_reverse_iterator rend() const noexcept
+  requires std::same_as<Layout, row_major> {
     return const_reverse_iterator(begin());
   }
 
@@ -274,7 +529,8 @@ public:
    *
    * @return Reverse iterator to the last element.
    */
-  [[nodiscard]] const_reverse_iterator crend() const noexcept {
+  [[nodiscard]] const_reverse_iterator crend() const noexcept
+  requires std::same_as<Layout, row_major> {
     return const_reverse_iterator(cbegin());
   }
 
@@ -284,16 +540,45 @@ public:
    * @param[in] pixel the pixel to assign to the elements
    * @return *this
    */
-  constexpr basic_image &fill(const value_type &pixel) noexcept {
-    for (auto &ptr : *this)
-      ptr = pixel;
+  basic_image &fill(const value_type &pixel) noexcept {
+    view().for_each_run([pixel](pointer ptr, size_type, size_type, size_type count) { std::fill_n(ptr, count, pixel); });
     return *this;
   }
 
 private:
-  size_type m_width          = 0;
-  size_type m_height         = 0;
-  std::unique_ptr<T[]> m_buf = nullptr;
+  void allocate(size_type width, size_type height, const mapping_type &map) {
+    if (width != 0 && height != 0) {
+      m_buf = alloc_traits::allocate(m_alloc, map.required_size());
+      std::uninitialized_default_construct_n(m_buf, map.required_size());
+      m_map = map;
+    }
+    m_width  = width;
+    m_height = height;
+  }
+
+  void copy_pixels(const basic_image &img) noexcept {
+    if constexpr (std::same_as<Layout, row_major>) {
+      for (size_type y = 0; y < get_height(); ++y)
+        std::copy_n(img.row(y), get_width(), row(y));
+    } else {
+      // same size, same mapping
+      std::copy_n(img.m_buf, m_map.required_size(), m_buf);
+    }
+  }
+
+  void release() noexcept {
+    if (m_buf != nullptr) {
+      std::destroy_n(m_buf, m_map.required_size());
+      alloc_traits::deallocate(m_alloc, m_buf, m_map.required_size());
+      m_buf = nullptr;
+    }
+  }
+
+  size_type m_width  = 0;
+  size_type m_height = 0;
+  mapping_type m_map;
+  pointer m_buf = nullptr;
+  [[no_unique_address]] allocator_type m_alloc;
 };
 } // namespace portal::drawing
 
@@ -0,0 +1,1107 @@
+/**
+ * @file image_view.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief non-owning image view
+ * @version 0.1
+ * @date 2022-04-09
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_IMAGE_VIEW_HPP
+#define PORTAL_DRAWING_IMAGE_VIEW_HPP
+
+#include "color.hpp"
+#include "layout.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <cassert>
+#include <stdexcept>
+
+namespace portal::drawing {
+/**
+ * @brief iterator over the pixels of strided rows
+ *
+ * Walks the pixels row by row and skips the padding at the end of each row.
+ *
+ * @tparam T pixel type, const for a constant iterator
+ */
+template <typename T>
+class pixel_iterator {
+public:
+  using iterator_category = std::bidirectional_iterator_tag; //!< @brief iterator category
+  using value_type        = std::remove_cv_t<T>;             //!< @brief value type
+  using difference_type   = std::ptrdiff_t;                  //!< @brief difference type
+  using pointer           = T *;                             //!< @brief pointer
+  using reference         = T &;                             //!< @brief reference
+
+  /**
+   * @brief default constructor
+   *
+   */
+  constexpr pixel_iterator() noexcept = default;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] row first pixel of the row
+   * @param[in] x position in the row
+   * @param[in] width pixels in a row
+   * @param[in] stride distance between rows in pixels
+   */
+  constexpr pixel_iterator(pointer row, std::size_t x, std::size_t width, std::size_t stride) noexcept
+      : m_row(row)
+      , m_x(x)
+      , m_width(width)
+      , m_stride(stride) {
+  }
+
+  /**
+   * @brief conversion to a constant iterator
+   *
+   * @return constant iterator at the same pixel
+   */
+  constexpr operator pixel_iterator<const T>() const noexcept
+  requires(!std::is_const_v<T>) {
+    return pixel_iterator<const T>(m_row, m_x, m_width, m_stride);
+  }
+
+  /**
+   * @brief dereference
+   *
+   * @return pixel
+   */
+  [[nodiscard]] constexpr reference operator*() const noexcept {
+    return m_row[m_x];
+  }
+
+  /**
+   * @brief member access
+   *
+   * @return pointer to the pixel
+   */
+  [[nodiscard]] constexpr pointer operator->() const noexcept {
+    return m_row + m_x;
+  }
+
+  /**
+   * @brief pre-increment
+   *
+   * @return *this
+   */
+  constexpr pixel_iterator &operator++() noexcept {
+    if (++m_x == m_width) {
+      m_x = 0;
+      m_row += m_stride;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief post-increment
+   *
+   * @return iterator before the increment
+   */
+  constexpr pixel_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  /**
+   * @brief pre-decrement
+   *
+   * @return *this
+   */
+  constexpr pixel_iterator &operator--() noexcept {
+    if (m_x == 0) {
+      m_x = m_width;
+      m_row -= m_stride;
+    }
+    --m_x;
+    return *this;
+  }
+
+  /**
+   * @brief post-decrement
+   *
+   * @return iterator before the decrement
+   */
+  constexpr pixel_iterator operator--(int) noexcept {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @param[in] lhs iterator
+   * @param[in] rhs iterator
+   * @return true if both refer to the same pixel
+   */
+  [[nodiscard]] friend constexpr bool operator==(const pixel_iterator &lhs, const pixel_iterator &rhs) noexcept {
+    return lhs.m_row == rhs.m_row && lhs.m_x == rhs.m_x;
+  }
+
+private:
+  pointer m_row        = nullptr;
+  std::size_t m_x      = 0;
+  std::size_t m_width  = 0;
+  std::size_t m_stride = 0;
+};
+
+/**
+ * @brief iterator over strided rows
+ *
+ * @tparam T pixel type, const for constant rows
+ */
+template <typename T>
+class row_iterator {
+public:
+  using iterator_category = std::random_access_iterator_tag; //!< @brief iterator category
+  using value_type        = std::span<T>;                    //!< @brief value type
+  using difference_type   = std::ptrdiff_t;                  //!< @brief difference type
+  using reference         = std::span<T>;                    //!< @brief reference (rows are computed)
+
+  /**
+   * @brief default constructor
+   *
+   */
+  constexpr row_iterator() noexcept = default;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] row first pixel of the row
+   * @param[in] width pixels in a row
+   * @param[in] stride distance between rows in pixels
+   */
+  constexpr row_iterator(T *row, std::size_t width, std::size_t stride) noexcept
+      : m_row(row)
+      , m_width(width)
+      , m_stride(stride) {
+  }
+
+  /**
+   * @brief dereference
+   *
+   * @return row
+   */
+  [[nodiscard]] constexpr reference operator*() const noexcept {
+    return reference(m_row, m_width);
+  }
+
+  /**
+   * @brief subscript
+   *
+   * @param[in] n offset
+   * @return row n after this one
+   */
+  [[nodiscard]] constexpr reference operator[](difference_type n) const noexcept {
+    return *(*this + n);
+  }
+
+  /**
+   * @brief pre-increment
+   *
+   * @return *this
+   */
+  constexpr row_iterator &operator++() noexcept {
+    m_row += m_stride;
+    return *this;
+  }
+
+  /**
+   * @brief post-increment
+   *
+   * @return iterator before the increment
+   */
+  constexpr row_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  /**
+   * @brief pre-decrement
+   *
+   * @return *this
+   */
+  constexpr row_iterator &operator--() noexcept {
+    m_row -= m_stride;
+    return *this;
+  }
+
+  /**
+   * @brief post-decrement
+   *
+   * @return iterator before the decrement
+   */
+  constexpr row_iterator operator--(int) noexcept {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  /**
+   * @brief advance
+   *
+   * @param[in] n offset
+   * @return *this
+   */
+  constexpr row_iterator &operator+=(difference_type n) noexcept {
+    m_row += n * static_cast<difference_type>(m_stride);
+    return *this;
+  }
+
+  /**
+   * @brief advance
+   *
+   * @param[in] n offset
+   * @return *this
+   */
+  constexpr row_iterator &operator-=(difference_type n) noexcept {
+    return *this += -n;
+  }
+
+  /**
+   * @brief advance
+   *
+   * @param[in] it iterator
+   * @param[in] n offset
+   * @return advanced iterator
+   */
+  [[nodiscard]] friend constexpr row_iterator operator+(row_iterator it, difference_type n) noexcept {
+    return it += n;
+  }
+
+  /**
+   * @brief advance
+   *
+   * @param[in] n offset
+   * @param[in] it iterator
+   * @return advanced iterator
+   */
+  [[nodiscard]] friend constexpr row_iterator operator+(difference_type n, row_iterator it) noexcept {
+    return it += n;
+  }
+
+  /**
+   * @brief advance
+   *
+   * @param[in] it iterator
+   * @param[in] n offset
+   * @return advanced iterator
+   */
+  [[nodiscard]] friend constexpr row_iterator operator-(row_iterator it, difference_type n) noexcept {
+    return it -= n;
+  }
+
+  /**
+   * @brief distance
+   *
+   * @param[in] lhs iterator
+   * @param[in] rhs iterator
+   * @return number of rows from rhs to lhs
+   */
+  [[nodiscard]] friend constexpr difference_type operator-(const row_iterator &lhs, const row_iterator &rhs) noexcept {
+    return lhs.m_stride == 0 ? 0 : (lhs.m_row - rhs.m_row) / static_cast<difference_type>(lhs.m_stride);
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @param[in] lhs iterator
+   * @param[in] rhs iterator
+   * @return true if both refer to the same row
+   */
+  [[nodiscard]] friend constexpr bool operator==(const row_iterator &lhs, const row_iterator &rhs) noexcept {
+    return lhs.m_row == rhs.m_row;
+  }
+
+  /**
+   * @brief compare
+   *
+   * @param[in] lhs iterator
+   * @param[in] rhs iterator
+   * @return ordering of the rows
+   */
+  [[nodiscard]] friend constexpr auto operator<=>(const row_iterator &lhs, const row_iterator &rhs) noexcept {
+    return lhs.m_row <=> rhs.m_row;
+  }
+
+private:
+  T *m_row             = nullptr;
+  std::size_t m_width  = 0;
+  std::size_t m_stride = 0;
+};
+
+/**
+ * @brief rows of an image, for range-based for
+ *
+ * @tparam T pixel type, const for constant rows
+ */
+template <typename T>
+class row_range {
+public:
+  using iterator = row_iterator<T>; //!< @brief iterator
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] first first row
+   * @param[in] last row following the last row
+   */
+  constexpr row_range(iterator first, iterator last) noexcept
+      : m_first(first)
+      , m_last(last) {
+  }
+
+  /**
+   * @brief returns an iterator to the first row
+   *
+   * @return Iterator to the first row.
+   */
+  [[nodiscard]] constexpr iterator begin() const noexcept {
+    return m_first;
+  }
+
+  /**
+   * @brief returns an iterator to the end
+   *
+   * @return Iterator to the row following the last row.
+   */
+  [[nodiscard]] constexpr iterator end() const noexcept {
+    return m_last;
+  }
+
+  /**
+   * @brief number of rows
+   *
+   * @return Number of rows
+   */
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return static_cast<std::size_t>(m_last - m_first);
+  }
+
+private:
+  iterator m_first;
+  iterator m_last;
+};
+
+/**
+ * @brief non-owning view of image pixels
+ *
+ * @tparam T pixel type, const for a read-only view
+ * @tparam Layout layout
+ */
+template <typename T, typename Layout = row_major>
+requires pixel_color<std::remove_const_t<T>>
+class basic_image_view;
+
+/**
+ * @brief non-owning view of row-major image pixels
+ *
+ * A pointer, a size and a row stride, cheap to copy. It refers to a
+ * basic_image, a region of one or externally owned pixels, which must
+ * outlive the view. A view of const pixels is read-only.
+ *
+ * @code
+ * basic_image<rgba8> img(1920, 1080);
+ * auto tile = img.view().subview(64, 64, 32, 32); // no copy
+ * fill(tile, {0, 0, 0, 255});
+ * @endcode
+ *
+ * @tparam T pixel type, const for a read-only view
+ */
+template <typename T>
+requires pixel_color<std::remove_const_t<T>>
+class basic_image_view<T, row_major> {
+public:
+  using value_type      = std::remove_const_t<T>; //!< @brief value type
+  using element_type    = T;                      //!< @brief element type
+  using layout_type     = row_major;              //!< @brief layout type
+  using pointer         = T *;                    //!< @brief pointer
+  using const_pointer   = const T *;              //!< @brief const pointer
+  using reference       = T &;                    //!< @brief reference
+  using const_reference = const T &;              //!< @brief const reference
+  using size_type       = std::size_t;            //!< @brief size type
+
+  using iterator         = pixel_iterator<T>;               //!< @brief iterator
+  using reverse_iterator = std::reverse_iterator<iterator>; //!< @brief reverse iterator
+
+  /**
+   * @brief default constructor, empty view
+   *
+   */
+  constexpr basic_image_view() noexcept = default;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] data first pixel
+   * @param[in] width width
+   * @param[in] height height
+   * @param[in] stride distance between rows in pixels
+   *
+   * @exception std::invalid_argument if stride < width and the view is not empty
+   */
+  constexpr basic_image_view(pointer data, size_type width, size_type height, size_type stride)
+      : m_data(width != 0 && height != 0 ? data : nullptr)
+      , m_width(width)
+      , m_height(height)
+      , m_stride(m_data != nullptr ? stride : 0) {
+    if (m_data != nullptr && stride < width)
+      throw std::invalid_argument("stride is less than width");
+  }
+
+  /**
+   * @brief constructor of tightly packed rows
+   *
+   * @param[in] data first pixel
+   * @param[in] width width
+   * @param[in] height height
+   */
+  constexpr basic_image_view(pointer data, size_type width, size_type height) noexcept
+      : basic_image_view(data, width, height, width) {
+  }
+
+  /**
+   * @brief conversion to a read-only view
+   *
+   * @return read-only view of the same pixels
+   */
+  constexpr operator basic_image_view<const T>() const noexcept
+  requires(!std::is_const_v<T>) {
+    return basic_image_view<const T>(m_data, m_width, m_height, m_stride);
+  }
+
+  /**
+   * @brief view
+   *
+   * @return *this, so that views and images can be passed to the same kernels
+   */
+  [[nodiscard]] constexpr basic_image_view view() const noexcept {
+    return *this;
+  }
+
+  /**
+   * @brief region of the view
+   *
+   * @param[in] x left
+   * @param[in] y top
+   * @param[in] width width
+   * @param[in] height height
+   * @return view of the region
+   *
+   * @exception std::out_of_range if the region exceeds the view
+   */
+  [[nodiscard]] constexpr basic_image_view subview(size_type x, size_type y, size_type width, size_type height) const {
+    if (x > get_width() || width > get_width() - x || y > get_height() || height > get_height() - y)
+      throw std::out_of_range("out of range");
+    if (width == 0 || height == 0)
+      return basic_image_view();
+    return basic_image_view(m_data + get_stride() * y + x, width, height, get_stride());
+  }
+
+  /**
+   * @brief direct access to the pixels
+   *
+   * @return Pointer to the first pixel
+   */
+  [[nodiscard]] constexpr pointer data() const noexcept {
+    return m_data;
+  }
+
+  /**
+   * @brief Get the width object
+   *
+   * @return Return view width
+   */
+  [[nodiscard]] constexpr size_type get_width() const noexcept {
+    return m_width;
+  }
+
+  /**
+   * @brief Get the height object
+   *
+   * @return Return view height
+   */
+  [[nodiscard]] constexpr size_type get_height() const noexcept {
+    return m_height;
+  }
+
+  /**
+   * @brief Get the stride object
+   *
+   * @return Return distance between rows in pixels, 0 for an empty view
+   */
+  [[nodiscard]] constexpr size_type get_stride() const noexcept {
+    return m_stride;
+  }
+
+  /**
+   * @brief view size
+   *
+   * @return Return number of pixels
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return get_width() * get_height();
+  }
+
+  /**
+   * @brief checks whether the view is empty
+   *
+   * @return true if the view has no pixel
+   */
+  [[nodiscard]] constexpr bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  /**
+   * @brief row
+   *
+   * @param[in] y y position
+   * @return Pointer to the first pixel of row y
+   */
+  [[nodiscard]] constexpr pointer row(size_type y) const noexcept {
+    assert(y < get_height());
+    return m_data + get_stride() * y;
+  }
+
+  /**
+   * @brief rows
+   *
+   * @return Range of the rows as std::span
+   */
+  [[nodiscard]] constexpr row_range<T> rows() const noexcept {
+    return row_range<T>(row_iterator<T>(m_data, get_width(), get_stride()),
+                        row_iterator<T>(m_data + get_stride() * get_height(), get_width(), get_stride()));
+  }
+
+  /**
+   * @brief Accessing a specified element
+   *
+   * @param[in] x x position
+   * @param[in] y y position
+   * @return Returns the specified element
+   */
+  [[nodiscard]] constexpr reference operator()(size_type x, size_type y) const noexcept {
+    assert(x < get_width());
+    return row(y)[x];
+  }
+
+  /**
+   * @brief access specified element with bounds checking
+   *
+   * @param[in] x position of the element to return
+   * @param[in] y position of the element to return
+   * @return Reference to the requested element.
+   *
+   * @exception std::out_of_range if x >= get_width() || y >= get_height()
+   */
+  [[nodiscard]] constexpr reference at(size_type x, size_type y) const {
+    if (x >= get_width() || y >= get_height())
+      throw std::out_of_range("out of range");
+    return (*this)(x, y);
+  }
+
+  /**
+   * @brief visit the pixels as runs contiguous in memory
+   *
+   * @param[in] func called as func(pointer, x, y, count) for count pixels from (x, y) to the right
+   */
+  template <typename F>
+  constexpr void for_each_run(F func) const {
+    for (size_type y = 0; y < get_height(); ++y)
+      func(row(y), size_type{0}, y, get_width());
+  }
+
+  /**
+   * @brief returns an iterator to the beginning
+   *
+   * @return Iterator to the first element.
+   */
+  [[nodiscard]] constexpr iterator begin() const noexcept {
+    return iterator(m_data, 0, get_width(), get_stride());
+  }
+
+  /**
+   * @brief returns an iterator to the end
+   *
+   * @return Iterator to the element following the last element.
+   */
+  [[nodiscard]] constexpr iterator end() const noexcept {
+    return iterator(m_data + get_stride() * get_height(), 0, get_width(), get_stride());
+  }
+
+  /**
+   * @brief returns a reverse iterator to the beginning
+   *
+   * @return Reverse iterator to the first element.
+   */
+  [[nodiscard]] constexpr reverse_iterator rbegin() const noexcept {
+    return reverse_iterator(end());
+  }
+
+  /**
+   * @brief returns a reverse iterator to the end
+   *
+   * @return Reverse iterator to the last element.
+   */
+  [[nodiscard]] constexpr reverse_iterator rend() const noexcept {
+    return reverse_iterator(begin());
+  }
+
+private:
+  pointer m_data     = nullptr;
+  size_type m_width  = 0;
+  size_type m_height = 0;
+  size_type m_stride = 0;
+};
+
+/**
+ * @brief iterator over a region in layout order
+ *
+ * Visits the region block by block (a tile of the layout), row-major
+ * inside each block, so that consecutive pixels stay close in memory.
+ *
+ * @tparam T pixel type, const for a constant iterator
+ * @tparam Mapping layout mapping
+ */
+template <typename T, typename Mapping>
+class block_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag; //!< @brief iterator category
+  using value_type        = std::remove_cv_t<T>;       //!< @brief value type
+  using difference_type   = std::ptrdiff_t;            //!< @brief difference type
+  using pointer           = T *;                       //!< @brief pointer
+  using reference         = T &;                       //!< @brief reference
+  using size_type         = std::size_t;               //!< @brief size type
+
+  /**
+   * @brief default constructor
+   *
+   */
+  constexpr block_iterator() noexcept = default;
+
+  /**
+   * @brief constructor of the first pixel
+   *
+   * @param[in] base storage
+   * @param[in] map mapping of the storage
+   * @param[in] x0 left of the region
+   * @param[in] y0 top of the region
+   * @param[in] x1 right of the region (exclusive)
+   * @param[in] y1 bottom of the region (exclusive)
+   */
+  constexpr block_iterator(pointer base, const Mapping &map, size_type x0, size_type y0, size_type x1, size_type y1) noexcept
+      : m_map(map)
+      , m_base(base)
+      , m_x0(x0)
+      , m_y0(y0)
+      , m_x1(x1)
+      , m_y1(y1)
+      , m_bx(x0 / Mapping::block_width * Mapping::block_width)
+      , m_by(y0 / Mapping::block_height * Mapping::block_height)
+      , m_x(x0)
+      , m_y(x0 < x1 ? y0 : y1) {
+  }
+
+  /**
+   * @brief constructor of the end
+   *
+   * @param[in] base storage
+   * @param[in] map mapping of the storage
+   * @param[in] x0 left of the region
+   * @param[in] y1 bottom of the region (exclusive)
+   */
+  constexpr block_iterator(pointer base, const Mapping &map, size_type x0, size_type y1) noexcept
+      : m_map(map)
+      , m_base(base)
+      , m_x0(x0)
+      , m_y0(y1)
+      , m_x1(x0)
+      , m_y1(y1)
+      , m_x(x0)
+      , m_y(y1) {
+  }
+
+  /**
+   * @brief conversion to a constant iterator
+   *
+   * @return constant iterator at the same pixel
+   */
+  constexpr operator block_iterator<const T, Mapping>() const noexcept
+  requires(!std::is_const_v<T>) {
+    block_iterator<const T, Mapping> it(m_base, m_map, m_x0, m_y1);
+    it.m_y0 = m_y0;
+    it.m_x1 = m_x1;
+    it.m_bx = m_bx;
+    it.m_by = m_by;
+    it.m_x  = m_x;
+    it.m_y  = m_y;
+    return it;
+  }
+
+  /**
+   * @brief dereference
+   *
+   * @return pixel
+   */
+  [[nodiscard]] constexpr reference operator*() const noexcept {
+    return m_base[m_map(m_x, m_y)];
+  }
+
+  /**
+   * @brief member access
+   *
+   * @return pointer to the pixel
+   */
+  [[nodiscard]] constexpr pointer operator->() const noexcept {
+    return m_base + m_map(m_x, m_y);
+  }
+
+  /**
+   * @brief x position
+   *
+   * @return x position of the pixel in the storage
+   */
+  [[nodiscard]] constexpr size_type x() const noexcept {
+    return m_x;
+  }
+
+  /**
+   * @brief y position
+   *
+   * @return y position of the pixel in the storage
+   */
+  [[nodiscard]] constexpr size_type y() const noexcept {
+    return m_y;
+  }
+
+  /**
+   * @brief pre-increment
+   *
+   * @return *this
+   */
+  constexpr block_iterator &operator++() noexcept {
+    if (++m_x < std::min(m_bx + Mapping::block_width, m_x1))
+      return *this;
+    m_x = std::max(m_bx, m_x0);
+    if (++m_y < std::min(m_by + Mapping::block_height, m_y1))
+      return *this;
+    // next block
+    m_bx += Mapping::block_width;
+    if (m_bx >= m_x1) {
+      m_bx = m_x0 / Mapping::block_width * Mapping::block_width;
+      m_by += Mapping::block_height;
+      if (m_by >= m_y1) {
+        m_x = m_x0;
+        m_y = m_y1;
+        return *this;
+      }
+    }
+    m_x = std::max(m_bx, m_x0);
+    m_y = std::max(m_by, m_y0);
+    return *this;
+  }
+
+  /**
+   * @brief post-increment
+   *
+   * @return iterator before the increment
+   */
+  constexpr block_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @param[in] lhs iterator
+   * @param[in] rhs iterator
+   * @return true if both refer to the same pixel
+   */
+  [[nodiscard]] friend constexpr bool operator==(const block_iterator &lhs, const block_iterator &rhs) noexcept {
+    return lhs.m_x == rhs.m_x && lhs.m_y == rhs.m_y;
+  }
+
+private:
+  template <typename U, typename M>
+  friend class block_iterator;
+
+  Mapping m_map;
+  pointer m_base = nullptr;
+  size_type m_x0 = 0;
+  size_type m_y0 = 0;
+  size_type m_x1 = 0;
+  size_type m_y1 = 0;
+  size_type m_bx = 0;
+  size_type m_by = 0;
+  size_type m_x  = 0;
+  size_type m_y  = 0;
+};
+
+/**
+ * @brief non-owning view of image pixels in a tiled or Morton layout
+ *
+ * The storage pointer, its mapping and a region of it, cheap to copy.
+ * Iteration and for_each_run go block by block in layout order.
+ *
+ * @tparam T pixel type, const for a read-only view
+ * @tparam Layout layout
+ */
+template <typename T, typename Layout>
+requires pixel_color<std::remove_const_t<T>>
+class basic_image_view {
+public:
+  using value_type      = std::remove_const_t<T>;          //!< @brief value type
+  using element_type    = T;                               //!< @brief element type
+  using layout_type     = Layout;                          //!< @brief layout type
+  using mapping_type    = typename Layout::mapping;        //!< @brief mapping type
+  using pointer         = T *;                             //!< @brief pointer
+  using const_pointer   = const T *;                       //!< @brief const pointer
+  using reference       = T &;                             //!< @brief reference
+  using const_reference = const T &;                       //!< @brief const reference
+  using size_type       = std::size_t;                     //!< @brief size type
+  using iterator        = block_iterator<T, mapping_type>; //!< @brief iterator
+
+  /**
+   * @brief default constructor, empty view
+   *
+   */
+  constexpr basic_image_view() noexcept = default;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] base storage
+   * @param[in] map mapping of the storage
+   * @param[in] x left of the region in the storage
+   * @param[in] y top of the region in the storage
+   * @param[in] width width
+   * @param[in] height height
+   */
+  constexpr basic_image_view(pointer base, const mapping_type &map, size_type x, size_type y, size_type width, size_type height) noexcept
+      : m_map(map)
+      , m_base(base)
+      , m_x(x)
+      , m_y(y)
+      , m_width(width)
+      , m_height(height) {
+  }
+
+  /**
+   * @brief conversion to a read-only view
+   *
+   * @return read-only view of the same pixels
+   */
+  constexpr operator basic_image_view<const T, Layout>() const noexcept
+  requires(!std::is_const_v<T>) {
+    return basic_image_view<const T, Layout>(m_base, m_map, m_x, m_y, m_width, m_height);
+  }
+
+  /**
+   * @brief view
+   *
+   * @return *this, so that views and images can be passed to the same kernels
+   */
+  [[nodiscard]] constexpr basic_image_view view() const noexcept {
+    return *this;
+  }
+
+  /**
+   * @brief region of the view
+   *
+   * @param[in] x left
+   * @param[in] y top
+   * @param[in] width width
+   * @param[in] height height
+   * @return view of the region
+   *
+   * @exception std::out_of_range if the region exceeds the view
+   */
+  [[nodiscard]] constexpr basic_image_view subview(size_type x, size_type y, size_type width, size_type height) const {
+    if (x > get_width() || width > get_width() - x || y > get_height() || height > get_height() - y)
+      throw std::out_of_range("out of range");
+    return basic_image_view(m_base, m_map, m_x + x, m_y + y, width, height);
+  }
+
+  /**
+   * @brief storage
+   *
+   * @return Pointer to the storage the mapping refers to
+   */
+  [[nodiscard]] constexpr pointer data() const noexcept {
+    return m_base;
+  }
+
+  /**
+   * @brief mapping
+   *
+   * @return mapping of the storage
+   */
+  [[nodiscard]] constexpr const mapping_type &mapping() const noexcept {
+    return m_map;
+  }
+
+  /**
+   * @brief Get the width object
+   *
+   * @return Return view width
+   */
+  [[nodiscard]] constexpr size_type get_width() const noexcept {
+    return m_width;
+  }
+
+  /**
+   * @brief Get the height object
+   *
+   * @return Return view height
+   */
+  [[nodiscard]] constexpr size_type get_height() const noexcept {
+    return m_height;
+  }
+
+  /**
+   * @brief view size
+   *
+   * @return Return number of pixels
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return get_width() * get_height();
+  }
+
+  /**
+   * @brief checks whether the view is empty
+   *
+   * @return true if the view has no pixel
+   */
+  [[nodiscard]] constexpr bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  /**
+   * @brief Accessing a specified element
+   *
+   * @param[in] x x position
+   * @param[in] y y position
+   * @return Returns the specified element
+   */
+  [[nodiscard]] constexpr reference operator()(size_type x, size_type y) const noexcept {
+    assert(x < get_width());
+    assert(y < get_height());
+    return m_base[m_map(m_x + x, m_y + y)];
+  }
+
+  /**
+   * @brief access specified element with bounds checking
+   *
+   * @param[in] x position of the element to return
+   * @param[in] y position of the element to return
+   * @return Reference to the requested element.
+   *
+   * @exception std::out_of_range if x >= get_width() || y >= get_height()
+   */
+  [[nodiscard]] constexpr reference at(size_type x, size_type y) const {
+    if (x >= get_width() || y >= get_height())
+      throw std::out_of_range("out of range");
+    return (*this)(x, y);
+  }
+
+  /**
+   * @brief visit the pixels as runs contiguous in memory
+   *
+   * Block by block in layout order.
+   *
+   * @param[in] func called as func(pointer, x, y, count) for count pixels from (x, y) to the right
+   */
+  template <typename F>
+  constexpr void for_each_run(F func) const {
+    constexpr size_type bw = mapping_type::block_width;
+    constexpr size_type bh = mapping_type::block_height;
+    const size_type x1     = m_x + m_width;
+    const size_type y1     = m_y + m_height;
+    if (empty())
+      return;
+    for (size_type by = m_y / bh * bh; by < y1; by += bh) {
+      for (size_type bx = m_x / bw * bw; bx < x1; bx += bw) {
+        const size_type xe = std::min(bx + bw, x1);
+        for (size_type y = std::max(by, m_y); y < std::min(by + bh, y1); ++y) {
+          for (size_type x = std::max(bx, m_x); x < xe;) {
+            const size_type n = m_map.run_length(x, y, xe);
+            func(m_base + m_map(x, y), x - m_x, y - m_y, n);
+            x += n;
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief returns an iterator to the beginning
+   *
+   * @return Iterator to the first element in layout order.
+   */
+  [[nodiscard]] constexpr iterator begin() const noexcept {
+    if (empty())
+      return end();
+    return iterator(m_base, m_map, m_x, m_y, m_x + m_width, m_y + m_height);
+  }
+
+  /**
+   * @brief returns an iterator to the end
+   *
+   * @return Iterator to the element following the last element.
+   */
+  [[nodiscard]] constexpr iterator end() const noexcept {
+    return iterator(m_base, m_map, m_x, m_y + m_height);
+  }
+
+private:
+  mapping_type m_map;
+  pointer m_base     = nullptr;
+  size_type m_x      = 0;
+  size_type m_y      = 0;
+  size_type m_width  = 0;
+  size_type m_height = 0;
+};
+
+/**
+ * @brief image or image view
+ *
+ * Anything with a view() member returning a basic_image_view, the kernels
+ * take both images and views through it.
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept image_like = requires(T &img) {
+  img.view().for_each_run([](auto *, std::size_t, std::size_t, std::size_t) {});
+};
+
+/**
+ * @brief view type of an image or view
+ *
+ * @tparam T image or view
+ */
+template <image_like T>
+using view_t = decltype(std::declval<T &>().view());
+
+/**
+ * @brief pixel type of an image or view
+ *
+ * @tparam T image or view
+ */
+template <image_like T>
+using pixel_t = typename view_t<T>::value_type;
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_IMAGE_VIEW_HPP
@@ -0,0 +1,276 @@
+/**
+ * @file layout.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief pixel memory layouts
+ * @version 0.1
+ * @date 2022-04-10
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_LAYOUT_HPP
+#define PORTAL_DRAWING_LAYOUT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace portal::drawing {
+/**
+ * @brief row-major layout, rows one after another with a stride
+ *
+ * Every layout has a mapping from (x, y) to the offset of the pixel in the
+ * storage. Besides the offset, the mapping tells the size of the storage,
+ * the block traversed at once by layout-aware iteration, and how many
+ * pixels from (x, y) to the right are contiguous in memory.
+ */
+struct row_major {
+  /**
+   * @brief row-major mapping
+   *
+   */
+  class mapping {
+  public:
+    using size_type = std::size_t; //!< @brief size type
+
+    /**
+     * @brief default constructor, empty mapping
+     *
+     */
+    constexpr mapping() noexcept = default;
+
+    /**
+     * @brief constructor
+     *
+     * @param[in] width width
+     * @param[in] height height
+     * @param[in] stride distance between rows in pixels, >= width
+     */
+    constexpr mapping([[maybe_unused]] size_type width, size_type height, size_type stride) noexcept
+        : m_height(height)
+        , m_stride(stride) {
+    }
+
+    /**
+     * @brief storage size
+     *
+     * @return number of pixels to allocate
+     */
+    [[nodiscard]] constexpr size_type required_size() const noexcept {
+      return m_stride * m_height;
+    }
+
+    /**
+     * @brief offset
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @return offset of the pixel in the storage
+     */
+    [[nodiscard]] constexpr size_type operator()(size_type x, size_type y) const noexcept {
+      return m_stride * y + x;
+    }
+
+    /**
+     * @brief contiguous pixels
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @param[in] last x position following the last pixel wanted
+     * @return number of pixels from (x, y) to the right that follow each other in memory
+     */
+    [[nodiscard]] constexpr size_type run_length(size_type x, [[maybe_unused]] size_type y, size_type last) const noexcept {
+      return last - x;
+    }
+
+    /**
+     * @brief stride
+     *
+     * @return distance between rows in pixels
+     */
+    [[nodiscard]] constexpr size_type stride() const noexcept {
+      return m_stride;
+    }
+
+  private:
+    size_type m_height = 0;
+    size_type m_stride = 0;
+  };
+};
+
+/**
+ * @brief tiled layout
+ *
+ * The image is cut into TW x TH tiles stored one after another in
+ * row-major tile order, each tile row-major inside. The storage is padded
+ * to whole tiles. A 2D neighbourhood then touches a few tiles instead of
+ * as many rows as it is high.
+ *
+ * @tparam TW tile width, a power of two
+ * @tparam TH tile height, a power of two
+ */
+template <std::size_t TW, std::size_t TH = TW>
+struct tiled {
+  static_assert(TW != 0 && (TW & (TW - 1)) == 0, "tile width must be a power of two");
+  static_assert(TH != 0 && (TH & (TH - 1)) == 0, "tile height must be a power of two");
+
+  /**
+   * @brief tiled mapping
+   *
+   */
+  class mapping {
+  public:
+    using size_type = std::size_t; //!< @brief size type
+
+    static constexpr size_type block_width  = TW; //!< @brief width of the traversal block
+    static constexpr size_type block_height = TH; //!< @brief height of the traversal block
+
+    /**
+     * @brief default constructor, empty mapping
+     *
+     */
+    constexpr mapping() noexcept = default;
+
+    /**
+     * @brief constructor
+     *
+     * @param[in] width width
+     * @param[in] height height
+     */
+    constexpr mapping(size_type width, size_type height) noexcept
+        : m_tiles_x((width + TW - 1) / TW)
+        , m_tiles_y((height + TH - 1) / TH) {
+    }
+
+    /**
+     * @brief storage size
+     *
+     * @return number of pixels to allocate
+     */
+    [[nodiscard]] constexpr size_type required_size() const noexcept {
+      return m_tiles_x * m_tiles_y * TW * TH;
+    }
+
+    /**
+     * @brief offset
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @return offset of the pixel in the storage
+     */
+    [[nodiscard]] constexpr size_type operator()(size_type x, size_type y) const noexcept {
+      return ((y / TH) * m_tiles_x + x / TW) * (TW * TH) + (y % TH) * TW + x % TW;
+    }
+
+    /**
+     * @brief contiguous pixels
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @param[in] last x position following the last pixel wanted
+     * @return number of pixels from (x, y) to the right that follow each other in memory
+     */
+    [[nodiscard]] constexpr size_type run_length(size_type x, [[maybe_unused]] size_type y, size_type last) const noexcept {
+      return std::min(last, (x / TW + 1) * TW) - x;
+    }
+
+  private:
+    size_type m_tiles_x = 0;
+    size_type m_tiles_y = 0;
+  };
+};
+
+/**
+ * @brief Morton (Z-order) layout
+ *
+ * Like tiled, but the pixels inside each T x T tile are in Z-order, the
+ * bits of x and y interleaved. Every aligned power-of-two square inside a
+ * tile is contiguous, so locality holds at all scales up to the tile while
+ * the padding stays bounded by whole tiles.
+ *
+ * @tparam T tile size, a power of two
+ */
+template <std::size_t T = 64>
+struct morton {
+  static_assert(T != 0 && (T & (T - 1)) == 0, "tile size must be a power of two");
+  static_assert(T <= 65536, "tile coordinates must fit in 16 bits");
+
+  /**
+   * @brief Morton mapping
+   *
+   */
+  class mapping {
+  public:
+    using size_type = std::size_t; //!< @brief size type
+
+    static constexpr size_type block_width  = T; //!< @brief width of the traversal block
+    static constexpr size_type block_height = T; //!< @brief height of the traversal block
+
+    /**
+     * @brief default constructor, empty mapping
+     *
+     */
+    constexpr mapping() noexcept = default;
+
+    /**
+     * @brief constructor
+     *
+     * @param[in] width width
+     * @param[in] height height
+     */
+    constexpr mapping(size_type width, size_type height) noexcept
+        : m_tiles_x((width + T - 1) / T)
+        , m_tiles_y((height + T - 1) / T) {
+    }
+
+    /**
+     * @brief storage size
+     *
+     * @return number of pixels to allocate
+     */
+    [[nodiscard]] constexpr size_type required_size() const noexcept {
+      return m_tiles_x * m_tiles_y * T * T;
+    }
+
+    /**
+     * @brief offset
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @return offset of the pixel in the storage
+     */
+    [[nodiscard]] constexpr size_type operator()(size_type x, size_type y) const noexcept {
+      const auto code = spread(static_cast<std::uint32_t>(x % T)) | (spread(static_cast<std::uint32_t>(y % T)) << 1);
+      return ((y / T) * m_tiles_x + x / T) * (T * T) + code;
+    }
+
+    /**
+     * @brief contiguous pixels
+     *
+     * @param[in] x x position
+     * @param[in] y y position
+     * @param[in] last x position following the last pixel wanted
+     * @return number of pixels from (x, y) to the right that follow each other in memory
+     */
+    [[nodiscard]] constexpr size_type run_length(size_type x, [[maybe_unused]] size_type y, size_type last) const noexcept {
+      // x and x + 1 are neighbours only when x is even
+      return x % 2 == 0 && x + 1 < last ? 2 : 1;
+    }
+
+  private:
+    [[nodiscard]] static constexpr std::uint32_t spread(std::uint32_t v) noexcept {
+      // put a zero bit above each of the low 16 bits
+      v = (v | (v << 8)) & 0x00ff00ff;
+      v = (v | (v << 4)) & 0x0f0f0f0f;
+      v = (v | (v << 2)) & 0x33333333;
+      v = (v | (v << 1)) & 0x55555555;
+      return v;
+    }
+
+    size_type m_tiles_x = 0;
+    size_type m_tiles_y = 0;
+  };
+};
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_LAYOUT_HPP
@@ -0,0 +1,524 @@
+/**
+ * @file netpbm.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief PGM, PPM, PAM and PFM image files
+ * @version 0.1
+ * @date 2022-04-19
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_NETPBM_HPP
+#define PORTAL_DRAWING_NETPBM_HPP
+
+#include "../mapped_file.hpp"
+#include "algorithm.hpp"
+#include "image.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief netpbm file format
+ *
+ */
+enum class netpbm_format {
+  pgm, //!< @brief P5, binary gray map
+  ppm, //!< @brief P6, binary pixel map
+  pam, //!< @brief P7, arbitrary map of 1 to 4 samples
+  pfm  //!< @brief PF or Pf, float map
+};
+
+/**
+ * @brief header of a netpbm file
+ *
+ */
+struct netpbm_header {
+  netpbm_format format = netpbm_format::ppm; //!< @brief format
+  std::size_t width    = 0;                  //!< @brief width
+  std::size_t height   = 0;                  //!< @brief height
+  std::size_t depth    = 0;                  //!< @brief samples per pixel, 1 to 4
+  std::uint32_t maxval = 0;                  //!< @brief maximum sample value, 0 for float samples
+  bool alpha           = false;              //!< @brief the last sample is alpha
+  bool little_endian   = false;              //!< @brief float samples are little-endian
+  std::size_t offset   = 0;                  //!< @brief offset of the pixels in the file
+
+  /**
+   * @brief size of a sample
+   *
+   * @return Returns 1 or 2 bytes for integer samples, 4 for float samples
+   */
+  [[nodiscard]] constexpr std::size_t sample_size() const noexcept {
+    return maxval == 0 ? 4 : maxval < 256 ? 1 : 2;
+  }
+
+  /**
+   * @brief size of a row
+   *
+   * @return Returns the size in bytes
+   */
+  [[nodiscard]] constexpr std::size_t row_size() const noexcept {
+    return width * depth * sample_size();
+  }
+};
+
+/**
+ * @brief parse the header of a netpbm file
+ *
+ * Reads binary PGM (P5), PPM (P6), PAM (P7) and PFM (PF, Pf) headers.
+ * Without a TUPLTYPE a PAM has alpha at depth 2 and 4.
+ *
+ * @param[in] bytes contents of the file
+ * @return Returns the header
+ *
+ * @exception std::runtime_error if the header is invalid or the pixels are truncated
+ */
+[[nodiscard]] inline netpbm_header read_netpbm_header(std::span<const std::byte> bytes) {
+  const auto *text       = reinterpret_cast<const char *>(bytes.data());
+  const std::size_t size = bytes.size();
+  std::size_t pos        = 2;
+  const auto invalid     = [] { return std::runtime_error("invalid netpbm header"); };
+  const auto space       = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; };
+  const auto token       = [&]() -> std::string_view {
+    while (pos < size && (space(text[pos]) || text[pos] == '#')) {
+      if (text[pos] == '#')
+        while (pos < size && text[pos] != '\n')
+          ++pos;
+      else
+        ++pos;
+    }
+    const std::size_t first = pos;
+    while (pos < size && !space(text[pos]))
+      ++pos;
+    if (first == pos)
+      throw invalid();
+    return {text + first, pos - first};
+  };
+  const auto number = [&]() {
+    const auto word = token();
+    std::size_t res = 0;
+    const auto [ptr, ec] = std::from_chars(word.data(), word.data() + word.size(), res);
+    if (ec != std::errc() || ptr != word.data() + word.size() || res == 0)
+      throw invalid();
+    return res;
+  };
+  // the pixels start after the single white space that ends the header
+  const auto end_header = [&] {
+    if (pos >= size || !space(text[pos]))
+      throw invalid();
+    return pos + 1;
+  };
+
+  if (size < 2 || text[0] != 'P')
+    throw invalid();
+  netpbm_header res;
+  switch (text[1]) {
+  case '5':
+  case '6':
+    res.format = text[1] == '5' ? netpbm_format::pgm : netpbm_format::ppm;
+    res.depth  = text[1] == '5' ? 1 : 3;
+    res.width  = number();
+    res.height = number();
+    res.maxval = static_cast<std::uint32_t>(std::min<std::size_t>(number(), 65536));
+    res.offset = end_header();
+    break;
+  case 'F':
+  case 'f': {
+    res.format       = netpbm_format::pfm;
+    res.depth        = text[1] == 'F' ? 3 : 1;
+    res.width        = number();
+    res.height       = number();
+    const auto word  = token();
+    double scale     = 0;
+    const auto [ptr, ec] = std::from_chars(word.data(), word.data() + word.size(), scale);
+    if (ec != std::errc() || ptr != word.data() + word.size() || scale == 0)
+      throw invalid();
+    res.little_endian = scale < 0;
+    res.offset        = end_header();
+    break;
+  }
+  case '7': {
+    res.format = netpbm_format::pam;
+    std::string_view tuple;
+    for (auto key = token(); key != "ENDHDR"; key = token()) {
+      if (key == "WIDTH")
+        res.width = number();
+      else if (key == "HEIGHT")
+        res.height = number();
+      else if (key == "DEPTH")
+        res.depth = number();
+      else if (key == "MAXVAL")
+        res.maxval = static_cast<std::uint32_t>(std::min<std::size_t>(number(), 65536));
+      else if (key == "TUPLTYPE")
+        tuple = token();
+      else
+        throw invalid();
+    }
+    res.offset = end_header();
+    res.alpha  = tuple.empty() ? res.depth == 2 || res.depth == 4 : tuple.ends_with("_ALPHA");
+    if (res.depth == 0 || res.depth > 4 || res.alpha != (res.depth == 2 || res.depth == 4) || res.maxval == 0)
+      throw invalid();
+    break;
+  }
+  default:
+    throw invalid();
+  }
+  if (res.width == 0 || res.height == 0 || (res.format != netpbm_format::pfm && (res.maxval == 0 || res.maxval > 65535)))
+    throw invalid();
+  if (res.width > (std::numeric_limits<std::size_t>::max() - res.offset) / res.height / res.depth / res.sample_size() || res.offset + res.row_size() * res.height > size)
+    throw std::runtime_error("truncated netpbm data");
+  return res;
+}
+
+/**
+ * @brief integer sample type a netpbm file of a pixel type stores
+ *
+ * @tparam P pixel type
+ */
+template <convertible_color P>
+using netpbm_sample_t = std::conditional_t<std::same_as<typename P::sample_type, std::uint8_t>, std::uint8_t, std::uint16_t>;
+
+/**
+ * @brief pixel type a netpbm file of a pixel type stores
+ *
+ * Integer samples keep their size and are sRGB, float samples are
+ * linear. Colors without alpha of float or half samples go to PFM, with
+ * alpha to 16-bit PAM.
+ *
+ * @tparam P pixel type
+ */
+template <convertible_color P>
+using netpbm_pixel_t = std::conditional_t<
+    float_sample<typename P::sample_type> && !alpha_color<P>,
+    std::conditional_t<gray_color<P>, basic_g<float, color_encoding::linear>, basic_rgb<float, color_encoding::linear>>,
+    std::conditional_t<gray_color<P>,
+                       std::conditional_t<alpha_color<P>, basic_ga<netpbm_sample_t<P>>, basic_g<netpbm_sample_t<P>>>,
+                       std::conditional_t<alpha_color<P>, basic_rgba<netpbm_sample_t<P>>, basic_rgb<netpbm_sample_t<P>>>>>;
+
+/**
+ * @brief call a function with the pixel type of a netpbm file
+ *
+ * @param[in] header header
+ * @param[in] func called as func(std::type_identity<pixel>())
+ * @return Returns the result of func
+ */
+template <typename F>
+decltype(auto) visit_netpbm_pixel(const netpbm_header &header, F &&func) {
+  const auto samples = [&]<typename S>(std::type_identity<S>) -> decltype(auto) {
+    switch (header.depth) {
+    case 1:
+      return func(std::type_identity<basic_g<S>>());
+    case 2:
+      return func(std::type_identity<basic_ga<S>>());
+    case 3:
+      return func(std::type_identity<basic_rgb<S>>());
+    default:
+      return func(std::type_identity<basic_rgba<S>>());
+    }
+  };
+  if (header.maxval == 0) {
+    if (header.depth == 1)
+      return func(std::type_identity<basic_g<float, color_encoding::linear>>());
+    return func(std::type_identity<basic_rgb<float, color_encoding::linear>>());
+  }
+  if (header.maxval < 256)
+    return samples(std::type_identity<std::uint8_t>());
+  return samples(std::type_identity<std::uint16_t>());
+}
+
+/**
+ * @brief reverse the byte order of samples
+ *
+ * @tparam T sample type, std::uint16_t or float
+ * @param[in,out] samples samples
+ */
+template <typename T>
+requires std::same_as<T, std::uint16_t> || std::same_as<T, float>
+void swap_byte_order(std::span<T> samples) noexcept {
+  for (auto &s : samples) {
+    if constexpr (std::same_as<T, std::uint16_t>) {
+      s = static_cast<std::uint16_t>(s << 8 | s >> 8);
+    } else {
+      const auto u = std::bit_cast<std::uint32_t>(s);
+      s            = std::bit_cast<float>((u << 24) | (u << 8 & 0xff0000u) | (u >> 8 & 0xff00u) | (u >> 24));
+    }
+  }
+}
+
+/**
+ * @brief check if the pixels of a netpbm file can be used in place
+ *
+ * The file must store P with full-range samples, in the byte order and
+ * alignment of the machine, top row first; PFM stores the bottom row
+ * first and is never mapped.
+ *
+ * @tparam P pixel type
+ * @param[in] header header
+ * @param[in] data first byte of the file
+ * @return true if the pixels at data + header.offset are an image of P
+ */
+template <convertible_color P>
+[[nodiscard]] bool can_map_netpbm(const netpbm_header &header, const std::byte *data) noexcept {
+  using sample = typename P::sample_type;
+  if constexpr (std::same_as<sample, std::uint8_t> || std::same_as<sample, std::uint16_t>) {
+    const bool same = visit_netpbm_pixel(header, []<typename File>(std::type_identity<File>) { return std::same_as<File, P>; });
+    return same && header.maxval == sample_max<sample> && (sizeof(sample) == 1 || std::endian::native == std::endian::big) &&
+           reinterpret_cast<std::uintptr_t>(data + header.offset) % alignof(P) == 0;
+  } else {
+    return false;
+  }
+}
+
+/**
+ * @brief decode a row of a netpbm file into its own pixel type
+ *
+ * Swaps the byte order to the machine's and scales integer samples from
+ * [0, maxval] to the full range.
+ *
+ * @tparam File pixel type of the file
+ * @param[in] header header
+ * @param[in] src first byte of the row in the file
+ * @param[out] dst pixels, header.width of them
+ */
+template <convertible_color File>
+void decode_netpbm_row(const netpbm_header &header, const std::byte *src, std::span<File> dst) noexcept {
+  using sample = typename File::sample_type;
+  std::memcpy(dst.data(), src, dst.size_bytes());
+  const std::span<sample> samples(reinterpret_cast<sample *>(dst.data()), dst.size() * header.depth);
+  if constexpr (std::same_as<sample, float>) {
+    if (header.little_endian != (std::endian::native == std::endian::little))
+      swap_byte_order(samples);
+  } else {
+    if constexpr (sizeof(sample) == 2 && std::endian::native == std::endian::little)
+      swap_byte_order(samples);
+    if (header.maxval != sample_max<sample>) {
+      const std::uint32_t maxval = header.maxval;
+      for (auto &s : samples)
+        s = static_cast<sample>((std::min<std::uint32_t>(s, maxval) * std::uint32_t{sample_max<sample>} + maxval / 2) / maxval);
+    }
+  }
+}
+
+/**
+ * @brief decode a netpbm file
+ *
+ * The samples are converted to P as by convert_pixels whatever the format
+ * of the file, P alone decides the pixel type of the result.
+ *
+ * @tparam P pixel type
+ * @param[in] bytes contents of the file
+ * @return Returns the image
+ *
+ * @exception std::runtime_error if the file is invalid
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> decode_netpbm(std::span<const std::byte> bytes) {
+  const auto header = read_netpbm_header(bytes);
+  basic_image<P> img(header.width, header.height);
+  const auto v = img.view();
+  visit_netpbm_pixel(header, [&]<typename File>(std::type_identity<File>) {
+    static_assert(sizeof(File) == simd::channels_v<File> * sizeof(typename File::sample_type));
+    std::vector<File> row(std::same_as<File, P> ? 0 : header.width);
+    for (std::size_t y = 0; y < header.height; ++y) {
+      const std::size_t file_y = header.format == netpbm_format::pfm ? header.height - 1 - y : y;
+      const std::byte *src     = bytes.data() + header.offset + header.row_size() * file_y;
+      if constexpr (std::same_as<File, P>) {
+        decode_netpbm_row(header, src, std::span(v.row(y), header.width));
+      } else {
+        decode_netpbm_row(header, src, std::span(row));
+        convert_pixels(std::span<const File>(row), std::span(v.row(y), header.width));
+      }
+    }
+  });
+  return img;
+}
+
+/**
+ * @brief load a netpbm file
+ *
+ * The file is mapped and decoded in one pass, as decode_netpbm.
+ *
+ * @tparam P pixel type
+ * @param[in] path file
+ * @return Returns the image
+ *
+ * @exception std::system_error if the file cannot be read
+ * @exception std::runtime_error if the file is invalid
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> load_netpbm(const std::filesystem::path &path) {
+  const mapped_file file(path);
+  return decode_netpbm<P>(file.bytes());
+}
+
+/**
+ * @brief netpbm file mapped as an image view
+ *
+ * The pixels are read in place, without a copy, as the kernels touch
+ * them. The file must store P as can_map_netpbm requires, e.g. a PPM of
+ * maxval 255 is a view of basic_rgb<std::uint8_t>.
+ *
+ * @code
+ * const mapped_image<basic_rgb<std::uint8_t>> frame("frame.ppm");
+ * basic_image<basic_rgba<float, color_encoding::linear>> linear(frame.get_width(), frame.get_height());
+ * convert(frame, linear);
+ * @endcode
+ *
+ * @tparam P pixel type
+ */
+template <convertible_color P>
+class mapped_image {
+public:
+  using value_type = P;                          //!< @brief value type
+  using view_type  = basic_image_view<const P>; //!< @brief view type
+  using size_type  = std::size_t;                //!< @brief size type
+
+  /**
+   * @brief map a netpbm file
+   *
+   * @param[in] path file
+   *
+   * @exception std::system_error if the file cannot be read
+   * @exception std::runtime_error if the file is invalid or does not store P
+   */
+  explicit mapped_image(const std::filesystem::path &path)
+      : m_file(path)
+      , m_header(read_netpbm_header(m_file.bytes())) {
+    if (!can_map_netpbm<P>(m_header, m_file.data()))
+      throw std::runtime_error("netpbm pixels do not match the pixel type");
+    m_view = view_type(reinterpret_cast<const P *>(m_file.data() + m_header.offset), m_header.width, m_header.height);
+  }
+
+  /**
+   * @brief view of the pixels
+   *
+   * @return Returns the view, valid while this object lives
+   */
+  [[nodiscard]] view_type view() const noexcept {
+    return m_view;
+  }
+
+  /**
+   * @brief header of the file
+   *
+   * @return Returns the header
+   */
+  [[nodiscard]] const netpbm_header &header() const noexcept {
+    return m_header;
+  }
+
+  /**
+   * @brief get width
+   *
+   * @return Returns the width
+   */
+  [[nodiscard]] size_type get_width() const noexcept {
+    return m_header.width;
+  }
+
+  /**
+   * @brief get height
+   *
+   * @return Returns the height
+   */
+  [[nodiscard]] size_type get_height() const noexcept {
+    return m_header.height;
+  }
+
+private:
+  mapped_file m_file;
+  netpbm_header m_header;
+  view_type m_view;
+};
+
+/**
+ * @brief write an image as a netpbm file
+ *
+ * The format follows the pixel type, see netpbm_pixel_t: gray to PGM,
+ * color to PPM, either with alpha to PAM, float to PFM. Rows are
+ * converted and written one at a time.
+ *
+ * @param[in,out] out binary stream
+ * @param[in] img image or view
+ *
+ * @exception std::runtime_error if the stream fails
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void write_netpbm(std::ostream &out, const Img &img) {
+  using pixel             = pixel_t<Img>;
+  using file              = netpbm_pixel_t<pixel>;
+  using sample            = typename file::sample_type;
+  const auto v            = img.view();
+  const std::size_t w     = v.get_width();
+  const std::size_t h     = v.get_height();
+  constexpr bool pfm      = std::same_as<sample, float>;
+  constexpr bool swap     = sizeof(sample) == 2 && std::endian::native == std::endian::little;
+  constexpr bool in_place = std::same_as<pixel, file> && row_major_view<decltype(v)> && !swap;
+  if constexpr (pfm)
+    out << (gray_color<file> ? "Pf\n" : "PF\n") << w << ' ' << h << '\n' << (std::endian::native == std::endian::little ? "-1.0\n" : "1.0\n");
+  else if constexpr (alpha_color<file>)
+    out << "P7\nWIDTH " << w << "\nHEIGHT " << h << "\nDEPTH " << simd::channels_v<file> << "\nMAXVAL " << std::uint32_t{sample_max<sample>} << "\nTUPLTYPE "
+        << (gray_color<file> ? "GRAYSCALE_ALPHA" : "RGB_ALPHA") << "\nENDHDR\n";
+  else
+    out << (gray_color<file> ? "P5\n" : "P6\n") << w << ' ' << h << '\n' << std::uint32_t{sample_max<sample>} << '\n';
+
+  std::vector<file> row(in_place ? 0 : w);
+  for (std::size_t i = 0; i < h; ++i) {
+    const std::size_t y = pfm ? h - 1 - i : i;
+    const file *ptr;
+    if constexpr (in_place) {
+      ptr = v.row(y);
+    } else {
+      if constexpr (row_major_view<decltype(v)>)
+        convert_pixels(std::span<const pixel>(v.row(y), w), std::span(row));
+      else
+        for (std::size_t x = 0; x < w; ++x)
+          row[x] = convert_pixel<file>(v(x, y));
+      if constexpr (swap)
+        swap_byte_order(std::span(reinterpret_cast<sample *>(row.data()), w * simd::channels_v<file>));
+      ptr = row.data();
+    }
+    out.write(reinterpret_cast<const char *>(ptr), static_cast<std::streamsize>(w * sizeof(file)));
+  }
+  if (!out)
+    throw std::runtime_error("cannot write netpbm data");
+}
+
+/**
+ * @brief save an image as a netpbm file
+ *
+ * @param[in] path file, overwritten
+ * @param[in] img image or view
+ *
+ * @exception std::runtime_error if the file cannot be written
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void save_netpbm(const std::filesystem::path &path, const Img &img) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("cannot open " + path.string());
+  write_netpbm(out, img);
+  out.close();
+  if (!out)
+    throw std::runtime_error("cannot write " + path.string());
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_NETPBM_HPP
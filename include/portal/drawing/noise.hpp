@@ -0,0 +1,80 @@
+/**
+ * @file noise.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief noise images
+ * @version 0.1
+ * @date 2022-04-17
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_NOISE_HPP
+#define PORTAL_DRAWING_NOISE_HPP
+
+#include "../random.hpp"
+#include "algorithm.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace portal::drawing {
+/**
+ * @brief fill the pixels with uniform noise
+ *
+ * Each color sample is uniform over [0, sample_max], alpha is opaque.
+ * Integer samples are copied from the random bits, floating-point ones
+ * mapped with unit_float().
+ *
+ * @param[in,out] dst image or view
+ * @param[in,out] engine engine
+ */
+template <writable_image Dst, full_range_engine Engine>
+requires convertible_color<pixel_t<Dst>>
+void fill_noise(Dst &&dst, Engine &engine) {
+  using pixel  = pixel_t<Dst>;
+  using sample = typename pixel::sample_type;
+  // samples per random word
+  constexpr std::size_t per_word = std::is_integral_v<sample> ? sizeof(std::uint32_t) / sizeof(sample) : 1;
+  dst.view().for_each_run([&engine](auto *ptr, std::size_t, std::size_t, std::size_t count) {
+    auto *samples       = reinterpret_cast<sample *>(ptr);
+    const std::size_t n = count * simd::channels_v<pixel>;
+    std::array<std::uint32_t, 256> bits;
+    for (std::size_t i = 0; i < n; i += bits.size() * per_word) {
+      const std::size_t m = std::min(bits.size() * per_word, n - i);
+      generate_bits(engine, std::span(bits).first((m + per_word - 1) / per_word));
+      if constexpr (std::is_integral_v<sample>) {
+        std::memcpy(samples + i, bits.data(), m * sizeof(sample));
+      } else {
+        for (std::size_t j = 0; j < m; ++j)
+          samples[i + j] = sample(unit_float(bits[j]));
+      }
+    }
+    if constexpr (alpha_color<pixel>)
+      for (std::size_t i = 0; i < count; ++i)
+        ptr[i].alpha = sample_max<sample>;
+  });
+}
+
+/**
+ * @brief fill the pixels with uniform noise from the simd engine of the calling thread
+ *
+ * Draws without locking, so bands can be filled in parallel:
+ * @code
+ * parallel_for_rows(img, [](auto band, std::size_t) { fill_noise(band); });
+ * @endcode
+ *
+ * @param[in,out] dst image or view
+ */
+template <writable_image Dst>
+requires convertible_color<pixel_t<Dst>>
+void fill_noise(Dst &&dst) {
+  fill_noise(dst, random_streams::shared().this_thread<simd_random_engine>());
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_NOISE_HPP
@@ -0,0 +1,337 @@
+/**
+ * @file packed.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief pixels packed in 32 bits
+ * @version 0.1
+ * @date 2022-04-14
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_PACKED_HPP
+#define PORTAL_DRAWING_PACKED_HPP
+
+#include "../half.hpp"
+#include "../math/fast.hpp"
+#include "color.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace portal::drawing {
+/**
+ * @brief 10 bit RGB and 2 bit alpha, normalized
+ *
+ */
+struct rgb10a2 {
+  using sample_type   = std::uint32_t;     //!< @brief type of the packed bits
+  using unpacked_type = basic_rgba<float>; //!< @brief pixel the samples are taken from
+
+  std::uint32_t bits; //!< @brief red in bits 0-9, green 10-19, blue 20-29, alpha 30-31
+
+  /**
+   * @brief pack a pixel
+   *
+   * @param[in] pixel pixel, samples outside [0, 1] saturate and NaN becomes 0
+   * @return Returns the packed pixel
+   */
+  [[nodiscard]] static constexpr rgb10a2 pack(const unpacked_type &pixel) noexcept {
+    const auto q = [](float v, float max) {
+      v = math::fast::select(v > 0, v, 0.f);
+      v = math::fast::select(v < 1, v, 1.f);
+      return static_cast<std::uint32_t>(static_cast<std::int32_t>(v * max + 0.5f));
+    };
+    return {q(pixel.red, 1023) | q(pixel.green, 1023) << 10 | q(pixel.blue, 1023) << 20 | q(pixel.alpha, 3) << 30};
+  }
+
+  /**
+   * @brief unpack the pixel
+   *
+   * @return Returns the samples
+   */
+  [[nodiscard]] constexpr unpacked_type unpack() const noexcept {
+    constexpr float scale = 1.f / 1023;
+    return {static_cast<float>(bits & 0x3ffu) * scale, static_cast<float>((bits >> 10) & 0x3ffu) * scale, static_cast<float>((bits >> 20) & 0x3ffu) * scale, static_cast<float>(bits >> 30) * (1.f / 3)};
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @return true if the bits are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const rgb10a2 &, const rgb10a2 &) = default;
+};
+
+/**
+ * @brief 9 bit RGB mantissas with a shared 5 bit exponent
+ *
+ * Unsigned, without an implicit leading one, the largest value is
+ * 511 / 512 * 2^16 = 65408. The exponent follows the largest sample, so
+ * the smaller ones lose precision.
+ *
+ */
+struct rgb9e5 {
+  using sample_type   = std::uint32_t;                            //!< @brief type of the packed bits
+  using unpacked_type = basic_rgb<float, color_encoding::linear>; //!< @brief pixel the samples are taken from
+
+  std::uint32_t bits; //!< @brief red mantissa in bits 0-8, green 9-17, blue 18-26, exponent 27-31
+
+  /**
+   * @brief pack a pixel
+   *
+   * Rounds to nearest as in EXT_texture_shared_exponent, without branches.
+   *
+   * @param[in] pixel pixel, samples outside [0, 65408] saturate and NaN becomes 0
+   * @return Returns the packed pixel
+   */
+  [[nodiscard]] static constexpr rgb9e5 pack(const unpacked_type &pixel) noexcept {
+    constexpr float max = 65408.f;
+    const auto clamp    = [](float v) {
+      v = math::fast::select(v > 0, v, 0.f);
+      return math::fast::select(v < max, v, max);
+    };
+    const float r = clamp(pixel.red);
+    const float g = clamp(pixel.green);
+    const float b = clamp(pixel.blue);
+    const float m = math::fast::select(r > g, r, g);
+    const float c = math::fast::select(m > b, m, b);
+    // floor(log2(c)) + 1 from the float exponent, biased by 15 and at least 0
+    const std::int32_t e = static_cast<std::int32_t>(std::bit_cast<std::uint32_t>(c) >> 23) - 127 + 16;
+    std::int32_t shared  = e & ~(e >> 31); // max(e, 0), SSE2 has no integer max
+    const auto scale     = [](std::int32_t s) { return std::bit_cast<float>(static_cast<std::uint32_t>(127 + 24 - s) << 23); };
+    // round half up, x - trunc(x) is exact where x + 0.5f may round
+    const auto round     = [](float x) {
+      const auto t = static_cast<std::int32_t>(x);
+      return t + (x - static_cast<float>(t) >= 0.5f);
+    };
+    // the largest sample may round up to 512
+    shared += round(c * scale(shared)) == 512;
+    const float k = scale(shared);
+    const auto q  = [&round, k](float v) { return static_cast<std::uint32_t>(round(v * k)); };
+    return {q(r) | q(g) << 9 | q(b) << 18 | static_cast<std::uint32_t>(shared) << 27};
+  }
+
+  /**
+   * @brief unpack the pixel
+   *
+   * @return Returns the samples, exact
+   */
+  [[nodiscard]] constexpr unpacked_type unpack() const noexcept {
+    const float k = std::bit_cast<float>(((bits >> 27) + 127u - 24u) << 23);
+    return {static_cast<float>(bits & 0x1ffu) * k, static_cast<float>((bits >> 9) & 0x1ffu) * k, static_cast<float>((bits >> 18) & 0x1ffu) * k};
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @return true if the bits are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const rgb9e5 &, const rgb9e5 &) = default;
+};
+
+/**
+ * @brief unsigned 11 bit float red and green, 10 bit float blue
+ *
+ * Each sample has a 5 bit exponent as half, with 6 (red, green) or 5
+ * (blue) mantissa bits and no sign.
+ *
+ */
+struct r11g11b10f {
+  using sample_type   = std::uint32_t;                            //!< @brief type of the packed bits
+  using unpacked_type = basic_rgb<float, color_encoding::linear>; //!< @brief pixel the samples are taken from
+
+  std::uint32_t bits; //!< @brief red in bits 0-10, green 11-21, blue 22-31
+
+  /**
+   * @brief pack a pixel
+   *
+   * Rounds to nearest even, overflows to infinity and keeps NaN.
+   *
+   * @param[in] pixel pixel, negative samples become 0
+   * @return Returns the packed pixel
+   */
+  [[nodiscard]] static constexpr r11g11b10f pack(const unpacked_type &pixel) noexcept {
+    const auto q = []<unsigned M>(float v, std::integral_constant<unsigned, M>) {
+      // clears negative numbers, -0 and -inf, but not a NaN with the sign set
+      const std::uint32_t f = std::bit_cast<std::uint32_t>(v);
+      return minifloat_bits<M>(v) & -std::uint32_t{f < 0x80000000u || f > 0xff800000u};
+    };
+    using six  = std::integral_constant<unsigned, 6>;
+    using five = std::integral_constant<unsigned, 5>;
+    return {q(pixel.red, six{}) | q(pixel.green, six{}) << 11 | q(pixel.blue, five{}) << 22};
+  }
+
+  /**
+   * @brief unpack the pixel
+   *
+   * @return Returns the samples, exact
+   */
+  [[nodiscard]] constexpr unpacked_type unpack() const noexcept {
+    return {minifloat_value<6>(bits & 0x7ffu), minifloat_value<6>((bits >> 11) & 0x7ffu), minifloat_value<5>(bits >> 22)};
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @return true if the bits are equal
+   */
+  [[nodiscard]] friend constexpr bool operator==(const r11g11b10f &, const r11g11b10f &) = default;
+};
+
+/**
+ * @brief pixel packed from the samples of another color
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept packed_color = requires(const T &a, const typename T::unpacked_type &u) {
+  { T::pack(u) } -> std::same_as<T>;
+  { a.unpack() } -> std::same_as<typename T::unpacked_type>;
+};
+
+/**
+ * @brief color with a conversion, packed or not
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept format_color = convertible_color<T> || packed_color<T>;
+
+/**
+ * @brief pack a row of pixels
+ *
+ * Same as P::pack on each pixel, in a loop the compiler vectorizes.
+ *
+ * @tparam P packed pixel
+ * @param[in] src pixels
+ * @param[out] dst packed pixels
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <packed_color P>
+void pack_pixels(std::span<const typename P::unpacked_type> src, std::span<P> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = P::pack(src[i]);
+}
+
+/**
+ * @brief unpack a row of pixels
+ *
+ * Same as unpack on each pixel, in a loop the compiler vectorizes.
+ *
+ * @tparam P packed pixel
+ * @param[in] src packed pixels
+ * @param[out] dst pixels
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <packed_color P>
+void unpack_pixels(std::span<const P> src, std::span<typename P::unpacked_type> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = src[i].unpack();
+}
+
+/**
+ * @brief convert a pixel to a packed pixel
+ *
+ * @tparam To packed pixel
+ * @tparam From source color
+ * @param[in] src pixel
+ * @return Returns the pixel converted to To::unpacked_type and packed
+ */
+template <packed_color To, format_color From>
+[[nodiscard]] constexpr To convert_pixel(const From &src) noexcept {
+  if constexpr (std::same_as<To, From>)
+    return src;
+  else
+    return To::pack(convert_pixel<typename To::unpacked_type>(src));
+}
+
+/**
+ * @brief convert a packed pixel
+ *
+ * @tparam To destination color
+ * @tparam From packed pixel
+ * @param[in] src pixel
+ * @return Returns the unpacked pixel converted to To
+ */
+template <convertible_color To, packed_color From>
+[[nodiscard]] constexpr To convert_pixel(const From &src) noexcept {
+  return convert_pixel<To>(src.unpack());
+}
+
+/**
+ * @brief convert a row of pixels to packed pixels
+ *
+ * The pixels are converted to To::unpacked_type and packed in chunks, or
+ * packed directly when they already are of that type.
+ *
+ * @tparam From source color
+ * @tparam To packed pixel
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <format_color From, packed_color To>
+void convert_pixels(std::span<const From> src, std::span<To> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  if constexpr (std::same_as<From, To>) {
+    std::copy(src.begin(), src.end(), dst.begin());
+  } else if constexpr (std::same_as<From, typename To::unpacked_type>) {
+    pack_pixels(src, dst);
+  } else {
+    constexpr std::size_t chunk = 64;
+    std::array<typename To::unpacked_type, chunk> buf;
+    for (std::size_t first = 0; first < src.size(); first += chunk) {
+      const auto n = std::min(chunk, src.size() - first);
+      convert_pixels(src.subspan(first, n), std::span(buf.data(), n));
+      pack_pixels<To>(std::span(buf.data(), n), dst.subspan(first, n));
+    }
+  }
+}
+
+/**
+ * @brief convert a row of packed pixels
+ *
+ * The pixels are unpacked and converted in chunks, or unpacked directly
+ * into To::unpacked_type.
+ *
+ * @tparam From packed pixel
+ * @tparam To destination color
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <packed_color From, convertible_color To>
+void convert_pixels(std::span<const From> src, std::span<To> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  if constexpr (std::same_as<To, typename From::unpacked_type>) {
+    unpack_pixels(src, dst);
+  } else {
+    constexpr std::size_t chunk = 64;
+    std::array<typename From::unpacked_type, chunk> buf;
+    for (std::size_t first = 0; first < src.size(); first += chunk) {
+      const auto n = std::min(chunk, src.size() - first);
+      unpack_pixels(src.subspan(first, n), std::span(buf.data(), n));
+      convert_pixels(std::span<const typename From::unpacked_type>(buf.data(), n), dst.subspan(first, n));
+    }
+  }
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_PACKED_HPP
@@ -0,0 +1,150 @@
+/**
+ * @file parallel.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief parallel image kernels
+ * @version 0.1
+ * @date 2022-04-15
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_PARALLEL_HPP
+#define PORTAL_DRAWING_PARALLEL_HPP
+
+#include "../thread_pool.hpp"
+#include "algorithm.hpp"
+#include "image_view.hpp"
+#include "packed.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace portal::drawing {
+/**
+ * @brief rows a parallel band is a multiple of
+ *
+ * The traversal block height of the layout, so that bands of a view
+ * starting on a block boundary do not share blocks.
+ *
+ * @tparam Layout layout
+ */
+template <typename Layout>
+inline constexpr std::size_t band_rows_v = 1;
+
+/**
+ * @brief rows a parallel band is a multiple of
+ *
+ * @tparam Layout layout with traversal blocks
+ */
+template <typename Layout>
+requires requires {
+  Layout::mapping::block_height;
+}
+inline constexpr std::size_t band_rows_v<Layout> = Layout::mapping::block_height;
+
+/**
+ * @brief run a function on bands of rows in parallel
+ *
+ * @code
+ * parallel_for_rows(img, [](auto band, std::size_t) { fill(band, {0, 0, 0, 255}); });
+ * @endcode
+ *
+ * @param[in] img image or view
+ * @param[in] func called as func(band, y) with the subview of full width from row y
+ * @param[in] grain rows per band, rounded up to band_rows_v, 0 to let the pool choose
+ * @param[in] pool pool
+ */
+template <image_like Img, typename F>
+void parallel_for_rows(Img &&img, F func, std::size_t grain = 0, thread_pool &pool = thread_pool::shared()) {
+  const auto v               = img.view();
+  constexpr std::size_t unit = band_rows_v<typename decltype(v)::layout_type>;
+  const std::size_t units    = (v.get_height() + unit - 1) / unit;
+  if (v.empty())
+    return;
+  pool.parallel_for(units, (grain + unit - 1) / unit, [&v, &func](std::size_t first, std::size_t last) {
+    const std::size_t y = first * unit;
+    func(v.subview(0, y, v.get_width(), std::min(last * unit, v.get_height()) - y), y);
+  });
+}
+
+/**
+ * @brief run a function on tiles in parallel
+ *
+ * Tiles go in row-major order, the ones at the right and bottom edges are
+ * clipped. Tiles the size of the traversal block of a tiled layout are
+ * contiguous in memory.
+ *
+ * @param[in] img image or view
+ * @param[in] tile_width tile width
+ * @param[in] tile_height tile height
+ * @param[in] func called as func(tile, x, y) with the subview of the tile at (x, y)
+ * @param[in] grain tiles per chunk of work, 0 to let the pool choose
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if a tile size is 0
+ */
+template <image_like Img, typename F>
+void parallel_for_tiles(Img &&img, std::size_t tile_width, std::size_t tile_height, F func, std::size_t grain = 0, thread_pool &pool = thread_pool::shared()) {
+  if (tile_width == 0 || tile_height == 0)
+    throw std::invalid_argument("tile size must not be 0");
+  const auto v           = img.view();
+  const std::size_t cols = (v.get_width() + tile_width - 1) / tile_width;
+  const std::size_t rows = (v.get_height() + tile_height - 1) / tile_height;
+  pool.parallel_for(cols * rows, grain, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      const std::size_t x = i % cols * tile_width;
+      const std::size_t y = i / cols * tile_height;
+      func(v.subview(x, y, std::min(tile_width, v.get_width() - x), std::min(tile_height, v.get_height() - y)), x, y);
+    }
+  });
+}
+
+/**
+ * @brief convert each pixel into another image in parallel
+ *
+ * Same as convert(src, dst, func) on bands of rows of dst.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] func conversion, called as func(src pixel) and returning the dst pixel, from several threads
+ * @param[in] grain rows per band, 0 to let the pool choose
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <image_like Src, writable_image Dst, typename F>
+requires std::convertible_to<std::invoke_result_t<F &, const pixel_t<Src> &>, pixel_t<Dst>>
+void parallel_transform(const Src &src, Dst &&dst, F func, std::size_t grain = 0, thread_pool &pool = thread_pool::shared()) {
+  const auto s = src.view();
+  if (s.get_width() != dst.view().get_width() || s.get_height() != dst.view().get_height())
+    throw std::invalid_argument("image sizes vary");
+  parallel_for_rows(
+      dst, [&s, &func](auto band, std::size_t y) { convert(s.subview(0, y, band.get_width(), band.get_height()), band, func); }, grain, pool);
+}
+
+/**
+ * @brief convert pixels into another format in parallel
+ *
+ * Same as convert(src, dst) on bands of rows of dst, with its simd
+ * kernels.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view of the same size
+ * @param[in] grain rows per band, 0 to let the pool choose
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <image_like Src, writable_image Dst>
+requires format_color<pixel_t<Src>> && format_color<pixel_t<Dst>>
+void parallel_transform(const Src &src, Dst &&dst, std::size_t grain = 0, thread_pool &pool = thread_pool::shared()) {
+  const auto s = src.view();
+  if (s.get_width() != dst.view().get_width() || s.get_height() != dst.view().get_height())
+    throw std::invalid_argument("image sizes vary");
+  parallel_for_rows(
+      dst, [&s](auto band, std::size_t y) { convert(s.subview(0, y, band.get_width(), band.get_height()), band); }, grain, pool);
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_PARALLEL_HPP
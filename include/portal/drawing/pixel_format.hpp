@@ -0,0 +1,492 @@
+/**
+ * @file pixel_format.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief conversion between pixel formats
+ * @version 0.1
+ * @date 2022-04-11
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_PIXEL_FORMAT_HPP
+#define PORTAL_DRAWING_PIXEL_FORMAT_HPP
+
+#include "../half.hpp"
+#include "../math/fast.hpp"
+#include "../math/simd.hpp"
+#include "color.hpp"
+#include "srgb.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace portal::drawing {
+/**
+ * @brief floating-point sample type
+ *
+ * Half samples are converted through float.
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept float_sample = std::same_as<T, float> || std::same_as<T, half>;
+
+/**
+ * @brief sample type with a conversion
+ *
+ * Integer samples are normalized to [0, max], floating-point samples to [0, 1].
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept pixel_sample = std::same_as<T, std::uint8_t> || std::same_as<T, std::uint16_t> || float_sample<T>;
+
+/**
+ * @brief sample value of full intensity
+ *
+ * @tparam T sample type
+ */
+template <pixel_sample T>
+inline constexpr T sample_max = float_sample<T> ? T(1) : std::numeric_limits<T>::max();
+
+/**
+ * @brief the more precise of two sample types
+ *
+ * @tparam T sample type
+ * @tparam U sample type
+ */
+template <pixel_sample T, pixel_sample U>
+using wider_sample_t = std::conditional_t<float_sample<T> || float_sample<U>, float, std::conditional_t<(sizeof(T) > sizeof(U)), T, U>>;
+
+/**
+ * @brief color with a conversion
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept convertible_color = (true_color<T> || gray_color<T>) && pixel_sample<typename T::sample_type>;
+
+/**
+ * @brief convert a sample
+ *
+ * Integer to integer and float to integer round to nearest, float samples
+ * outside [0, 1] saturate and NaN becomes 0. Half samples convert as
+ * their float value.
+ *
+ * @tparam To destination sample type
+ * @tparam From source sample type
+ * @param[in] value sample
+ * @return Returns the sample in To
+ */
+template <pixel_sample To, pixel_sample From>
+[[nodiscard]] constexpr To convert_sample(From value) noexcept {
+  if constexpr (std::same_as<To, From>) {
+    return value;
+  } else if constexpr (std::same_as<To, half>) {
+    return half(convert_sample<float>(value));
+  } else if constexpr (std::same_as<From, half>) {
+    return convert_sample<To>(static_cast<float>(value));
+  } else if constexpr (std::is_floating_point_v<To>) {
+    return static_cast<To>(value) * (To(1) / sample_max<From>);
+  } else if constexpr (std::is_floating_point_v<From>) {
+    // bit selects keep the loops of callers vectorizable, std::min / std::max do not without -fno-trapping-math
+    value = math::fast::select(value > 0, value, From(0));
+    value = math::fast::select(value < 1, value, From(1));
+    return static_cast<To>(static_cast<std::int32_t>(value * sample_max<To> + From(0.5)));
+  } else if constexpr (sizeof(To) > sizeof(From)) {
+    return static_cast<To>(value * 257u);
+  } else {
+    // round(value / 257)
+    return static_cast<To>((value * 255u + 32895u) >> 16);
+  }
+}
+
+/**
+ * @brief transfer table of 8 bit samples
+ *
+ * @tparam To destination sample type
+ * @tparam E encoding of the destination, the source has the other one
+ */
+template <pixel_sample To, color_encoding E>
+inline constexpr auto byte_transfer_table = [] {
+  std::array<To, 256> table{};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    const double x = i / 255.;
+    table[i]       = convert_sample<To>(static_cast<float>(E == color_encoding::linear ? srgb_to_linear(x) : linear_to_srgb(x)));
+  }
+  return table;
+}();
+
+/**
+ * @brief convert a color sample between encodings
+ *
+ * 8 bit sources are looked up in byte_transfer_table, other sources go
+ * through float and the medium tier of srgb_to_linear / linear_to_srgb.
+ *
+ * @tparam To destination sample type
+ * @tparam ToE destination encoding
+ * @tparam FromE source encoding
+ * @tparam From source sample type
+ * @param[in] value sample
+ * @return Returns the sample in To and ToE
+ */
+template <pixel_sample To, color_encoding ToE, color_encoding FromE, pixel_sample From>
+[[nodiscard]] constexpr To transcode_sample(From value) noexcept {
+  using math::fast::precision;
+  if constexpr (ToE == FromE) {
+    return convert_sample<To>(value);
+  } else if constexpr (std::same_as<From, std::uint8_t>) {
+    return byte_transfer_table<To, ToE>[value];
+  } else if constexpr (ToE == color_encoding::linear) {
+    return convert_sample<To>(srgb_to_linear<precision::medium>(convert_sample<float>(value)));
+  } else {
+    return convert_sample<To>(linear_to_srgb<precision::medium>(convert_sample<float>(value)));
+  }
+}
+
+/**
+ * @brief luminance (BT.601 weights)
+ *
+ * Integer samples use 15 bit fixed-point weights, so the result is exact
+ * and the same in the scalar and simd paths.
+ *
+ * @tparam T sample type
+ * @param[in] red red
+ * @param[in] green green
+ * @param[in] blue blue
+ * @return Returns 0.299 red + 0.587 green + 0.114 blue
+ */
+template <pixel_sample T>
+[[nodiscard]] constexpr T luminance(T red, T green, T blue) noexcept {
+  if constexpr (float_sample<T>)
+    return static_cast<T>(0.299f * red + 0.587f * green + 0.114f * blue);
+  else
+    return static_cast<T>((9798u * red + 19235u * green + 3735u * blue + 16384u) >> 15);
+}
+
+/**
+ * @brief convert a pixel
+ *
+ * Channels are matched by name. Color to gray takes the luminance, gray to
+ * color repeats the gray, a missing alpha becomes opaque and an alpha
+ * without a destination is dropped. Color samples of different encodings
+ * are transcoded as by transcode_sample, the luminance is then taken on
+ * linear samples.
+ *
+ * @tparam To destination color
+ * @tparam From source color
+ * @param[in] src pixel
+ * @return Returns the pixel in To
+ */
+template <convertible_color To, convertible_color From>
+[[nodiscard]] constexpr To convert_pixel(const From &src) noexcept {
+  using to_sample         = typename To::sample_type;
+  using from_sample       = typename From::sample_type;
+  constexpr auto to_enc   = encoding_v<To>;
+  constexpr auto from_enc = encoding_v<From>;
+  const auto color        = [](auto value) { return transcode_sample<to_sample, to_enc, from_enc>(value); };
+  To res{};
+  if constexpr (true_color<To> && true_color<From>) {
+    res.red   = color(src.red);
+    res.green = color(src.green);
+    res.blue  = color(src.blue);
+  } else if constexpr (true_color<To>) {
+    res.red   = color(src.gray);
+    res.green = res.red;
+    res.blue  = res.red;
+  } else if constexpr (true_color<From>) {
+    constexpr bool same     = to_enc == from_enc;
+    constexpr auto luma_enc = same ? to_enc : color_encoding::linear;
+    using W                 = std::conditional_t<same, wider_sample_t<to_sample, from_sample>, float>;
+    const auto in           = [](from_sample value) { return transcode_sample<W, luma_enc, from_enc>(value); };
+    const W y               = luminance(in(src.red), in(src.green), in(src.blue));
+    res.gray                = transcode_sample<to_sample, to_enc, luma_enc>(y);
+  } else {
+    res.gray = color(src.gray);
+  }
+  if constexpr (alpha_color<To> && alpha_color<From>)
+    res.alpha = convert_sample<to_sample>(src.alpha);
+  else if constexpr (alpha_color<To>)
+    res.alpha = sample_max<to_sample>;
+  return res;
+}
+
+/**
+ * @brief simd row kernels of the pixel conversion
+ *
+ * Each kernel converts the longest prefix it can and returns its length,
+ * the caller finishes the rest with convert_pixel. Without the instruction
+ * set a kernel returns 0. Plain SSE2 has no byte shuffle, there the
+ * compiler's own vectorization of the pixel loop beats shifts and masks.
+ */
+namespace simd {
+/**
+ * @brief number of samples in a pixel
+ *
+ * @tparam P pixel type
+ */
+template <convertible_color P>
+inline constexpr std::size_t channels_v = sizeof(P) / sizeof(typename P::sample_type);
+
+/**
+ * @brief position of the destination samples in the source pixel
+ *
+ * Entry i is the source sample stored in sample i of the destination, -1
+ * for an alpha without a source (filled opaque).
+ *
+ * @tparam To destination color
+ * @tparam From source color
+ * @return Returns the sample map
+ */
+template <true_color To, true_color From>
+[[nodiscard]] consteval std::array<int, 4> channel_map() noexcept {
+  constexpr std::size_t s = sizeof(typename From::sample_type);
+  constexpr std::size_t d = sizeof(typename To::sample_type);
+  std::array<int, 4> res  = {-1, -1, -1, -1};
+  res[offsetof(To, red) / d]   = static_cast<int>(offsetof(From, red) / s);
+  res[offsetof(To, green) / d] = static_cast<int>(offsetof(From, green) / s);
+  res[offsetof(To, blue) / d]  = static_cast<int>(offsetof(From, blue) / s);
+  if constexpr (alpha_color<To> && alpha_color<From>)
+    res[offsetof(To, alpha) / d] = static_cast<int>(offsetof(From, alpha) / s);
+  return res;
+}
+
+/**
+ * @brief reorder 8 bit color samples (BGRA <-> RGBA, RGB <-> RGBA, ...)
+ *
+ * @tparam To destination color
+ * @tparam From source color
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels
+ * @param[in] count number of pixels
+ * @return Returns the number of pixels converted
+ */
+template <true_color To, true_color From>
+std::size_t swizzle([[maybe_unused]] const From *src, [[maybe_unused]] To *dst, [[maybe_unused]] std::size_t count) noexcept {
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSSE3)
+  constexpr auto map = channel_map<To, From>();
+  constexpr auto sc  = channels_v<From>;
+  constexpr auto dc  = channels_v<To>;
+  const auto *s      = reinterpret_cast<const std::uint8_t *>(src);
+  auto *d            = reinterpret_cast<std::uint8_t *>(dst);
+  // 4 pixels per shuffle, loads and stores are 16 bytes wide even for 12 byte groups
+  alignas(16) std::uint8_t shuffle[16], fill[16] = {};
+  for (std::size_t p = 0; p < 4; ++p) {
+    for (std::size_t k = 0; k < dc; ++k) {
+      shuffle[p * dc + k] = map[k] < 0 ? 0x80 : static_cast<std::uint8_t>(p * sc + map[k]);
+      fill[p * dc + k]    = map[k] < 0 ? 0xff : 0;
+    }
+  }
+  for (std::size_t k = 4 * dc; k < 16; ++k)
+    shuffle[k] = 0x80;
+  const __m128i mask  = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffle));
+  const __m128i alpha = _mm_load_si128(reinterpret_cast<const __m128i *>(fill));
+  constexpr std::size_t group = (16 + std::min(sc, dc) - 1) / std::min(sc, dc);
+  for (; i + group <= count; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i * sc));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(d + i * dc), _mm_or_si128(_mm_shuffle_epi8(v, mask), alpha));
+  }
+#endif
+  return i;
+}
+
+/**
+ * @brief repeat 8 bit gray into 4 sample color
+ *
+ * @tparam To destination color
+ * @tparam From source color
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels
+ * @param[in] count number of pixels
+ * @return Returns the number of pixels converted
+ */
+template <true_color To, gray_color From>
+std::size_t expand_gray(const From *src, To *dst, std::size_t count) noexcept {
+  std::size_t i = 0;
+  if constexpr (channels_v<To> == 4 && channels_v<From> == 1 && std::endian::native == std::endian::little) {
+    constexpr std::uint32_t opaque = 0xffu << (8 * (offsetof(To, alpha)));
+    constexpr std::uint32_t spread = 0x01010101u & ~opaque;
+    for (; i < count; ++i) {
+      const std::uint32_t v = src[i].gray * spread | opaque;
+      std::memcpy(dst + i, &v, 4);
+    }
+  }
+  return i;
+}
+
+/**
+ * @brief luminance of 8 bit 4 sample color
+ *
+ * @tparam To destination color
+ * @tparam From source color
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels
+ * @param[in] count number of pixels
+ * @return Returns the number of pixels converted
+ */
+template <gray_color To, true_color From>
+std::size_t luminance(const From *src, To *dst, std::size_t count) noexcept {
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+  if constexpr (channels_v<From> == 4 && channels_v<To> == 1) {
+    // 16 bit weights in the sample order of From, pmaddwd adds two samples at once
+    alignas(16) std::int16_t weight[8] = {};
+    for (std::size_t p = 0; p < 8; p += 4) {
+      weight[p + offsetof(From, red)]   = 9798;
+      weight[p + offsetof(From, green)] = 19235;
+      weight[p + offsetof(From, blue)]  = 3735;
+    }
+    const __m128i w     = _mm_load_si128(reinterpret_cast<const __m128i *>(weight));
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(16384);
+    const auto *s       = reinterpret_cast<const std::uint8_t *>(src);
+    const auto four     = [&](std::size_t j) {
+      const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + j * 4));
+      const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), w);
+      const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), w);
+      const __m128 a   = _mm_castsi128_ps(lo);
+      const __m128 b   = _mm_castsi128_ps(hi);
+      const __m128i y  = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+      return _mm_srli_epi32(_mm_add_epi32(y, round), 15);
+    };
+    for (; i + 16 <= count; i += 16) {
+      const __m128i lo = _mm_packs_epi32(four(i), four(i + 4));
+      const __m128i hi = _mm_packs_epi32(four(i + 8), four(i + 12));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+  }
+#endif
+  return i;
+}
+
+/**
+ * @brief float samples to 8 bit samples
+ *
+ * @param[in] src source samples
+ * @param[out] dst destination samples
+ * @param[in] count number of samples
+ * @return Returns the number of samples converted
+ */
+inline std::size_t quantize(const float *src, std::uint8_t *dst, std::size_t count) noexcept {
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+  // the integer packs saturate, NaN converts to INT_MIN and saturates to 0
+  const __m128 scale = _mm_set1_ps(255.f);
+  const __m128 half  = _mm_set1_ps(0.5f);
+  const auto four    = [&](std::size_t j) {
+    const __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + j), scale), half);
+    return _mm_cvttps_epi32(_mm_min_ps(scale, v));
+  };
+  for (; i + 16 <= count; i += 16) {
+    const __m128i lo = _mm_packs_epi32(four(i), four(i + 4));
+    const __m128i hi = _mm_packs_epi32(four(i + 8), four(i + 12));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  return i;
+}
+} // namespace simd
+
+/**
+ * @brief convert a row of pixels
+ *
+ * Same as convert_pixel on each pixel. Swizzles, gray expansion, 8 bit
+ * luminance, float to 8 bit quantization and half to and from float run
+ * simd kernels, conversions that keep the sample order are done sample by
+ * sample in a loop the compiler vectorizes. Between encodings 8 bit sources are looked up in
+ * tables, other sources are converted to float and run through the
+ * batched srgb_to_linear / linear_to_srgb.
+ *
+ * @tparam From source color
+ * @tparam To destination color
+ * @param[in] src source pixels
+ * @param[out] dst destination pixels, must not overlap src unless the types are the same
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <convertible_color From, convertible_color To>
+void convert_pixels(std::span<const From> src, std::span<To> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  using from_sample = typename From::sample_type;
+  using to_sample   = typename To::sample_type;
+  const auto count  = src.size();
+  std::size_t i     = 0;
+
+  constexpr bool same_order = [] {
+    if constexpr (true_color<To> && true_color<From>) {
+      constexpr auto map = simd::channel_map<To, From>();
+      return simd::channels_v<To> == simd::channels_v<From> && map == std::array<int, 4>{0, 1, 2, simd::channels_v<To> == 4 ? 3 : -1};
+    } else if constexpr (gray_color<To> && gray_color<From>) {
+      return simd::channels_v<To> == simd::channels_v<From>;
+    } else {
+      return false;
+    }
+  }();
+  constexpr bool bytes = std::same_as<from_sample, std::uint8_t> && std::same_as<to_sample, std::uint8_t> && encoding_v<From> == encoding_v<To>;
+
+  if constexpr (std::same_as<From, To>) {
+    std::copy(src.begin(), src.end(), dst.begin());
+    return;
+  } else if constexpr (same_order && encoding_v<From> == encoding_v<To>) {
+    // only the sample type differs
+    const auto *s = reinterpret_cast<const from_sample *>(src.data());
+    auto *d       = reinterpret_cast<to_sample *>(dst.data());
+    const auto n  = count * simd::channels_v<From>;
+    std::size_t j = 0;
+    if constexpr (std::same_as<from_sample, float> && std::same_as<to_sample, std::uint8_t>) {
+      j = simd::quantize(s, d, n);
+    } else if constexpr (std::same_as<from_sample, half> && std::same_as<to_sample, float>) {
+      half_to_float(std::span(s, n), std::span(d, n));
+      return;
+    } else if constexpr (std::same_as<from_sample, float> && std::same_as<to_sample, half>) {
+      float_to_half(std::span(s, n), std::span(d, n));
+      return;
+    }
+    for (; j < n; ++j)
+      d[j] = convert_sample<to_sample>(s[j]);
+    return;
+  } else if constexpr (encoding_v<From> != encoding_v<To> && !std::same_as<from_sample, std::uint8_t> && !(true_color<From> && gray_color<To>)) {
+    // to float samples, through the curve in batches, then a conversion that keeps the encoding
+    using mid                   = rebind_color_t<From, float, encoding_v<To>>;
+    constexpr std::size_t chunk = 64;
+    std::array<mid, chunk> buf;
+    auto *samples = reinterpret_cast<float *>(buf.data());
+    for (std::size_t first = 0; first < count; first += chunk) {
+      const auto n  = std::min(chunk, count - first);
+      const auto m  = n * simd::channels_v<From>;
+      const auto *s = reinterpret_cast<const from_sample *>(src.data() + first);
+      for (std::size_t j = 0; j < m; ++j)
+        samples[j] = convert_sample<float>(s[j]);
+      if constexpr (encoding_v<To> == color_encoding::linear)
+        srgb_to_linear(std::span<const float>(samples, m), std::span(samples, m));
+      else
+        linear_to_srgb(std::span<const float>(samples, m), std::span(samples, m));
+      if constexpr (alpha_color<From>)
+        for (std::size_t j = 0; j < n; ++j)
+          buf[j].alpha = convert_sample<float>(src[first + j].alpha);
+      convert_pixels(std::span<const mid>(buf.data(), n), dst.subspan(first, n));
+    }
+    return;
+  } else if constexpr (bytes && true_color<To> && true_color<From>) {
+    i = simd::swizzle(src.data(), dst.data(), count);
+  } else if constexpr (bytes && true_color<To>) {
+    i = simd::expand_gray(src.data(), dst.data(), count);
+  } else if constexpr (bytes && true_color<From>) {
+    i = simd::luminance(src.data(), dst.data(), count);
+  }
+  for (; i < count; ++i)
+    dst[i] = convert_pixel<To>(src[i]);
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_PIXEL_FORMAT_HPP
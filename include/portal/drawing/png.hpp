@@ -0,0 +1,490 @@
+/**
+ * @file png.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief PNG image files
+ * @version 0.1
+ * @date 2022-04-20
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_PNG_HPP
+#define PORTAL_DRAWING_PNG_HPP
+
+#include "../deflate.hpp"
+#include "../mapped_file.hpp"
+#include "../thread_pool.hpp"
+#include "algorithm.hpp"
+#include "image.hpp"
+#include "netpbm.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief pixel type a PNG file of a pixel type stores
+ *
+ * 8-bit samples stay 8-bit, the others are stored as 16-bit, all sRGB.
+ *
+ * @tparam P pixel type
+ */
+template <convertible_color P>
+using png_pixel_t = std::conditional_t<gray_color<P>,
+                                       std::conditional_t<alpha_color<P>, basic_ga<netpbm_sample_t<P>>, basic_g<netpbm_sample_t<P>>>,
+                                       std::conditional_t<alpha_color<P>, basic_rgba<netpbm_sample_t<P>>, basic_rgb<netpbm_sample_t<P>>>>;
+
+/**
+ * @brief filter a PNG row with the filter of the least sum of absolute differences
+ *
+ * The usual heuristic: the filtered bytes taken as signed, the filter
+ * closest to zero overall compresses best.
+ *
+ * @param[in] row row
+ * @param[in] prev row above, zeros for the first row
+ * @param[in] bpp bytes per pixel, at least 1
+ * @param[out] dst the filter type then row.size() filtered bytes
+ * @param[in] adaptive false to use no filter
+ */
+inline void filter_png_row(std::span<const std::uint8_t> row, const std::uint8_t *prev, std::size_t bpp, std::uint8_t *dst, bool adaptive = true) noexcept {
+  const std::size_t n = row.size();
+  const auto *cur     = row.data();
+  // residual of x from its left, upper and upper left neighbours a, b and c
+  const auto residual = []<unsigned Filter>(std::integral_constant<unsigned, Filter>, int x, int a, int b, int c) {
+    int p = 0;
+    if constexpr (Filter == 1) {
+      p = a;
+    } else if constexpr (Filter == 2) {
+      p = b;
+    } else if constexpr (Filter == 3) {
+      p = (a + b) >> 1;
+    } else if constexpr (Filter == 4) {
+      const int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+      p = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+    }
+    return static_cast<std::uint8_t>(x - p);
+  };
+  // a loop per filter with the first pixel peeled, the rest vectorizes
+  const auto cost = [&](auto filter) {
+    std::uint32_t sum = 0;
+    for (std::size_t i = 0; i < bpp; ++i)
+      sum += static_cast<std::uint32_t>(std::abs(static_cast<std::int8_t>(residual(filter, cur[i], 0, prev[i], 0))));
+    for (std::size_t i = bpp; i < n; ++i)
+      sum += static_cast<std::uint32_t>(std::abs(static_cast<std::int8_t>(residual(filter, cur[i], cur[i - bpp], prev[i], prev[i - bpp]))));
+    return sum;
+  };
+  const auto apply = [&](auto filter) {
+    dst[0] = static_cast<std::uint8_t>(decltype(filter)::value);
+    for (std::size_t i = 0; i < bpp; ++i)
+      dst[1 + i] = residual(filter, cur[i], 0, prev[i], 0);
+    for (std::size_t i = bpp; i < n; ++i)
+      dst[1 + i] = residual(filter, cur[i], cur[i - bpp], prev[i], prev[i - bpp]);
+  };
+  using none  = std::integral_constant<unsigned, 0>;
+  using sub   = std::integral_constant<unsigned, 1>;
+  using up    = std::integral_constant<unsigned, 2>;
+  using avg   = std::integral_constant<unsigned, 3>;
+  using paeth = std::integral_constant<unsigned, 4>;
+  if (!adaptive || n < bpp)
+    return apply(none());
+  const std::array<std::uint32_t, 5> costs = {cost(none()), cost(sub()), cost(up()), cost(avg()), cost(paeth())};
+  switch (std::min_element(costs.begin(), costs.end()) - costs.begin()) {
+  case 0:
+    return apply(none());
+  case 1:
+    return apply(sub());
+  case 2:
+    return apply(up());
+  case 3:
+    return apply(avg());
+  default:
+    return apply(paeth());
+  }
+}
+
+/**
+ * @brief undo the filter of a PNG row
+ *
+ * @param[in] filter filter type
+ * @param[in,out] row filtered bytes, replaced by the row
+ * @param[in] prev row above, zeros for the first row
+ * @param[in] bpp bytes per pixel, at least 1
+ * @return false if the filter type is invalid
+ */
+inline bool unfilter_png_row(unsigned filter, std::span<std::uint8_t> row, const std::uint8_t *prev, std::size_t bpp) noexcept {
+  const std::size_t n = row.size();
+  auto *cur           = row.data();
+  const std::size_t m = std::min(bpp, n);
+  switch (filter) {
+  case 0:
+    return true;
+  case 1:
+    for (std::size_t i = bpp; i < n; ++i)
+      cur[i] = static_cast<std::uint8_t>(cur[i] + cur[i - bpp]);
+    return true;
+  case 2:
+    for (std::size_t i = 0; i < n; ++i)
+      cur[i] = static_cast<std::uint8_t>(cur[i] + prev[i]);
+    return true;
+  case 3:
+    for (std::size_t i = 0; i < m; ++i)
+      cur[i] = static_cast<std::uint8_t>(cur[i] + prev[i] / 2);
+    for (std::size_t i = bpp; i < n; ++i)
+      cur[i] = static_cast<std::uint8_t>(cur[i] + (cur[i - bpp] + prev[i]) / 2);
+    return true;
+  case 4:
+    for (std::size_t i = 0; i < m; ++i)
+      cur[i] = static_cast<std::uint8_t>(cur[i] + prev[i]);
+    for (std::size_t i = bpp; i < n; ++i) {
+      const int a = cur[i - bpp], b = prev[i], c = prev[i - bpp];
+      const int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+      cur[i] = static_cast<std::uint8_t>(cur[i] + (pa <= pb && pa <= pc ? a : pb <= pc ? b : c));
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief write a PNG chunk
+ *
+ * @param[in,out] out binary stream
+ * @param[in] type chunk type
+ * @param[in] data chunk data
+ */
+inline void write_png_chunk(std::ostream &out, const char (&type)[5], std::span<const std::byte> data) {
+  std::array<std::byte, 8> head;
+  const auto size = static_cast<std::uint32_t>(data.size());
+  for (int i = 0; i < 4; ++i) {
+    head[i]     = static_cast<std::byte>(size >> (24 - 8 * i));
+    head[4 + i] = static_cast<std::byte>(type[i]);
+  }
+  const std::uint32_t crc = crc32(data, crc32(std::span(head).subspan(4)));
+  std::array<std::byte, 4> tail;
+  for (int i = 0; i < 4; ++i)
+    tail[i] = static_cast<std::byte>(crc >> (24 - 8 * i));
+  out.write(reinterpret_cast<const char *>(head.data()), 8);
+  out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  out.write(reinterpret_cast<const char *>(tail.data()), 4);
+}
+
+/**
+ * @brief write an image as a PNG file
+ *
+ * Bands of rows are filtered and compressed on the pool, each into an
+ * independent piece of the zlib stream that ends on a byte boundary, and
+ * written in order as IDAT chunks. A few bands per participant are in
+ * memory at a time. The pieces cost a little size against one serial
+ * stream, the window restarts at each band.
+ *
+ * @param[in,out] out binary stream
+ * @param[in] img image or view, not empty
+ * @param[in] level 0 to store, 1 fastest to 9 smallest
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if img is empty, wider or taller than 2^31 - 1 or level is not in [0, 9]
+ * @exception std::runtime_error if the stream fails
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void write_png(std::ostream &out, const Img &img, int level = 6, thread_pool &pool = thread_pool::shared()) {
+  using pixel = pixel_t<Img>;
+  using file  = png_pixel_t<pixel>;
+  using sample = typename file::sample_type;
+  const auto v          = img.view();
+  const std::size_t w   = v.get_width();
+  const std::size_t h   = v.get_height();
+  const std::size_t row = w * sizeof(file);
+  if (v.empty())
+    throw std::invalid_argument("image is empty");
+  // IHDR holds 31 bit sizes
+  if (w > 0x7fffffff || h > 0x7fffffff)
+    throw std::invalid_argument("image is too large for PNG");
+  if (level < 0 || level > 9)
+    throw std::invalid_argument("level must be in [0, 9]");
+
+  constexpr std::array<unsigned char, 8> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  out.write(reinterpret_cast<const char *>(signature.data()), 8);
+  std::array<std::byte, 13> ihdr{};
+  for (int i = 0; i < 4; ++i) {
+    ihdr[i]     = static_cast<std::byte>(w >> (24 - 8 * i));
+    ihdr[4 + i] = static_cast<std::byte>(h >> (24 - 8 * i));
+  }
+  ihdr[8] = static_cast<std::byte>(sizeof(sample) * 8);
+  ihdr[9] = static_cast<std::byte>((true_color<file> ? 2 : 0) | (alpha_color<file> ? 4 : 0));
+  write_png_chunk(out, "IHDR", ihdr);
+  write_png_chunk(out, "sRGB", std::array<std::byte, 1>{});
+
+  // rows of file pixels in PNG byte order
+  const auto load = [&v, w](std::size_t y, std::vector<file> &dst) {
+    if constexpr (row_major_view<decltype(v)>)
+      convert_pixels(std::span<const pixel>(v.row(y), w), std::span(dst));
+    else
+      for (std::size_t x = 0; x < w; ++x)
+        dst[x] = convert_pixel<file>(v(x, y));
+    if constexpr (sizeof(sample) == 2 && std::endian::native == std::endian::little)
+      swap_byte_order(std::span(reinterpret_cast<sample *>(dst.data()), w * simd::channels_v<file>));
+  };
+  const std::size_t band_rows = std::max<std::size_t>(1, (std::size_t{256} << 10) / (row + 1));
+  const std::size_t bands     = (h + band_rows - 1) / band_rows;
+  const std::size_t batch     = pool.size() * 4;
+  std::vector<std::vector<std::byte>> pieces(std::min(batch, bands));
+  std::vector<std::uint32_t> checks(pieces.size());
+  std::uint32_t adler = 1;
+  for (std::size_t first = 0; first < bands; first += batch) {
+    const std::size_t count = std::min(batch, bands - first);
+    pool.parallel_for(count, 1, [&](std::size_t begin, std::size_t end) {
+      std::vector<file> prev(w), cur(w);
+      std::vector<std::byte> filtered;
+      for (std::size_t b = begin; b < end; ++b) {
+        const std::size_t y0 = (first + b) * band_rows, y1 = std::min(h, y0 + band_rows);
+        filtered.resize((row + 1) * (y1 - y0));
+        if (y0 == 0)
+          std::fill(prev.begin(), prev.end(), file{});
+        else
+          load(y0 - 1, prev);
+        for (std::size_t y = y0; y < y1; ++y) {
+          load(y, cur);
+          filter_png_row(std::span(reinterpret_cast<const std::uint8_t *>(cur.data()), row), reinterpret_cast<const std::uint8_t *>(prev.data()), sizeof(file),
+                         reinterpret_cast<std::uint8_t *>(filtered.data() + (row + 1) * (y - y0)), level != 0);
+          std::swap(prev, cur);
+        }
+        auto &piece = pieces[b];
+        piece.clear();
+        if (y0 == 0) {
+          const auto header = zlib_header(level);
+          piece.assign(header.begin(), header.end());
+        }
+        deflate_encoder(level).compress(filtered, y1 == h, piece);
+        checks[b] = adler32(filtered);
+      }
+    });
+    for (std::size_t b = 0; b < count; ++b) {
+      const std::size_t rows = std::min(h, (first + b + 1) * band_rows) - (first + b) * band_rows;
+      adler                  = adler32_combine(adler, checks[b], (row + 1) * rows);
+      write_png_chunk(out, "IDAT", pieces[b]);
+    }
+  }
+  std::array<std::byte, 4> trailer;
+  for (int i = 0; i < 4; ++i)
+    trailer[i] = static_cast<std::byte>(adler >> (24 - 8 * i));
+  write_png_chunk(out, "IDAT", trailer);
+  write_png_chunk(out, "IEND", {});
+  if (!out)
+    throw std::runtime_error("cannot write PNG data");
+}
+
+/**
+ * @brief save an image as a PNG file
+ *
+ * @param[in] path file, overwritten
+ * @param[in] img image or view, not empty
+ * @param[in] level 0 to store, 1 fastest to 9 smallest
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if img is empty or level is not in [0, 9]
+ * @exception std::runtime_error if the file cannot be written
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void save_png(const std::filesystem::path &path, const Img &img, int level = 6, thread_pool &pool = thread_pool::shared()) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("cannot open " + path.string());
+  write_png(out, img, level, pool);
+  out.close();
+  if (!out)
+    throw std::runtime_error("cannot write " + path.string());
+}
+
+/**
+ * @brief decode a PNG file
+ *
+ * Reads every color type and bit depth of non-interlaced files, palette
+ * transparency included. The samples are converted to P as by
+ * convert_pixels.
+ *
+ * @tparam P pixel type
+ * @param[in] bytes contents of the file
+ * @return Returns the image
+ *
+ * @exception std::runtime_error if the file is invalid, interlaced or fails a checksum
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> decode_png(std::span<const std::byte> bytes) {
+  const auto invalid = [] { return std::runtime_error("invalid PNG data"); };
+  const auto be32    = [](const std::byte *p) {
+    return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 | static_cast<std::uint32_t>(p[2]) << 8 | static_cast<std::uint32_t>(p[3]);
+  };
+  constexpr std::array<unsigned char, 8> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  if (bytes.size() < 8 || std::memcmp(bytes.data(), signature.data(), 8) != 0)
+    throw invalid();
+
+  std::size_t w = 0, h = 0;
+  unsigned depth = 0, type = 0;
+  std::vector<basic_rgba<std::uint8_t>> palette;
+  std::vector<std::byte> idat;
+  for (std::size_t pos = 8;;) {
+    if (bytes.size() - pos < 12)
+      throw invalid();
+    const std::size_t size = be32(bytes.data() + pos);
+    if (bytes.size() - pos - 12 < size)
+      throw invalid();
+    const auto chunk = bytes.subspan(pos + 4, size + 4);
+    const auto data  = chunk.subspan(4);
+    if (crc32(chunk) != be32(bytes.data() + pos + 8 + size))
+      throw std::runtime_error("PNG checksum mismatch");
+    const std::string_view name(reinterpret_cast<const char *>(chunk.data()), 4);
+    pos += size + 12;
+    if (w == 0 && name != "IHDR")
+      throw invalid();
+    if (name == "IHDR") {
+      if (size != 13 || w != 0)
+        throw invalid();
+      w     = be32(data.data());
+      h     = be32(data.data() + 4);
+      depth = static_cast<unsigned>(data[8]);
+      type  = static_cast<unsigned>(data[9]);
+      const bool valid_depth = type == 0 ? std::has_single_bit(depth) && depth <= 16 : type == 3 ? std::has_single_bit(depth) && depth <= 8 : (type == 2 || type == 4 || type == 6) && (depth == 8 || depth == 16);
+      if (w == 0 || h == 0 || !valid_depth || data[10] != std::byte{0} || data[11] != std::byte{0})
+        throw invalid();
+      if (data[12] != std::byte{0})
+        throw std::runtime_error("interlaced PNG is not supported");
+    } else if (name == "PLTE") {
+      if (size % 3 != 0 || size > 768)
+        throw invalid();
+      palette.resize(size / 3);
+      for (std::size_t i = 0; i < palette.size(); ++i)
+        palette[i] = {static_cast<std::uint8_t>(data[3 * i]), static_cast<std::uint8_t>(data[3 * i + 1]), static_cast<std::uint8_t>(data[3 * i + 2]), 255};
+    } else if (name == "tRNS" && type == 3) {
+      for (std::size_t i = 0; i < std::min(size, palette.size()); ++i)
+        palette[i].alpha = static_cast<std::uint8_t>(data[i]);
+    } else if (name == "IDAT") {
+      idat.insert(idat.end(), data.begin(), data.end());
+    } else if (name == "IEND") {
+      break;
+    } else if ((static_cast<unsigned>(chunk[0]) & 0x20) == 0) {
+      throw invalid(); // an unknown critical chunk
+    }
+  }
+  if (type == 3 && palette.empty())
+    throw invalid();
+
+  const std::size_t channels = std::array<std::size_t, 7>{1, 0, 3, 1, 2, 0, 4}[type];
+  const std::size_t bits     = channels * depth;
+  if (w > std::numeric_limits<std::size_t>::max() / bits / h / 2)
+    throw invalid();
+  const std::size_t row = (w * bits + 7) / 8;
+  const std::size_t bpp = std::max<std::size_t>(1, bits / 8);
+  auto raw              = zlib_decompress(idat, (row + 1) * h);
+  if (raw.size() != (row + 1) * h)
+    throw invalid();
+
+  basic_image<P> img(w, h);
+  const auto v      = img.view();
+  auto *data        = reinterpret_cast<std::uint8_t *>(raw.data());
+  const auto decode = [&]<typename File>(std::type_identity<File>) {
+    std::vector<File> pixels(std::same_as<File, P> && depth >= 8 && type != 3 ? 0 : w);
+    std::vector<std::uint8_t> zeros(row);
+    const std::uint8_t *prev = zeros.data();
+    for (std::size_t y = 0; y < h; ++y) {
+      auto *cur           = data + (row + 1) * y + 1;
+      if (!unfilter_png_row(cur[-1], std::span(cur, row), prev, bpp))
+        throw invalid();
+      prev = cur;
+
+      File *dst = pixels.empty() ? reinterpret_cast<File *>(v.row(y)) : pixels.data();
+      if (depth >= 8 && type != 3) {
+        std::memcpy(dst, cur, row);
+        if constexpr (sizeof(typename File::sample_type) == 2 && std::endian::native == std::endian::little)
+          swap_byte_order(std::span(reinterpret_cast<std::uint16_t *>(dst), w * channels));
+      } else if constexpr (std::same_as<File, basic_rgba<std::uint8_t>> || std::same_as<File, basic_g<std::uint8_t>>) {
+        // palette indices and 1, 2 and 4-bit gray levels, the first pixel in the high bits
+        const unsigned mask = (1u << depth) - 1;
+        for (std::size_t x = 0; x < w; ++x) {
+          const unsigned value = cur[x * depth / 8] >> (8 - depth - x * depth % 8) & mask;
+          if constexpr (alpha_color<File>) {
+            if (value >= palette.size())
+              throw invalid();
+            dst[x] = palette[value];
+          } else {
+            dst[x] = File{static_cast<std::uint8_t>(value * 255 / mask)};
+          }
+        }
+      }
+      if (!pixels.empty())
+        convert_pixels(std::span<const File>(pixels), std::span(v.row(y), w));
+    }
+  };
+  if (type == 3) {
+    decode(std::type_identity<basic_rgba<std::uint8_t>>());
+  } else if (depth < 8) {
+    decode(std::type_identity<basic_g<std::uint8_t>>());
+  } else if (depth == 8) {
+    switch (type) {
+    case 0:
+      decode(std::type_identity<basic_g<std::uint8_t>>());
+      break;
+    case 2:
+      decode(std::type_identity<basic_rgb<std::uint8_t>>());
+      break;
+    case 4:
+      decode(std::type_identity<basic_ga<std::uint8_t>>());
+      break;
+    default:
+      decode(std::type_identity<basic_rgba<std::uint8_t>>());
+      break;
+    }
+  } else {
+    switch (type) {
+    case 0:
+      decode(std::type_identity<basic_g<std::uint16_t>>());
+      break;
+    case 2:
+      decode(std::type_identity<basic_rgb<std::uint16_t>>());
+      break;
+    case 4:
+      decode(std::type_identity<basic_ga<std::uint16_t>>());
+      break;
+    default:
+      decode(std::type_identity<basic_rgba<std::uint16_t>>());
+      break;
+    }
+  }
+  return img;
+}
+
+/**
+ * @brief load a PNG file
+ *
+ * @tparam P pixel type
+ * @param[in] path file
+ * @return Returns the image
+ *
+ * @exception std::system_error if the file cannot be read
+ * @exception std::runtime_error if the file is invalid, interlaced or fails a checksum
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> load_png(const std::filesystem::path &path) {
+  const mapped_file file(path);
+  return decode_png<P>(file.bytes());
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_PNG_HPP
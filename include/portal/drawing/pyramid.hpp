@@ -0,0 +1,490 @@
+/**
+ * @file pyramid.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief mip chains
+ * @version 0.1
+ * @date 2022-04-23
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_PYRAMID_HPP
+#define PORTAL_DRAWING_PYRAMID_HPP
+
+#include "../math/simd.hpp"
+#include "../thread_pool.hpp"
+#include "algorithm.hpp"
+#include "color.hpp"
+#include "image.hpp"
+#include "image_view.hpp"
+#include "pixel_format.hpp"
+#include "storage.hpp"
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief mean of a 2 x 2 block, the default filter of basic_image_pyramid
+ *
+ * Integer samples are rounded to nearest, the samples are averaged as
+ * they are encoded.
+ *
+ */
+struct box_reduce {
+  /**
+   * @brief reduce a block
+   *
+   * @tparam P pixel type
+   * @param[in] a top left
+   * @param[in] b top right
+   * @param[in] c bottom left
+   * @param[in] d bottom right
+   * @return Returns the mean
+   */
+  template <convertible_color P>
+  [[nodiscard]] P operator()(const P &a, const P &b, const P &c, const P &d) const noexcept {
+    using S = typename P::sample_type;
+    P res;
+    auto *r        = reinterpret_cast<S *>(&res);
+    const auto *pa = reinterpret_cast<const S *>(&a);
+    const auto *pb = reinterpret_cast<const S *>(&b);
+    const auto *pc = reinterpret_cast<const S *>(&c);
+    const auto *pd = reinterpret_cast<const S *>(&d);
+    for (std::size_t i = 0; i < simd::channels_v<P>; ++i) {
+      if constexpr (std::integral<S>)
+        r[i] = static_cast<S>((std::uint32_t{pa[i]} + pb[i] + pc[i] + pd[i] + 2) >> 2);
+      else
+        r[i] = static_cast<S>((static_cast<float>(pa[i]) + static_cast<float>(pb[i]) + static_cast<float>(pc[i]) + static_cast<float>(pd[i])) * 0.25f);
+    }
+    return res;
+  }
+};
+
+/**
+ * @brief mip chain in one allocation
+ *
+ * Level 0 is the image, each next level halves it, rounding up, down to
+ * 1 x 1: pixel (x, y) of level i + 1 reduces pixels 2x and 2x + 1 of rows
+ * 2y and 2y + 1 of level i, the last column or row repeated at odd sizes.
+ * Every source pixel has exactly one parent, so a changed rectangle only
+ * touches the halved rectangle of each next level.
+ *
+ * The levels are row_major with aligned rows, one after another in a
+ * single allocation. Writes to level 0 are announced with invalidate()
+ * and update() recomputes only those rectangles of the other levels.
+ *
+ * @code
+ * basic_image_pyramid<rgba8> mips(texture); // copies and builds
+ * draw(mips.level(0).subview(x, y, w, h));
+ * mips.invalidate(x, y, w, h);
+ * mips.update();
+ * @endcode
+ *
+ * @tparam T pixel type
+ * @tparam Allocator allocator, aligned_allocator or pool_allocator
+ */
+template <pixel_color T, typename Allocator = aligned_allocator<T>>
+class basic_image_pyramid {
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using image_type   = basic_image<T, Allocator>;
+
+public:
+  using value_type      = T;                             //!< @brief value type
+  using allocator_type  = Allocator;                     //!< @brief allocator type
+  using pointer         = T *;                           //!< @brief pointer
+  using const_pointer   = const T *;                     //!< @brief const pointer
+  using size_type       = std::size_t;                   //!< @brief size type
+  using view_type       = basic_image_view<T>;           //!< @brief view type of a level
+  using const_view_type = basic_image_view<const T>;     //!< @brief read-only view type of a level
+
+  /**
+   * @brief row alignment in bytes
+   *
+   */
+  static constexpr size_type alignment = image_type::alignment;
+
+  /**
+   * @brief number of levels of a full chain
+   *
+   * @param[in] width width of level 0
+   * @param[in] height height of level 0
+   * @return Returns the levels down to 1 x 1, 0 for an empty size
+   */
+  [[nodiscard]] static constexpr size_type full_levels(size_type width, size_type height) noexcept {
+    return width == 0 || height == 0 ? 0 : static_cast<size_type>(std::bit_width(std::max(width, height) - 1)) + 1;
+  }
+
+  /**
+   * @brief default constructor, no levels
+   *
+   */
+  basic_image_pyramid() = default;
+
+  /**
+   * @brief constructor, the pixels are default-initialized
+   *
+   * @param[in] width width of level 0
+   * @param[in] height height of level 0
+   * @param[in] levels levels, clamped to full_levels(width, height), 0 for all
+   * @param[in] alloc allocator
+   */
+  basic_image_pyramid(size_type width, size_type height, size_type levels = 0, const allocator_type &alloc = allocator_type())
+      : m_alloc(alloc) {
+    allocate(width, height, levels == 0 ? full_levels(width, height) : std::min(levels, full_levels(width, height)));
+  }
+
+  /**
+   * @brief constructor, a full chain of an image
+   *
+   * @param[in] img image or view of pixels of type T
+   * @param[in] pool pool
+   */
+  template <image_like Img>
+  requires std::same_as<pixel_t<Img>, T> && convertible_color<T>
+  explicit basic_image_pyramid(const Img &img, thread_pool &pool = thread_pool::shared())
+      : basic_image_pyramid(img.view().get_width(), img.view().get_height()) {
+    if (m_levels.empty())
+      return;
+    const auto src = img.view();
+    const auto dst = level(0);
+    pool.parallel_for(dst.get_height(), 0, [&](size_type first, size_type last) {
+      for (size_type y = first; y < last; ++y) {
+        if constexpr (row_major_view<decltype(src)>)
+          std::copy_n(src.row(y), dst.get_width(), dst.row(y));
+        else
+          for (size_type x = 0; x < dst.get_width(); ++x)
+            dst(x, y) = src(x, y);
+      }
+    });
+    build(box_reduce(), pool);
+  }
+
+  /**
+   * @brief copy constructor
+   *
+   * @param[in] other pyramid
+   */
+  basic_image_pyramid(const basic_image_pyramid &other)
+      : m_alloc(alloc_traits::select_on_container_copy_construction(other.m_alloc)) {
+    allocate(other.get_width(), other.get_height(), other.levels());
+    std::copy_n(other.m_buf, m_size, m_buf);
+    m_dirty = other.m_dirty;
+  }
+
+  /**
+   * @brief move constructor
+   *
+   * @param[in] other pyramid, left without levels
+   */
+  basic_image_pyramid(basic_image_pyramid &&other) noexcept
+      : m_levels(std::move(other.m_levels)), m_dirty(std::move(other.m_dirty)), m_buf(std::exchange(other.m_buf, nullptr)),
+        m_size(std::exchange(other.m_size, 0)), m_alloc(other.m_alloc) {
+    other.m_levels.clear();
+    other.m_dirty.clear();
+  }
+
+  /**
+   * @brief destructor
+   *
+   */
+  ~basic_image_pyramid() {
+    release();
+  }
+
+  /**
+   * @brief copy assignment
+   *
+   * @param[in] other pyramid
+   * @return *this
+   */
+  basic_image_pyramid &operator=(const basic_image_pyramid &other) {
+    if (this != &other)
+      *this = basic_image_pyramid(other);
+    return *this;
+  }
+
+  /**
+   * @brief move assignment
+   *
+   * @param[in] other pyramid, left without levels
+   * @return *this
+   */
+  basic_image_pyramid &operator=(basic_image_pyramid &&other) noexcept {
+    if (this != &other) {
+      release();
+      m_levels = std::exchange(other.m_levels, {});
+      m_dirty  = std::exchange(other.m_dirty, {});
+      m_buf    = std::exchange(other.m_buf, nullptr);
+      m_size   = std::exchange(other.m_size, 0);
+      m_alloc  = other.m_alloc;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief number of levels
+   *
+   * @return Returns the number of levels
+   */
+  [[nodiscard]] size_type levels() const noexcept {
+    return m_levels.size();
+  }
+
+  /**
+   * @brief width of level 0
+   *
+   * @return Returns the width, 0 without levels
+   */
+  [[nodiscard]] size_type get_width() const noexcept {
+    return m_levels.empty() ? 0 : m_levels[0].width;
+  }
+
+  /**
+   * @brief height of level 0
+   *
+   * @return Returns the height, 0 without levels
+   */
+  [[nodiscard]] size_type get_height() const noexcept {
+    return m_levels.empty() ? 0 : m_levels[0].height;
+  }
+
+  /**
+   * @brief pixels of all levels
+   *
+   * @return Returns the first pixel of level 0, the levels follow with their padding
+   */
+  [[nodiscard]] pointer data() noexcept {
+    return m_buf;
+  }
+
+  /**
+   * @brief pixels of all levels
+   *
+   * @return Returns the first pixel of level 0, the levels follow with their padding
+   */
+  [[nodiscard]] const_pointer data() const noexcept {
+    return m_buf;
+  }
+
+  /**
+   * @brief level
+   *
+   * @param[in] i level, < levels()
+   * @return Returns the view of the level
+   *
+   * @exception std::out_of_range if i >= levels()
+   */
+  [[nodiscard]] view_type level(size_type i) {
+    const auto &l = m_levels.at(i);
+    return view_type(m_buf + l.offset, l.width, l.height, l.stride);
+  }
+
+  /**
+   * @brief level
+   *
+   * @param[in] i level, < levels()
+   * @return Returns the read-only view of the level
+   *
+   * @exception std::out_of_range if i >= levels()
+   */
+  [[nodiscard]] const_view_type level(size_type i) const {
+    const auto &l = m_levels.at(i);
+    return const_view_type(m_buf + l.offset, l.width, l.height, l.stride);
+  }
+
+  /**
+   * @brief announce a write to level 0
+   *
+   * The rectangle is clipped to level 0 and kept until update() or
+   * build(). Overlapping or touching rectangles are merged.
+   *
+   * @param[in] x left
+   * @param[in] y top
+   * @param[in] width width
+   * @param[in] height height
+   */
+  void invalidate(size_type x, size_type y, size_type width, size_type height) {
+    region r{std::min(x, get_width()), std::min(y, get_height()), 0, 0};
+    r.right  = std::min(get_width(), x + std::min(width, get_width()));
+    r.bottom = std::min(get_height(), y + std::min(height, get_height()));
+    if (r.left >= r.right || r.top >= r.bottom)
+      return;
+    // merge until nothing touches, a handful of rectangles at most
+    for (auto it = m_dirty.begin(); it != m_dirty.end();) {
+      if (it->left <= r.right && r.left <= it->right && it->top <= r.bottom && r.top <= it->bottom) {
+        r   = {std::min(r.left, it->left), std::min(r.top, it->top), std::max(r.right, it->right), std::max(r.bottom, it->bottom)};
+        *it = m_dirty.back();
+        m_dirty.pop_back();
+        it = m_dirty.begin();
+      } else {
+        ++it;
+      }
+    }
+    m_dirty.push_back(r);
+  }
+
+  /**
+   * @brief whether some write to level 0 is not yet propagated
+   *
+   * @return Returns true if update() has work
+   */
+  [[nodiscard]] bool dirty() const noexcept {
+    return !m_dirty.empty();
+  }
+
+  /**
+   * @brief recompute every level from level 0
+   *
+   * @tparam Reduce called as reduce(a, b, c, d) for the 2 x 2 block a b / c d, returns T
+   * @param[in] reduce filter, box_reduce runs with SSE2 for 8 bit rgba, bgra and gray
+   * @param[in] pool pool
+   */
+  template <typename Reduce = box_reduce>
+  void build(Reduce reduce = Reduce(), thread_pool &pool = thread_pool::shared()) {
+    for (size_type i = 1; i < levels(); ++i)
+      reduce_region(i, {0, 0, m_levels[i].width, m_levels[i].height}, reduce, pool);
+    m_dirty.clear();
+  }
+
+  /**
+   * @brief recompute the invalidated rectangles of the other levels
+   *
+   * Each rectangle is halved outward level by level; a change of a few
+   * pixels costs a few pixels per level.
+   *
+   * @tparam Reduce called as reduce(a, b, c, d) for the 2 x 2 block a b / c d, returns T
+   * @param[in] reduce filter, the one of build()
+   * @param[in] pool pool
+   */
+  template <typename Reduce = box_reduce>
+  void update(Reduce reduce = Reduce(), thread_pool &pool = thread_pool::shared()) {
+    for (size_type i = 1; i < levels(); ++i)
+      for (auto &r : m_dirty) {
+        r = {r.left / 2, r.top / 2, (r.right + 1) / 2, (r.bottom + 1) / 2};
+        reduce_region(i, r, reduce, pool);
+      }
+    m_dirty.clear();
+  }
+
+private:
+  struct level_info {
+    size_type offset = 0;
+    size_type width  = 0;
+    size_type height = 0;
+    size_type stride = 0;
+  };
+
+  // [left, right) x [top, bottom)
+  struct region {
+    size_type left   = 0;
+    size_type top    = 0;
+    size_type right  = 0;
+    size_type bottom = 0;
+  };
+
+  void allocate(size_type width, size_type height, size_type levels) {
+    size_type offset = 0;
+    for (size_type i = 0; i < levels; ++i) {
+      // a stride keeping rows aligned keeps the next level aligned too
+      const size_type stride = image_type::default_stride(width);
+      m_levels.push_back({offset, width, height, stride});
+      offset += stride * height;
+      width  = (width + 1) / 2;
+      height = (height + 1) / 2;
+    }
+    if (offset != 0) {
+      m_buf = alloc_traits::allocate(m_alloc, offset);
+      std::uninitialized_default_construct_n(m_buf, offset);
+      m_size = offset;
+    }
+  }
+
+  void release() noexcept {
+    if (m_buf != nullptr) {
+      std::destroy_n(m_buf, m_size);
+      alloc_traits::deallocate(m_alloc, m_buf, m_size);
+      m_buf = nullptr;
+    }
+    m_size = 0;
+    m_levels.clear();
+  }
+
+  template <typename Reduce>
+  void reduce_region(size_type i, const region &r, Reduce &reduce, thread_pool &pool) {
+    const auto src = std::as_const(*this).level(i - 1);
+    const auto dst = level(i);
+    // about 16 K pixels a chunk, small levels stay on the calling thread
+    const size_type grain = std::max<size_type>(1, (size_type{1} << 14) / (r.right - r.left));
+    pool.parallel_for(r.bottom - r.top, grain, [&](size_type first, size_type last) {
+      for (size_type y = r.top + first; y < r.top + last; ++y) {
+        const T *top    = src.row(2 * y);
+        const T *bottom = src.row(std::min(2 * y + 1, src.get_height() - 1));
+        reduce_row(top, bottom, dst.row(y), src.get_width(), r.left, r.right, reduce);
+      }
+    });
+  }
+
+  template <typename Reduce>
+  static void reduce_row(const T *top, const T *bottom, T *dst, size_type src_width, size_type first, size_type last, Reduce &reduce) {
+    size_type x = first;
+    // pairs inside the row, the odd last column is repeated below
+    const size_type pairs = std::min(last, src_width / 2);
+#if defined(PORTAL_SIMD_SSE2)
+    if constexpr (std::same_as<Reduce, box_reduce> && convertible_color<T>) {
+      if constexpr (std::same_as<typename T::sample_type, std::uint8_t> && simd::channels_v<T> == 4) {
+        // 4 pixels from 8: 16 bit sums of the rows, then of the neighbors
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi16(2);
+        const auto pair    = [zero](__m128i a, __m128i b) {
+          const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+          const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+          return _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)), _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+        };
+        for (; x + 4 <= pairs; x += 4) {
+          const auto *t   = reinterpret_cast<const __m128i *>(top + 2 * x);
+          const auto *b   = reinterpret_cast<const __m128i *>(bottom + 2 * x);
+          const __m128i l = _mm_srli_epi16(_mm_add_epi16(pair(_mm_loadu_si128(t), _mm_loadu_si128(b)), half), 2);
+          const __m128i r = _mm_srli_epi16(_mm_add_epi16(pair(_mm_loadu_si128(t + 1), _mm_loadu_si128(b + 1)), half), 2);
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(l, r));
+        }
+      } else if constexpr (std::same_as<typename T::sample_type, std::uint8_t> && simd::channels_v<T> == 1) {
+        // 16 pixels from 32: neighbors summed by a multiply-add with ones
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i half = _mm_set1_epi32(2);
+        const auto pair    = [&](__m128i a, __m128i b) {
+          const __m128i lo = _mm_madd_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)), ones);
+          const __m128i hi = _mm_madd_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)), ones);
+          return _mm_packs_epi32(_mm_srli_epi32(_mm_add_epi32(lo, half), 2), _mm_srli_epi32(_mm_add_epi32(hi, half), 2));
+        };
+        for (; x + 16 <= pairs; x += 16) {
+          const auto *t = reinterpret_cast<const __m128i *>(top + 2 * x);
+          const auto *b = reinterpret_cast<const __m128i *>(bottom + 2 * x);
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                           _mm_packus_epi16(pair(_mm_loadu_si128(t), _mm_loadu_si128(b)), pair(_mm_loadu_si128(t + 1), _mm_loadu_si128(b + 1))));
+        }
+      }
+    }
+#endif
+    for (; x < last; ++x) {
+      const size_type l = 2 * x, r = std::min(2 * x + 1, src_width - 1);
+      dst[x]            = reduce(top[l], top[r], bottom[l], bottom[r]);
+    }
+  }
+
+  std::vector<level_info> m_levels;
+  std::vector<region> m_dirty;
+  pointer m_buf  = nullptr;
+  size_type m_size = 0;
+  [[no_unique_address]] allocator_type m_alloc;
+};
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_PYRAMID_HPP
@@ -0,0 +1,253 @@
+/**
+ * @file qoi.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief QOI image files
+ * @version 0.1
+ * @date 2022-04-20
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_QOI_HPP
+#define PORTAL_DRAWING_QOI_HPP
+
+#include "../mapped_file.hpp"
+#include "algorithm.hpp"
+#include "image.hpp"
+#include "pixel_format.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief write an image as a QOI file
+ *
+ * The "Quite OK Image" format: every pixel is a run, an index into the
+ * 64 recently seen colors, a small difference to the previous pixel or
+ * the color itself. A single pass of byte-wise work, several times
+ * faster than DEFLATE at a somewhat larger size.
+ *
+ * @param[in,out] out binary stream
+ * @param[in] img image or view, not empty
+ *
+ * @exception std::invalid_argument if img is empty, wider or taller than 2^32 - 1
+ * @exception std::runtime_error if the stream fails
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void write_qoi(std::ostream &out, const Img &img) {
+  using pixel         = pixel_t<Img>;
+  using rgba8         = basic_rgba<std::uint8_t>;
+  const auto v        = img.view();
+  const std::size_t w = v.get_width();
+  const std::size_t h = v.get_height();
+  if (v.empty())
+    throw std::invalid_argument("image is empty");
+  if (w > 0xffffffff || h > 0xffffffff)
+    throw std::invalid_argument("image is too large for QOI");
+
+  std::vector<std::uint8_t> buf(14);
+  std::memcpy(buf.data(), "qoif", 4);
+  for (int i = 0; i < 4; ++i) {
+    buf[4 + i] = static_cast<std::uint8_t>(w >> (24 - 8 * i));
+    buf[8 + i] = static_cast<std::uint8_t>(h >> (24 - 8 * i));
+  }
+  buf[12] = alpha_color<pixel> ? 4 : 3;
+  buf[13] = 0; // sRGB with linear alpha
+
+  std::array<rgba8, 64> index{};
+  std::vector<rgba8> row(w);
+  rgba8 prev{0, 0, 0, 255};
+  unsigned run = 0;
+  for (std::size_t y = 0; y < h; ++y) {
+    if constexpr (row_major_view<decltype(v)>)
+      convert_pixels(std::span<const pixel>(v.row(y), w), std::span(row));
+    else
+      for (std::size_t x = 0; x < w; ++x)
+        row[x] = convert_pixel<rgba8>(v(x, y));
+    const std::size_t used = buf.size();
+    buf.resize(used + w * 5 + 1);
+    auto *dst = buf.data() + used;
+    for (const auto &px : row) {
+      if (px == prev) {
+        if (++run == 62) {
+          *dst++ = static_cast<std::uint8_t>(0xc0 | (run - 1));
+          run    = 0;
+        }
+        continue;
+      }
+      if (run != 0) {
+        *dst++ = static_cast<std::uint8_t>(0xc0 | (run - 1));
+        run    = 0;
+      }
+      const unsigned hash = (px.red * 3u + px.green * 5u + px.blue * 7u + px.alpha * 11u) % 64;
+      if (index[hash] == px) {
+        *dst++ = static_cast<std::uint8_t>(hash);
+      } else if (index[hash] = px; px.alpha == prev.alpha) {
+        const auto dr = static_cast<std::int8_t>(px.red - prev.red);
+        const auto dg = static_cast<std::int8_t>(px.green - prev.green);
+        const auto db = static_cast<std::int8_t>(px.blue - prev.blue);
+        const int rg = dr - dg, bg = db - dg;
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+          *dst++ = static_cast<std::uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        } else if (dg >= -32 && dg <= 31 && rg >= -8 && rg <= 7 && bg >= -8 && bg <= 7) {
+          *dst++ = static_cast<std::uint8_t>(0x80 | (dg + 32));
+          *dst++ = static_cast<std::uint8_t>((rg + 8) << 4 | (bg + 8));
+        } else {
+          *dst++ = 0xfe;
+          *dst++ = px.red;
+          *dst++ = px.green;
+          *dst++ = px.blue;
+        }
+      } else {
+        *dst++ = 0xff;
+        *dst++ = px.red;
+        *dst++ = px.green;
+        *dst++ = px.blue;
+        *dst++ = px.alpha;
+      }
+      prev = px;
+    }
+    buf.resize(static_cast<std::size_t>(dst - buf.data()));
+    if (buf.size() >= (std::size_t{64} << 10)) {
+      out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+      buf.clear();
+    }
+  }
+  if (run != 0)
+    buf.push_back(static_cast<std::uint8_t>(0xc0 | (run - 1)));
+  buf.insert(buf.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+  if (!out)
+    throw std::runtime_error("cannot write QOI data");
+}
+
+/**
+ * @brief save an image as a QOI file
+ *
+ * @param[in] path file, overwritten
+ * @param[in] img image or view, not empty
+ *
+ * @exception std::invalid_argument if img is empty
+ * @exception std::runtime_error if the file cannot be written
+ */
+template <image_like Img>
+requires convertible_color<pixel_t<Img>>
+void save_qoi(const std::filesystem::path &path, const Img &img) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("cannot open " + path.string());
+  write_qoi(out, img);
+  out.close();
+  if (!out)
+    throw std::runtime_error("cannot write " + path.string());
+}
+
+/**
+ * @brief decode a QOI file
+ *
+ * The samples are converted to P as by convert_pixels.
+ *
+ * @tparam P pixel type
+ * @param[in] bytes contents of the file
+ * @return Returns the image
+ *
+ * @exception std::runtime_error if the file is invalid
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> decode_qoi(std::span<const std::byte> bytes) {
+  using rgba8        = basic_rgba<std::uint8_t>;
+  const auto invalid = [] { return std::runtime_error("invalid QOI data"); };
+  const auto *src    = reinterpret_cast<const std::uint8_t *>(bytes.data());
+  const auto be32    = [](const std::uint8_t *p) {
+    return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 | static_cast<std::uint32_t>(p[2]) << 8 | static_cast<std::uint32_t>(p[3]);
+  };
+  if (bytes.size() < 22 || std::memcmp(src, "qoif", 4) != 0)
+    throw invalid();
+  const std::size_t w = be32(src + 4);
+  const std::size_t h = be32(src + 8);
+  if (w == 0 || h == 0 || src[12] < 3 || src[12] > 4 || src[13] > 1)
+    throw invalid();
+  // a pixel takes at least 1/62 of a byte
+  if (w > std::numeric_limits<std::size_t>::max() / h || w * h / 62 > bytes.size())
+    throw invalid();
+
+  basic_image<P> img(w, h);
+  const auto v      = img.view();
+  const auto *end   = src + bytes.size() - 8;
+  const auto *pos   = src + 14;
+  std::array<rgba8, 64> index{};
+  std::vector<rgba8> row(w);
+  rgba8 px{0, 0, 0, 255};
+  unsigned run = 0;
+  for (std::size_t y = 0; y < h; ++y) {
+    for (auto &dst : row) {
+      if (run != 0) {
+        --run;
+        dst = px;
+        continue;
+      }
+      if (pos >= end)
+        throw invalid();
+      const unsigned op = *pos++;
+      if (op == 0xfe || op == 0xff) {
+        if (end - pos < (op == 0xff ? 4 : 3))
+          throw invalid();
+        px.red   = pos[0];
+        px.green = pos[1];
+        px.blue  = pos[2];
+        if (op == 0xff)
+          px.alpha = pos[3];
+        pos += op == 0xff ? 4 : 3;
+      } else if (op >> 6 == 0) {
+        px = index[op];
+      } else if (op >> 6 == 1) {
+        px.red   = static_cast<std::uint8_t>(px.red + ((op >> 4) & 3) - 2);
+        px.green = static_cast<std::uint8_t>(px.green + ((op >> 2) & 3) - 2);
+        px.blue  = static_cast<std::uint8_t>(px.blue + (op & 3) - 2);
+      } else if (op >> 6 == 2) {
+        if (pos == end)
+          throw invalid();
+        const int dg = static_cast<int>(op & 0x3f) - 32, next = *pos++;
+        px.red       = static_cast<std::uint8_t>(px.red + dg + (next >> 4) - 8);
+        px.green     = static_cast<std::uint8_t>(px.green + dg);
+        px.blue      = static_cast<std::uint8_t>(px.blue + dg + (next & 15) - 8);
+      } else {
+        run = op & 0x3f;
+      }
+      index[(px.red * 3u + px.green * 5u + px.blue * 7u + px.alpha * 11u) % 64] = px;
+      dst                                                                     = px;
+    }
+    convert_pixels(std::span<const rgba8>(row), std::span(v.row(y), w));
+  }
+  return img;
+}
+
+/**
+ * @brief load a QOI file
+ *
+ * @tparam P pixel type
+ * @param[in] path file
+ * @return Returns the image
+ *
+ * @exception std::system_error if the file cannot be read
+ * @exception std::runtime_error if the file is invalid
+ */
+template <convertible_color P>
+[[nodiscard]] basic_image<P> load_qoi(const std::filesystem::path &path) {
+  const mapped_file file(path);
+  return decode_qoi<P>(file.bytes());
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_QOI_HPP
@@ -0,0 +1,550 @@
+/**
+ * @file resample.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief image resampling
+ * @version 0.1
+ * @date 2022-04-22
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_RESAMPLE_HPP
+#define PORTAL_DRAWING_RESAMPLE_HPP
+
+#include "../math/simd.hpp"
+#include "../thread_pool.hpp"
+#include "algorithm.hpp"
+#include "color.hpp"
+#include "image.hpp"
+#include "parallel.hpp"
+#include "pixel_format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace portal::drawing {
+/**
+ * @brief reconstruction filter of a resampling
+ *
+ */
+enum class resample_filter {
+  nearest,  //!< @brief the pixel under the center
+  bilinear, //!< @brief triangle, radius 1
+  bicubic,  //!< @brief Catmull-Rom spline (Keys, a = -0.5), radius 2
+  lanczos3, //!< @brief sinc windowed by sinc, radius 3
+  area,     //!< @brief mean of the source covered by the pixel, weighted by the covered area
+};
+
+/**
+ * @brief radius of a filter
+ *
+ * @param[in] filter filter
+ * @return Returns the radius in source pixels when upscaling
+ */
+[[nodiscard]] constexpr float resample_support(resample_filter filter) noexcept {
+  switch (filter) {
+  case resample_filter::bilinear:
+    return 1.0f;
+  case resample_filter::bicubic:
+    return 2.0f;
+  case resample_filter::lanczos3:
+    return 3.0f;
+  default:
+    return 0.5f;
+  }
+}
+
+/**
+ * @brief weight of a filter
+ *
+ * @param[in] filter filter
+ * @param[in] x distance to the center
+ * @return Returns the unnormalized weight, 0 outside of the support
+ */
+[[nodiscard]] inline float resample_weight(resample_filter filter, float x) noexcept {
+  x = std::abs(x);
+  switch (filter) {
+  case resample_filter::bilinear:
+    return x < 1.0f ? 1.0f - x : 0.0f;
+  case resample_filter::bicubic:
+    if (x < 1.0f)
+      return (1.5f * x - 2.5f) * x * x + 1.0f;
+    return x < 2.0f ? ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f : 0.0f;
+  case resample_filter::lanczos3: {
+    if (x < 1e-6f)
+      return 1.0f;
+    if (x >= 3.0f)
+      return 0.0f;
+    const float px = std::numbers::pi_v<float> * x;
+    return 3.0f * std::sin(px) * std::sin(px / 3.0f) / (px * px);
+  }
+  default:
+    return x <= 0.5f ? 1.0f : 0.0f;
+  }
+}
+
+/**
+ * @brief weights of a resampling along one axis
+ *
+ * Each destination pixel i is a weighted sum of taps() consecutive
+ * source pixels from first(i). The filter is stretched by the scale when
+ * downscaling, so every source pixel contributes; windows are clipped
+ * at the edges and renormalized. Independent of the pixels, one table
+ * serves every row (or column) of every image of the same sizes.
+ *
+ */
+class resample_coefficients {
+public:
+  static constexpr int fixed_bits = 14; //!< @brief fraction bits of fixed_weights
+
+  /**
+   * @brief Construct a new resample coefficients object
+   *
+   * @param[in] source source size
+   * @param[in] size destination size
+   * @param[in] filter filter
+   *
+   * @exception std::invalid_argument if source is 0 and size is not
+   */
+  resample_coefficients(std::size_t source, std::size_t size, resample_filter filter)
+      : m_source(source), m_first(size) {
+    if (size == 0)
+      return;
+    if (source == 0)
+      throw std::invalid_argument("cannot resample an empty image");
+    const double ratio = static_cast<double>(source) / static_cast<double>(size);
+    const double scale = std::max(ratio, 1.0);
+    const double reach = filter == resample_filter::nearest ? 0.0 : filter == resample_filter::area ? ratio / 2 + 1 : resample_support(filter) * scale;
+    m_taps             = std::min<std::size_t>(source, filter == resample_filter::nearest ? 1 : static_cast<std::size_t>(std::ceil(reach)) * 2 + 1);
+    m_weights.assign(size * m_taps, 0.0f);
+    m_fixed.assign(size * m_taps + 1, 0); // a pair can be read at the last tap
+
+    std::vector<double> window;
+    for (std::size_t i = 0; i < size; ++i) {
+      const double center = (static_cast<double>(i) + 0.5) * ratio;
+      std::size_t lo, hi;
+      window.clear();
+      if (filter == resample_filter::nearest) {
+        lo = std::min(static_cast<std::size_t>(center), source - 1);
+        hi = lo + 1;
+        window.push_back(1.0);
+      } else if (filter == resample_filter::area) {
+        // the footprint [i ratio, (i + 1) ratio) against each [k, k + 1)
+        const double a = static_cast<double>(i) * ratio, b = a + ratio;
+        lo             = std::min(static_cast<std::size_t>(a), source - 1);
+        hi             = std::min(static_cast<std::size_t>(std::ceil(b)), source);
+        for (std::size_t k = lo; k < hi; ++k)
+          window.push_back(std::max(0.0, std::min(b, static_cast<double>(k + 1)) - std::max(a, static_cast<double>(k))));
+      } else {
+        lo = static_cast<std::size_t>(std::max(0.0, std::floor(center - reach + 0.5)));
+        hi = static_cast<std::size_t>(std::clamp(std::floor(center + reach + 0.5), 1.0, static_cast<double>(source)));
+        lo = std::min(lo, hi - 1);
+        for (std::size_t k = lo; k < hi; ++k)
+          window.push_back(resample_weight(filter, static_cast<float>((static_cast<double>(k) + 0.5 - center) / scale)));
+      }
+      double sum = 0;
+      for (const double w : window)
+        sum += w;
+      if (sum == 0.0) {
+        window.assign(window.size(), 1.0);
+        sum = static_cast<double>(window.size());
+      }
+
+      // the window placed in taps() pixels that stay in the source
+      hi          = std::min(hi, lo + m_taps);
+      m_first[i]  = std::min(lo, source - m_taps);
+      float *dst  = m_weights.data() + i * m_taps + (lo - m_first[i]);
+      auto *fixed = m_fixed.data() + i * m_taps + (lo - m_first[i]);
+      int total = 0, largest = 0;
+      for (std::size_t k = 0; k < hi - lo; ++k) {
+        dst[k]   = static_cast<float>(window[k] / sum);
+        fixed[k] = static_cast<std::int16_t>(std::lround(window[k] / sum * (1 << fixed_bits)));
+        total += fixed[k];
+        if (fixed[k] > fixed[largest])
+          largest = static_cast<int>(k);
+      }
+      // exact unity gain, flat areas stay flat
+      fixed[largest] = static_cast<std::int16_t>(fixed[largest] + (1 << fixed_bits) - total);
+    }
+  }
+
+  /**
+   * @brief source size
+   *
+   * @return Returns the size
+   */
+  [[nodiscard]] std::size_t source_size() const noexcept {
+    return m_source;
+  }
+
+  /**
+   * @brief destination size
+   *
+   * @return Returns the size
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_first.size();
+  }
+
+  /**
+   * @brief source pixels per destination pixel
+   *
+   * @return Returns the number of taps
+   */
+  [[nodiscard]] std::size_t taps() const noexcept {
+    return m_taps;
+  }
+
+  /**
+   * @brief first source pixel of a destination pixel
+   *
+   * @param[in] i destination pixel, < size()
+   * @return Returns the index, first(i) + taps() <= source_size()
+   */
+  [[nodiscard]] std::size_t first(std::size_t i) const noexcept {
+    return m_first[i];
+  }
+
+  /**
+   * @brief weights of a destination pixel
+   *
+   * @param[in] i destination pixel, < size()
+   * @return Returns taps() weights that sum to 1
+   */
+  [[nodiscard]] std::span<const float> weights(std::size_t i) const noexcept {
+    return std::span(m_weights).subspan(i * m_taps, m_taps);
+  }
+
+  /**
+   * @brief weights of a destination pixel in fixed point
+   *
+   * @param[in] i destination pixel, < size()
+   * @return Returns taps() weights with fixed_bits fraction bits that sum to exactly 1 << fixed_bits
+   */
+  [[nodiscard]] std::span<const std::int16_t> fixed_weights(std::size_t i) const noexcept {
+    return std::span(m_fixed).subspan(i * m_taps, m_taps);
+  }
+
+private:
+  std::size_t m_source = 0;
+  std::size_t m_taps   = 0;
+  std::vector<std::size_t> m_first;
+  std::vector<float> m_weights;
+  std::vector<std::int16_t> m_fixed;
+};
+
+/**
+ * @brief resampling between two image sizes
+ *
+ * Separable: rows are resampled to the destination width into a
+ * temporary image of the source height, then its columns to the
+ * destination height, one row of weights at a time along whole rows.
+ * Both passes run in parallel over rows. The weights are computed once
+ * per resampler, keep one to resize many images of the same sizes.
+ *
+ * Formats with 8 bit samples are resampled in fixed point: 14 bit
+ * weights, SSE2 multiply-adds of paired taps, and 16 bit rows between
+ * the passes that keep 6 more bits and the overshoot of bicubic and
+ * Lanczos. Other formats are resampled in float. The samples are
+ * resampled as they are encoded, for linear light convert to a linear
+ * format first; colors with alpha should be premultiplied.
+ *
+ * @code
+ * const resampler thumbnail(4000, 3000, 400, 300, resample_filter::area);
+ * for (const auto &photo : photos)
+ *   thumbnail(photo, thumbnails.emplace_back(400, 300));
+ * @endcode
+ */
+class resampler {
+public:
+  static constexpr std::size_t cached_count = 4; //!< @brief resamplers each thread keeps for cached()
+
+  /**
+   * @brief Construct a new resampler object
+   *
+   * @param[in] src_width source width
+   * @param[in] src_height source height
+   * @param[in] dst_width destination width
+   * @param[in] dst_height destination height
+   * @param[in] filter filter
+   *
+   * @exception std::invalid_argument if the source is empty and the destination is not
+   */
+  resampler(std::size_t src_width, std::size_t src_height, std::size_t dst_width, std::size_t dst_height, resample_filter filter = resample_filter::bicubic)
+      : m_horizontal(src_width, dst_width, filter), m_vertical(src_height, dst_height, filter) {
+    if (dst_width * dst_height != 0 && src_width * src_height == 0)
+      throw std::invalid_argument("cannot resample an empty image");
+  }
+
+  /**
+   * @brief resampler of the calling thread
+   *
+   * Each thread keeps the last cached_count resamplers it asked for, a
+   * repeated size pair and filter reuses their tables.
+   *
+   * @param[in] src_width source width
+   * @param[in] src_height source height
+   * @param[in] dst_width destination width
+   * @param[in] dst_height destination height
+   * @param[in] filter filter
+   * @return Returns the resampler, valid after it leaves the cache
+   *
+   * @exception std::invalid_argument if the source is empty and the destination is not
+   */
+  [[nodiscard]] static std::shared_ptr<const resampler> cached(std::size_t src_width, std::size_t src_height, std::size_t dst_width, std::size_t dst_height, resample_filter filter = resample_filter::bicubic) {
+    struct entry {
+      std::size_t sizes[4];
+      resample_filter filter;
+      std::shared_ptr<const resampler> value;
+    };
+    thread_local std::vector<entry> cache;
+    const std::size_t sizes[] = {src_width, src_height, dst_width, dst_height};
+    const auto it             = std::find_if(cache.begin(), cache.end(), [&](const entry &e) {
+      return e.filter == filter && std::ranges::equal(sizes, e.sizes);
+    });
+    if (it != cache.end()) {
+      // most recent first
+      std::rotate(cache.begin(), it, it + 1);
+      return cache.front().value;
+    }
+    auto res = std::make_shared<const resampler>(src_width, src_height, dst_width, dst_height, filter);
+    if (cache.size() == cached_count)
+      cache.pop_back();
+    cache.insert(cache.begin(), entry{{src_width, src_height, dst_width, dst_height}, filter, res});
+    return res;
+  }
+
+  /**
+   * @brief weights along rows
+   *
+   * @return Returns the coefficients
+   */
+  [[nodiscard]] const resample_coefficients &horizontal() const noexcept {
+    return m_horizontal;
+  }
+
+  /**
+   * @brief weights along columns
+   *
+   * @return Returns the coefficients
+   */
+  [[nodiscard]] const resample_coefficients &vertical() const noexcept {
+    return m_vertical;
+  }
+
+  /**
+   * @brief resample an image
+   *
+   * @param[in] src image or view of the source size
+   * @param[in,out] dst image or view of the destination size, not overlapping src
+   * @param[in] pool pool
+   *
+   * @exception std::invalid_argument if the sizes differ from those of the resampler
+   */
+  template <image_like Src, writable_image Dst>
+  requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+  void operator()(const Src &src, Dst &&dst, thread_pool &pool = thread_pool::shared()) const {
+    using S                 = pixel_t<Src>;
+    using D                 = pixel_t<Dst>;
+    constexpr bool fixed    = std::same_as<typename D::sample_type, std::uint8_t>;
+    using W                 = std::conditional_t<fixed, D, rebind_color_t<D, float>>;
+    using T                 = typename W::sample_type;
+    using M                 = std::conditional_t<fixed, std::int16_t, float>;
+    constexpr std::size_t C = simd::channels_v<W>;
+    // fraction bits of the 16 bit rows between the passes, overshoot kept in the headroom;
+    // only the fixed-point paths read them
+    constexpr int extra                     = 6;
+    [[maybe_unused]] constexpr int shift[2] = {resample_coefficients::fixed_bits - extra, resample_coefficients::fixed_bits + extra};
+    const auto s                            = src.view();
+    const auto d                            = dst.view();
+    if (s.get_width() != m_horizontal.source_size() || s.get_height() != m_vertical.source_size() || d.get_width() != m_horizontal.size() ||
+        d.get_height() != m_vertical.size())
+      throw std::invalid_argument("image sizes do not match the resampler");
+    if (d.empty())
+      return;
+    const std::size_t sw = s.get_width();
+    const std::size_t dw = d.get_width(), dh = d.get_height();
+    const std::size_t ht = m_horizontal.taps(), vt = m_vertical.taps();
+    const std::size_t n  = dw * C;
+
+    // rows of dw pixels, only those some destination row reads
+    const std::size_t top    = m_vertical.first(0);
+    const std::size_t bottom = m_vertical.first(dh - 1) + vt;
+    std::vector<M> between((bottom - top) * n);
+    pool.parallel_for(bottom - top, 0, [&](std::size_t first, std::size_t last) {
+      std::vector<W> scratch(sw);
+      for (std::size_t j = first; j < last; ++j) {
+        const std::size_t y = top + j;
+        const T *in;
+        if constexpr (row_major_view<decltype(s)> && std::same_as<S, W>) {
+          in = reinterpret_cast<const T *>(s.row(y));
+        } else {
+          if constexpr (row_major_view<decltype(s)>)
+            convert_pixels(std::span<const S>(s.row(y), sw), std::span(scratch));
+          else
+            for (std::size_t x = 0; x < sw; ++x)
+              scratch[x] = convert_pixel<W>(s(x, y));
+          in = reinterpret_cast<const T *>(scratch.data());
+        }
+        M *out        = between.data() + j * n;
+        std::size_t x = 0;
+#if defined(PORTAL_SIMD_SSE2)
+        if constexpr (fixed && C == 4) {
+          // two pixels a step, their channels paired for one multiply-add
+          const __m128i zero = _mm_setzero_si128();
+          for (; x < dw; ++x) {
+            const T *window    = in + m_horizontal.first(x) * C;
+            const auto weights = m_horizontal.fixed_weights(x);
+            __m128i sum        = _mm_set1_epi32(1 << (shift[0] - 1));
+            std::size_t k      = 0;
+            for (; k + 2 <= ht; k += 2) {
+              std::int32_t w;
+              std::memcpy(&w, weights.data() + k, sizeof(w));
+              const __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(window + k * C)), zero);
+              sum                = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(pair, _mm_srli_si128(pair, 8)), _mm_set1_epi32(w)));
+            }
+            if (k < ht) {
+              std::int32_t last;
+              std::memcpy(&last, window + k * C, sizeof(last));
+              const __m128i pixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero);
+              sum                 = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(pixel, zero), _mm_set1_epi32(static_cast<std::uint16_t>(weights[k]))));
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x * C), _mm_packs_epi32(_mm_srai_epi32(sum, shift[0]), zero));
+          }
+        }
+#endif
+        for (; x < dw; ++x) {
+          const T *window = in + m_horizontal.first(x) * C;
+          if constexpr (fixed) {
+            const auto weights = m_horizontal.fixed_weights(x);
+            std::int32_t acc[C];
+            std::fill_n(acc, C, std::int32_t{1} << (shift[0] - 1));
+            for (std::size_t k = 0; k < ht; ++k)
+              for (std::size_t c = 0; c < C; ++c)
+                acc[c] += weights[k] * window[k * C + c];
+            for (std::size_t c = 0; c < C; ++c)
+              out[x * C + c] = static_cast<M>(std::clamp(acc[c] >> shift[0], -32768, 32767));
+          } else {
+            const auto weights = m_horizontal.weights(x);
+            float acc[C]       = {};
+            for (std::size_t k = 0; k < ht; ++k)
+              for (std::size_t c = 0; c < C; ++c)
+                acc[c] += weights[k] * window[k * C + c];
+            std::copy_n(acc, C, out + x * C);
+          }
+        }
+      }
+    });
+
+    parallel_for_rows(
+        d,
+        [&](auto band, std::size_t first) {
+          using A = std::conditional_t<fixed, std::int32_t, float>;
+          std::vector<A> acc(n);
+          std::vector<D> row(row_major_view<decltype(band)> && fixed ? 0 : dw);
+          for (std::size_t j = 0; j < band.get_height(); ++j) {
+            const std::size_t y = first + j;
+            const M *rows       = between.data() + (m_vertical.first(y) - top) * n;
+            if constexpr (fixed) {
+              const auto weights = m_vertical.fixed_weights(y);
+              T *out;
+              if constexpr (row_major_view<decltype(band)>)
+                out = reinterpret_cast<T *>(band.row(j));
+              else
+                out = reinterpret_cast<T *>(row.data());
+              std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+              // 16 samples a step, the sums in registers, rows paired for one multiply-add
+              for (; i + 16 <= n; i += 16) {
+                __m128i sum[4];
+                std::fill_n(sum, 4, _mm_set1_epi32(1 << (shift[1] - 1)));
+                for (std::size_t k = 0; k < vt; k += 2) {
+                  // past the last tap the weight is 0, the table has a pair there
+                  const M *a = rows + k * n + i;
+                  const M *b = k + 1 < vt ? a + n : a;
+                  std::int32_t ws;
+                  std::memcpy(&ws, weights.data() + k, sizeof(ws));
+                  const __m128i w = k + 1 < vt ? _mm_set1_epi32(ws) : _mm_set1_epi32(static_cast<std::uint16_t>(weights[k]));
+                  for (std::size_t h = 0; h < 2; ++h) {
+                    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + h * 8));
+                    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + h * 8));
+                    sum[2 * h]       = _mm_add_epi32(sum[2 * h], _mm_madd_epi16(_mm_unpacklo_epi16(lo, hi), w));
+                    sum[2 * h + 1]   = _mm_add_epi32(sum[2 * h + 1], _mm_madd_epi16(_mm_unpackhi_epi16(lo, hi), w));
+                  }
+                }
+                for (auto &v : sum)
+                  v = _mm_srai_epi32(v, shift[1]);
+                const __m128i res = _mm_packus_epi16(_mm_packs_epi32(sum[0], sum[1]), _mm_packs_epi32(sum[2], sum[3]));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), res);
+              }
+#endif
+              // the sums of whole rows, widening multiply-adds
+              std::fill(acc.begin() + static_cast<std::ptrdiff_t>(i), acc.end(), A{1} << (shift[1] - 1));
+              for (std::size_t k = 0; k < vt; ++k) {
+                const M *line        = rows + k * n;
+                const std::int16_t w = weights[k];
+                for (std::size_t l = i; l < n; ++l)
+                  acc[l] += w * line[l];
+              }
+              for (; i < n; ++i)
+                out[i] = static_cast<T>(std::clamp(acc[i] >> shift[1], 0, 255));
+            } else {
+              const auto weights = m_vertical.weights(y);
+              std::fill(acc.begin(), acc.end(), 0.0f);
+              for (std::size_t k = 0; k < vt; ++k) {
+                const M *line = rows + k * n;
+                const A w     = weights[k];
+                for (std::size_t i = 0; i < n; ++i)
+                  acc[i] += w * line[i];
+              }
+              const std::span result(reinterpret_cast<const W *>(acc.data()), dw);
+              if constexpr (row_major_view<decltype(band)>)
+                convert_pixels(result, std::span(band.row(j), dw));
+              else
+                convert_pixels(result, std::span(row));
+            }
+            if constexpr (!row_major_view<decltype(band)>)
+              for (std::size_t x = 0; x < dw; ++x)
+                band(x, j) = row[x];
+          }
+        },
+        0, pool);
+  }
+
+private:
+  resample_coefficients m_horizontal;
+  resample_coefficients m_vertical;
+};
+
+/**
+ * @brief resize an image
+ *
+ * The image to the size of dst. The coefficient tables come from
+ * resampler::cached, resizing between the same sizes again on a thread
+ * reuses them.
+ *
+ * @param[in] src image or view
+ * @param[in,out] dst image or view, not overlapping src
+ * @param[in] filter filter
+ * @param[in] pool pool
+ *
+ * @exception std::invalid_argument if src is empty and dst is not
+ */
+template <image_like Src, writable_image Dst>
+requires convertible_color<pixel_t<Src>> && convertible_color<pixel_t<Dst>>
+void resize(const Src &src, Dst &&dst, resample_filter filter = resample_filter::bicubic, thread_pool &pool = thread_pool::shared()) {
+  const auto s = src.view();
+  const auto d = dst.view();
+  (*resampler::cached(s.get_width(), s.get_height(), d.get_width(), d.get_height(), filter))(s, d, pool);
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_RESAMPLE_HPP
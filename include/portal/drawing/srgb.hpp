@@ -0,0 +1,153 @@
+/**
+ * @file srgb.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief sRGB transfer function
+ * @version 0.1
+ * @date 2022-04-13
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_SRGB_HPP
+#define PORTAL_DRAWING_SRGB_HPP
+
+#include "../math/fast.hpp"
+#include "../math/lut.hpp"
+#include "../math/math.hpp"
+#include "../math/simd.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+namespace portal::drawing {
+/**
+ * @brief table of the power segment of the sRGB decoding
+ *
+ * Catmull-Rom through 256 samples of ((x + 0.055) / 1.055)^2.4 on
+ * [0.04045, 1], the curve is smooth there so the error stays near the
+ * rounding of T.
+ *
+ * @tparam T floating-point type
+ */
+template <std::floating_point T>
+inline constexpr auto srgb_decode_lut = math::make_lut<256, math::interpolation::cubic>(
+    [](T x) { return math::slow_pow((x + T(0.055)) / T(1.055), T(2.4)); }, T(0.04045), T(1));
+
+/**
+ * @brief table of the power segment of the sRGB encoding
+ *
+ * The encoding is taken as a function of t = sqrt(x), Catmull-Rom through
+ * 256 samples of 1.055 t^(2 / 2.4) - 0.055 on [sqrt(0.0031308), 1]. In x
+ * the slope of the curve is unbounded towards 0, in t it is not.
+ *
+ * @tparam T floating-point type
+ */
+template <std::floating_point T>
+inline constexpr auto srgb_encode_lut = math::make_lut<256, math::interpolation::cubic>(
+    [](T t) { return T(1.055) * math::slow_pow(t, T(2 / 2.4)) - T(0.055); }, math::slow_sqrt(T(0.0031308)), T(1));
+
+/**
+ * @brief sRGB to linear
+ *
+ * The reduced tiers look the power segment up in srgb_decode_lut, a few
+ * ulp off.
+ *
+ * @tparam P precision, high is the exact curve
+ * @tparam T floating-point type
+ * @param[in] x sRGB-encoded value, the reduced tiers clamp it above 1
+ * @return Returns the linear value
+ */
+template <math::fast::precision P = math::fast::precision::high, std::floating_point T>
+[[nodiscard]] constexpr T srgb_to_linear(T x) noexcept {
+  if constexpr (P == math::fast::precision::high)
+    return x <= T(0.04045) ? x / T(12.92) : math::slow_pow((x + T(0.055)) / T(1.055), T(2.4));
+  else
+    return math::fast::select(x <= T(0.04045), x * T(1 / 12.92), srgb_decode_lut<T>(x));
+}
+
+/**
+ * @brief linear to sRGB
+ *
+ * The medium tier looks the power segment up in srgb_encode_lut, the low
+ * tier takes it from math::fast::pow, about 4e-5 off but without table
+ * lookups, so loops calling it vectorize.
+ *
+ * @tparam P precision, high is the exact curve
+ * @tparam T floating-point type
+ * @param[in] x linear value, the medium tier clamps it above 1
+ * @return Returns the sRGB-encoded value
+ */
+template <math::fast::precision P = math::fast::precision::high, std::floating_point T>
+[[nodiscard]] constexpr T linear_to_srgb(T x) noexcept {
+  if constexpr (P == math::fast::precision::high)
+    return x <= T(0.0031308) ? x * T(12.92) : T(1.055) * math::slow_pow(x, T(1 / 2.4)) - T(0.055);
+  else if constexpr (P == math::fast::precision::medium)
+    return math::fast::select(x <= T(0.0031308), x * T(12.92), srgb_encode_lut<T>(math::fast::sqrt<math::fast::precision::high>(x)));
+  else
+    return math::fast::select(x <= T(0.0031308), x * T(12.92), T(1.055) * math::fast::pow<math::fast::precision::medium>(x, T(1 / 2.4)) - T(0.055));
+}
+
+/**
+ * @brief sRGB to linear of many values
+ *
+ * Same as srgb_to_linear<precision::medium> on each value, the table is
+ * looked up in batches.
+ *
+ * @param[in] src sRGB-encoded values
+ * @param[out] dst linear values, may be src
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+inline void srgb_to_linear(std::span<const float> src, std::span<float> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  constexpr std::size_t chunk = 256;
+  float buf[chunk];
+  for (std::size_t first = 0; first < src.size(); first += chunk) {
+    const auto n = std::min(chunk, src.size() - first);
+    srgb_decode_lut<float>(src.subspan(first, n), std::span(buf, n));
+    for (std::size_t i = 0; i < n; ++i) {
+      const float x  = src[first + i];
+      dst[first + i] = math::fast::select(x <= 0.04045f, x * float(1 / 12.92), buf[i]);
+    }
+  }
+}
+
+/**
+ * @brief linear to sRGB of many values
+ *
+ * Same as linear_to_srgb<precision::medium> on each value, the table is
+ * looked up in batches.
+ *
+ * @param[in] src linear values
+ * @param[out] dst sRGB-encoded values, may be src
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+inline void linear_to_srgb(std::span<const float> src, std::span<float> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  constexpr std::size_t chunk = 256;
+  float buf[chunk];
+  for (std::size_t first = 0; first < src.size(); first += chunk) {
+    const auto n  = std::min(chunk, src.size() - first);
+    std::size_t i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+    // std::sqrt does not vectorize while it may set errno
+    for (; i + 4 <= n; i += 4)
+      _mm_storeu_ps(buf + i, _mm_sqrt_ps(_mm_loadu_ps(src.data() + first + i)));
+#endif
+    for (; i < n; ++i)
+      buf[i] = math::fast::sqrt<math::fast::precision::high>(src[first + i]);
+    srgb_encode_lut<float>(std::span<const float>(buf, n), std::span(buf, n));
+    for (i = 0; i < n; ++i) {
+      const float x  = src[first + i];
+      dst[first + i] = math::fast::select(x <= 0.0031308f, x * 12.92f, buf[i]);
+    }
+  }
+}
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_SRGB_HPP
@@ -0,0 +1,410 @@
+/**
+ * @file storage.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief pixel storage allocators
+ * @version 0.1
+ * @date 2022-04-08
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_DRAWING_STORAGE_HPP
+#define PORTAL_DRAWING_STORAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace portal::drawing {
+/**
+ * @brief default alignment of pixel rows (a cache line, enough for any SIMD load)
+ *
+ */
+inline constexpr std::size_t default_alignment = 64;
+
+/**
+ * @brief default limit of the bytes a buffer_pool keeps cached
+ *
+ */
+inline constexpr std::size_t default_max_cached = std::size_t{256} << 20;
+
+/**
+ * @brief allocator of aligned memory
+ *
+ * @tparam T value type
+ * @tparam Align alignment in bytes
+ */
+template <typename T, std::size_t Align = default_alignment>
+class aligned_allocator {
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+  static_assert(Align >= alignof(T), "alignment is weaker than the type requires");
+
+public:
+  using value_type = T; //!< @brief value type
+
+  /**
+   * @brief alignment in bytes
+   *
+   */
+  static constexpr std::size_t alignment = Align;
+
+  /**
+   * @brief same allocator for another type
+   *
+   * @tparam U value type
+   */
+  template <typename U>
+  struct rebind {
+    using other = aligned_allocator<U, Align>; //!< @brief allocator of U
+  };
+
+  /**
+   * @brief default constructor
+   *
+   */
+  constexpr aligned_allocator() noexcept = default;
+
+  /**
+   * @brief converting constructor
+   *
+   * @tparam U value type
+   */
+  template <typename U>
+  constexpr aligned_allocator(const aligned_allocator<U, Align> &) noexcept {
+  }
+
+  /**
+   * @brief allocate
+   *
+   * @param[in] n number of elements
+   * @return aligned storage of n elements
+   *
+   * @exception std::bad_array_new_length if n * sizeof(T) overflows
+   * @exception std::bad_alloc if allocation fails
+   */
+  [[nodiscard]] T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+  }
+
+  /**
+   * @brief deallocate
+   *
+   * @param[in] ptr storage returned by allocate(n)
+   * @param[in] n number of elements
+   */
+  void deallocate(T *ptr, std::size_t n) noexcept {
+    ::operator delete(ptr, n * sizeof(T), std::align_val_t{Align});
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @return true, all aligned allocators are interchangeable
+   */
+  template <typename U>
+  [[nodiscard]] friend constexpr bool operator==(const aligned_allocator &, const aligned_allocator<U, Align> &) noexcept {
+    return true;
+  }
+};
+
+/**
+ * @brief thread-safe pool of aligned buffers
+ *
+ * Released buffers are kept in a free list per byte size and handed out
+ * again by the next acquire of the same size, so recycling same-sized
+ * images does not reach operator new. The free lists are intrusive, a
+ * cached buffer stores the link to the next one. A buffer that would take
+ * the cache over max_cached() bytes is freed instead.
+ */
+class buffer_pool {
+public:
+  /**
+   * @brief constructor
+   *
+   * @param[in] alignment alignment of the buffers in bytes, a power of two
+   * @param[in] max_cached limit of the cached bytes
+   *
+   * @exception std::invalid_argument if alignment is not a power of two
+   */
+  explicit buffer_pool(std::size_t alignment = default_alignment, std::size_t max_cached = default_max_cached)
+      : m_alignment(std::max(alignment, alignof(node))), m_max_cached(max_cached) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+      throw std::invalid_argument("alignment must be a power of two");
+  }
+
+  buffer_pool(const buffer_pool &)            = delete;
+  buffer_pool &operator=(const buffer_pool &) = delete;
+
+  /**
+   * @brief destructor, frees the cached buffers
+   *
+   * Buffers still acquired must not be released after the pool is destroyed.
+   */
+  ~buffer_pool() {
+    trim();
+  }
+
+  /**
+   * @brief process-wide pool
+   *
+   * @return pool with the default alignment
+   */
+  [[nodiscard]] static buffer_pool &shared() {
+    static buffer_pool pool;
+    return pool;
+  }
+
+  /**
+   * @brief acquire a buffer
+   *
+   * @param[in] bytes size in bytes
+   * @return buffer of bytes, a cached one if available
+   *
+   * @exception std::bad_alloc if allocation fails
+   */
+  [[nodiscard]] void *acquire(std::size_t bytes) {
+    bytes = block_size(bytes);
+    {
+      std::lock_guard lock(m_mutex);
+      if (auto it = m_free.find(bytes); it != m_free.end() && it->second != nullptr) {
+        node *head = it->second;
+        it->second = head->next;
+        m_cached -= bytes;
+        return head;
+      }
+    }
+    return ::operator new(bytes, std::align_val_t{m_alignment});
+  }
+
+  /**
+   * @brief return a buffer to the pool
+   *
+   * The buffer is cached unless that takes the cache over max_cached()
+   * bytes, then it is freed.
+   *
+   * @param[in] ptr buffer returned by acquire(bytes)
+   * @param[in] bytes size in bytes
+   */
+  void release(void *ptr, std::size_t bytes) noexcept {
+    if (ptr == nullptr)
+      return;
+    bytes = block_size(bytes);
+    {
+      std::lock_guard lock(m_mutex);
+      if (bytes <= m_max_cached - m_cached) {
+        try {
+          node *&head = m_free[bytes];
+          head        = ::new (ptr) node{head};
+          m_cached += bytes;
+          return;
+        } catch (...) {
+          // the free list of a new size could not be created, free the buffer instead
+        }
+      }
+    }
+    ::operator delete(ptr, bytes, std::align_val_t{m_alignment});
+  }
+
+  /**
+   * @brief free all cached buffers
+   *
+   * The cache never holds more than max_cached() bytes, trim() frees the
+   * rest as well, e.g. after a change of frame size.
+   */
+  void trim() noexcept {
+    std::lock_guard lock(m_mutex);
+    for (auto &[bytes, head] : m_free) {
+      while (head != nullptr) {
+        node *next = head->next;
+        ::operator delete(head, bytes, std::align_val_t{m_alignment});
+        head = next;
+      }
+    }
+    m_free.clear();
+    m_cached = 0;
+  }
+
+  /**
+   * @brief cached bytes
+   *
+   * @return total size of the cached buffers
+   */
+  [[nodiscard]] std::size_t cached() const {
+    std::lock_guard lock(m_mutex);
+    return m_cached;
+  }
+
+  /**
+   * @brief limit of the cached bytes
+   *
+   * @return bytes the pool keeps cached at most
+   */
+  [[nodiscard]] std::size_t max_cached() const noexcept {
+    return m_max_cached;
+  }
+
+  /**
+   * @brief alignment
+   *
+   * @return alignment of the buffers in bytes
+   */
+  [[nodiscard]] std::size_t alignment() const noexcept {
+    return m_alignment;
+  }
+
+private:
+  struct node {
+    node *next;
+  };
+
+  [[nodiscard]] static std::size_t block_size(std::size_t bytes) noexcept {
+    return std::max(bytes, sizeof(node));
+  }
+
+  mutable std::mutex m_mutex;
+  std::map<std::size_t, node *> m_free;
+  std::size_t m_alignment  = default_alignment;
+  std::size_t m_max_cached = default_max_cached;
+  std::size_t m_cached     = 0;
+};
+
+/**
+ * @brief allocator drawing from a buffer_pool
+ *
+ * The pool must outlive every allocator and every buffer allocated from it.
+ *
+ * @tparam T value type
+ * @tparam Align alignment in bytes
+ */
+template <typename T, std::size_t Align = default_alignment>
+class pool_allocator {
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+  static_assert(Align >= alignof(T), "alignment is weaker than the type requires");
+
+public:
+  using value_type = T; //!< @brief value type
+
+  /**
+   * @brief alignment in bytes
+   *
+   */
+  static constexpr std::size_t alignment = Align;
+
+  /**
+   * @brief same allocator for another type
+   *
+   * @tparam U value type
+   */
+  template <typename U>
+  struct rebind {
+    using other = pool_allocator<U, Align>; //!< @brief allocator of U
+  };
+
+  /**
+   * @brief constructor using buffer_pool::shared()
+   *
+   */
+  pool_allocator()
+      : pool_allocator(buffer_pool::shared()) {
+  }
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] pool pool
+   *
+   * @exception std::invalid_argument if pool.alignment() < Align
+   */
+  explicit pool_allocator(buffer_pool &pool)
+      : m_pool(&pool) {
+    if (pool.alignment() < Align)
+      throw std::invalid_argument("pool alignment is too weak");
+  }
+
+  /**
+   * @brief converting constructor
+   *
+   * @tparam U value type
+   * @param[in] alloc allocator
+   */
+  template <typename U>
+  pool_allocator(const pool_allocator<U, Align> &alloc) noexcept
+      : m_pool(&alloc.pool()) {
+  }
+
+  /**
+   * @brief allocate
+   *
+   * @param[in] n number of elements
+   * @return storage of n elements
+   *
+   * @exception std::bad_array_new_length if n * sizeof(T) overflows
+   * @exception std::bad_alloc if allocation fails
+   */
+  [[nodiscard]] T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T *>(m_pool->acquire(n * sizeof(T)));
+  }
+
+  /**
+   * @brief deallocate, the storage goes back to the pool
+   *
+   * @param[in] ptr storage returned by allocate(n)
+   * @param[in] n number of elements
+   */
+  void deallocate(T *ptr, std::size_t n) noexcept {
+    m_pool->release(ptr, n * sizeof(T));
+  }
+
+  /**
+   * @brief pool
+   *
+   * @return pool
+   */
+  [[nodiscard]] buffer_pool &pool() const noexcept {
+    return *m_pool;
+  }
+
+  /**
+   * @brief equal to
+   *
+   * @return true if both allocators draw from the same pool
+   */
+  template <typename U>
+  [[nodiscard]] friend bool operator==(const pool_allocator &lhs, const pool_allocator<U, Align> &rhs) noexcept {
+    return &lhs.pool() == &rhs.pool();
+  }
+
+private:
+  buffer_pool *m_pool;
+};
+
+/**
+ * @brief alignment an allocator guarantees
+ *
+ * @tparam A allocator
+ */
+template <typename A>
+inline constexpr std::size_t allocator_alignment_v = alignof(typename A::value_type);
+
+/**
+ * @brief alignment an allocator guarantees
+ *
+ * @tparam A allocator with an alignment member
+ */
+template <typename A>
+requires requires {
+  A::alignment;
+}
+inline constexpr std::size_t allocator_alignment_v<A> = A::alignment;
+} // namespace portal::drawing
+
+#endif // PORTAL_DRAWING_STORAGE_HPP
@@ -0,0 +1,251 @@
+/**
+ * @file half.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief half-precision floating-point
+ * @version 0.1
+ * @date 2022-04-14
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_HALF_HPP
+#define PORTAL_HALF_HPP
+
+#include "math/simd.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief float to the bits of a float with a 5 bit exponent
+ *
+ * Rounds to nearest even, overflows to infinity and keeps NaN. The sign is
+ * dropped, the result holds the magnitude only. All cases are computed and
+ * their bits blended, so loops calling it vectorize.
+ *
+ * @tparam M mantissa bits, 10 for binary16
+ * @param[in] value value
+ * @return Returns the exponent and mantissa bits of |value|
+ */
+template <unsigned M>
+requires(M >= 1 && M <= 10)
+[[nodiscard]] constexpr std::uint32_t minifloat_bits(float value) noexcept {
+  constexpr std::uint32_t inf = 0x1fu << M;
+  const std::uint32_t f       = std::bit_cast<std::uint32_t>(value) & 0x7fffffffu;
+  // below the smallest normal: adding 2^(9 - M) rounds the mantissa to a multiple of the smallest subnormal
+  constexpr float magic       = std::bit_cast<float>((127u + 9u - M) << 23);
+  const std::uint32_t sub     = std::bit_cast<std::uint32_t>(std::bit_cast<float>(f) + magic) - std::bit_cast<std::uint32_t>(magic);
+  // rebias the exponent and round half to even, a carry out of the mantissa steps the exponent up
+  const std::uint32_t odd     = (f >> (23 - M)) & 1u;
+  const std::uint32_t norm    = (f - ((127u - 15u) << 23) + ((1u << (22 - M)) - 1u) + odd) >> (23 - M);
+  const std::uint32_t special = inf | ((1u << (M - 1)) & -std::uint32_t{f > 0x7f800000u});
+  const std::uint32_t is_big  = -std::uint32_t{f >= 0x47800000u};
+  const std::uint32_t is_sub  = -std::uint32_t{f < 0x38800000u};
+  return (special & is_big) | (sub & is_sub) | (norm & ~(is_big | is_sub));
+}
+
+/**
+ * @brief value of the bits of a float with a 5 bit exponent
+ *
+ * Exact. All cases are computed and their bits blended, so loops calling
+ * it vectorize.
+ *
+ * @tparam M mantissa bits, 10 for binary16
+ * @param[in] bits exponent and mantissa bits, higher bits are ignored
+ * @return Returns the value, positive
+ */
+template <unsigned M>
+requires(M >= 1 && M <= 10)
+[[nodiscard]] constexpr float minifloat_value(std::uint32_t bits) noexcept {
+  constexpr std::uint32_t inf = 0x1fu << M;
+  const std::uint32_t exp     = bits & inf;
+  const std::uint32_t shifted = (bits & (inf | ((1u << M) - 1u))) << (23 - M);
+  const std::uint32_t norm    = shifted + ((127u - 15u) << 23);
+  const std::uint32_t special = shifted + ((255u - 31u) << 23);
+  // mantissa times the smallest subnormal, both exact in float
+  const std::uint32_t sub     = std::bit_cast<std::uint32_t>(static_cast<float>(bits & ((1u << M) - 1u)) * std::bit_cast<float>((127u - 14u - M) << 23));
+  const std::uint32_t is_sub     = -std::uint32_t{exp == 0};
+  const std::uint32_t is_special = -std::uint32_t{exp == inf};
+  return std::bit_cast<float>((sub & is_sub) | (special & is_special) | (norm & ~(is_sub | is_special)));
+}
+
+/**
+ * @brief half-precision floating-point (IEEE 754 binary16)
+ *
+ * A storage type: arithmetic converts to float. Conversions round to
+ * nearest even.
+ *
+ */
+class half {
+public:
+  /**
+   * @brief Construct a new half object, uninitialized as a float would be
+   *
+   */
+  half() noexcept = default;
+
+  /**
+   * @brief Construct a new half object
+   *
+   * @param[in] value value, rounded to nearest even
+   */
+  constexpr explicit half(float value) noexcept
+      : m_bits(static_cast<std::uint16_t>(minifloat_bits<10>(value) | ((std::bit_cast<std::uint32_t>(value) >> 16) & 0x8000u))) {
+  }
+
+  /**
+   * @brief half from its bits
+   *
+   * @param[in] bits bits
+   * @return Returns the half
+   */
+  [[nodiscard]] static constexpr half from_bits(std::uint16_t bits) noexcept {
+    half res;
+    res.m_bits = bits;
+    return res;
+  }
+
+  /**
+   * @brief bits
+   *
+   * @return Returns the bits
+   */
+  [[nodiscard]] constexpr std::uint16_t bits() const noexcept {
+    return m_bits;
+  }
+
+  /**
+   * @brief to float
+   *
+   * @return Returns the value, exact
+   */
+  [[nodiscard]] constexpr operator float() const noexcept {
+    const std::uint32_t sign = (std::uint32_t{m_bits} & 0x8000u) << 16;
+    return std::bit_cast<float>(std::bit_cast<std::uint32_t>(minifloat_value<10>(m_bits)) | sign);
+  }
+
+private:
+  std::uint16_t m_bits;
+};
+
+/**
+ * @brief half to float of many values
+ *
+ * Uses F16C or NEON conversions when available.
+ *
+ * @param[in] src halves
+ * @param[out] dst floats
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+inline void half_to_float(std::span<const half> src, std::span<float> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_F16C)
+  for (; i + 8 <= src.size(); i += 8)
+    _mm256_storeu_ps(dst.data() + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data() + i))));
+#elif defined(PORTAL_SIMD_NEON)
+  for (; i + 4 <= src.size(); i += 4)
+    vst1q_f32(dst.data() + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const std::uint16_t *>(src.data() + i)))));
+#endif
+  for (; i < src.size(); ++i)
+    dst[i] = src[i];
+}
+
+/**
+ * @brief float to half of many values
+ *
+ * Uses F16C or NEON conversions when available, all paths round to nearest
+ * even. NaN payloads may differ between the paths.
+ *
+ * @param[in] src floats
+ * @param[out] dst halves
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+inline void float_to_half(std::span<const float> src, std::span<half> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  std::size_t i = 0;
+#if defined(PORTAL_SIMD_F16C)
+  for (; i + 8 <= src.size(); i += 8)
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst.data() + i), _mm256_cvtps_ph(_mm256_loadu_ps(src.data() + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(PORTAL_SIMD_NEON)
+  for (; i + 4 <= src.size(); i += 4)
+    vst1_u16(reinterpret_cast<std::uint16_t *>(dst.data() + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src.data() + i))));
+#endif
+  for (; i < src.size(); ++i)
+    dst[i] = half(src[i]);
+}
+} // namespace portal
+
+/**
+ * @brief numeric limits of half
+ *
+ */
+template <>
+class std::numeric_limits<portal::half> {
+public:
+  static constexpr bool is_specialized           = true;             //!< @brief specialized
+  static constexpr bool is_signed                = true;             //!< @brief signed
+  static constexpr bool is_integer               = false;            //!< @brief not an integer
+  static constexpr bool is_exact                 = false;            //!< @brief not exact
+  static constexpr bool has_infinity             = true;             //!< @brief has infinity
+  static constexpr bool has_quiet_NaN            = true;             //!< @brief has quiet NaN
+  static constexpr bool has_signaling_NaN        = true;             //!< @brief has signaling NaN
+  static constexpr float_denorm_style has_denorm = denorm_present;   //!< @brief has subnormals
+  static constexpr bool has_denorm_loss          = false;            //!< @brief loss of accuracy is not detected as denormalization
+  static constexpr bool is_iec559                = true;             //!< @brief IEEE 754
+  static constexpr bool is_bounded               = true;             //!< @brief bounded
+  static constexpr bool is_modulo                = false;            //!< @brief not modulo
+  static constexpr bool traps                    = false;            //!< @brief arithmetic does not trap
+  static constexpr bool tinyness_before          = false;            //!< @brief tininess is detected after rounding
+  static constexpr float_round_style round_style = round_to_nearest; //!< @brief rounding of conversions
+  static constexpr int digits                    = 11;               //!< @brief mantissa bits with the implicit one
+  static constexpr int digits10                  = 3;                //!< @brief decimal digits kept
+  static constexpr int max_digits10              = 5;                //!< @brief decimal digits to round-trip
+  static constexpr int radix                     = 2;                //!< @brief radix
+  static constexpr int min_exponent              = -13;              //!< @brief smallest normal exponent + 1
+  static constexpr int max_exponent              = 16;               //!< @brief largest exponent + 1
+  static constexpr int min_exponent10            = -4;               //!< @brief smallest normal power of 10
+  static constexpr int max_exponent10            = 4;                //!< @brief largest finite power of 10
+
+  static constexpr portal::half min() noexcept {
+    return portal::half::from_bits(0x0400);
+  }
+  static constexpr portal::half lowest() noexcept {
+    return portal::half::from_bits(0xfbff);
+  }
+  static constexpr portal::half max() noexcept {
+    return portal::half::from_bits(0x7bff);
+  }
+  static constexpr portal::half epsilon() noexcept {
+    return portal::half::from_bits(0x1400);
+  }
+  static constexpr portal::half round_error() noexcept {
+    return portal::half::from_bits(0x3800);
+  }
+  static constexpr portal::half infinity() noexcept {
+    return portal::half::from_bits(0x7c00);
+  }
+  static constexpr portal::half quiet_NaN() noexcept {
+    return portal::half::from_bits(0x7e00);
+  }
+  static constexpr portal::half signaling_NaN() noexcept {
+    return portal::half::from_bits(0x7d00);
+  }
+  static constexpr portal::half denorm_min() noexcept {
+    return portal::half::from_bits(0x0001);
+  }
+};
+
+#endif // PORTAL_HALF_HPP
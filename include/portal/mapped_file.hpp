@@ -0,0 +1,201 @@
+/**
+ * @file mapped_file.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief read-only memory-mapped files
+ * @version 0.1
+ * @date 2022-04-19
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MAPPED_FILE_HPP
+#define PORTAL_MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief read-only memory-mapped file
+ *
+ * The pages are read by the kernel as they are first touched, a file of
+ * any size is opened in constant time and read at disk speed. The
+ * contents must not be changed by another process while mapped.
+ */
+class mapped_file {
+public:
+  using size_type = std::size_t; //!< @brief size type
+
+  /**
+   * @brief default constructor, no file
+   *
+   */
+  mapped_file() noexcept = default;
+
+  /**
+   * @brief map a file
+   *
+   * @param[in] path file
+   *
+   * @exception std::system_error if the file cannot be opened or mapped
+   */
+  explicit mapped_file(const std::filesystem::path &path) {
+#if defined(_WIN32)
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "cannot open " + path.string());
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+      const auto error = GetLastError();
+      CloseHandle(file);
+      throw std::system_error(static_cast<int>(error), std::system_category(), "cannot stat " + path.string());
+    }
+    if (size.QuadPart != 0) {
+      const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr) {
+        m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+      }
+      if (m_data == nullptr) {
+        const auto error = GetLastError();
+        CloseHandle(file);
+        throw std::system_error(static_cast<int>(error), std::system_category(), "cannot map " + path.string());
+      }
+      m_size = static_cast<size_type>(size.QuadPart);
+    }
+    CloseHandle(file);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), "cannot open " + path.string());
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "cannot stat " + path.string());
+    }
+    if (st.st_size != 0) {
+      void *data = ::mmap(nullptr, static_cast<size_type>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "cannot map " + path.string());
+      }
+      ::madvise(data, static_cast<size_type>(st.st_size), MADV_SEQUENTIAL);
+      m_data = data;
+      m_size = static_cast<size_type>(st.st_size);
+    }
+    ::close(fd);
+#endif
+  }
+
+  mapped_file(const mapped_file &) = delete;
+
+  /**
+   * @brief move constructor
+   *
+   * @param[in,out] file file, left empty
+   */
+  mapped_file(mapped_file &&file) noexcept
+      : m_data(std::exchange(file.m_data, nullptr))
+      , m_size(std::exchange(file.m_size, 0)) {
+  }
+
+  /**
+   * @brief destructor, unmap the file
+   *
+   */
+  ~mapped_file() {
+    unmap();
+  }
+
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  /**
+   * @brief move assignment
+   *
+   * @param[in,out] file file, left empty
+   * @return *this
+   */
+  mapped_file &operator=(mapped_file &&file) noexcept {
+    if (this != &file) {
+      unmap();
+      m_data = std::exchange(file.m_data, nullptr);
+      m_size = std::exchange(file.m_size, 0);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief first byte of the file
+   *
+   * @return Returns the first byte, nullptr if empty
+   */
+  [[nodiscard]] const std::byte *data() const noexcept {
+    return static_cast<const std::byte *>(m_data);
+  }
+
+  /**
+   * @brief size of the file
+   *
+   * @return Returns the size in bytes
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    return m_size;
+  }
+
+  /**
+   * @brief check if empty
+   *
+   * @return true if no file is mapped or the file is empty
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return m_size == 0;
+  }
+
+  /**
+   * @brief contents of the file
+   *
+   * @return Returns the bytes
+   */
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return {data(), m_size};
+  }
+
+private:
+  void unmap() noexcept {
+    if (m_data == nullptr)
+      return;
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+#else
+    ::munmap(m_data, m_size);
+#endif
+  }
+
+  void *m_data     = nullptr;
+  size_type m_size = 0;
+};
+} // namespace portal
+
+#endif // PORTAL_MAPPED_FILE_HPP
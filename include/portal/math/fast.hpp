@@ -0,0 +1,717 @@
+/**
+ * @file fast.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief fast approximate math functions
+ * @version 0.1
+ * @date 2022-04-06
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_FAST_HPP
+#define PORTAL_MATH_FAST_HPP
+
+#include "math.hpp"
+#include "fs_vector.hpp"
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+/**
+ * @brief fast math namespace
+ *
+ * Every function takes the precision tier as its first template argument.
+ * The medium and low tiers are branch-free polynomial approximations, so
+ * loops over the span overloads are vectorized by the compiler.
+ */
+namespace portal::math::fast {
+/**
+ * @brief precision tier
+ *
+ */
+enum class precision {
+  high,   //!< @brief about 1 ulp, same as slow_* / std
+  medium, //!< @brief error <= 1e-4
+  low     //!< @brief error <= 1e-2
+};
+
+/**
+ * @brief floating-point traits
+ *
+ * @tparam T floating-point type
+ */
+template <std::floating_point T>
+struct float_traits;
+
+/**
+ * @brief float traits
+ *
+ */
+template <>
+struct float_traits<float> {
+  using bits_type                        = std::uint32_t;   //!< @brief same size unsigned integer
+  static constexpr int mantissa          = 23;              //!< @brief mantissa bits
+  static constexpr int bias              = 127;             //!< @brief exponent bias
+  static constexpr bits_type rsqrt_magic = 0x5f375a86;      //!< @brief initial rsqrt guess
+  static constexpr float round_magic     = 12582912.f;      //!< @brief 1.5 * 2^23, adding it rounds to integer
+  static constexpr float pio2_hi         = 1.5703125f;      //!< @brief pi / 2 (high part, exact product with small k)
+  static constexpr float pio2_mid        = 4.83751296997e-4f; //!< @brief pi / 2 (middle part)
+  static constexpr float pio2_lo         = 7.54978995489e-8f; //!< @brief pi / 2 (low part)
+  static constexpr float ln2_hi          = 6.93145752e-1f;  //!< @brief ln 2 (high part)
+  static constexpr float ln2_lo          = 1.42860677e-6f;  //!< @brief ln 2 (low part)
+  static constexpr float exp_min         = -87.f;           //!< @brief exp argument lower clamp
+  static constexpr float exp_max         = 88.f;            //!< @brief exp argument upper clamp
+};
+
+/**
+ * @brief double traits
+ *
+ */
+template <>
+struct float_traits<double> {
+  using bits_type                        = std::uint64_t;              //!< @brief same size unsigned integer
+  static constexpr int mantissa          = 52;                         //!< @brief mantissa bits
+  static constexpr int bias              = 1023;                       //!< @brief exponent bias
+  static constexpr bits_type rsqrt_magic = 0x5fe6eb50c7b537a9;         //!< @brief initial rsqrt guess
+  static constexpr double round_magic    = 6755399441055744.0;         //!< @brief 1.5 * 2^52, adding it rounds to integer
+  static constexpr double pio2_hi        = 1.57079632673412561417e+0;  //!< @brief pi / 2 (high part, exact product with small k)
+  static constexpr double pio2_mid       = 6.07710050630396597660e-11; //!< @brief pi / 2 (middle part)
+  static constexpr double pio2_lo        = 2.02226624879595063154e-21; //!< @brief pi / 2 (low part)
+  static constexpr double ln2_hi         = 6.93147180369123816490e-1;  //!< @brief ln 2 (high part)
+  static constexpr double ln2_lo         = 1.90821492927058770002e-10; //!< @brief ln 2 (low part)
+  static constexpr double exp_min        = -708.;                      //!< @brief exp argument lower clamp
+  static constexpr double exp_max        = 709.;                       //!< @brief exp argument upper clamp
+};
+
+/**
+ * @brief round to nearest integer
+ *
+ * @tparam T floating-point type
+ * @param[in] x value, |x| < 2^(mantissa - 1)
+ * @return x rounded to the nearest integer
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr T round_nearest(T x) noexcept {
+  return (x + float_traits<T>::round_magic) - float_traits<T>::round_magic;
+}
+
+/**
+ * @brief branch-free select
+ *
+ * Blends the bit patterns, so the compiler cannot sink the computation of
+ * either value into a branch and the calling loop stays vectorizable.
+ *
+ * @tparam T floating-point type
+ * @param[in] cond condition
+ * @param[in] a value if cond
+ * @param[in] b value if !cond
+ * @return Returns cond ? a : b
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr T select(bool cond, T a, T b) noexcept {
+  using bits_type      = typename float_traits<T>::bits_type;
+  const bits_type mask = ~(static_cast<bits_type>(cond) - 1);
+  return std::bit_cast<T>((std::bit_cast<bits_type>(a) & mask) | (std::bit_cast<bits_type>(b) & ~mask));
+}
+
+/**
+ * @brief reciprocal square root
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x value
+ * @return Returns 1 / sqrt(x), relative error
+ *
+ * @pre x > 0
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T rsqrt(T x) noexcept {
+  if constexpr (P == precision::high) {
+    return 1 / slow_sqrt(x);
+  } else {
+    using traits = float_traits<T>;
+    const T half = x * static_cast<T>(0.5);
+    T y          = std::bit_cast<T>(static_cast<typename traits::bits_type>(traits::rsqrt_magic - (std::bit_cast<typename traits::bits_type>(x) >> 1)));
+    // Newton-Raphson, each step squares the relative error (3.4e-2 -> 1.8e-3 -> 4.7e-6)
+    y = y * (static_cast<T>(1.5) - half * y * y);
+    if constexpr (P == precision::medium)
+      y = y * (static_cast<T>(1.5) - half * y * y);
+    return y;
+  }
+}
+
+/**
+ * @brief square root
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x value
+ * @return Returns sqrt(x), relative error
+ *
+ * @pre x >= 0
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T sqrt(T x) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_sqrt(x);
+  } else {
+    // x * rsqrt(x) is not inf for x = inf, pass it through as exp and log pass NaN
+    const T res = x * rsqrt<P>(select(x < std::numeric_limits<T>::min(), std::numeric_limits<T>::min(), x));
+    return select(x == std::numeric_limits<T>::infinity(), x, res);
+  }
+}
+
+/**
+ * @brief sin and cos
+ *
+ * The argument is reduced to [-pi/4, pi/4] and both polynomials are
+ * evaluated, the quadrant selects and negates them without branches.
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] theta theta, |theta| < 1e4 for the reduced tiers
+ * @param[out] s sin of theta, absolute error
+ * @param[out] c cos of theta, absolute error
+ */
+template <precision P = precision::medium, std::floating_point T>
+constexpr void sincos(T theta, T &s, T &c) noexcept {
+  if constexpr (P == precision::high) {
+    s = slow_sin(theta);
+    c = slow_cos(theta);
+  } else {
+    using traits = float_traits<T>;
+    const T k    = round_nearest(theta * (2 / std::numbers::pi_v<T>));
+    const T r    = ((theta - k * traits::pio2_hi) - k * traits::pio2_mid) - k * traits::pio2_lo;
+    const T r2   = r * r;
+    T ps, pc;
+    if constexpr (P == precision::medium) {
+      // truncation error r^7/7! = 3.6e-5 and r^8/8! = 3.6e-6
+      ps = r * (1 + r2 * (static_cast<T>(-1. / 6) + r2 * static_cast<T>(1. / 120)));
+      pc = 1 + r2 * (static_cast<T>(-1. / 2) + r2 * (static_cast<T>(1. / 24) + r2 * static_cast<T>(-1. / 720)));
+    } else {
+      // truncation error r^5/5! = 2.5e-3 and r^6/6! = 3.2e-4
+      ps = r * (1 + r2 * static_cast<T>(-1. / 6));
+      pc = 1 + r2 * (static_cast<T>(-1. / 2) + r2 * static_cast<T>(1. / 24));
+    }
+    // quadrant swap and signs as bit operations, so both polynomials stay branch-free
+    using bits_type          = typename traits::bits_type;
+    constexpr int sign_shift = sizeof(T) * 8 - 2;
+    const auto q             = static_cast<bits_type>(static_cast<std::int32_t>(k));
+    const bits_type swap     = ~((q & 1) - 1);
+    const bits_type bs       = std::bit_cast<bits_type>(ps);
+    const bits_type bc       = std::bit_cast<bits_type>(pc);
+    s                        = std::bit_cast<T>(((bc & swap) | (bs & ~swap)) ^ ((q & 2) << sign_shift));
+    c                        = std::bit_cast<T>(((bs & swap) | (bc & ~swap)) ^ (((q + 1) & 2) << sign_shift));
+  }
+}
+
+/**
+ * @brief sin
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] theta theta, |theta| < 1e4 for the reduced tiers
+ * @return Returns the sin of theta, absolute error
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T sin(T theta) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_sin(theta);
+  } else {
+    T s, c;
+    sincos<P>(theta, s, c);
+    return s;
+  }
+}
+
+/**
+ * @brief cos
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] theta theta, |theta| < 1e4 for the reduced tiers
+ * @return Returns the cos of theta, absolute error
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T cos(T theta) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_cos(theta);
+  } else {
+    T s, c;
+    sincos<P>(theta, s, c);
+    return c;
+  }
+}
+
+/**
+ * @brief tan
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] theta theta, |theta| < 1e4 for the reduced tiers
+ * @return Returns the tan of theta, relative error away from the poles
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T tan(T theta) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_tan(theta);
+  } else {
+    T s, c;
+    sincos<P>(theta, s, c);
+    return s / c;
+  }
+}
+
+/**
+ * @brief exp
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x value, clamped to [exp_min, exp_max] for the reduced tiers
+ * @return Returns e raised to x, relative error. NaN if x is NaN
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T exp(T x) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_exp(x);
+  } else {
+    using traits   = float_traits<T>;
+    // NaN passes every clamp and its k would not convert, reduce 0 instead and return it as is below
+    const bool nan = x != x;
+    const T c      = select(nan, static_cast<T>(0), select(x < traits::exp_min, traits::exp_min, select(x > traits::exp_max, traits::exp_max, x)));
+    const T k      = round_nearest(c * std::numbers::log2e_v<T>);
+    const T r      = (c - k * traits::ln2_hi) - k * traits::ln2_lo;
+    T p;
+    if constexpr (P == precision::medium) {
+      // |r| <= ln2/2, truncation error r^5/5! = 4.2e-5
+      p = 1 + r * (1 + r * (static_cast<T>(1. / 2) + r * (static_cast<T>(1. / 6) + r * static_cast<T>(1. / 24))));
+    } else {
+      // truncation error r^4/4! = 6.0e-4
+      p = 1 + r * (1 + r * (static_cast<T>(1. / 2) + r * static_cast<T>(1. / 6)));
+    }
+    const auto e = static_cast<typename traits::bits_type>(static_cast<std::int32_t>(k) + traits::bias);
+    return select(nan, x, p * std::bit_cast<T>(static_cast<typename traits::bits_type>(e << traits::mantissa)));
+  }
+}
+
+/**
+ * @brief natural logarithm
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x value
+ * @return Returns log(x), absolute error. -inf if x == 0, NaN if x < 0 or x is NaN
+ *
+ * @pre x is not subnormal for the reduced tiers
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T log(T x) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_log(x);
+  } else {
+    using traits             = float_traits<T>;
+    using bits_type          = typename traits::bits_type;
+    constexpr bits_type frac = (bits_type{1} << traits::mantissa) - 1;
+    const auto bits          = std::bit_cast<bits_type>(x);
+    // x = m * 2^e, m in [sqrt(1/2), sqrt(2)), split on the bits
+    const bool big = (bits & frac) > (std::bit_cast<bits_type>(std::numbers::sqrt2_v<T>) & frac);
+    const T e      = static_cast<T>(static_cast<std::int32_t>(bits >> traits::mantissa) - traits::bias + big);
+    const T m      = std::bit_cast<T>(static_cast<bits_type>(((bits & frac) | std::bit_cast<bits_type>(static_cast<T>(1))) - (static_cast<bits_type>(big) << traits::mantissa)));
+    // log(m) = 2 atanh(s), |s| <= 0.172
+    const T s  = (m - 1) / (m + 1);
+    const T s2 = s * s;
+    T p;
+    if constexpr (P == precision::medium) {
+      // truncation error 2 s^7 / 7 = 1.3e-6
+      p = 2 * s * (1 + s2 * (static_cast<T>(1. / 3) + s2 * static_cast<T>(1. / 5)));
+    } else {
+      // truncation error 2 s^5 / 5 = 6.0e-5
+      p = 2 * s * (1 + s2 * static_cast<T>(1. / 3));
+    }
+    const T res     = e * std::numbers::ln2_v<T> + p;
+    const T special = select(x == 0, -std::numeric_limits<T>::infinity(), std::numeric_limits<T>::quiet_NaN());
+    return select(x > 0 || x != x, select(x == std::numeric_limits<T>::infinity() || x != x, x, res), special);
+  }
+}
+
+/**
+ * @brief power
+ *
+ * Computed as exp(y log(x)), the error of the reduced tiers grows with |y log(x)|.
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x base
+ * @param[in] y exponent
+ * @return Returns x raised to y
+ *
+ * @pre x >= 0 for the reduced tiers
+ */
+template <precision P = precision::medium, std::floating_point T>
+[[nodiscard]] constexpr T pow(T x, T y) noexcept {
+  if constexpr (P == precision::high) {
+    return slow_pow(x, y);
+  } else {
+    // 0^y as the high tier: 1 for y = 0, +inf for y < 0, 0 for y > 0
+    const T zero = select(y == 0, static_cast<T>(1), select(y < 0, std::numeric_limits<T>::infinity(), static_cast<T>(0)));
+    return select(x == 0, zero, exp<P>(y * log<P>(x)));
+  }
+}
+
+/**
+ * @brief reciprocal square root of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void rsqrt(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = rsqrt<P>(src[i]);
+}
+
+/**
+ * @brief reciprocal square root of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> rsqrt(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = rsqrt<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief square root of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void sqrt(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = sqrt<P>(src[i]);
+}
+
+/**
+ * @brief square root of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> sqrt(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = sqrt<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief sin of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void sin(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = sin<P>(src[i]);
+}
+
+/**
+ * @brief sin of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> sin(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = sin<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief cos of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void cos(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = cos<P>(src[i]);
+}
+
+/**
+ * @brief cos of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> cos(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = cos<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief tan of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void tan(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = tan<P>(src[i]);
+}
+
+/**
+ * @brief tan of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> tan(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = tan<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief exp of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void exp(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = exp<P>(src[i]);
+}
+
+/**
+ * @brief exp of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> exp(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = exp<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief natural logarithm of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] dst destination, may be the same memory as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void log(std::span<const T> src, std::span<T> dst) {
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    dst[i] = log<P>(src[i]);
+}
+
+/**
+ * @brief natural logarithm of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> log(const fs_vector<T, N> &vec) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = log<P>(vec[i]);
+  return res;
+}
+
+/**
+ * @brief sin and cos of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] src source
+ * @param[out] s sin destination
+ * @param[out] c cos destination
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <precision P = precision::medium, std::floating_point T>
+void sincos(std::span<const T> src, std::span<T> s, std::span<T> c) {
+  if (src.size() != s.size() || src.size() != c.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < src.size(); ++i)
+    sincos<P>(src[i], s[i], c[i]);
+}
+
+/**
+ * @brief sin and cos of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] vec vector
+ * @param[out] s sin of each element
+ * @param[out] c cos of each element
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+constexpr void sincos(const fs_vector<T, N> &vec, fs_vector<T, N> &s, fs_vector<T, N> &c) noexcept {
+  for (std::size_t i = 0; i < N; ++i)
+    sincos<P>(vec[i], s[i], c[i]);
+}
+
+/**
+ * @brief power of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x bases
+ * @param[in] y exponents
+ * @param[out] dst destination, may be the same memory as x or y
+ *
+ * @exception std::invalid_argument if the span sizes vary
+ */
+template <precision P = precision::medium, std::floating_point T>
+void pow(std::span<const T> x, std::span<const T> y, std::span<T> dst) {
+  if (x.size() != dst.size() || y.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < dst.size(); ++i)
+    dst[i] = pow<P>(x[i], y[i]);
+}
+
+/**
+ * @brief power of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @param[in] x bases
+ * @param[in] y exponent
+ * @param[out] dst destination, may be the same memory as x
+ *
+ * @exception std::invalid_argument if x.size() != dst.size()
+ */
+template <precision P = precision::medium, std::floating_point T>
+void pow(std::span<const T> x, std::type_identity_t<T> y, std::span<T> dst) {
+  if (x.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+  for (std::size_t i = 0; i < dst.size(); ++i)
+    dst[i] = pow<P>(x[i], y);
+}
+
+/**
+ * @brief power of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] x bases
+ * @param[in] y exponents
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> pow(const fs_vector<T, N> &x, const fs_vector<T, N> &y) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = pow<P>(x[i], y[i]);
+  return res;
+}
+
+/**
+ * @brief power of each element
+ *
+ * @tparam P precision
+ * @tparam T floating-point type
+ * @tparam N size
+ * @param[in] x bases
+ * @param[in] y exponent
+ * @return vector
+ */
+template <precision P = precision::medium, std::floating_point T, std::size_t N>
+[[nodiscard]] constexpr fs_vector<T, N> pow(const fs_vector<T, N> &x, const T &y) noexcept {
+  fs_vector<T, N> res;
+  for (std::size_t i = 0; i < N; ++i)
+    res[i] = pow<P>(x[i], y);
+  return res;
+}
+} // namespace portal::math::fast
+
+#endif // PORTAL_MATH_FAST_HPP
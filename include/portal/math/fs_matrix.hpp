@@ -0,0 +1,587 @@
+/**
+ * @file fs_matrix.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief fix size matrix
+ * @version 0.1
+ * @date 2022-04-05
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_FS_MATRIX_HPP
+#define PORTAL_MATH_FS_MATRIX_HPP
+
+#include "fs_vector.hpp"
+#include <span>
+#include <type_traits>
+
+namespace portal::math {
+/**
+ * @brief fix size matrix
+ *
+ * Row-major, each row is an fs_vector so that row operations use the simd kernels.
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ */
+template <typename T, std::size_t R, std::size_t C>
+class fs_matrix {
+public:
+  using value_type = T;               //!< @brief value type
+  using size_type  = std::size_t;     //!< @brief size type
+  using row_type   = fs_vector<T, C>; //!< @brief row type
+
+  /**
+   * @brief default constructor (zero matrix)
+   *
+   */
+  constexpr fs_matrix() noexcept = default;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] rows rows
+   *
+   * @pre sizeof...(rows) <= R
+   */
+  constexpr fs_matrix(const std::convertible_to<row_type> auto &...rows) noexcept
+      : m_row{static_cast<row_type>(rows)...} {
+  }
+
+  /**
+   * @brief identity matrix
+   *
+   * @return Returns the identity matrix
+   */
+  [[nodiscard]] static constexpr fs_matrix identity() noexcept {
+    fs_matrix res;
+    for (size_type i = 0; i < std::min(R, C); ++i)
+      res.m_row[i][i] = 1;
+    return res;
+  }
+
+  /**
+   * @brief access specified row
+   *
+   * @param[in] row row
+   * @return Reference to the requested row.
+   *
+   * @pre row < rows()
+   */
+  [[nodiscard]] constexpr row_type &operator[](size_type row) noexcept {
+    assert(row < rows());
+    return m_row[row];
+  }
+
+  /**
+   * @brief access specified row
+   *
+   * @param[in] row row
+   * @return Reference to the requested row.
+   *
+   * @pre row < rows()
+   */
+  [[nodiscard]] constexpr const row_type &operator[](size_type row) const noexcept {
+    assert(row < rows());
+    return m_row[row];
+  }
+
+  /**
+   * @brief access specified element
+   *
+   * @param[in] row row
+   * @param[in] col column
+   * @return Reference to the requested element.
+   *
+   * @pre row < rows() && col < cols()
+   */
+  [[nodiscard]] constexpr T &operator()(size_type row, size_type col) noexcept {
+    assert(row < rows());
+    assert(col < cols());
+    return m_row[row][col];
+  }
+
+  /**
+   * @brief access specified element
+   *
+   * @param[in] row row
+   * @param[in] col column
+   * @return Reference to the requested element.
+   *
+   * @pre row < rows() && col < cols()
+   */
+  [[nodiscard]] constexpr const T &operator()(size_type row, size_type col) const noexcept {
+    assert(row < rows());
+    assert(col < cols());
+    return m_row[row][col];
+  }
+
+  /**
+   * @brief access specified element with bounds checking
+   *
+   * @param[in] row row
+   * @param[in] col column
+   * @return Reference to the requested element.
+   *
+   * @exception std::out_of_range if row >= rows() || col >= cols()
+   */
+  [[nodiscard]] constexpr T &at(size_type row, size_type col) {
+    if (row >= rows() || col >= cols())
+      throw std::out_of_range("out of range");
+    return m_row[row][col];
+  }
+
+  /**
+   * @brief access specified element with bounds checking
+   *
+   * @param[in] row row
+   * @param[in] col column
+   * @return Reference to the requested element.
+   *
+   * @exception std::out_of_range if row >= rows() || col >= cols()
+   */
+  [[nodiscard]] constexpr const T &at(size_type row, size_type col) const {
+    if (row >= rows() || col >= cols())
+      throw std::out_of_range("out of range");
+    return m_row[row][col];
+  }
+
+  /**
+   * @brief number of rows
+   *
+   * @return R
+   */
+  [[nodiscard]] constexpr size_type rows() const noexcept {
+    return R;
+  }
+
+  /**
+   * @brief number of columns
+   *
+   * @return C
+   */
+  [[nodiscard]] constexpr size_type cols() const noexcept {
+    return C;
+  }
+
+  /**
+   * @brief addition assignment operator
+   *
+   * @param[in] mat matrix
+   * @return *this
+   */
+  constexpr fs_matrix &operator+=(const fs_matrix &mat) noexcept {
+    for (size_type i = 0; i < R; ++i)
+      m_row[i] += mat.m_row[i];
+    return *this;
+  }
+
+  /**
+   * @brief subtraction assignment operator
+   *
+   * @param[in] mat matrix
+   * @return *this
+   */
+  constexpr fs_matrix &operator-=(const fs_matrix &mat) noexcept {
+    for (size_type i = 0; i < R; ++i)
+      m_row[i] -= mat.m_row[i];
+    return *this;
+  }
+
+  /**
+   * @brief multiplication assignment operator
+   *
+   * @param[in] scal scalar
+   * @return *this
+   */
+  constexpr fs_matrix &operator*=(const T &scal) noexcept {
+    for (auto &row : m_row)
+      row *= scal;
+    return *this;
+  }
+
+private:
+  row_type m_row[R > 0 ? R : 1] = {};
+};
+
+/**
+ * @brief addition
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs matrix
+ * @return Returns the result of adding lhs and rhs.
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, R, C> operator+(const fs_matrix<T, R, C> &lhs, const fs_matrix<T, R, C> &rhs) noexcept {
+  return fs_matrix<T, R, C>(lhs) += rhs;
+}
+
+/**
+ * @brief subtraction
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs matrix
+ * @return Returns the result of subtracting lhs and rhs.
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, R, C> operator-(const fs_matrix<T, R, C> &lhs, const fs_matrix<T, R, C> &rhs) noexcept {
+  return fs_matrix<T, R, C>(lhs) -= rhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs scalar
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, R, C> operator*(const fs_matrix<T, R, C> &lhs, const T &rhs) noexcept {
+  return fs_matrix<T, R, C>(lhs) *= rhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs scalar
+ * @param[in] rhs matrix
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, R, C> operator*(const T &lhs, const fs_matrix<T, R, C> &rhs) noexcept {
+  return fs_matrix<T, R, C>(rhs) *= lhs;
+}
+
+/**
+ * @brief product of a matrix and a vector
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs vector
+ * @return Returns lhs * rhs
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_vector<T, R> operator*(const fs_matrix<T, R, C> &lhs, const fs_vector<T, C> &rhs) noexcept {
+  fs_vector<T, R> res;
+  for (std::size_t i = 0; i < R; ++i)
+    res[i] = dot(lhs[i], rhs);
+  return res;
+}
+
+/**
+ * @brief product of two matrices
+ *
+ * Each row of the result accumulates scaled rows of rhs, so the inner loop
+ * runs over contiguous columns.
+ *
+ * @tparam T type
+ * @tparam R rows of lhs
+ * @tparam K columns of lhs and rows of rhs
+ * @tparam C columns of rhs
+ * @param[in] lhs matrix
+ * @param[in] rhs matrix
+ * @return Returns lhs * rhs
+ */
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, R, C> operator*(const fs_matrix<T, R, K> &lhs, const fs_matrix<T, K, C> &rhs) noexcept {
+  fs_matrix<T, R, C> res;
+  for (std::size_t i = 0; i < R; ++i)
+    for (std::size_t k = 0; k < K; ++k)
+      res[i] += rhs[k] * lhs(i, k);
+  return res;
+}
+
+/**
+ * @brief Compare
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs matrix
+ * @return true lhs and rhs are the same value
+ * @return false lhs and rhs are different values.
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr bool operator==(const fs_matrix<T, R, C> &lhs, const fs_matrix<T, R, C> &rhs) noexcept {
+  for (std::size_t i = 0; i < R; ++i)
+    if (lhs[i] != rhs[i])
+      return false;
+  return true;
+}
+
+/**
+ * @brief Compare
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] lhs matrix
+ * @param[in] rhs matrix
+ * @return true lhs and rhs are different values.
+ * @return false lhs and rhs are the same value
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr bool operator!=(const fs_matrix<T, R, C> &lhs, const fs_matrix<T, R, C> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief transpose
+ *
+ * @tparam T type
+ * @tparam R rows
+ * @tparam C columns
+ * @param[in] mat matrix
+ * @return Returns the transposed matrix
+ */
+template <typename T, std::size_t R, std::size_t C>
+[[nodiscard]] constexpr fs_matrix<T, C, R> transpose(const fs_matrix<T, R, C> &mat) noexcept {
+  fs_matrix<T, C, R> res;
+  for (std::size_t i = 0; i < R; ++i)
+    for (std::size_t j = 0; j < C; ++j)
+      res(j, i) = mat(i, j);
+  return res;
+}
+
+/**
+ * @brief determinant
+ *
+ * @tparam T type
+ * @param[in] m matrix
+ * @return Returns the determinant of m
+ */
+template <typename T>
+[[nodiscard]] constexpr T determinant(const fs_matrix<T, 2, 2> &m) noexcept {
+  return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+}
+
+/**
+ * @brief determinant
+ *
+ * @tparam T type
+ * @param[in] m matrix
+ * @return Returns the determinant of m
+ */
+template <typename T>
+[[nodiscard]] constexpr T determinant(const fs_matrix<T, 3, 3> &m) noexcept {
+  return dot(m[0], cross(m[1], m[2]));
+}
+
+/**
+ * @brief determinant
+ *
+ * @tparam T type
+ * @param[in] m matrix
+ * @return Returns the determinant of m
+ */
+template <typename T>
+[[nodiscard]] constexpr T determinant(const fs_matrix<T, 4, 4> &m) noexcept {
+  const T s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+  const T s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+  const T s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+  const T s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+  const T s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+  const T s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+  const T c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+  const T c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+  const T c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+  const T c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+  const T c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+  const T c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+  return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+/**
+ * @brief inverse
+ *
+ * @tparam T floating-point type
+ * @param[in] m matrix
+ * @return Returns the inverse of m
+ *
+ * @exception std::domain_error if m is singular
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr fs_matrix<T, 3, 3> inverse(const fs_matrix<T, 3, 3> &m) {
+  const T det = determinant(m);
+  if (det == 0)
+    throw std::domain_error("singular matrix");
+  // columns of the inverse are the cross products of the rows
+  return transpose(fs_matrix<T, 3, 3>{
+                       cross(m[1], m[2]),
+                       cross(m[2], m[0]),
+                       cross(m[0], m[1])}) *
+         (1 / det);
+}
+
+/**
+ * @brief inverse
+ *
+ * @tparam T floating-point type
+ * @param[in] m matrix
+ * @return Returns the inverse of m
+ *
+ * @exception std::domain_error if m is singular
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr fs_matrix<T, 4, 4> inverse(const fs_matrix<T, 4, 4> &m) {
+  // Laplace expansion by 2x2 minors of the upper and lower row pairs
+  const T s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+  const T s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+  const T s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+  const T s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+  const T s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+  const T s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+  const T c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+  const T c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+  const T c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+  const T c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+  const T c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+  const T c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+
+  const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  if (det == 0)
+    throw std::domain_error("singular matrix");
+
+  // clang-format off
+  return fs_matrix<T, 4, 4>{
+    fs_vector<T, 4>{ m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3,
+                    -m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3,
+                     m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3,
+                    -m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3},
+    fs_vector<T, 4>{-m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1,
+                     m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1,
+                    -m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1,
+                     m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1},
+    fs_vector<T, 4>{ m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0,
+                    -m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0,
+                     m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0,
+                    -m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0},
+    fs_vector<T, 4>{-m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0,
+                     m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0,
+                    -m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0,
+                     m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0}} *
+         (1 / det);
+  // clang-format on
+}
+
+/**
+ * @brief lane count of the batched transforms
+ *
+ * @tparam T type
+ */
+template <typename T>
+inline constexpr std::size_t transform_block_v = 32 / sizeof(T);
+
+/**
+ * @brief affine transform of a span of vectors
+ *
+ * dst[i] = linear * src[i] + offset, evaluated transform_block_v<T> vectors at a time in SoA layout.
+ *
+ * @tparam T type
+ * @param[in] linear linear part
+ * @param[in] offset translation
+ * @param[in] src source vectors
+ * @param[out] dst destination vectors, may be the same span as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <typename T>
+void transform_affine(const fs_matrix<T, 3, 3> &linear,
+                      const fs_vector<T, 3> &offset,
+                      std::type_identity_t<std::span<const fs_vector<T, 3>>> src,
+                      std::type_identity_t<std::span<fs_vector<T, 3>>> dst) {
+  constexpr std::size_t W = transform_block_v<T>;
+  if (src.size() != dst.size())
+    throw std::invalid_argument("span sizes vary");
+
+  // local copies, so that stores to dst cannot alias the coefficients
+  const fs_matrix<T, 3, 3> m = linear;
+  const fs_vector<T, 3> t    = offset;
+
+  const auto block = [&](std::size_t i, std::size_t count) {
+    T in[3][W] = {};
+    T out[3][W];
+    for (std::size_t w = 0; w < count; ++w)
+      for (std::size_t c = 0; c < 3; ++c)
+        in[c][w] = src[i + w][c];
+    for (std::size_t r = 0; r < 3; ++r)
+      for (std::size_t w = 0; w < W; ++w)
+        out[r][w] = m(r, 0) * in[0][w] + m(r, 1) * in[1][w] + m(r, 2) * in[2][w] + t[r];
+    for (std::size_t w = 0; w < count; ++w)
+      for (std::size_t c = 0; c < 3; ++c)
+        dst[i + w][c] = out[c][w];
+  };
+
+  std::size_t i = 0;
+  for (; i + W <= src.size(); i += W)
+    block(i, W); // constant count, inlined and fully unrolled
+  if (i < src.size())
+    block(i, src.size() - i);
+}
+
+/**
+ * @brief transform points
+ *
+ * Points are treated as (x, y, z, 1). The last row of m is assumed to be (0, 0, 0, 1).
+ *
+ * @tparam T type
+ * @param[in] m affine transform
+ * @param[in] src source points
+ * @param[out] dst destination points, may be the same span as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ */
+template <typename T>
+void transform_points(const fs_matrix<T, 4, 4> &m,
+                      std::type_identity_t<std::span<const fs_vector<T, 3>>> src,
+                      std::type_identity_t<std::span<fs_vector<T, 3>>> dst) {
+  const fs_matrix<T, 3, 3> linear{
+      fs_vector<T, 3>{m(0, 0), m(0, 1), m(0, 2)},
+      fs_vector<T, 3>{m(1, 0), m(1, 1), m(1, 2)},
+      fs_vector<T, 3>{m(2, 0), m(2, 1), m(2, 2)}};
+  transform_affine(linear, fs_vector<T, 3>{m(0, 3), m(1, 3), m(2, 3)}, src, dst);
+}
+
+/**
+ * @brief transform normals
+ *
+ * Normals are multiplied by the inverse transpose of the upper 3x3 of m and are not renormalized.
+ *
+ * @tparam T floating-point type
+ * @param[in] m affine transform
+ * @param[in] src source normals
+ * @param[out] dst destination normals, may be the same span as src
+ *
+ * @exception std::invalid_argument if src.size() != dst.size()
+ * @exception std::domain_error if the upper 3x3 of m is singular
+ */
+template <std::floating_point T>
+void transform_normals(const fs_matrix<T, 4, 4> &m,
+                       std::type_identity_t<std::span<const fs_vector<T, 3>>> src,
+                       std::type_identity_t<std::span<fs_vector<T, 3>>> dst) {
+  const fs_matrix<T, 3, 3> linear{
+      fs_vector<T, 3>{m(0, 0), m(0, 1), m(0, 2)},
+      fs_vector<T, 3>{m(1, 0), m(1, 1), m(1, 2)},
+      fs_vector<T, 3>{m(2, 0), m(2, 1), m(2, 2)}};
+  transform_affine(transpose(inverse(linear)), fs_vector<T, 3>{}, src, dst);
+}
+
+} // namespace portal::math
+
+#endif // PORTAL_MATH_FS_MATRIX_HPP
@@ -12,6 +12,7 @@
 #define PORTAL_MATH_FS_VECTOR_HPP
 
 #include "math.hpp"
+#include "simd.hpp"
 #include "../random.hpp"
 
 namespace portal::math {
@@ -25,7 +26,13 @@ namespace tag {
  *
  */
 struct fill_t {
-} fill;
+};
+
+/**
+ * @brief fill tag object
+ *
+ */
+inline constexpr fill_t fill{};
 } // namespace tag
 
 /**
@@ -392,6 +399,12 @@ public:
    * @return *this
    */
   constexpr fs_vector &operator+=(const fs_vector &vec) noexcept {
+    if constexpr (simd::enabled_v<T, N>) {
+      if (!std::is_constant_evaluated()) {
+        simd::add<T, N>(m_elem, vec.m_elem);
+        return *this;
+      }
+    }
     for (size_type index = 0; index < size(); ++index)
       m_elem[index] += vec[index];
     return *this;
@@ -420,6 +433,12 @@ public:
    * @return *this
    */
   constexpr fs_vector &operator-=(const fs_vector &vec) noexcept {
+    if constexpr (simd::enabled_v<T, N>) {
+      if (!std::is_constant_evaluated()) {
+        simd::sub<T, N>(m_elem, vec.m_elem);
+        return *this;
+      }
+    }
     for (size_type index = 0; index < size(); ++index)
       m_elem[index] -= vec[index];
     return *this;
@@ -437,7 +456,7 @@ public:
     if (size() != vec.size())
       throw std::invalid_argument("vector sizes vary");
     for (size_type index = 0; index < size(); ++index)
-      m_elem[index] += vec[index];
+      m_elem[index] -= vec[index];
     return *this;
   }
 
@@ -449,6 +468,12 @@ public:
    * @return *this
    */
   constexpr fs_vector &operator*=(const T &scal) noexcept {
+    if constexpr (simd::enabled_v<T, N>) {
+      if (!std::is_constant_evaluated()) {
+        simd::scale<T, N>(m_elem, scal);
+        return *this;
+      }
+    }
     for (auto &ptr : m_elem)
       ptr *= scal;
     return *this;
@@ -462,6 +487,12 @@ public:
    */
   constexpr fs_vector &operator/=(const T &scal) noexcept {
     assert(!is_zero(scal));
+    if constexpr (simd::enabled_v<T, N>) {
+      if (!std::is_constant_evaluated()) {
+        simd::divide<T, N>(m_elem, scal);
+        return *this;
+      }
+    }
     for (auto &ptr : m_elem)
       ptr /= scal;
     return *this;
@@ -500,7 +531,7 @@ public:
   }
 
 private:
-  value_type m_elem[N > 0 ? N : 1] = {};
+  alignas(simd::alignment_v<T, N>) value_type m_elem[N > 0 ? N : 1] = {};
 };
 
 /**
@@ -624,6 +655,12 @@ template <typename T, std::size_t N>
 template <typename T, std::size_t N>
 [[nodiscard]] constexpr fs_vector<T, N> mul_peram(const fs_vector<T, N> &lhs, const fs_vector<T, N> &rhs) noexcept {
   fs_vector<T, N> res(lhs);
+  if constexpr (simd::enabled_v<T, N>) {
+    if (!std::is_constant_evaluated()) {
+      simd::mul<T, N>(res.data(), rhs.data());
+      return res;
+    }
+  }
   for (size_t i = 0; i < N; ++i)
     res[i] *= rhs[i];
   return res;
@@ -660,8 +697,14 @@ template <typename T, std::size_t N>
 template <typename T, std::size_t N>
 [[nodiscard]] constexpr fs_vector<T, N> max_peram(const fs_vector<T, N> &lhs, const fs_vector<T, N> &rhs) noexcept {
   fs_vector<T, N> res(lhs);
+  if constexpr (simd::enabled_v<T, N>) {
+    if (!std::is_constant_evaluated()) {
+      simd::max<T, N>(res.data(), rhs.data());
+      return res;
+    }
+  }
   for (size_t i = 0; i < N; ++i)
-    res[i] *= std::max<T>(res[i], rhs[i]);
+    res[i] = std::max<T>(res[i], rhs[i]);
   return res;
 }
 
@@ -696,8 +739,14 @@ template <typename T, std::size_t N>
 template <typename T, std::size_t N>
 [[nodiscard]] constexpr fs_vector<T, N> min_peram(const fs_vector<T, N> &lhs, const fs_vector<T, N> &rhs) noexcept {
   fs_vector<T, N> res(lhs);
+  if constexpr (simd::enabled_v<T, N>) {
+    if (!std::is_constant_evaluated()) {
+      simd::min<T, N>(res.data(), rhs.data());
+      return res;
+    }
+  }
   for (size_t i = 0; i < N; ++i)
-    res[i] *= std::min<T>(res[i], rhs[i]);
+    res[i] = std::min<T>(res[i], rhs[i]);
   return res;
 }
 
@@ -731,6 +780,10 @@ template <typename T, std::size_t N>
  */
 template <typename T, std::size_t N>
 [[nodiscard]] constexpr T dot(const fs_vector<T, N> &lhs, const fs_vector<T, N> &rhs) noexcept {
+  if constexpr (simd::enabled_v<T, N>) {
+    if (!std::is_constant_evaluated())
+      return simd::dot<T, N>(lhs.data(), rhs.data());
+  }
   T res = {};
   for (std::size_t i = 0; i < N; ++i)
     res += lhs[i] * rhs[i];
@@ -0,0 +1,399 @@
+/**
+ * @file fs_vector_expr.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief lazy element-wise vector expressions
+ * @version 0.1
+ * @date 2022-04-04
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_FS_VECTOR_EXPR_HPP
+#define PORTAL_MATH_FS_VECTOR_EXPR_HPP
+
+#include "fs_vector.hpp"
+#include <functional>
+#include <type_traits>
+
+/**
+ * @brief expression namespace
+ *
+ * A chain started with lazy() builds a tree of element-wise operations.
+ * Nothing is computed until the tree is assigned to a vector, which then
+ * runs a single loop over the elements.
+ *
+ * @code
+ * fs_vector<double, 16> r;
+ * r = lazy(a) + lazy(b) * s - c; // one loop, no temporaries
+ * @endcode
+ *
+ * Vector operands are held by reference, the expression must be evaluated
+ * before they are destroyed.
+ */
+namespace portal::math::expr {
+/**
+ * @brief vector expression concept
+ *
+ * @tparam T type
+ */
+template <typename T>
+concept vector_expression = vector_class<T> && requires {
+  requires T::is_vector_expression;
+};
+
+/**
+ * @brief how an operand is held in a node
+ *
+ * @tparam V operand type
+ */
+template <typename V>
+using operand_t = std::conditional_t<vector_expression<V>, const V, const V &>;
+
+/**
+ * @brief common typedefs of expression nodes
+ *
+ * @tparam T value type
+ */
+template <typename T>
+struct node_base {
+  static constexpr bool is_vector_expression = true; //!< @brief expression marker
+
+  using value_type      = T;           //!< @brief value type
+  using pointer         = const T *;   //!< @brief pointer
+  using const_pointer   = const T *;   //!< @brief const pointer
+  using reference       = T;           //!< @brief reference (elements are computed)
+  using const_reference = T;           //!< @brief const reference (elements are computed)
+  using size_type       = std::size_t; //!< @brief size type
+};
+
+/**
+ * @brief leaf referring to a vector
+ *
+ * @tparam V vector type
+ */
+template <vector_class V>
+class ref : public node_base<typename V::value_type> {
+public:
+  using typename node_base<typename V::value_type>::value_type;
+  using typename node_base<typename V::value_type>::size_type;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] vec vector
+   */
+  constexpr explicit ref(const V &vec) noexcept
+      : m_vec(vec) {
+  }
+
+  /**
+   * @brief element
+   *
+   * @param[in] pos position
+   * @return element
+   */
+  [[nodiscard]] constexpr value_type operator[](size_type pos) const {
+    return m_vec[pos];
+  }
+
+  /**
+   * @brief size
+   *
+   * @return number of elements
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return m_vec.size();
+  }
+
+private:
+  const V &m_vec;
+};
+
+/**
+ * @brief element-wise unary operation
+ *
+ * @tparam E operand
+ * @tparam Op operation
+ */
+template <vector_class E, typename Op>
+class unary : public node_base<typename E::value_type> {
+public:
+  using typename node_base<typename E::value_type>::value_type;
+  using typename node_base<typename E::value_type>::size_type;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] vec operand
+   */
+  constexpr explicit unary(const E &vec) noexcept
+      : m_vec(vec) {
+  }
+
+  /**
+   * @brief element
+   *
+   * @param[in] pos position
+   * @return element
+   */
+  [[nodiscard]] constexpr value_type operator[](size_type pos) const {
+    return Op{}(m_vec[pos]);
+  }
+
+  /**
+   * @brief size
+   *
+   * @return number of elements
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return m_vec.size();
+  }
+
+private:
+  operand_t<E> m_vec;
+};
+
+/**
+ * @brief element-wise binary operation
+ *
+ * @tparam L left operand
+ * @tparam R right operand
+ * @tparam Op operation
+ */
+template <vector_class L, vector_class R, typename Op>
+class binary : public node_base<typename L::value_type> {
+public:
+  using typename node_base<typename L::value_type>::value_type;
+  using typename node_base<typename L::value_type>::size_type;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] lhs left operand
+   * @param[in] rhs right operand
+   *
+   * @exception std::invalid_argument if lhs.size() != rhs.size()
+   */
+  constexpr binary(const L &lhs, const R &rhs)
+      : m_lhs(lhs)
+      , m_rhs(rhs) {
+    if (m_lhs.size() != m_rhs.size())
+      throw std::invalid_argument("vector sizes vary");
+  }
+
+  /**
+   * @brief element
+   *
+   * @param[in] pos position
+   * @return element
+   */
+  [[nodiscard]] constexpr value_type operator[](size_type pos) const {
+    return Op{}(static_cast<value_type>(m_lhs[pos]), static_cast<value_type>(m_rhs[pos]));
+  }
+
+  /**
+   * @brief size
+   *
+   * @return number of elements
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return m_lhs.size();
+  }
+
+private:
+  operand_t<L> m_lhs;
+  operand_t<R> m_rhs;
+};
+
+/**
+ * @brief element-wise operation with a scalar
+ *
+ * @tparam E vector operand
+ * @tparam Op operation, called as Op{}(element, scalar)
+ */
+template <vector_class E, typename Op>
+class scalar : public node_base<typename E::value_type> {
+public:
+  using typename node_base<typename E::value_type>::value_type;
+  using typename node_base<typename E::value_type>::size_type;
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] vec vector operand
+   * @param[in] scal scalar operand
+   */
+  constexpr scalar(const E &vec, const value_type &scal) noexcept
+      : m_vec(vec)
+      , m_scal(scal) {
+  }
+
+  /**
+   * @brief element
+   *
+   * @param[in] pos position
+   * @return element
+   */
+  [[nodiscard]] constexpr value_type operator[](size_type pos) const {
+    return Op{}(static_cast<value_type>(m_vec[pos]), m_scal);
+  }
+
+  /**
+   * @brief size
+   *
+   * @return number of elements
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return m_vec.size();
+  }
+
+private:
+  operand_t<E> m_vec;
+  value_type m_scal;
+};
+
+/**
+ * @brief larger of two values
+ *
+ */
+struct max_op {
+  template <typename T>
+  [[nodiscard]] constexpr T operator()(const T &lhs, const T &rhs) const {
+    return std::max<T>(lhs, rhs);
+  }
+};
+
+/**
+ * @brief smaller of two values
+ *
+ */
+struct min_op {
+  template <typename T>
+  [[nodiscard]] constexpr T operator()(const T &lhs, const T &rhs) const {
+    return std::min<T>(lhs, rhs);
+  }
+};
+
+/**
+ * @brief addition
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs vector or expression
+ * @return lazy expression of lhs + rhs
+ */
+template <vector_expression L, vector_class R>
+[[nodiscard]] constexpr auto operator+(const L &lhs, const R &rhs) {
+  return binary<L, R, std::plus<>>(lhs, rhs);
+}
+
+/**
+ * @brief subtraction
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs vector or expression
+ * @return lazy expression of lhs - rhs
+ */
+template <vector_expression L, vector_class R>
+[[nodiscard]] constexpr auto operator-(const L &lhs, const R &rhs) {
+  return binary<L, R, std::minus<>>(lhs, rhs);
+}
+
+/**
+ * @brief multiplication
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs scalar
+ * @return lazy expression of lhs * rhs
+ */
+template <vector_expression E>
+[[nodiscard]] constexpr auto operator*(const E &lhs, const typename E::value_type &rhs) noexcept {
+  return scalar<E, std::multiplies<>>(lhs, rhs);
+}
+
+/**
+ * @brief multiplication
+ *
+ * @param[in] lhs scalar
+ * @param[in] rhs expression
+ * @return lazy expression of lhs * rhs
+ */
+template <vector_expression E>
+[[nodiscard]] constexpr auto operator*(const typename E::value_type &lhs, const E &rhs) noexcept {
+  return scalar<E, std::multiplies<>>(rhs, lhs);
+}
+
+/**
+ * @brief division
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs scalar
+ * @return lazy expression of lhs / rhs
+ */
+template <vector_expression E>
+[[nodiscard]] constexpr auto operator/(const E &lhs, const typename E::value_type &rhs) noexcept {
+  assert(!is_zero(rhs));
+  return scalar<E, std::divides<>>(lhs, rhs);
+}
+
+/**
+ * @brief unary minus
+ *
+ * @param[in] vec expression
+ * @return lazy expression of -vec
+ */
+template <vector_expression E>
+[[nodiscard]] constexpr auto operator-(const E &vec) noexcept {
+  return unary<E, std::negate<>>(vec);
+}
+
+/**
+ * @brief Multiply each element of the vector.
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs vector or expression
+ * @return lazy expression
+ */
+template <vector_expression L, vector_class R>
+[[nodiscard]] constexpr auto mul_peram(const L &lhs, const R &rhs) {
+  return binary<L, R, std::multiplies<>>(lhs, rhs);
+}
+
+/**
+ * @brief Select the larger value of each element of the vector
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs vector or expression
+ * @return lazy expression
+ */
+template <vector_expression L, vector_class R>
+[[nodiscard]] constexpr auto max_peram(const L &lhs, const R &rhs) {
+  return binary<L, R, max_op>(lhs, rhs);
+}
+
+/**
+ * @brief Select a smaller value for each element of the vector
+ *
+ * @param[in] lhs expression
+ * @param[in] rhs vector or expression
+ * @return lazy expression
+ */
+template <vector_expression L, vector_class R>
+[[nodiscard]] constexpr auto min_peram(const L &lhs, const R &rhs) {
+  return binary<L, R, min_op>(lhs, rhs);
+}
+} // namespace portal::math::expr
+
+namespace portal::math {
+/**
+ * @brief start a lazy expression
+ *
+ * @param[in] vec vector
+ * @return expression referring to vec
+ */
+template <vector_class V>
+[[nodiscard]] constexpr expr::ref<V> lazy(const V &vec) noexcept {
+  return expr::ref<V>(vec);
+}
+} // namespace portal::math
+
+#endif // PORTAL_MATH_FS_VECTOR_EXPR_HPP
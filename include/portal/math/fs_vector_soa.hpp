@@ -0,0 +1,600 @@
+/**
+ * @file fs_vector_soa.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief structure of arrays packet of fix size vectors
+ * @version 0.1
+ * @date 2022-04-03
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_FS_VECTOR_SOA_HPP
+#define PORTAL_MATH_FS_VECTOR_SOA_HPP
+
+#include "fs_vector.hpp"
+#include <span>
+
+namespace portal::math {
+/**
+ * @brief packet of W fix size vectors in structure of arrays layout
+ *
+ * Component n of every lane is stored contiguously, so each operation runs
+ * one lane per simd slot.
+ *
+ * @tparam T type
+ * @tparam N size of each vector
+ * @tparam W lane count
+ */
+template <typename T, std::size_t N, std::size_t W>
+class fs_vector_soa {
+public:
+  using value_type     = T;                  //!< @brief value type
+  using size_type      = std::size_t;        //!< @brief size type
+  using vector_type    = fs_vector<T, N>;    //!< @brief vector of one lane
+  using component_type = fs_vector<T, W>;    //!< @brief one component of every lane
+  using mask_type      = fs_vector<bool, W>; //!< @brief lane mask
+
+  /**
+   * @brief default constructor
+   *
+   */
+  constexpr fs_vector_soa() noexcept = default;
+
+  /**
+   * @brief broadcast constructor
+   *
+   * @param[in] vec vector stored to every lane
+   */
+  constexpr explicit fs_vector_soa(const vector_type &vec) noexcept {
+    for (size_type n = 0; n < N; ++n)
+      m_comp[n].fill(vec[n]);
+  }
+
+  /**
+   * @brief load constructor
+   *
+   * @param[in] src vectors
+   *
+   * @exception std::invalid_argument if src.size() > W
+   */
+  constexpr explicit fs_vector_soa(std::span<const vector_type> src) {
+    load(src);
+  }
+
+  /**
+   * @brief load lanes from array of structures
+   *
+   * Lanes without a source vector are set to zero.
+   *
+   * @param[in] src vectors
+   * @return *this
+   *
+   * @exception std::invalid_argument if src.size() > W
+   */
+  constexpr fs_vector_soa &load(std::span<const vector_type> src) {
+    if (src.size() > W)
+      throw std::invalid_argument("too many vectors");
+    for (size_type n = 0; n < N; ++n) {
+      for (size_type w = 0; w < src.size(); ++w)
+        m_comp[n][w] = src[w][n];
+      for (size_type w = src.size(); w < W; ++w)
+        m_comp[n][w] = T{};
+    }
+    return *this;
+  }
+
+  /**
+   * @brief store lanes to array of structures
+   *
+   * Only the first dst.size() lanes are stored.
+   *
+   * @param[out] dst vectors
+   *
+   * @exception std::invalid_argument if dst.size() > W
+   */
+  constexpr void store(std::span<vector_type> dst) const {
+    if (dst.size() > W)
+      throw std::invalid_argument("too many vectors");
+    for (size_type w = 0; w < dst.size(); ++w)
+      dst[w] = lane(w);
+  }
+
+  /**
+   * @brief vector of a lane
+   *
+   * @param[in] w lane
+   * @return Returns the vector stored in lane w
+   *
+   * @pre w < width()
+   */
+  [[nodiscard]] constexpr vector_type lane(size_type w) const noexcept {
+    assert(w < width());
+    vector_type res;
+    for (size_type n = 0; n < N; ++n)
+      res[n] = m_comp[n][w];
+    return res;
+  }
+
+  /**
+   * @brief set the vector of a lane
+   *
+   * @param[in] w lane
+   * @param[in] vec vector
+   * @return *this
+   *
+   * @pre w < width()
+   */
+  constexpr fs_vector_soa &set_lane(size_type w, const vector_type &vec) noexcept {
+    assert(w < width());
+    for (size_type n = 0; n < N; ++n)
+      m_comp[n][w] = vec[n];
+    return *this;
+  }
+
+  /**
+   * @brief access specified component
+   *
+   * @param[in] pos component
+   * @return Reference to the W lanes of the component
+   *
+   * @pre pos < size()
+   */
+  [[nodiscard]] constexpr component_type &operator[](size_type pos) noexcept {
+    assert(pos < size());
+    return m_comp[pos];
+  }
+
+  /**
+   * @brief access specified component
+   *
+   * @param[in] pos component
+   * @return Reference to the W lanes of the component
+   *
+   * @pre pos < size()
+   */
+  [[nodiscard]] constexpr const component_type &operator[](size_type pos) const noexcept {
+    assert(pos < size());
+    return m_comp[pos];
+  }
+
+  /**
+   * @brief returns the number of components
+   *
+   * @return The size of each vector.
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return N;
+  }
+
+  /**
+   * @brief returns the number of lanes
+   *
+   * @return The number of vectors in the packet.
+   */
+  [[nodiscard]] constexpr size_type width() const noexcept {
+    return W;
+  }
+
+  /**
+   * @brief addition assignment operator
+   *
+   * @param[in] vec packet
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator+=(const fs_vector_soa &vec) noexcept {
+    for (size_type n = 0; n < N; ++n)
+      m_comp[n] += vec.m_comp[n];
+    return *this;
+  }
+
+  /**
+   * @brief subtraction assignment operator
+   *
+   * @param[in] vec packet
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator-=(const fs_vector_soa &vec) noexcept {
+    for (size_type n = 0; n < N; ++n)
+      m_comp[n] -= vec.m_comp[n];
+    return *this;
+  }
+
+  /**
+   * @brief multiplication assignment operator
+   *
+   * @param[in] scal scalar
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator*=(const T &scal) noexcept {
+    for (auto &comp : m_comp)
+      comp *= scal;
+    return *this;
+  }
+
+  /**
+   * @brief multiplication assignment operator
+   *
+   * @param[in] scal scalar of each lane
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator*=(const component_type &scal) noexcept {
+    for (auto &comp : m_comp)
+      comp = mul_peram(comp, scal);
+    return *this;
+  }
+
+  /**
+   * @brief division assignment operator
+   *
+   * @param[in] scal scalar
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator/=(const T &scal) noexcept {
+    assert(!is_zero(scal));
+    for (auto &comp : m_comp)
+      comp /= scal;
+    return *this;
+  }
+
+  /**
+   * @brief division assignment operator
+   *
+   * @param[in] vec packet, divides element by element
+   * @return *this
+   */
+  constexpr fs_vector_soa &operator/=(const fs_vector_soa &vec) noexcept {
+    for (size_type n = 0; n < N; ++n) {
+      for (size_type w = 0; w < W; ++w) {
+        assert(!is_zero(vec.m_comp[n][w]));
+        m_comp[n][w] /= vec.m_comp[n][w];
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * @brief unary plus
+   *
+   * @return copy packet
+   */
+  [[nodiscard]] constexpr fs_vector_soa operator+() const noexcept {
+    return *this;
+  }
+
+  /**
+   * @brief unary minus
+   *
+   * @return negated packet
+   */
+  [[nodiscard]] constexpr fs_vector_soa operator-() const noexcept {
+    fs_vector_soa res;
+    for (size_type n = 0; n < N; ++n)
+      res.m_comp[n] = -m_comp[n];
+    return res;
+  }
+
+private:
+  component_type m_comp[N > 0 ? N : 1] = {};
+};
+
+/**
+ * @brief addition
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return Returns the result of adding lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator+(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(lhs) += rhs;
+}
+
+/**
+ * @brief subtraction
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return Returns the result of subtracting lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator-(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(lhs) -= rhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs scalar
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator*(const fs_vector_soa<T, N, W> &lhs, const T &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(lhs) *= rhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs scalar
+ * @param[in] rhs packet
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator*(const T &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(rhs) *= lhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs scalar of each lane
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator*(const fs_vector_soa<T, N, W> &lhs, const fs_vector<T, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(lhs) *= rhs;
+}
+
+/**
+ * @brief multiplication
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs scalar of each lane
+ * @param[in] rhs packet
+ * @return Returns the result of multiplying lhs and rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator*(const fs_vector<T, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(rhs) *= lhs;
+}
+
+/**
+ * @brief division
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs scalar
+ * @return Returns the result of dividing lhs by rhs.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator/(const fs_vector_soa<T, N, W> &lhs, const T &rhs) noexcept {
+  assert(!is_zero(rhs));
+  return fs_vector_soa<T, N, W>(lhs) /= rhs;
+}
+
+/**
+ * @brief division
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return Returns the result of dividing lhs by rhs element by element.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> operator/(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return fs_vector_soa<T, N, W>(lhs) /= rhs;
+}
+
+/**
+ * @brief Compare
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return true lhs and rhs are the same value
+ * @return false lhs and rhs are different values.
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr bool operator==(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  for (std::size_t n = 0; n < N; ++n)
+    if (lhs[n] != rhs[n])
+      return false;
+  return true;
+}
+
+/**
+ * @brief Compare
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return true lhs and rhs are different values.
+ * @return false lhs and rhs are the same value
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr bool operator!=(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief Multiply each element of the packet.
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return packet
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> mul_peram(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  fs_vector_soa<T, N, W> res;
+  for (std::size_t n = 0; n < N; ++n)
+    res[n] = mul_peram(lhs[n], rhs[n]);
+  return res;
+}
+
+/**
+ * @brief Select the larger value of each element of the packet
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return packet
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> max_peram(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  fs_vector_soa<T, N, W> res;
+  for (std::size_t n = 0; n < N; ++n)
+    res[n] = max_peram(lhs[n], rhs[n]);
+  return res;
+}
+
+/**
+ * @brief Select a smaller value for each element of the packet
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return packet
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> min_peram(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  fs_vector_soa<T, N, W> res;
+  for (std::size_t n = 0; n < N; ++n)
+    res[n] = min_peram(lhs[n], rhs[n]);
+  return res;
+}
+
+/**
+ * @brief dot product of each lane
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return Return the dot product of lhs and rhs for each lane
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector<T, W> dot(const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  fs_vector<T, W> res;
+  for (std::size_t n = 0; n < N; ++n)
+    res += mul_peram(lhs[n], rhs[n]);
+  return res;
+}
+
+/**
+ * @brief square of the norm of each lane
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] vec packet
+ * @return Return the square norm of each lane
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector<T, W> sqr_norm(const fs_vector_soa<T, N, W> &vec) noexcept {
+  return dot(vec, vec);
+}
+
+/**
+ * @brief norm of each lane
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] vec packet
+ * @return Return the norm of each lane
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector<T, W> norm(const fs_vector_soa<T, N, W> &vec) noexcept {
+  auto res = sqr_norm(vec);
+  for (auto &p : res)
+    p = slow_sqrt(p);
+  return res;
+}
+
+/**
+ * @brief normalized
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] vec packet
+ * @return Return packet with every lane normalized
+ *
+ * @pre no lane of vec is a zero vector
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> normalized(const fs_vector_soa<T, N, W> &vec) noexcept {
+  auto inv = norm(vec);
+  for (auto &p : inv) {
+    assert(!is_zero(p));
+    p = 1 / p;
+  }
+  return vec * inv;
+}
+
+/**
+ * @brief cross of each lane
+ *
+ * @tparam T type
+ * @tparam W lane count
+ * @param[in] lhs packet
+ * @param[in] rhs packet
+ * @return packet
+ */
+template <typename T, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, 3, W> cross(const fs_vector_soa<T, 3, W> &lhs, const fs_vector_soa<T, 3, W> &rhs) noexcept {
+  fs_vector_soa<T, 3, W> res;
+  res[0] = mul_peram(lhs[1], rhs[2]) - mul_peram(lhs[2], rhs[1]);
+  res[1] = mul_peram(lhs[2], rhs[0]) - mul_peram(lhs[0], rhs[2]);
+  res[2] = mul_peram(lhs[0], rhs[1]) - mul_peram(lhs[1], rhs[0]);
+  return res;
+}
+
+/**
+ * @brief masked select
+ *
+ * @tparam T type
+ * @tparam N size
+ * @tparam W lane count
+ * @param[in] mask lane mask
+ * @param[in] lhs packet selected where mask is true
+ * @param[in] rhs packet selected where mask is false
+ * @return packet
+ */
+template <typename T, std::size_t N, std::size_t W>
+[[nodiscard]] constexpr fs_vector_soa<T, N, W> select(const fs_vector<bool, W> &mask, const fs_vector_soa<T, N, W> &lhs, const fs_vector_soa<T, N, W> &rhs) noexcept {
+  fs_vector_soa<T, N, W> res;
+  for (std::size_t n = 0; n < N; ++n)
+    for (std::size_t w = 0; w < W; ++w)
+      res[n][w] = mask[w] ? lhs[n][w] : rhs[n][w];
+  return res;
+}
+
+} // namespace portal::math
+
+#endif // PORTAL_MATH_FS_VECTOR_SOA_HPP
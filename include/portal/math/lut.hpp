@@ -0,0 +1,260 @@
+/**
+ * @file lut.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief compile-time lookup tables
+ * @version 0.1
+ * @date 2022-04-07
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_LUT_HPP
+#define PORTAL_MATH_LUT_HPP
+
+#include "math.hpp"
+#include "simd.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace portal::math {
+/**
+ * @brief lookup interpolation
+ *
+ */
+enum class interpolation {
+  linear, //!< @brief linear between the two nearest samples
+  cubic   //!< @brief Catmull-Rom through the four nearest samples
+};
+
+/**
+ * @brief lookup table of a unary function
+ *
+ * The table samples the function at N evenly spaced points of [lo, hi]
+ * and keeps the polynomial of each interval, 2 (linear) or 4 (cubic)
+ * coefficients. Built in a constant expression, the samples come from the
+ * constexpr branches of the slow_* functions and end up in static storage.
+ *
+ * @code
+ * static constexpr auto sin_table = make_lut<256>([](double x) { return slow_sin(x); }, 0.0, std::numbers::pi / 2);
+ * double y = sin_table(0.5); // |y - sin(0.5)| <= sin_table.error()
+ * @endcode
+ *
+ * @tparam T floating-point type
+ * @tparam N number of samples
+ * @tparam I interpolation
+ */
+template <std::floating_point T, std::size_t N, interpolation I = interpolation::linear>
+class lut {
+  static_assert(N >= 2, "a lookup table needs two samples at least");
+  static_assert(I != interpolation::cubic || N >= 3, "cubic interpolation needs three samples at least");
+
+public:
+  using value_type = T;           //!< @brief value type
+  using size_type  = std::size_t; //!< @brief size type
+
+  /**
+   * @brief number of coefficients of each interval
+   *
+   */
+  static constexpr size_type order = I == interpolation::linear ? 2 : 4;
+
+  /**
+   * @brief number of points checked inside each interval by the error estimation
+   *
+   */
+  static constexpr size_type checks = 4;
+
+  /**
+   * @brief constructor
+   *
+   * @tparam F function type, invocable with T
+   * @param[in] func function
+   * @param[in] lo lower bound of the range
+   * @param[in] hi upper bound of the range
+   *
+   * @exception std::invalid_argument if !(lo < hi)
+   */
+  template <std::invocable<T> F>
+  constexpr lut(F func, T lo, T hi)
+      : m_lo(lo)
+      , m_hi(hi) {
+    if (!(lo < hi))
+      throw std::invalid_argument("empty range");
+    const T step = (hi - lo) / (N - 1);
+    m_scale      = (N - 1) / (hi - lo);
+
+    // one extra sample at both ends, extrapolated quadratically
+    T p[N + 2] = {};
+    for (size_type i = 0; i < N; ++i)
+      p[i + 1] = static_cast<T>(func(i == N - 1 ? hi : lo + step * i));
+    if constexpr (I == interpolation::cubic) {
+      p[0]     = 3 * p[1] - 3 * p[2] + p[3];
+      p[N + 1] = 3 * p[N] - 3 * p[N - 1] + p[N - 2];
+    }
+
+    for (size_type i = 0; i + 1 < N; ++i) {
+      T *c = m_coef[i];
+      if constexpr (I == interpolation::linear) {
+        c[0] = p[i + 1];
+        c[1] = p[i + 2] - p[i + 1];
+      } else {
+        // Catmull-Rom
+        c[0] = p[i + 1];
+        c[1] = (p[i + 2] - p[i]) / 2;
+        c[2] = (2 * p[i] - 5 * p[i + 1] + 4 * p[i + 2] - p[i + 3]) / 2;
+        c[3] = (-p[i] + 3 * p[i + 1] - 3 * p[i + 2] + p[i + 3]) / 2;
+      }
+    }
+
+    for (size_type i = 0; i + 1 < N; ++i) {
+      for (size_type j = 1; j < checks; ++j) {
+        const T x = lo + step * (i + static_cast<T>(j) / checks);
+        m_error   = std::max(m_error, absolute(static_cast<T>(func(x)) - (*this)(x)));
+      }
+    }
+  }
+
+  /**
+   * @brief lookup
+   *
+   * @param[in] x value, clamped to [lo(), hi()]
+   * @return Returns the interpolated function value
+   */
+  [[nodiscard]] constexpr T operator()(T x) const noexcept {
+    T t          = (x - m_lo) * m_scale;
+    t            = t > 0 ? t : 0;
+    t            = t < N - 1 ? t : N - 1;
+    const auto i = std::min(static_cast<std::int32_t>(t), static_cast<std::int32_t>(N - 2));
+    const T f    = t - static_cast<T>(i);
+    const T *c   = m_coef[i];
+    T res        = c[order - 1];
+    for (size_type k = order - 1; k > 0; --k)
+      res = c[k - 1] + f * res;
+    return res;
+  }
+
+  /**
+   * @brief lookup of many values
+   *
+   * Same as operator() on each value. float tables take four values at once
+   * with SSE2, the coefficients of each interval are one load and a
+   * transpose turns them into a register per coefficient.
+   *
+   * @param[in] x values
+   * @param[out] y interpolated function values, may be x
+   *
+   * @exception std::invalid_argument if the span sizes vary
+   */
+  void operator()(std::span<const T> x, std::span<T> y) const {
+    if (x.size() != y.size())
+      throw std::invalid_argument("span sizes vary");
+    size_type i = 0;
+#if defined(PORTAL_SIMD_SSE2)
+    if constexpr (std::same_as<T, float>) {
+      const __m128 lo    = _mm_set1_ps(m_lo);
+      const __m128 scale = _mm_set1_ps(m_scale);
+      const __m128 last  = _mm_set1_ps(N - 1);
+      const __m128 limit = _mm_set1_ps(N - 2);
+      for (; i + 4 <= x.size(); i += 4) {
+        // with the bound second, max and min return it for NaN like the compares of operator()
+        __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x.data() + i), lo), scale);
+        t        = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), last);
+        alignas(16) std::int32_t k[4];
+        const __m128i index = _mm_cvttps_epi32(_mm_min_ps(t, limit));
+        _mm_store_si128(reinterpret_cast<__m128i *>(k), index);
+        const __m128 f = _mm_sub_ps(t, _mm_cvtepi32_ps(index));
+        __m128 res;
+        if constexpr (order == 4) {
+          __m128 c0 = _mm_loadu_ps(m_coef[k[0]]);
+          __m128 c1 = _mm_loadu_ps(m_coef[k[1]]);
+          __m128 c2 = _mm_loadu_ps(m_coef[k[2]]);
+          __m128 c3 = _mm_loadu_ps(m_coef[k[3]]);
+          _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+          res = _mm_add_ps(c2, _mm_mul_ps(f, c3));
+          res = _mm_add_ps(c1, _mm_mul_ps(f, res));
+          res = _mm_add_ps(c0, _mm_mul_ps(f, res));
+        } else {
+          const auto pair = [this](std::int32_t j) { return reinterpret_cast<const __m64 *>(m_coef[j]); };
+          const __m128 ab = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), pair(k[0])), pair(k[1]));
+          const __m128 cd = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), pair(k[2])), pair(k[3]));
+          res             = _mm_add_ps(_mm_shuffle_ps(ab, cd, _MM_SHUFFLE(2, 0, 2, 0)), _mm_mul_ps(f, _mm_shuffle_ps(ab, cd, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+        _mm_storeu_ps(y.data() + i, res);
+      }
+    }
+#endif
+    for (; i < x.size(); ++i)
+      y[i] = (*this)(x[i]);
+  }
+
+  /**
+   * @brief error bound
+   *
+   * The largest absolute error found at checks - 1 points inside each
+   * interval while building the table. It is an estimate for smooth
+   * functions, not a proof.
+   *
+   * @return error bound
+   */
+  [[nodiscard]] constexpr T error() const noexcept {
+    return m_error;
+  }
+
+  /**
+   * @brief lower bound of the range
+   *
+   * @return lower bound
+   */
+  [[nodiscard]] constexpr T lo() const noexcept {
+    return m_lo;
+  }
+
+  /**
+   * @brief upper bound of the range
+   *
+   * @return upper bound
+   */
+  [[nodiscard]] constexpr T hi() const noexcept {
+    return m_hi;
+  }
+
+  /**
+   * @brief size
+   *
+   * @return number of samples
+   */
+  [[nodiscard]] constexpr size_type size() const noexcept {
+    return N;
+  }
+
+private:
+  T m_coef[N - 1][order] = {};
+  T m_lo                 = 0;
+  T m_hi                 = 0;
+  T m_scale              = 0;
+  T m_error              = 0;
+};
+
+/**
+ * @brief make a lookup table
+ *
+ * @tparam N number of samples
+ * @tparam I interpolation
+ * @tparam T floating-point type
+ * @tparam F function type
+ * @param[in] func function
+ * @param[in] lo lower bound of the range
+ * @param[in] hi upper bound of the range
+ * @return lookup table
+ *
+ * @exception std::invalid_argument if !(lo < hi)
+ */
+template <std::size_t N, interpolation I = interpolation::linear, std::floating_point T, std::invocable<T> F>
+[[nodiscard]] constexpr lut<T, N, I> make_lut(F func, T lo, T hi) {
+  return lut<T, N, I>(func, lo, hi);
+}
+} // namespace portal::math
+
+#endif // PORTAL_MATH_LUT_HPP
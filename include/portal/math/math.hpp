@@ -12,10 +12,13 @@
 #ifndef PORTAL_MATH_MATH_HPP
 #define PORTAL_MATH_MATH_HPP
 
+#include <algorithm>
 #include <concepts>
+#include <limits>
 #include <numbers>
 #include <numeric>
 #include <cassert>
+#include <cmath>
 #include <stdexcept>
 
 /**
@@ -210,6 +213,124 @@ template <std::floating_point T>
   }
 }
 
+/**
+ * @brief slow exp
+ *
+ * At compile time x is reduced to 2^k e^r with |r| <= ln2 / 2, the result
+ * is within a few ulp.
+ *
+ * @tparam T floating-point type
+ * @param[in] x value
+ * @return Returns e raised to x, inf if x == inf, 0 if x == -inf
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr T slow_exp(const T &x) {
+  if (std::is_constant_evaluated()) {
+    if constexpr (sizeof(T) < sizeof(double)) {
+      // k * ln2_hi below is exact only with the bits of a double
+      return static_cast<T>(slow_exp(static_cast<double>(x)));
+    } else {
+      using limits = std::numeric_limits<T>;
+      if (x != x)
+        return x;
+      if (x > limits::max_exponent * std::numbers::ln2_v<T>)
+        return limits::infinity();
+      if (x < (limits::min_exponent - limits::digits - 1) * std::numbers::ln2_v<T>)
+        return 0;
+      // ln2 = ln2_hi + ln2_lo, the low 32 bits of ln2_hi are zero
+      constexpr T ln2_hi = static_cast<T>(6.93147180369123816490e-01);
+      constexpr T ln2_lo = static_cast<T>(1.90821492927058770002e-10);
+      const T kf         = x * std::numbers::log2e_v<T>;
+      const int k        = static_cast<int>(kf < 0 ? kf - static_cast<T>(0.5) : kf + static_cast<T>(0.5));
+      const T r          = (x - k * ln2_hi) - k * ln2_lo;
+
+      T series = 1;
+      T tmp    = 1;
+      T n      = 1;
+      do {
+        tmp *= r / n;
+        series += tmp;
+        n += 1;
+      } while (absolute(tmp) >= limits::epsilon() * series);
+
+      // 2^k may not be representable, its halves are and only the last product rounds
+      const auto pow2 = [](int e) {
+        T p = 1;
+        for (; e > 0; --e)
+          p *= 2;
+        for (; e < 0; ++e)
+          p /= 2;
+        return p;
+      };
+      return series * pow2(k / 2) * pow2(k - k / 2);
+    }
+  } else {
+    return std::exp(x);
+  }
+}
+
+/**
+ * @brief slow natural logarithm
+ *
+ * @tparam T floating-point type
+ * @param[in] x value
+ * @return Returns log(x), -inf if x == 0, NaN if x < 0
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr T slow_log(const T &x) {
+  if (std::is_constant_evaluated()) {
+    if (x != x || x < 0)
+      return std::numeric_limits<T>::quiet_NaN();
+    if (x == 0)
+      return -std::numeric_limits<T>::infinity();
+    if (x == std::numeric_limits<T>::infinity())
+      return x;
+    // x = m * 2^e with m in [1, 2)
+    T m   = x;
+    int e = 0;
+    for (; m >= 2; ++e)
+      m /= 2;
+    for (; m < 1; --e)
+      m *= 2;
+    // log(m) = 2 atanh(s)
+    const T s    = (m - 1) / (m + 1);
+    const T s_sq = s * s;
+    T series     = s;
+    T tmp        = s;
+    T n          = 1;
+    do {
+      tmp *= s_sq;
+      n += 2;
+      series += tmp / n;
+    } while (tmp / n > std::numeric_limits<T>::epsilon() * series);
+
+    return 2 * series + e * std::numbers::ln2_v<T>;
+  } else {
+    return std::log(x);
+  }
+}
+
+/**
+ * @brief slow power
+ *
+ * @tparam T floating-point type
+ * @param[in] x base, >= 0
+ * @param[in] y exponent
+ * @return Returns x raised to y
+ */
+template <std::floating_point T>
+[[nodiscard]] constexpr T slow_pow(const T &x, const T &y) {
+  if (std::is_constant_evaluated()) {
+    if (y == 0)
+      return 1;
+    if (x == 0)
+      return y > 0 ? 0 : std::numeric_limits<T>::infinity();
+    return slow_exp(y * slow_log(x));
+  } else {
+    return std::pow(x, y);
+  }
+}
+
 } // namespace portal::math
 
 #endif // PORTAL_MATH_MATH_HPP
\ No newline at end of file
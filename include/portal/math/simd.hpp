@@ -0,0 +1,488 @@
+/**
+ * @file simd.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief simd kernels for small fix size vectors
+ * @version 0.1
+ * @date 2022-04-02
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_MATH_SIMD_HPP
+#define PORTAL_MATH_SIMD_HPP
+
+#include <cstddef>
+
+#if !defined(PORTAL_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PORTAL_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define PORTAL_SIMD_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX__)
+#define PORTAL_SIMD_AVX 1
+#include <immintrin.h>
+#endif
+// GCC and Clang define __F16C__, MSVC has no macro for it but every AVX2 CPU has it
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define PORTAL_SIMD_F16C 1
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define PORTAL_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+/**
+ * @brief simd namespace
+ *
+ * Kernels operate on unaligned pointers to N contiguous elements.
+ * Only shapes that fill whole registers (float x 4, double x 2, double x 4) are provided,
+ * partial shapes such as x 3 need extra shuffles and measure slower than scalar code.
+ */
+namespace portal::math::simd {
+/**
+ * @brief simd kernel
+ *
+ * The primary template is disabled, callers fall back to scalar code.
+ *
+ * @tparam T type
+ * @tparam N size
+ */
+template <typename T, std::size_t N>
+struct kernel {
+  static constexpr bool enabled = false; //!< @brief kernel available
+};
+
+/**
+ * @brief kernel made from two narrower kernels
+ *
+ * @tparam Lo kernel of the low elements
+ * @tparam Hi kernel of the high elements
+ */
+template <typename Lo, typename Hi>
+struct kernel_pair {
+  static constexpr bool enabled = Lo::enabled && Hi::enabled; //!< @brief kernel available
+
+  /**
+   * @brief register type
+   *
+   */
+  struct register_type {
+    typename Lo::register_type lo; //!< @brief low elements
+    typename Hi::register_type hi; //!< @brief high elements
+  };
+
+  template <typename T>
+  static register_type load(const T *p) noexcept {
+    return {Lo::load(p), Hi::load(p + Lo::size)};
+  }
+  template <typename T>
+  static void store(T *p, const register_type &v) noexcept {
+    Lo::store(p, v.lo);
+    Hi::store(p + Lo::size, v.hi);
+  }
+  template <typename T>
+  static register_type broadcast(T s) noexcept {
+    return {Lo::broadcast(s), Hi::broadcast(s)};
+  }
+  static register_type add(const register_type &a, const register_type &b) noexcept {
+    return {Lo::add(a.lo, b.lo), Hi::add(a.hi, b.hi)};
+  }
+  static register_type sub(const register_type &a, const register_type &b) noexcept {
+    return {Lo::sub(a.lo, b.lo), Hi::sub(a.hi, b.hi)};
+  }
+  static register_type mul(const register_type &a, const register_type &b) noexcept {
+    return {Lo::mul(a.lo, b.lo), Hi::mul(a.hi, b.hi)};
+  }
+  static register_type div(const register_type &a, const register_type &b) noexcept {
+    return {Lo::div(a.lo, b.lo), Hi::div(a.hi, b.hi)};
+  }
+  static register_type max(const register_type &a, const register_type &b) noexcept {
+    return {Lo::max(a.lo, b.lo), Hi::max(a.hi, b.hi)};
+  }
+  static register_type min(const register_type &a, const register_type &b) noexcept {
+    return {Lo::min(a.lo, b.lo), Hi::min(a.hi, b.hi)};
+  }
+  static auto hsum(const register_type &v) noexcept {
+    return Lo::hsum(v.lo) + Hi::hsum(v.hi);
+  }
+};
+
+#if defined(PORTAL_SIMD_SSE2)
+/**
+ * @brief float x 4 kernel (SSE2)
+ *
+ */
+template <>
+struct kernel<float, 4> {
+  static constexpr bool enabled     = true;   //!< @brief kernel available
+  static constexpr std::size_t size = 4;      //!< @brief element count
+  using register_type               = __m128; //!< @brief register type
+
+  static register_type load(const float *p) noexcept {
+    return _mm_loadu_ps(p);
+  }
+  static void store(float *p, register_type v) noexcept {
+    _mm_storeu_ps(p, v);
+  }
+  static register_type broadcast(float s) noexcept {
+    return _mm_set1_ps(s);
+  }
+  static register_type add(register_type a, register_type b) noexcept {
+    return _mm_add_ps(a, b);
+  }
+  static register_type sub(register_type a, register_type b) noexcept {
+    return _mm_sub_ps(a, b);
+  }
+  static register_type mul(register_type a, register_type b) noexcept {
+    return _mm_mul_ps(a, b);
+  }
+  static register_type div(register_type a, register_type b) noexcept {
+    return _mm_div_ps(a, b);
+  }
+  static register_type max(register_type a, register_type b) noexcept {
+    return _mm_max_ps(a, b);
+  }
+  static register_type min(register_type a, register_type b) noexcept {
+    return _mm_min_ps(a, b);
+  }
+  static float hsum(register_type v) noexcept {
+    register_type shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    register_type sums = _mm_add_ps(v, shuf);
+    shuf               = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+  }
+};
+
+/**
+ * @brief double x 2 kernel (SSE2)
+ *
+ */
+template <>
+struct kernel<double, 2> {
+  static constexpr bool enabled     = true;    //!< @brief kernel available
+  static constexpr std::size_t size = 2;       //!< @brief element count
+  using register_type               = __m128d; //!< @brief register type
+
+  static register_type load(const double *p) noexcept {
+    return _mm_loadu_pd(p);
+  }
+  static void store(double *p, register_type v) noexcept {
+    _mm_storeu_pd(p, v);
+  }
+  static register_type broadcast(double s) noexcept {
+    return _mm_set1_pd(s);
+  }
+  static register_type add(register_type a, register_type b) noexcept {
+    return _mm_add_pd(a, b);
+  }
+  static register_type sub(register_type a, register_type b) noexcept {
+    return _mm_sub_pd(a, b);
+  }
+  static register_type mul(register_type a, register_type b) noexcept {
+    return _mm_mul_pd(a, b);
+  }
+  static register_type div(register_type a, register_type b) noexcept {
+    return _mm_div_pd(a, b);
+  }
+  static register_type max(register_type a, register_type b) noexcept {
+    return _mm_max_pd(a, b);
+  }
+  static register_type min(register_type a, register_type b) noexcept {
+    return _mm_min_pd(a, b);
+  }
+  static double hsum(register_type v) noexcept {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+  }
+};
+
+#if defined(PORTAL_SIMD_AVX)
+/**
+ * @brief double x 4 kernel (AVX)
+ *
+ */
+template <>
+struct kernel<double, 4> {
+  static constexpr bool enabled     = true;    //!< @brief kernel available
+  static constexpr std::size_t size = 4;       //!< @brief element count
+  using register_type               = __m256d; //!< @brief register type
+
+  static register_type load(const double *p) noexcept {
+    return _mm256_loadu_pd(p);
+  }
+  static void store(double *p, register_type v) noexcept {
+    _mm256_storeu_pd(p, v);
+  }
+  static register_type broadcast(double s) noexcept {
+    return _mm256_set1_pd(s);
+  }
+  static register_type add(register_type a, register_type b) noexcept {
+    return _mm256_add_pd(a, b);
+  }
+  static register_type sub(register_type a, register_type b) noexcept {
+    return _mm256_sub_pd(a, b);
+  }
+  static register_type mul(register_type a, register_type b) noexcept {
+    return _mm256_mul_pd(a, b);
+  }
+  static register_type div(register_type a, register_type b) noexcept {
+    return _mm256_div_pd(a, b);
+  }
+  static register_type max(register_type a, register_type b) noexcept {
+    return _mm256_max_pd(a, b);
+  }
+  static register_type min(register_type a, register_type b) noexcept {
+    return _mm256_min_pd(a, b);
+  }
+  static double hsum(register_type v) noexcept {
+    return kernel<double, 2>::hsum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+  }
+};
+#else
+/**
+ * @brief double x 4 kernel (SSE2 x 2)
+ *
+ */
+template <>
+struct kernel<double, 4> : kernel_pair<kernel<double, 2>, kernel<double, 2>> {
+  static constexpr std::size_t size = 4; //!< @brief element count
+};
+#endif
+#endif // PORTAL_SIMD_SSE2
+
+#if defined(PORTAL_SIMD_NEON)
+/**
+ * @brief float x 4 kernel (NEON)
+ *
+ */
+template <>
+struct kernel<float, 4> {
+  static constexpr bool enabled     = true;        //!< @brief kernel available
+  static constexpr std::size_t size = 4;           //!< @brief element count
+  using register_type               = float32x4_t; //!< @brief register type
+
+  static register_type load(const float *p) noexcept {
+    return vld1q_f32(p);
+  }
+  static void store(float *p, register_type v) noexcept {
+    vst1q_f32(p, v);
+  }
+  static register_type broadcast(float s) noexcept {
+    return vdupq_n_f32(s);
+  }
+  static register_type add(register_type a, register_type b) noexcept {
+    return vaddq_f32(a, b);
+  }
+  static register_type sub(register_type a, register_type b) noexcept {
+    return vsubq_f32(a, b);
+  }
+  static register_type mul(register_type a, register_type b) noexcept {
+    return vmulq_f32(a, b);
+  }
+  static register_type div(register_type a, register_type b) noexcept {
+    return vdivq_f32(a, b);
+  }
+  static register_type max(register_type a, register_type b) noexcept {
+    return vmaxq_f32(a, b);
+  }
+  static register_type min(register_type a, register_type b) noexcept {
+    return vminq_f32(a, b);
+  }
+  static float hsum(register_type v) noexcept {
+    return vaddvq_f32(v);
+  }
+};
+
+/**
+ * @brief double x 2 kernel (NEON)
+ *
+ */
+template <>
+struct kernel<double, 2> {
+  static constexpr bool enabled     = true;        //!< @brief kernel available
+  static constexpr std::size_t size = 2;           //!< @brief element count
+  using register_type               = float64x2_t; //!< @brief register type
+
+  static register_type load(const double *p) noexcept {
+    return vld1q_f64(p);
+  }
+  static void store(double *p, register_type v) noexcept {
+    vst1q_f64(p, v);
+  }
+  static register_type broadcast(double s) noexcept {
+    return vdupq_n_f64(s);
+  }
+  static register_type add(register_type a, register_type b) noexcept {
+    return vaddq_f64(a, b);
+  }
+  static register_type sub(register_type a, register_type b) noexcept {
+    return vsubq_f64(a, b);
+  }
+  static register_type mul(register_type a, register_type b) noexcept {
+    return vmulq_f64(a, b);
+  }
+  static register_type div(register_type a, register_type b) noexcept {
+    return vdivq_f64(a, b);
+  }
+  static register_type max(register_type a, register_type b) noexcept {
+    return vmaxq_f64(a, b);
+  }
+  static register_type min(register_type a, register_type b) noexcept {
+    return vminq_f64(a, b);
+  }
+  static double hsum(register_type v) noexcept {
+    return vaddvq_f64(v);
+  }
+};
+
+/**
+ * @brief double x 4 kernel (NEON x 2)
+ *
+ */
+template <>
+struct kernel<double, 4> : kernel_pair<kernel<double, 2>, kernel<double, 2>> {
+  static constexpr std::size_t size = 4; //!< @brief element count
+};
+#endif // PORTAL_SIMD_NEON
+
+/**
+ * @brief simd kernel is available
+ *
+ * @tparam T type
+ * @tparam N size
+ */
+template <typename T, std::size_t N>
+inline constexpr bool enabled_v = kernel<T, N>::enabled;
+
+/**
+ * @brief storage alignment
+ *
+ * Vectors with a kernel are aligned to the whole vector, so that a vector never straddles a cache line.
+ * Other shapes keep the natural alignment of T to stay tightly packed in arrays.
+ *
+ * @tparam T type
+ * @tparam N size
+ */
+template <typename T, std::size_t N>
+inline constexpr std::size_t alignment_v = enabled_v<T, N> ? sizeof(T) * N : alignof(T);
+
+/**
+ * @brief dst[i] += src[i]
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] src source
+ */
+template <typename T, std::size_t N>
+inline void add(T *dst, const T *src) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::add(K::load(dst), K::load(src)));
+}
+
+/**
+ * @brief dst[i] -= src[i]
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] src source
+ */
+template <typename T, std::size_t N>
+inline void sub(T *dst, const T *src) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::sub(K::load(dst), K::load(src)));
+}
+
+/**
+ * @brief dst[i] *= src[i]
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] src source
+ */
+template <typename T, std::size_t N>
+inline void mul(T *dst, const T *src) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::mul(K::load(dst), K::load(src)));
+}
+
+/**
+ * @brief dst[i] = max(dst[i], src[i])
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] src source
+ */
+template <typename T, std::size_t N>
+inline void max(T *dst, const T *src) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::max(K::load(dst), K::load(src)));
+}
+
+/**
+ * @brief dst[i] = min(dst[i], src[i])
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] src source
+ */
+template <typename T, std::size_t N>
+inline void min(T *dst, const T *src) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::min(K::load(dst), K::load(src)));
+}
+
+/**
+ * @brief dst[i] *= scal
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] scal scalar
+ */
+template <typename T, std::size_t N>
+inline void scale(T *dst, T scal) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::mul(K::load(dst), K::broadcast(scal)));
+}
+
+/**
+ * @brief dst[i] /= scal
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in,out] dst destination
+ * @param[in] scal scalar
+ */
+template <typename T, std::size_t N>
+inline void divide(T *dst, T scal) noexcept {
+  using K = kernel<T, N>;
+  K::store(dst, K::div(K::load(dst), K::broadcast(scal)));
+}
+
+/**
+ * @brief dot product
+ *
+ * @tparam T type
+ * @tparam N size
+ * @param[in] lhs vector
+ * @param[in] rhs vector
+ * @return Return the dot product of lhs and rhs
+ */
+template <typename T, std::size_t N>
+[[nodiscard]] inline T dot(const T *lhs, const T *rhs) noexcept {
+  using K = kernel<T, N>;
+  return K::hsum(K::mul(K::load(lhs), K::load(rhs)));
+}
+} // namespace portal::math::simd
+
+#endif // PORTAL_MATH_SIMD_HPP
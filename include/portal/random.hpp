@@ -11,22 +11,225 @@
 #ifndef PORTAL_RANDOM_HPP
 #define PORTAL_RANDOM_HPP
 
+#include "random_engine.hpp"
 #include <random>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <concepts>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
 
 /**
  * @brief portal namespace
  *
  */
 namespace portal {
+/**
+ * @brief engine seeded from a 64 bit key
+ *
+ * Engines taking a seed sequence get one filled from the key, others the
+ * key itself.
+ *
+ * @tparam Engine engine
+ * @param[in] key key
+ * @return Returns the engine
+ */
+template <std::uniform_random_bit_generator Engine>
+[[nodiscard]] Engine make_engine(std::uint64_t key) {
+  if constexpr (std::is_constructible_v<Engine, std::seed_seq &>) {
+    const std::uint64_t a = mix64(key);
+    const std::uint64_t b = mix64(a);
+    std::seed_seq seq{static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(a >> 32), static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(b >> 32)};
+    return Engine(seq);
+  } else {
+    return Engine(key);
+  }
+}
+
+/**
+ * @brief independent random streams derived from one seed
+ *
+ * Stream i of seed s is an engine seeded from a key hashed from (s, i);
+ * distinct streams of a seed have distinct keys. Each thread draws from its
+ * own engine on its own stream, so drawing takes no lock. A thread's stream
+ * is the order in which it first drew, or the one set with
+ * set_this_thread_stream(); with a fixed seed and the same streams the
+ * draws are the same from run to run.
+ *
+ * For results independent of scheduling, key streams by work item instead
+ * of by thread:
+ * @code
+ * pool.parallel_for(tiles, 1, [](std::size_t first, std::size_t last) {
+ *   for (std::size_t i = first; i < last; ++i) {
+ *     auto engine = random_streams::shared().stream<pcg32>(i);
+ *     ...
+ *   }
+ * });
+ * @endcode
+ */
+class random_streams {
+public:
+  random_streams(const random_streams &)            = delete;
+  random_streams &operator=(const random_streams &) = delete;
+
+  /**
+   * @brief process-wide streams
+   *
+   * @return streams, seeded from std::random_device until seed() is called
+   */
+  [[nodiscard]] static random_streams &shared() {
+    static random_streams streams;
+    return streams;
+  }
+
+  /**
+   * @brief seed
+   *
+   * @return Returns the seed
+   */
+  [[nodiscard]] std::uint64_t seed() const noexcept {
+    return m_seed.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief reseed, restarting every stream
+   *
+   * Threads pick the new seed up on their next draw. Draws racing with the
+   * call may use either seed.
+   *
+   * @param[in] seed seed
+   */
+  void seed(std::uint64_t seed) noexcept {
+    m_seed.store(seed, std::memory_order_relaxed);
+    m_epoch.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * @brief key of a stream
+   *
+   * @param[in] id stream
+   * @return Returns the key of the stream of the current seed
+   */
+  [[nodiscard]] std::uint64_t key(std::uint64_t id) const noexcept {
+    return mix64(mix64(seed()) ^ id);
+  }
+
+  /**
+   * @brief engine at the start of a stream
+   *
+   * @tparam Engine engine
+   * @param[in] id stream
+   * @return Returns a new engine
+   */
+  template <std::uniform_random_bit_generator Engine>
+  [[nodiscard]] Engine stream(std::uint64_t id) const {
+    return make_engine<Engine>(key(id));
+  }
+
+  /**
+   * @brief engine of the calling thread
+   *
+   * One per thread and engine type, restarted when the seed or the stream
+   * of the thread changes.
+   *
+   * @tparam Engine engine
+   * @return Returns the engine
+   */
+  template <std::uniform_random_bit_generator Engine>
+  [[nodiscard]] Engine &this_thread() {
+    thread_local Engine engine;
+    thread_local std::uint64_t engine_epoch  = 0;
+    thread_local std::uint64_t engine_stream = 0;
+    const std::uint64_t epoch                = m_epoch.load(std::memory_order_acquire);
+    const std::uint64_t id                   = thread_stream();
+    if (engine_epoch != epoch || engine_stream != id) {
+      engine        = stream<Engine>(id);
+      engine_epoch  = epoch;
+      engine_stream = id;
+    }
+    return engine;
+  }
+
+  /**
+   * @brief stream of the calling thread
+   *
+   * @return Returns the stream
+   */
+  [[nodiscard]] std::uint64_t this_thread_stream() {
+    return thread_stream();
+  }
+
+  /**
+   * @brief set the stream of the calling thread
+   *
+   * Give each thread of a pool its index to make its draws independent of
+   * the order threads start in.
+   *
+   * @param[in] id stream
+   */
+  void set_this_thread_stream(std::uint64_t id) {
+    thread_stream() = id;
+  }
+
+private:
+  random_streams()
+      : m_seed(std::uint64_t{std::random_device{}()} << 32 | std::random_device{}()) {
+  }
+
+  std::uint64_t &thread_stream() {
+    thread_local std::uint64_t id = m_next_stream.fetch_add(1, std::memory_order_relaxed);
+    return id;
+  }
+
+  std::atomic<std::uint64_t> m_seed;
+  std::atomic<std::uint64_t> m_epoch{1};
+  std::atomic<std::uint64_t> m_next_stream{0};
+};
+
+/**
+ * @brief seed random and the distributions drawing from thread engines
+ *
+ * @param[in] seed seed
+ */
+inline void seed_random(std::uint64_t seed) noexcept {
+  random_streams::shared().seed(seed);
+}
+
+/**
+ * @brief random bits to a float in [0, 1)
+ *
+ * The 23 high bits become the mantissa of a float in [1, 2).
+ *
+ * @param[in] bits random bits
+ * @return Returns a multiple of 2^-23 in [0, 1)
+ */
+[[nodiscard]] constexpr float unit_float(std::uint32_t bits) noexcept {
+  return std::bit_cast<float>(0x3f800000u | bits >> 9) - 1.0f;
+}
+
+/**
+ * @brief random bits to a double in [0, 1)
+ *
+ * @param[in] bits random bits
+ * @return Returns a multiple of 2^-52 in [0, 1)
+ */
+[[nodiscard]] constexpr double unit_double(std::uint64_t bits) noexcept {
+  return std::bit_cast<double>(0x3ff0000000000000u | bits >> 12) - 1.0;
+}
+
 /**
  * @brief uniform real distribution
  *
  * @tparam T floating-point type
- * @tparam Engine engine
+ * @tparam Engine engine of the calling thread used when none is passed
  */
-template <std::floating_point T = double, std::uniform_random_bit_generator Engine = std::mt19937>
+template <std::floating_point T = double, std::uniform_random_bit_generator Engine = default_random_engine>
 class uniform_real_distribution {
 public:
   using param_type  = std::uniform_real_distribution<T>::param_type;  //!< @param parameter
@@ -49,8 +252,7 @@ public:
    * @pre a < b
    */
   explicit uniform_real_distribution(T a, T b = static_cast<T>(1))
-      : m_dist(a, b)
-      , m_engine(std::random_device{}()) {
+      : m_dist(a, b) {
     assert(a < b);
   }
 
@@ -113,7 +315,7 @@ public:
    * @return param_type 
    */
   param_type param() const {
-    return m_dist.param;
+    return m_dist.param();
   }
 
   /**
@@ -123,7 +325,7 @@ public:
    * @param[in] parm parameter
    * @return result_type 
    */
-  result_type operator()(const std::uniform_random_bit_generator auto &engine, const param_type &parm) {
+  result_type operator()(std::uniform_random_bit_generator auto &engine, const param_type &parm) {
     return m_dist(engine, parm);
   }
 
@@ -133,32 +335,80 @@ public:
    * @param[in] engine engine 
    * @return result_type 
    */
-  result_type operator()(const std::uniform_random_bit_generator auto &engine) {
+  result_type operator()(std::uniform_random_bit_generator auto &engine) {
     return m_dist(engine);
   }
 
   /**
-   * @brief random
-   * 
-   * @return result_type 
+   * @brief random from the engine of the calling thread
+   *
+   * Safe to call on one object from several threads, see random_streams.
+   *
+   * @return result_type
+   */
+  result_type operator()() const {
+    // a copy, the distribution is stateless but its call operator is not const
+    auto dist = m_dist;
+    return dist(random_streams::shared().this_thread<Engine>());
+  }
+
+  /**
+   * @brief fill with random values from the simd engine of the calling thread
+   *
+   * @param[out] dst values
    */
-  result_type operator()() {
-    return m_dist(m_engine);
+  void generate(std::span<result_type> dst) const {
+    generate(dst, random_streams::shared().this_thread<simd_random_engine>());
+  }
+
+  /**
+   * @brief fill with random values
+   *
+   * Maps random bits with unit_float() or unit_double() instead of
+   * std::uniform_real_distribution, in a loop the compiler vectorizes.
+   *
+   * @param[out] dst values
+   * @param[in,out] engine engine
+   */
+  void generate(std::span<result_type> dst, full_range_engine auto &engine) const {
+    // a double takes two words
+    constexpr std::size_t words = sizeof(T) > sizeof(float) ? 2 : 1;
+    std::array<std::uint32_t, 256> bits;
+    const T lo    = a();
+    const T hi    = b();
+    const T scale = hi - lo;
+    // lo + scale * u may round up to hi
+    const T below = std::nextafter(hi, lo);
+    for (std::size_t i = 0; i < dst.size(); i += bits.size() / words) {
+      const std::size_t n = std::min(bits.size() / words, dst.size() - i);
+      generate_bits(engine, std::span(bits).first(n * words));
+      for (std::size_t j = 0; j < n; ++j) {
+        if constexpr (words == 1) {
+          const float x   = lo + scale * unit_float(bits[j]);
+          const auto keep = -std::uint32_t{x < hi};
+          dst[i + j]      = std::bit_cast<float>((std::bit_cast<std::uint32_t>(x) & keep) | (std::bit_cast<std::uint32_t>(below) & ~keep));
+        } else {
+          const T x  = lo + scale * static_cast<T>(unit_double(std::uint64_t{bits[2 * j + 1]} << 32 | bits[2 * j]));
+          dst[i + j] = x < hi ? x : below;
+        }
+      }
+    }
   }
 
 private:
   std::uniform_real_distribution<T> m_dist;
-  Engine m_engine = {};
 };
 
 /**
  * @brief uniform int distribution
  *
- * @tparam T floating-point type
- * @tparam Engine engine
+ * @tparam T integral type, short or wider
+ * @tparam Engine engine of the calling thread used when none is passed
  */
-template <std::integral T = int, std::uniform_random_bit_generator Engine = std::mt19937>
+template <std::integral T = int, std::uniform_random_bit_generator Engine = default_random_engine>
 class uniform_int_distribution {
+  static_assert(sizeof(T) >= sizeof(short), "std::uniform_int_distribution does not take 8 bit types");
+
 public:
   using param_type  = std::uniform_int_distribution<T>::param_type;  //!< @param parameter
   using result_type = std::uniform_int_distribution<T>::result_type; //!< @param result type
@@ -180,8 +430,7 @@ public:
    * @pre a < b
    */
   explicit uniform_int_distribution(T a, T b = std::numeric_limits<T>::max())
-      : m_dist(a, b)
-      , m_engine(std::random_device{}()) {
+      : m_dist(a, b) {
     assert(a < b);
   }
 
@@ -244,7 +493,7 @@ public:
    * @return param_type 
    */
   param_type param() const {
-    return m_dist.param;
+    return m_dist.param();
   }
 
   /**
@@ -254,7 +503,7 @@ public:
    * @param[in] parm parameter
    * @return result_type 
    */
-  result_type operator()(const std::uniform_random_bit_generator auto &engine, const param_type &parm) {
+  result_type operator()(std::uniform_random_bit_generator auto &engine, const param_type &parm) {
     return m_dist(engine, parm);
   }
 
@@ -264,27 +513,78 @@ public:
    * @param[in] engine engine 
    * @return result_type 
    */
-  result_type operator()(const std::uniform_random_bit_generator auto &engine) {
+  result_type operator()(std::uniform_random_bit_generator auto &engine) {
     return m_dist(engine);
   }
 
   /**
-   * @brief random
-   * 
-   * @return result_type 
+   * @brief random from the engine of the calling thread
+   *
+   * Safe to call on one object from several threads, see random_streams.
+   *
+   * @return result_type
    */
-  result_type operator()() {
-    return m_dist(m_engine);
+  result_type operator()() const {
+    // a copy, the distribution is stateless but its call operator is not const
+    auto dist = m_dist;
+    return dist(random_streams::shared().this_thread<Engine>());
+  }
+
+  /**
+   * @brief fill with random values from the simd engine of the calling thread
+   *
+   * @param[out] dst values
+   */
+  void generate(std::span<result_type> dst) const {
+    generate(dst, random_streams::shared().this_thread<simd_random_engine>());
+  }
+
+  /**
+   * @brief fill with random values
+   *
+   * Ranges of up to 2^32 values map a random word w to a + (w * range >>
+   * 32) in a loop the compiler vectorizes; a value is off uniform by at
+   * most range / 2^32. Wider ranges draw one by one.
+   *
+   * @param[out] dst values
+   * @param[in,out] engine engine
+   */
+  void generate(std::span<result_type> dst, full_range_engine auto &engine) const {
+    using unsigned_type       = std::make_unsigned_t<T>;
+    const std::uint64_t range = static_cast<unsigned_type>(static_cast<unsigned_type>(b()) - static_cast<unsigned_type>(a())) + std::uint64_t{1};
+    if (range == 0 || range > (std::uint64_t{1} << 32)) {
+      auto dist = m_dist;
+      for (auto &x : dst)
+        x = dist(engine);
+      return;
+    }
+    std::array<std::uint32_t, 256> bits;
+    const unsigned_type lo = static_cast<unsigned_type>(a());
+    // a range of 2^32 takes the words as they are, a multiplier of 0 marks it
+    const std::uint32_t mul = static_cast<std::uint32_t>(range);
+    for (std::size_t i = 0; i < dst.size(); i += bits.size()) {
+      const std::size_t n = std::min(bits.size(), dst.size() - i);
+      generate_bits(engine, std::span(bits).first(n));
+      if (mul == 0) {
+        for (std::size_t j = 0; j < n; ++j)
+          dst[i + j] = static_cast<T>(static_cast<unsigned_type>(lo + bits[j]));
+      } else {
+        for (std::size_t j = 0; j < n; ++j)
+          dst[i + j] = static_cast<T>(static_cast<unsigned_type>(lo + static_cast<unsigned_type>(std::uint64_t{bits[j]} * mul >> 32)));
+      }
+    }
   }
 
 private:
   std::uniform_int_distribution<T> m_dist;
-  Engine m_engine = {};
 };
 
 /**
  * @brief random
- * 
+ *
+ * Draws from the engine of the calling thread without locking, see
+ * random_streams; seed_random() makes the draws reproducible.
+ *
  * @tparam T floating point type
  */
 template<std::floating_point T = double>
@@ -0,0 +1,653 @@
+/**
+ * @file random_engine.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief small-state random engines
+ * @version 0.1
+ * @date 2022-04-16
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_RANDOM_ENGINE_HPP
+#define PORTAL_RANDOM_ENGINE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <utility>
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief SplitMix64 output function
+ *
+ * A bijection on 64 bit integers whose outputs for consecutive inputs look
+ * independent.
+ *
+ * @param[in] x value
+ * @return Returns the mixed value
+ */
+[[nodiscard]] constexpr std::uint64_t mix64(std::uint64_t x) noexcept {
+  x += 0x9e3779b97f4a7c15u;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief SplitMix64
+ *
+ * 8 bytes of state, a Weyl sequence through mix64(). Fast and good enough
+ * to seed the other engines, its period is 2^64.
+ *
+ */
+class splitmix64 {
+public:
+  using result_type = std::uint64_t; //!< @brief result type
+
+  /**
+   * @brief Construct a new splitmix64 object
+   *
+   * @param[in] seed seed
+   */
+  constexpr explicit splitmix64(std::uint64_t seed = 0) noexcept
+      : m_state(seed) {
+  }
+
+  /**
+   * @brief min value
+   *
+   * @return Returns 0
+   */
+  [[nodiscard]] static constexpr result_type min() noexcept {
+    return 0;
+  }
+
+  /**
+   * @brief max value
+   *
+   * @return Returns the max value of result_type
+   */
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief next value
+   *
+   * @return Returns the value
+   */
+  constexpr result_type operator()() noexcept {
+    const std::uint64_t x = m_state;
+    m_state += 0x9e3779b97f4a7c15u;
+    return mix64(x);
+  }
+
+  /**
+   * @brief skip values
+   *
+   * @param[in] n number of values
+   */
+  constexpr void discard(unsigned long long n) noexcept {
+    m_state += 0x9e3779b97f4a7c15u * n;
+  }
+
+  /**
+   * @brief equal
+   *
+   * @return true if the engines produce the same values
+   */
+  [[nodiscard]] constexpr bool operator==(const splitmix64 &) const noexcept = default;
+
+private:
+  std::uint64_t m_state;
+};
+
+/**
+ * @brief PCG32 (PCG-XSH-RR 64/32)
+ *
+ * 16 bytes of state: a 64 bit LCG whose output is permuted. Each odd
+ * increment selects one of 2^63 streams of period 2^64, and discard()
+ * jumps ahead in O(log n).
+ *
+ */
+class pcg32 {
+public:
+  using result_type = std::uint32_t; //!< @brief result type
+
+  /**
+   * @brief Construct a new pcg32 object
+   *
+   * @param[in] seed seed
+   * @param[in] stream stream
+   */
+  constexpr explicit pcg32(std::uint64_t seed = 0x853c49e6748fea9bu, std::uint64_t stream = 0xda3e39cb94b95bdbu) noexcept
+      : m_state(0)
+      , m_inc(stream << 1 | 1u) {
+    step();
+    m_state += seed;
+    step();
+  }
+
+  /**
+   * @brief min value
+   *
+   * @return Returns 0
+   */
+  [[nodiscard]] static constexpr result_type min() noexcept {
+    return 0;
+  }
+
+  /**
+   * @brief max value
+   *
+   * @return Returns the max value of result_type
+   */
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief next value
+   *
+   * @return Returns the value
+   */
+  constexpr result_type operator()() noexcept {
+    const std::uint64_t x = m_state;
+    step();
+    return std::rotr(static_cast<std::uint32_t>(((x >> 18) ^ x) >> 27), static_cast<int>(x >> 59));
+  }
+
+  /**
+   * @brief skip values
+   *
+   * @param[in] n number of values
+   */
+  constexpr void discard(unsigned long long n) noexcept {
+    // compose the affine step with itself by squaring
+    std::uint64_t mul = 1, add = 0;
+    std::uint64_t cur_mul = multiplier, cur_add = m_inc;
+    for (; n != 0; n >>= 1) {
+      if (n & 1u) {
+        mul *= cur_mul;
+        add = add * cur_mul + cur_add;
+      }
+      cur_add *= cur_mul + 1;
+      cur_mul *= cur_mul;
+    }
+    m_state = m_state * mul + add;
+  }
+
+  /**
+   * @brief equal
+   *
+   * @return true if the engines produce the same values
+   */
+  [[nodiscard]] constexpr bool operator==(const pcg32 &) const noexcept = default;
+
+private:
+  static constexpr std::uint64_t multiplier = 6364136223846793005u;
+
+  constexpr void step() noexcept {
+    m_state = m_state * multiplier + m_inc;
+  }
+
+  std::uint64_t m_state;
+  std::uint64_t m_inc;
+};
+
+/**
+ * @brief xoshiro engine
+ *
+ * 4 words of state, seeded through splitmix64, never all zero. jump()
+ * advances by the square root of the period (2^64 values for 32 bit words,
+ * 2^128 for 64 bit ones) to split non-overlapping streams.
+ *
+ * @tparam T word type, std::uint32_t or std::uint64_t
+ * @tparam PlusPlus true for xoshiro++ output, false for xoshiro+, whose
+ * lowest bits are weak but which suffices for floating-point values
+ */
+template <typename T, bool PlusPlus>
+requires std::same_as<T, std::uint32_t> || std::same_as<T, std::uint64_t>
+class basic_xoshiro {
+public:
+  using result_type = T; //!< @brief result type
+
+  /**
+   * @brief Construct a new basic xoshiro object
+   *
+   * @param[in] seed seed
+   */
+  constexpr explicit basic_xoshiro(std::uint64_t seed = 0) noexcept {
+    splitmix64 init(seed);
+    if constexpr (wide) {
+      for (auto &s : m_state)
+        s = init();
+    } else {
+      for (std::size_t i = 0; i < 4; i += 2) {
+        const std::uint64_t x = init();
+        m_state[i]            = static_cast<T>(x);
+        m_state[i + 1]        = static_cast<T>(x >> 32);
+      }
+    }
+  }
+
+  /**
+   * @brief min value
+   *
+   * @return Returns 0
+   */
+  [[nodiscard]] static constexpr result_type min() noexcept {
+    return 0;
+  }
+
+  /**
+   * @brief max value
+   *
+   * @return Returns the max value of result_type
+   */
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief next value
+   *
+   * @return Returns the value
+   */
+  constexpr result_type operator()() noexcept {
+    auto &s = m_state;
+    T res;
+    if constexpr (PlusPlus)
+      res = std::rotl(static_cast<T>(s[0] + s[3]), wide ? 23 : 7) + s[0];
+    else
+      res = s[0] + s[3];
+    const T t = s[1] << (wide ? 17 : 9);
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = std::rotl(s[3], wide ? 45 : 11);
+    return res;
+  }
+
+  /**
+   * @brief skip values
+   *
+   * @param[in] n number of values
+   */
+  constexpr void discard(unsigned long long n) noexcept {
+    for (; n != 0; --n)
+      (*this)();
+  }
+
+  /**
+   * @brief skip 2^64 values (32 bit words) or 2^128 values (64 bit words)
+   *
+   */
+  constexpr void jump() noexcept {
+    constexpr std::array<T, 4> poly = wide ? std::array<T, 4>{static_cast<T>(0x180ec6d33cfd0abau), static_cast<T>(0xd5a61266f0c9392cu), static_cast<T>(0xa9582618e03fc9aau), static_cast<T>(0x39abdc4529b1661cu)}
+                                           : std::array<T, 4>{static_cast<T>(0x8764000bu), static_cast<T>(0xf542d2d3u), static_cast<T>(0x6fa035c3u), static_cast<T>(0x77f2db5bu)};
+    std::array<T, 4> res{};
+    for (const T word : poly) {
+      for (int b = 0; b < std::numeric_limits<T>::digits; ++b) {
+        if ((word >> b) & 1u)
+          for (std::size_t i = 0; i < 4; ++i)
+            res[i] ^= m_state[i];
+        (*this)();
+      }
+    }
+    m_state = res;
+  }
+
+  /**
+   * @brief state
+   *
+   * @return Returns the 4 words of state
+   */
+  [[nodiscard]] constexpr const std::array<T, 4> &state() const noexcept {
+    return m_state;
+  }
+
+  /**
+   * @brief equal
+   *
+   * @return true if the engines produce the same values
+   */
+  [[nodiscard]] constexpr bool operator==(const basic_xoshiro &) const noexcept = default;
+
+private:
+  static constexpr bool wide = std::same_as<T, std::uint64_t>;
+
+  std::array<T, 4> m_state;
+};
+
+using xoshiro128p  = basic_xoshiro<std::uint32_t, false>; //!< @brief xoshiro128+
+using xoshiro128pp = basic_xoshiro<std::uint32_t, true>;  //!< @brief xoshiro128++
+using xoshiro256p  = basic_xoshiro<std::uint64_t, false>; //!< @brief xoshiro256+
+using xoshiro256pp = basic_xoshiro<std::uint64_t, true>;  //!< @brief xoshiro256++
+
+/**
+ * @brief xoshiro128 engines stepped side by side
+ *
+ * Lane i is a xoshiro128 engine jumped i times from the one of the seed,
+ * so the lanes never overlap. The state is kept lane-wise, each step
+ * computes one value of every lane in a loop the compiler vectorizes.
+ * Values come out as lane 0, 1, ..., Lanes - 1 of each step; generate()
+ * writes whole steps straight into the destination.
+ *
+ * @tparam PlusPlus true for xoshiro128++ output, false for xoshiro128+
+ * @tparam Lanes number of lanes
+ */
+template <bool PlusPlus, std::size_t Lanes>
+requires(Lanes > 0)
+class basic_xoshiro128_lanes {
+public:
+  using result_type = std::uint32_t; //!< @brief result type
+
+  /**
+   * @brief Construct a new basic xoshiro128 lanes object
+   *
+   * @param[in] seed seed
+   */
+  constexpr explicit basic_xoshiro128_lanes(std::uint64_t seed = 0) noexcept {
+    basic_xoshiro<std::uint32_t, PlusPlus> lane(seed);
+    for (std::size_t i = 0; i < Lanes; ++i) {
+      for (std::size_t j = 0; j < 4; ++j)
+        m_state[j][i] = lane.state()[j];
+      lane.jump();
+    }
+  }
+
+  /**
+   * @brief min value
+   *
+   * @return Returns 0
+   */
+  [[nodiscard]] static constexpr result_type min() noexcept {
+    return 0;
+  }
+
+  /**
+   * @brief max value
+   *
+   * @return Returns the max value of result_type
+   */
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief next value
+   *
+   * @return Returns the value
+   */
+  constexpr result_type operator()() noexcept {
+    if (m_index == Lanes) {
+      step(m_block.data());
+      m_index = 0;
+    }
+    return m_block[m_index++];
+  }
+
+  /**
+   * @brief next values
+   *
+   * Same values as dst.size() calls of operator().
+   *
+   * @param[out] dst values
+   */
+  constexpr void generate(std::span<result_type> dst) noexcept {
+    std::size_t i = 0;
+    for (; i < dst.size() && m_index < Lanes; ++i)
+      dst[i] = m_block[m_index++];
+    for (; i + Lanes <= dst.size(); i += Lanes)
+      step(dst.data() + i);
+    for (; i < dst.size(); ++i)
+      dst[i] = (*this)();
+  }
+
+  /**
+   * @brief skip values
+   *
+   * @param[in] n number of values
+   */
+  constexpr void discard(unsigned long long n) noexcept {
+    for (; n != 0 && m_index < Lanes; --n)
+      ++m_index;
+    std::array<result_type, Lanes> skipped;
+    for (; n >= Lanes; n -= Lanes)
+      step(skipped.data());
+    for (; n != 0; --n)
+      (*this)();
+  }
+
+  /**
+   * @brief equal
+   *
+   * @return true if the engines produce the same values
+   */
+  [[nodiscard]] constexpr bool operator==(const basic_xoshiro128_lanes &) const noexcept = default;
+
+private:
+  constexpr void step(result_type *dst) noexcept {
+    auto &[s0, s1, s2, s3] = m_state;
+    std::array<result_type, Lanes> res;
+    for (std::size_t i = 0; i < Lanes; ++i) {
+      if constexpr (PlusPlus)
+        res[i] = std::rotl(s0[i] + s3[i], 7) + s0[i];
+      else
+        res[i] = s0[i] + s3[i];
+      const std::uint32_t t = s1[i] << 9;
+      s2[i] ^= s0[i];
+      s3[i] ^= s1[i];
+      s1[i] ^= s2[i];
+      s0[i] ^= s3[i];
+      s2[i] ^= t;
+      s3[i] = std::rotl(s3[i], 11);
+    }
+    std::copy(res.begin(), res.end(), dst);
+  }
+
+  std::array<std::array<std::uint32_t, Lanes>, 4> m_state;
+  std::array<result_type, Lanes> m_block{};
+  std::size_t m_index = Lanes;
+};
+
+using xoshiro128p_x8  = basic_xoshiro128_lanes<false, 8>; //!< @brief 8 lanes of xoshiro128+
+using xoshiro128pp_x8 = basic_xoshiro128_lanes<true, 8>;  //!< @brief 8 lanes of xoshiro128++
+
+/**
+ * @brief Philox4x32-10
+ *
+ * Counter-based: value i is a bijection of the 128 bit counter i/4 under a
+ * 64 bit key, so any value is computed directly with block() and streams
+ * are just keys. As an engine it holds the key, the counter and the block
+ * in use.
+ *
+ * @code
+ * // the samples of a pixel, whatever thread computes it
+ * const auto r = philox4x32::block({x, y, frame, 0}, seed);
+ * @endcode
+ */
+class philox4x32 {
+public:
+  using result_type  = std::uint32_t;                //!< @brief result type
+  using counter_type = std::array<std::uint32_t, 4>; //!< @brief counter and block type
+
+  /**
+   * @brief Construct a new philox4x32 object
+   *
+   * @param[in] key key
+   * @param[in] counter first counter
+   */
+  constexpr explicit philox4x32(std::uint64_t key = 0, const counter_type &counter = {}) noexcept
+      : m_key(key)
+      , m_counter(counter) {
+  }
+
+  /**
+   * @brief block of a counter
+   *
+   * @param[in] counter counter
+   * @param[in] key key
+   * @return Returns the 4 values of the block
+   */
+  [[nodiscard]] static constexpr counter_type block(counter_type counter, std::uint64_t key) noexcept {
+    std::uint32_t k0 = static_cast<std::uint32_t>(key);
+    std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+    for (int round = 0; round < 10; ++round) {
+      const std::uint64_t p0 = std::uint64_t{0xd2511f53u} * counter[0];
+      const std::uint64_t p1 = std::uint64_t{0xcd9e8d57u} * counter[2];
+      counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ k0, static_cast<std::uint32_t>(p1), static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ k1, static_cast<std::uint32_t>(p0)};
+      k0 += 0x9e3779b9u;
+      k1 += 0xbb67ae85u;
+    }
+    return counter;
+  }
+
+  /**
+   * @brief min value
+   *
+   * @return Returns 0
+   */
+  [[nodiscard]] static constexpr result_type min() noexcept {
+    return 0;
+  }
+
+  /**
+   * @brief max value
+   *
+   * @return Returns the max value of result_type
+   */
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief next value
+   *
+   * @return Returns the value
+   */
+  constexpr result_type operator()() noexcept {
+    if (m_index == 4) {
+      m_block = block(m_counter, m_key);
+      increment(1);
+      m_index = 0;
+    }
+    return m_block[m_index++];
+  }
+
+  /**
+   * @brief skip values
+   *
+   * @param[in] n number of values
+   */
+  constexpr void discard(unsigned long long n) noexcept {
+    const unsigned long long in_block = 4 - m_index;
+    if (n <= in_block) {
+      m_index += static_cast<unsigned>(n);
+      return;
+    }
+    n -= in_block;
+    increment(n / 4);
+    m_index = 4;
+    if (n % 4 != 0) {
+      (*this)();
+      m_index = static_cast<unsigned>(n % 4);
+    }
+  }
+
+  /**
+   * @brief counter of the next block
+   *
+   * @return Returns the counter
+   */
+  [[nodiscard]] constexpr const counter_type &counter() const noexcept {
+    return m_counter;
+  }
+
+  /**
+   * @brief equal
+   *
+   * @return true if the engines produce the same values
+   */
+  [[nodiscard]] constexpr bool operator==(const philox4x32 &) const noexcept = default;
+
+private:
+  constexpr void increment(std::uint64_t n) noexcept {
+    const std::uint64_t low   = (std::uint64_t{m_counter[1]} << 32 | m_counter[0]) + n;
+    const std::uint32_t carry = low < n;
+    m_counter[0]              = static_cast<std::uint32_t>(low);
+    m_counter[1]              = static_cast<std::uint32_t>(low >> 32);
+    m_counter[2] += carry;
+    m_counter[3] += carry && m_counter[2] == 0;
+  }
+
+  std::uint64_t m_key;
+  counter_type m_counter;
+  counter_type m_block{};
+  unsigned m_index = 4;
+};
+
+/**
+ * @brief default engine of portal's distributions
+ *
+ */
+using default_random_engine = xoshiro256pp;
+
+/**
+ * @brief default engine of portal's bulk generation
+ *
+ */
+using simd_random_engine = xoshiro128pp_x8;
+
+/**
+ * @brief engine whose values are all 32 or all 64 bit patterns
+ *
+ * @tparam Engine engine
+ */
+template <typename Engine>
+concept full_range_engine = std::uniform_random_bit_generator<Engine> && Engine::min() == 0 &&
+                            (Engine::max() == std::numeric_limits<std::uint32_t>::max() || Engine::max() == std::numeric_limits<std::uint64_t>::max());
+
+/**
+ * @brief fill with random bits
+ *
+ * Uses the generate() member of engines having one, a 64 bit value gives
+ * two words.
+ *
+ * @param[in,out] engine engine
+ * @param[out] dst words
+ */
+template <full_range_engine Engine>
+constexpr void generate_bits(Engine &engine, std::span<std::uint32_t> dst) {
+  if constexpr (requires { engine.generate(dst); }) {
+    engine.generate(dst);
+  } else if constexpr (Engine::max() == std::numeric_limits<std::uint32_t>::max()) {
+    for (auto &word : dst)
+      word = static_cast<std::uint32_t>(engine());
+  } else {
+    std::size_t i = 0;
+    for (; i + 2 <= dst.size(); i += 2) {
+      const std::uint64_t x = engine();
+      dst[i]                = static_cast<std::uint32_t>(x);
+      dst[i + 1]            = static_cast<std::uint32_t>(x >> 32);
+    }
+    if (i < dst.size())
+      dst[i] = static_cast<std::uint32_t>(engine() >> 32);
+  }
+}
+} // namespace portal
+
+#endif // PORTAL_RANDOM_ENGINE_HPP
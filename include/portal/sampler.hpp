@@ -0,0 +1,593 @@
+/**
+ * @file sampler.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief low-discrepancy samplers
+ * @version 0.1
+ * @date 2022-04-17
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_SAMPLER_HPP
+#define PORTAL_SAMPLER_HPP
+
+#include "random.hpp"
+#include "random_engine.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief reverse the bits of a word
+ *
+ * @param[in] x word
+ * @return Returns x with bit i moved to bit 31 - i
+ */
+[[nodiscard]] constexpr std::uint32_t reverse_bits(std::uint32_t x) noexcept {
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+  x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+/**
+ * @brief hash-based nested uniform scramble
+ *
+ * The Laine-Karras permutation on the reversed bits: each bit is flipped
+ * depending on the seed and the bits above it only, which is Owen
+ * scrambling in base 2. Scrambling keeps every power-of-two stratification
+ * of a sequence.
+ *
+ * @param[in] x fixed-point value in [0, 1) or an index
+ * @param[in] seed seed
+ * @return Returns the scrambled value
+ */
+[[nodiscard]] constexpr std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t seed) noexcept {
+  x = reverse_bits(x);
+  x += seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return reverse_bits(x);
+}
+
+/**
+ * @brief Owen-scrambled Sobol sampler
+ *
+ * Sample i of dimension d of a pixel is the Sobol point of a shuffled
+ * index, Owen-scrambled with a seed of the pixel and d. The first 2^k
+ * samples of a pixel stratify each dimension into 2^k intervals, and
+ * dimensions 0 and 1 jointly into every elementary box of area 2^-k.
+ * Dimensions beyond max_dimensions repeat the matrices with an independent
+ * shuffle per group of max_dimensions (padding).
+ *
+ * @code
+ * const sobol_sampler sampler(seed);
+ * for (std::uint32_t i = 0; i < spp; ++i)
+ *   trace(x, y, sampler(y * width + x, i, 0), sampler(y * width + x, i, 1));
+ * @endcode
+ */
+class sobol_sampler {
+public:
+  static constexpr std::uint32_t max_dimensions = 16; //!< @brief dimensions with their own matrix
+
+  /**
+   * @brief Construct a new sobol sampler object
+   *
+   * @param[in] seed seed
+   */
+  constexpr explicit sobol_sampler(std::uint64_t seed = 0) noexcept
+      : m_seed(seed) {
+  }
+
+  /**
+   * @brief unscrambled Sobol point
+   *
+   * @param[in] index index
+   * @param[in] dim dimension, < max_dimensions
+   * @return Returns the fixed-point value in [0, 1), 32 fraction bits
+   */
+  [[nodiscard]] static constexpr std::uint32_t sobol_bits(std::uint32_t index, std::uint32_t dim) noexcept {
+    assert(dim < max_dimensions);
+    const auto &table = tables[dim];
+    return table[0][index & 0xffu] ^ table[1][(index >> 8) & 0xffu] ^ table[2][(index >> 16) & 0xffu] ^ table[3][index >> 24];
+  }
+
+  /**
+   * @brief sample
+   *
+   * @param[in] pixel pixel, for example y * width + x
+   * @param[in] index sample index
+   * @param[in] dim dimension
+   * @return Returns the value in [0, 1)
+   */
+  [[nodiscard]] constexpr float operator()(std::uint32_t pixel, std::uint32_t index, std::uint32_t dim) const noexcept {
+    const std::uint32_t i = owen_scramble(index, index_seed(pixel, dim));
+    return unit_float(owen_scramble(sobol_bits(i, dim % max_dimensions), dim_seed(pixel, dim)));
+  }
+
+  /**
+   * @brief consecutive samples of a dimension
+   *
+   * The same values as operator(), computed several indices at a time.
+   *
+   * @param[in] pixel pixel
+   * @param[in] first first sample index
+   * @param[in] dim dimension
+   * @param[out] dst values of samples first, first + 1, ...
+   */
+  constexpr void generate(std::uint32_t pixel, std::uint32_t first, std::uint32_t dim, std::span<float> dst) const noexcept {
+    // the scrambles vectorize, the table lookups in between do not
+    constexpr std::size_t batch = 64;
+    const std::uint32_t is      = index_seed(pixel, dim);
+    const std::uint32_t ds      = dim_seed(pixel, dim);
+    std::array<std::uint32_t, batch> bits;
+    for (std::size_t i = 0; i < dst.size(); i += batch) {
+      const std::size_t n = std::min(batch, dst.size() - i);
+      for (std::size_t l = 0; l < batch; ++l)
+        bits[l] = owen_scramble(first + static_cast<std::uint32_t>(i + l), is);
+      for (std::size_t l = 0; l < batch; ++l)
+        bits[l] = sobol_bits(bits[l], dim % max_dimensions);
+      for (std::size_t l = 0; l < n; ++l)
+        dst[i + l] = unit_float(owen_scramble(bits[l], ds));
+    }
+  }
+
+private:
+  // primitive polynomial degree, its inner coefficients and initial direction numbers (Joe and Kuo)
+  struct direction {
+    unsigned degree;
+    std::uint32_t poly;
+    std::array<std::uint32_t, 6> m;
+  };
+
+  static constexpr std::array<direction, max_dimensions - 1> directions = {{
+      {1, 0, {1}},
+      {2, 1, {1, 3}},
+      {3, 1, {1, 3, 1}},
+      {3, 2, {1, 1, 1}},
+      {4, 1, {1, 1, 3, 3}},
+      {4, 4, {1, 3, 5, 13}},
+      {5, 2, {1, 1, 5, 5, 17}},
+      {5, 4, {1, 1, 5, 5, 5}},
+      {5, 7, {1, 1, 7, 11, 19}},
+      {5, 11, {1, 1, 5, 1, 1}},
+      {5, 13, {1, 1, 1, 3, 11}},
+      {5, 14, {1, 3, 5, 5, 31}},
+      {6, 1, {1, 3, 3, 9, 7, 49}},
+      {6, 13, {1, 1, 1, 15, 21, 21}},
+      {6, 16, {1, 3, 1, 13, 27, 49}},
+  }};
+
+  // column b of a matrix is the value of index bit b
+  static constexpr auto matrices = [] {
+    std::array<std::array<std::uint32_t, 32>, max_dimensions> res{};
+    for (std::size_t b = 0; b < 32; ++b)
+      res[0][b] = 1u << (31 - b);
+    for (std::size_t d = 1; d < max_dimensions; ++d) {
+      const auto &[s, a, m] = directions[d - 1];
+      auto &v               = res[d];
+      for (std::size_t b = 0; b < s; ++b)
+        v[b] = m[b] << (31 - b);
+      for (std::size_t b = s; b < 32; ++b) {
+        v[b] = v[b - s] ^ (v[b - s] >> s);
+        for (std::size_t k = 1; k < s; ++k)
+          v[b] ^= ((a >> (s - 1 - k)) & 1u) * v[b - k];
+      }
+    }
+    return res;
+  }();
+
+  // the matrix times each value of each index byte
+  static constexpr auto tables = [] {
+    std::array<std::array<std::array<std::uint32_t, 256>, 4>, max_dimensions> res{};
+    for (std::size_t d = 0; d < max_dimensions; ++d)
+      for (std::size_t k = 0; k < 4; ++k)
+        for (std::uint32_t v = 1; v < 256; ++v)
+          res[d][k][v] = res[d][k][v & (v - 1)] ^ matrices[d][8 * k + static_cast<std::size_t>(std::countr_zero(v))];
+    return res;
+  }();
+
+  [[nodiscard]] constexpr std::uint32_t index_seed(std::uint32_t pixel, std::uint32_t dim) const noexcept {
+    return static_cast<std::uint32_t>(mix64(mix64(m_seed ^ pixel) ^ (dim / max_dimensions)));
+  }
+
+  [[nodiscard]] constexpr std::uint32_t dim_seed(std::uint32_t pixel, std::uint32_t dim) const noexcept {
+    return static_cast<std::uint32_t>(mix64(mix64(m_seed ^ pixel) + 0x9e3779b97f4a7c15u * (dim + 1)) >> 32);
+  }
+
+  std::uint64_t m_seed;
+};
+
+/**
+ * @brief randomized Halton sampler
+ *
+ * Dimension d is the radical inverse in the d-th prime base, shifted
+ * modulo 1 by a random offset per pixel and dimension (Cranley-Patterson
+ * rotation). The first b^k samples stratify dimension d into b^k
+ * intervals, for its base b.
+ */
+class halton_sampler {
+public:
+  static constexpr std::uint32_t max_dimensions = 32; //!< @brief number of bases
+
+  /**
+   * @brief Construct a new halton sampler object
+   *
+   * @param[in] seed seed
+   */
+  constexpr explicit halton_sampler(std::uint64_t seed = 0) noexcept
+      : m_seed(seed) {
+  }
+
+  /**
+   * @brief radical inverse
+   *
+   * @param[in] index index
+   * @param[in] dim dimension, < max_dimensions
+   * @return Returns the digits of index in base the dim-th prime, mirrored at the radix point, correctly rounded
+   */
+  [[nodiscard]] static constexpr double radical_inverse(std::uint32_t index, std::uint32_t dim) noexcept {
+    assert(dim < max_dimensions);
+    const auto &table = tables[dim];
+    return static_cast<double>(mirrored(index, table)) / table.denominator;
+  }
+
+  /**
+   * @brief sample
+   *
+   * @param[in] pixel pixel, for example y * width + x
+   * @param[in] index sample index
+   * @param[in] dim dimension, < max_dimensions
+   * @return Returns the value in [0, 1)
+   */
+  [[nodiscard]] constexpr float operator()(std::uint32_t pixel, std::uint32_t index, std::uint32_t dim) const noexcept {
+    double x = radical_inverse(index, dim) + offset(pixel, dim);
+    x -= x >= 1.0 ? 1.0 : 0.0;
+    // rounding to float may reach 1
+    return std::min(static_cast<float>(x), 1.0f - std::numeric_limits<float>::epsilon() / 2);
+  }
+
+  /**
+   * @brief consecutive samples of a dimension
+   *
+   * The same values as operator(), computed several indices at a time.
+   *
+   * @param[in] pixel pixel
+   * @param[in] first first sample index
+   * @param[in] dim dimension, < max_dimensions
+   * @param[out] dst values of samples first, first + 1, ...
+   */
+  constexpr void generate(std::uint32_t pixel, std::uint32_t first, std::uint32_t dim, std::span<float> dst) const noexcept {
+    // the digit lookups are scalar, the division, rotation and rounding vectorize
+    assert(dim < max_dimensions);
+    constexpr std::size_t batch = 64;
+    const auto &table           = tables[dim];
+    const double shift          = offset(pixel, dim);
+    std::array<std::uint64_t, batch> digits;
+    for (std::size_t i = 0; i < dst.size(); i += batch) {
+      const std::size_t n = std::min(batch, dst.size() - i);
+      for (std::size_t l = 0; l < n; ++l)
+        digits[l] = mirrored(first + static_cast<std::uint32_t>(i + l), table);
+      for (std::size_t l = 0; l < n; ++l) {
+        double x = static_cast<double>(digits[l]) / table.denominator + shift;
+        x -= x >= 1.0 ? 1.0 : 0.0;
+        dst[i + l] = std::min(static_cast<float>(x), 1.0f - std::numeric_limits<float>::epsilon() / 2);
+      }
+    }
+  }
+
+private:
+  static constexpr std::array<std::uint32_t, max_dimensions> primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+                                                                       59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+
+  // an index is split into chunks of m digits, chunk = base^m <= 256, whose mirrored digits come from a table
+  struct digit_table {
+    std::uint32_t chunk;
+    std::uint32_t chunks;
+    double denominator; // chunk^chunks, all 32 bit indices have fewer digits
+    std::array<std::uint8_t, 256> mirrored;
+  };
+
+  static constexpr auto tables = [] {
+    std::array<digit_table, max_dimensions> res{};
+    for (std::size_t d = 0; d < max_dimensions; ++d) {
+      const std::uint32_t base = primes[d];
+      auto &t                  = res[d];
+      std::uint32_t digits     = 1;
+      for (t.chunk = base; t.chunk * base <= 256; t.chunk *= base)
+        ++digits;
+      std::uint64_t denominator = 1;
+      for (t.chunks = 0; denominator <= std::numeric_limits<std::uint32_t>::max(); ++t.chunks)
+        denominator *= t.chunk;
+      t.denominator = static_cast<double>(denominator);
+      for (std::uint32_t c = 0; c < t.chunk; ++c) {
+        std::uint32_t m = 0;
+        for (std::uint32_t k = 0, v = c; k < digits; ++k, v /= base)
+          m = m * base + v % base;
+        t.mirrored[c] = static_cast<std::uint8_t>(m);
+      }
+    }
+    return res;
+  }();
+
+  // the mirrored digits as an integer over table.denominator, below 2^40 and exact in a double
+  [[nodiscard]] static constexpr std::uint64_t mirrored(std::uint32_t index, const digit_table &table) noexcept {
+    std::uint64_t res = 0;
+    for (std::uint32_t k = 0; k < table.chunks; ++k, index /= table.chunk)
+      res = res * table.chunk + table.mirrored[index % table.chunk];
+    return res;
+  }
+
+  [[nodiscard]] constexpr double offset(std::uint32_t pixel, std::uint32_t dim) const noexcept {
+    return unit_double(mix64(mix64(m_seed ^ pixel) + 0x9e3779b97f4a7c15u * (dim + 1)));
+  }
+
+  std::uint64_t m_seed;
+};
+
+/**
+ * @brief R_d sampler (Roberts' generalized golden-ratio sequence)
+ *
+ * Sample i of dimension j is frac(offset + i * alpha_j), alpha_j = g^-(j + 1)
+ * where g is the real root of x^(d + 1) = x + 1, kept in 32 bit fixed point
+ * so a sample is one multiply-add. With d = 2 it is the R2 sequence. The
+ * offset is random per pixel and dimension.
+ */
+class r2_sampler {
+public:
+  /**
+   * @brief Construct a new r2 sampler object
+   *
+   * @param[in] dimensions number of dimensions d
+   * @param[in] seed seed
+   *
+   * @exception std::invalid_argument if dimensions is 0
+   */
+  explicit r2_sampler(std::uint32_t dimensions = 2, std::uint64_t seed = 0)
+      : m_seed(seed) {
+    if (dimensions == 0)
+      throw std::invalid_argument("dimensions must not be 0");
+    double g = 2.0;
+    for (int i = 0; i < 64; ++i)
+      g = std::pow(1.0 + g, 1.0 / (dimensions + 1));
+    double alpha = 1.0;
+    for (std::uint32_t j = 0; j < dimensions; ++j) {
+      alpha /= g;
+      m_alpha.push_back(static_cast<std::uint32_t>(std::llround(std::ldexp(alpha, 32)) & 0xffffffffu));
+    }
+  }
+
+  /**
+   * @brief number of dimensions
+   *
+   * @return Returns d
+   */
+  [[nodiscard]] std::uint32_t dimensions() const noexcept {
+    return static_cast<std::uint32_t>(m_alpha.size());
+  }
+
+  /**
+   * @brief sample
+   *
+   * @param[in] pixel pixel, for example y * width + x
+   * @param[in] index sample index
+   * @param[in] dim dimension, < dimensions()
+   * @return Returns the value in [0, 1)
+   */
+  [[nodiscard]] float operator()(std::uint32_t pixel, std::uint32_t index, std::uint32_t dim) const noexcept {
+    assert(dim < dimensions());
+    return unit_float(offset(pixel, dim) + index * m_alpha[dim]);
+  }
+
+  /**
+   * @brief consecutive samples of a dimension
+   *
+   * @param[in] pixel pixel
+   * @param[in] first first sample index
+   * @param[in] dim dimension, < dimensions()
+   * @param[out] dst values of samples first, first + 1, ...
+   */
+  void generate(std::uint32_t pixel, std::uint32_t first, std::uint32_t dim, std::span<float> dst) const noexcept {
+    assert(dim < dimensions());
+    const std::uint32_t alpha = m_alpha[dim];
+    const std::uint32_t start = offset(pixel, dim) + first * alpha;
+    for (std::size_t i = 0; i < dst.size(); ++i)
+      dst[i] = unit_float(start + static_cast<std::uint32_t>(i) * alpha);
+  }
+
+private:
+  [[nodiscard]] std::uint32_t offset(std::uint32_t pixel, std::uint32_t dim) const noexcept {
+    return static_cast<std::uint32_t>(mix64(mix64(m_seed ^ pixel) + 0x9e3779b97f4a7c15u * (dim + 1)) >> 32);
+  }
+
+  std::uint64_t m_seed;
+  std::vector<std::uint32_t> m_alpha;
+};
+
+/**
+ * @brief tiled blue-noise mask
+ *
+ * A size x size threshold mask made by void-and-cluster: each value is a
+ * distinct rank (r + 0.5) / size^2, and thresholding at any level leaves
+ * evenly spread pixels without low-frequency clumps. The mask tiles the
+ * plane. Sample i of dimension d at a pixel reads the mask at an offset
+ * per dimension and adds i times a step of the R2 sequence modulo 1, so
+ * each sample index keeps the blue-noise spectrum over the screen while
+ * the samples of a pixel are well spread.
+ */
+class blue_noise_mask {
+public:
+  /**
+   * @brief Construct a new blue noise mask object
+   *
+   * Building takes O(size^4) time, build it once.
+   *
+   * @param[in] size width and height
+   * @param[in] seed seed of the initial pattern
+   *
+   * @exception std::invalid_argument if size is 0
+   */
+  explicit blue_noise_mask(std::size_t size = 64, std::uint64_t seed = 0)
+      : m_size(size)
+      , m_values(size * size) {
+    if (size == 0)
+      throw std::invalid_argument("size must not be 0");
+    build(seed);
+  }
+
+  /**
+   * @brief width and height
+   *
+   * @return Returns the size
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_size;
+  }
+
+  /**
+   * @brief mask value
+   *
+   * @param[in] x x, wrapped
+   * @param[in] y y, wrapped
+   * @return Returns the value in (0, 1)
+   */
+  [[nodiscard]] float operator()(std::size_t x, std::size_t y) const noexcept {
+    return m_values[y % m_size * m_size + x % m_size];
+  }
+
+  /**
+   * @brief sample
+   *
+   * @param[in] x x
+   * @param[in] y y
+   * @param[in] index sample index
+   * @param[in] dim dimension
+   * @return Returns the value in [0, 1)
+   */
+  [[nodiscard]] float operator()(std::size_t x, std::size_t y, std::uint32_t index, std::uint32_t dim) const noexcept {
+    return unit_float(start(x, y, dim) + index * step(dim));
+  }
+
+  /**
+   * @brief consecutive samples of a dimension
+   *
+   * The same values as operator(), the mask is read once and each sample
+   * is one multiply-add.
+   *
+   * @param[in] x x
+   * @param[in] y y
+   * @param[in] first first sample index
+   * @param[in] dim dimension
+   * @param[out] dst values of samples first, first + 1, ...
+   */
+  void generate(std::size_t x, std::size_t y, std::uint32_t first, std::uint32_t dim, std::span<float> dst) const noexcept {
+    const std::uint32_t s = step(dim);
+    const std::uint32_t v = start(x, y, dim) + first * s;
+    for (std::size_t i = 0; i < dst.size(); ++i)
+      dst[i] = unit_float(v + static_cast<std::uint32_t>(i) * s);
+  }
+
+private:
+  [[nodiscard]] std::uint32_t start(std::size_t x, std::size_t y, std::uint32_t dim) const noexcept {
+    const std::uint64_t h = mix64(dim);
+    const float v         = (*this)(x + static_cast<std::size_t>(h % m_size), y + static_cast<std::size_t>((h >> 32) % m_size));
+    return static_cast<std::uint32_t>(std::ldexp(v, 32));
+  }
+
+  // R2 steps, so that dimensions 2j and 2j + 1 do not move together
+  [[nodiscard]] static constexpr std::uint32_t step(std::uint32_t dim) noexcept {
+    return dim % 2 == 0 ? 0xc13fa9a9u : 0x91e10da5u;
+  }
+
+  void build(std::uint64_t seed) {
+    const std::size_t n = m_values.size();
+    // gaussian energy of the toroidal offset (dx, dy)
+    std::vector<double> kernel(n);
+    for (std::size_t dy = 0; dy < m_size; ++dy) {
+      for (std::size_t dx = 0; dx < m_size; ++dx) {
+        const double tx          = static_cast<double>(std::min(dx, m_size - dx));
+        const double ty          = static_cast<double>(std::min(dy, m_size - dy));
+        kernel[dy * m_size + dx] = std::exp(-(tx * tx + ty * ty) / (2 * 1.5 * 1.5));
+      }
+    }
+    std::vector<double> energy(n);
+    std::vector<char> ones(n);
+    const auto update = [&](std::size_t p, double sign) {
+      ones[p]              = sign > 0;
+      const std::size_t px = p % m_size, py = p / m_size;
+      for (std::size_t y = 0; y < m_size; ++y) {
+        const double *row = kernel.data() + (y + m_size - py) % m_size * m_size;
+        for (std::size_t x = 0; x < m_size; ++x)
+          energy[y * m_size + x] += sign * row[(x + m_size - px) % m_size];
+      }
+    };
+    // the one with the most energy is the tightest cluster, the zero with the least the largest void
+    const auto extreme = [&](bool one) {
+      std::size_t res = n;
+      for (std::size_t p = 0; p < n; ++p)
+        if (ones[p] == one && (res == n || (one ? energy[p] > energy[res] : energy[p] < energy[res])))
+          res = p;
+      return res;
+    };
+
+    // initial pattern of about a tenth, relaxed by moving clusters into voids
+    pcg32 engine(seed);
+    std::size_t count = std::max<std::size_t>(1, n / 10);
+    for (std::size_t placed = 0; placed < count;) {
+      const std::size_t p = engine() % n;
+      if (!ones[p]) {
+        update(p, 1);
+        ++placed;
+      }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::size_t cluster = extreme(true);
+      update(cluster, -1);
+      const std::size_t hole = extreme(false);
+      update(hole, 1);
+      if (hole == cluster)
+        break;
+    }
+    const auto initial_ones   = ones;
+    const auto initial_energy = energy;
+
+    // rank the initial pattern by removing clusters, then fill voids
+    std::vector<std::size_t> rank(n);
+    for (std::size_t r = count; r-- > 0;) {
+      const std::size_t cluster = extreme(true);
+      update(cluster, -1);
+      rank[cluster] = r;
+    }
+    ones   = initial_ones;
+    energy = initial_energy;
+    for (std::size_t r = count; r < n; ++r) {
+      const std::size_t hole = extreme(false);
+      update(hole, 1);
+      rank[hole] = r;
+    }
+    for (std::size_t p = 0; p < n; ++p)
+      m_values[p] = static_cast<float>((static_cast<double>(rank[p]) + 0.5) / static_cast<double>(n));
+  }
+
+  std::size_t m_size;
+  std::vector<float> m_values;
+};
+} // namespace portal
+
+#endif // PORTAL_SAMPLER_HPP
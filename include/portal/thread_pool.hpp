@@ -0,0 +1,295 @@
+/**
+ * @file thread_pool.hpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief work-stealing thread pool
+ * @version 0.1
+ * @date 2022-04-15
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#ifndef PORTAL_THREAD_POOL_HPP
+#define PORTAL_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief portal namespace
+ *
+ */
+namespace portal {
+/**
+ * @brief work-stealing thread pool for parallel loops
+ *
+ * A loop of count indices is cut into chunks of grain indices. Each
+ * participant, the calling thread and the workers, starts with a
+ * contiguous share of the chunks and takes them from the front; when its
+ * share runs out it steals the back half of another participant's share,
+ * trying its neighbours first. Participant i thus gets the same indices
+ * loop after loop, so with pinned workers the memory it first touched
+ * stays on its NUMA node. A share is a begin / end pair in one atomic
+ * word, taking and stealing are a single compare-exchange each.
+ *
+ * Loops run one at a time, a loop started from inside a loop of the same
+ * pool runs on the calling thread.
+ */
+class thread_pool {
+public:
+  using size_type = std::size_t; //!< @brief size type
+
+  /**
+   * @brief constructor
+   *
+   * @param[in] threads number of participants including the calling thread, 0 for std::thread::hardware_concurrency()
+   * @param[in] pin pin worker i to the i-th CPU the process may run on (Linux only, ignored elsewhere)
+   *
+   * @exception std::system_error if a worker cannot be started, the ones already started are joined
+   */
+  explicit thread_pool(size_type threads = 0, bool pin = false)
+      : m_slots(std::max<size_type>(1, threads != 0 ? threads : std::thread::hardware_concurrency())) {
+    m_workers.reserve(m_slots.size() - 1);
+    try {
+      for (size_type i = 1; i < m_slots.size(); ++i)
+        m_workers.emplace_back([this, i, pin] {
+          if (pin)
+            pin_to_cpu(i);
+          worker(i);
+        });
+    } catch (...) {
+      // the destructor does not run for a throwing constructor
+      stop();
+      throw;
+    }
+  }
+
+  thread_pool(const thread_pool &)            = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  /**
+   * @brief destructor, joins the workers
+   *
+   */
+  ~thread_pool() {
+    stop();
+  }
+
+  /**
+   * @brief process-wide pool
+   *
+   * @return pool with a participant per hardware thread
+   */
+  [[nodiscard]] static thread_pool &shared() {
+    static thread_pool pool;
+    return pool;
+  }
+
+  /**
+   * @brief number of participants
+   *
+   * @return Returns the number of workers plus the calling thread
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    return m_slots.size();
+  }
+
+  /**
+   * @brief run a loop in parallel
+   *
+   * Returns when every index is done. If func throws, chunks not yet
+   * started are skipped and the first exception is rethrown.
+   *
+   * @param[in] count number of indices
+   * @param[in] grain indices per chunk, 0 for about 8 chunks per participant
+   * @param[in] func called as func(begin, end) for each chunk [begin, end) of [0, count)
+   */
+  template <typename F>
+  void parallel_for(size_type count, size_type grain, F &&func) {
+    if (count == 0)
+      return;
+    if (grain == 0)
+      grain = std::max<size_type>(1, count / (size() * 8));
+    // a chunk index must fit in half a share word
+    grain             = std::max(grain, (count - 1) / std::numeric_limits<std::uint32_t>::max() + 1);
+    const size_type n = (count + grain - 1) / grain;
+    const auto run    = [&func, count, grain](size_type first, size_type last) { func(first * grain, std::min(count, last * grain)); };
+    if (n == 1 || size() == 1 || t_current == this) {
+      run(0, n);
+      return;
+    }
+
+    std::lock_guard job_lock(m_job_mutex);
+    m_func  = [](void *ctx, size_type first, size_type last) { (*static_cast<decltype(run) *>(ctx))(first, last); };
+    m_ctx   = const_cast<void *>(static_cast<const void *>(&run));
+    m_error = nullptr;
+    m_failed.store(false, std::memory_order_relaxed);
+    for (size_type i = 0; i < size(); ++i)
+      m_slots[i].share.store(make_share(n * i / size(), n * (i + 1) / size()), std::memory_order_relaxed);
+    m_pending.store(m_workers.size(), std::memory_order_relaxed);
+    {
+      std::lock_guard lock(m_mutex);
+      ++m_generation;
+    }
+    m_wake.notify_all();
+
+    participate(0);
+    // every worker checks in, so none is left stealing from the slots of the next loop
+    {
+      std::unique_lock lock(m_mutex);
+      m_done.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+
+private:
+  // begin in the low half, end in the high half
+  [[nodiscard]] static constexpr std::uint64_t make_share(size_type first, size_type last) noexcept {
+    return std::uint64_t{last} << 32 | first;
+  }
+
+  struct alignas(64) slot {
+    std::atomic<std::uint64_t> share{0};
+  };
+
+  // wake and join the started workers
+  void stop() noexcept {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &th : m_workers)
+      th.join();
+  }
+
+  void worker(size_type index) {
+    std::uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock lock(m_mutex);
+        m_wake.wait(lock, [this, seen] { return m_stop || m_generation != seen; });
+        if (m_stop)
+          return;
+        seen = m_generation;
+      }
+      participate(index);
+      if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(m_mutex);
+        m_done.notify_one();
+      }
+    }
+  }
+
+  void participate(size_type index) {
+    const thread_pool *outer = std::exchange(t_current, this);
+    for (;;) {
+      while (take(index))
+        ;
+      if (!steal(index))
+        break;
+    }
+    t_current = outer;
+  }
+
+  // run the first chunk of the own share
+  bool take(size_type index) {
+    auto &share     = m_slots[index].share;
+    std::uint64_t s = share.load(std::memory_order_acquire);
+    std::uint32_t first;
+    do {
+      first = static_cast<std::uint32_t>(s);
+      if (first >= static_cast<std::uint32_t>(s >> 32))
+        return false;
+    } while (!share.compare_exchange_weak(s, s + 1, std::memory_order_acq_rel));
+    if (!m_failed.load(std::memory_order_relaxed)) {
+      try {
+        m_func(m_ctx, first, first + 1);
+      } catch (...) {
+        std::lock_guard lock(m_mutex);
+        if (!m_failed.exchange(true))
+          m_error = std::current_exception();
+      }
+    }
+    return true;
+  }
+
+  // move the back half of another share into the own one, nearest participants first
+  bool steal(size_type index) {
+    for (size_type d = 1; d < size(); ++d) {
+      for (const size_type victim : {(index + d) % size(), (index + size() - d) % size()}) {
+        auto &share     = m_slots[victim].share;
+        std::uint64_t s = share.load(std::memory_order_acquire);
+        for (;;) {
+          const std::uint32_t first = static_cast<std::uint32_t>(s);
+          const std::uint32_t last  = static_cast<std::uint32_t>(s >> 32);
+          if (first >= last)
+            break;
+          const std::uint32_t mid = first + (last - first) / 2;
+          if (share.compare_exchange_weak(s, make_share(first, mid), std::memory_order_acq_rel)) {
+            // the own share is empty, nobody else changes it
+            m_slots[index].share.store(make_share(mid, last), std::memory_order_release);
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  static void pin_to_cpu([[maybe_unused]] size_type index) noexcept {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+      return;
+    size_type k = index % static_cast<size_type>(CPU_COUNT(&allowed));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &allowed) && k-- == 0) {
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+        return;
+      }
+    }
+#endif
+  }
+
+  static inline thread_local const thread_pool *t_current = nullptr;
+
+  std::vector<slot> m_slots;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_job_mutex;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  std::uint64_t m_generation = 0;
+  bool m_stop                = false;
+
+  void (*m_func)(void *, size_type, size_type) = nullptr;
+  void *m_ctx                                  = nullptr;
+  std::atomic<size_type> m_pending{0};
+  std::atomic<bool> m_failed{false};
+  std::exception_ptr m_error;
+};
+} // namespace portal
+
+#endif // PORTAL_THREAD_POOL_HPP
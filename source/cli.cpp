@@ -0,0 +1,299 @@
+/**
+ * @file cli.cpp
+ * @author ygsiro (entoyukari@gmail.com)
+ * @brief headless frontend
+ * @version 0.1
+ * @date 2022-04-18
+ *
+ * @copyright &copy; 2022 ygsiro
+ *
+ */
+#include <portal/drawing/image.hpp>
+#include <portal/drawing/netpbm.hpp>
+#include <portal/drawing/noise.hpp>
+#include <portal/drawing/parallel.hpp>
+#include <portal/drawing/png.hpp>
+#include <portal/drawing/qoi.hpp>
+#include <portal/sampler.hpp>
+#include <portal/thread_pool.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace portal::drawing;
+
+namespace {
+constexpr std::string_view usage = R"(usage: portal_cli [options] [job]
+
+options:
+  -j, --threads N   worker threads including the main one, 0 for all cores (default)
+  -t, --timing      print the time of each phase of each job to stderr
+  -b, --batch FILE  run the jobs of FILE, one per line, '#' starts a comment, - for stdin
+  -h, --help        print this help
+
+jobs:
+  render WIDTH HEIGHT SPP OUT   zone plate, SPP Sobol samples per pixel
+  noise WIDTH HEIGHT OUT        uniform noise
+
+OUT is written by its extension as PNG or QOI (8 bit sRGB), PFM (linear float) or
+otherwise binary PPM (8 bit sRGB).
+)";
+
+using linear_rgb = basic_rgb<float, color_encoding::linear>;
+using rgb8       = basic_rgb<std::uint8_t>;
+
+/**
+ * @brief wall-clock time of the phases of a job
+ *
+ */
+class phase_timer {
+public:
+  /**
+   * @brief end the current phase and start another
+   *
+   * @param[in] name name of the phase that ends
+   */
+  void lap(std::string name) {
+    const auto now = clock::now();
+    m_phases.emplace_back(std::move(name), std::chrono::duration<double, std::milli>(now - m_last).count());
+    m_last = now;
+  }
+
+  /**
+   * @brief phases as "name 1.23 ms, ..., total 4.56 ms"
+   *
+   * @return Returns the text
+   */
+  [[nodiscard]] std::string str() const {
+    std::ostringstream os;
+    os.setf(std::ios::fixed);
+    os.precision(2);
+    double total = 0;
+    for (const auto &[name, ms] : m_phases) {
+      os << name << ' ' << ms << " ms, ";
+      total += ms;
+    }
+    os << "total " << total << " ms";
+    return os.str();
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  clock::time_point m_last = clock::now();
+  std::vector<std::pair<std::string, double>> m_phases;
+};
+
+/**
+ * @brief number of an argument
+ *
+ * @param[in] arg argument
+ * @return Returns the number
+ *
+ * @exception std::invalid_argument if arg is not a non-negative integer
+ */
+std::size_t to_size(std::string_view arg) {
+  std::size_t res;
+  const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), res);
+  if (ec != std::errc() || ptr != arg.data() + arg.size())
+    throw std::invalid_argument("not a number: " + std::string(arg));
+  return res;
+}
+
+/**
+ * @brief write a linear image
+ *
+ * @param[in] img image
+ * @param[in] path PNG, QOI, PFM or PPM file
+ * @param[in] pool pool for the conversion to sRGB and PNG compression
+ * @param[in,out] timer timer
+ */
+void write_image(const basic_image<linear_rgb> &img, const std::filesystem::path &path, portal::thread_pool &pool, phase_timer &timer) {
+  auto ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  if (ext == ".pfm") {
+    save_netpbm(path, img);
+  } else {
+    basic_image<rgb8> encoded(img.get_width(), img.get_height());
+    parallel_transform(img, encoded, 0, pool);
+    timer.lap("encode");
+    if (ext == ".png")
+      save_png(path, encoded, 6, pool);
+    else if (ext == ".qoi")
+      save_qoi(path, encoded);
+    else
+      save_netpbm(path, encoded);
+  }
+  timer.lap("write");
+}
+
+/**
+ * @brief render a zone plate
+ *
+ * cos(k r^2) aliases badly at low sample counts, the channels use
+ * different k.
+ */
+basic_image<linear_rgb> render(std::size_t width, std::size_t height, std::uint32_t spp, portal::thread_pool &pool) {
+  basic_image<linear_rgb> img(width, height);
+  const portal::sobol_sampler sampler(1);
+  const float scale = 1.0f / static_cast<float>(std::max(width, height));
+  parallel_for_rows(
+      img, [&](auto band, std::size_t top) {
+        for (std::size_t j = 0; j < band.get_height(); ++j) {
+          for (std::size_t x = 0; x < band.get_width(); ++x) {
+            const auto pixel = static_cast<std::uint32_t>((top + j) * width + x);
+            linear_rgb sum{0.0f, 0.0f, 0.0f};
+            for (std::uint32_t i = 0; i < spp; ++i) {
+              const float u  = (static_cast<float>(x) + sampler(pixel, i, 0)) * scale - 0.5f;
+              const float v  = (static_cast<float>(top + j) + sampler(pixel, i, 1)) * scale - 0.5f;
+              const float r2 = u * u + v * v;
+              sum.red += 0.5f + 0.5f * std::cos(900.0f * r2);
+              sum.green += 0.5f + 0.5f * std::cos(1200.0f * r2);
+              sum.blue += 0.5f + 0.5f * std::cos(1500.0f * r2);
+            }
+            band(x, j) = {sum.red / spp, sum.green / spp, sum.blue / spp};
+          }
+        }
+      },
+      0, pool);
+  return img;
+}
+
+/**
+ * @brief run a job
+ *
+ * @param[in] args job name and arguments
+ * @param[in] pool pool
+ * @param[in,out] timer timer
+ * @return Returns a description of the job
+ *
+ * @exception std::invalid_argument if the job is unknown or its arguments are wrong
+ */
+std::string run(const std::vector<std::string> &args, portal::thread_pool &pool, phase_timer &timer) {
+  const auto expect = [&args](std::size_t count) {
+    if (args.size() != count + 1)
+      throw std::invalid_argument(args[0] + " takes " + std::to_string(count) + " arguments");
+  };
+  const auto extent = [&args](std::size_t i) {
+    const std::size_t res = to_size(args[i]);
+    if (res == 0)
+      throw std::invalid_argument(args[0] + " needs a positive width and height");
+    return res;
+  };
+  if (args[0] == "render") {
+    expect(4);
+    const std::size_t width = extent(1), height = extent(2);
+    const auto spp          = static_cast<std::uint32_t>(std::max<std::size_t>(1, to_size(args[3])));
+    const auto img          = render(width, height, spp, pool);
+    timer.lap("render");
+    write_image(img, args[4], pool, timer);
+    return "render " + args[1] + 'x' + args[2] + 'x' + std::to_string(spp) + " -> " + args[4];
+  }
+  if (args[0] == "noise") {
+    expect(3);
+    basic_image<linear_rgb> img(extent(1), extent(2));
+    parallel_for_rows(
+        img, [](auto band, std::size_t) { fill_noise(band); }, 0, pool);
+    timer.lap("noise");
+    write_image(img, args[3], pool, timer);
+    return "noise " + args[1] + 'x' + args[2] + " -> " + args[3];
+  }
+  throw std::invalid_argument("unknown job: " + args[0]);
+}
+
+/**
+ * @brief jobs of a batch file
+ *
+ * @param[in] in batch file
+ * @return Returns the jobs, split on white space
+ */
+std::vector<std::vector<std::string>> read_batch(std::istream &in) {
+  std::vector<std::vector<std::string>> res;
+  for (std::string line; std::getline(in, line);) {
+    std::istringstream words(line.substr(0, line.find('#')));
+    std::vector<std::string> job;
+    for (std::string word; words >> word;)
+      job.push_back(word);
+    if (!job.empty())
+      res.push_back(std::move(job));
+  }
+  return res;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::size_t threads = 0;
+  bool timing         = false;
+  std::vector<std::vector<std::string>> jobs;
+  std::vector<std::string> job;
+  std::optional<portal::thread_pool> pool;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string_view arg = argv[i];
+      const auto value           = [&]() -> std::string_view {
+        if (i + 1 >= argc)
+          throw std::invalid_argument(std::string(arg) + " needs a value");
+        return argv[++i];
+      };
+      if (arg == "-h" || arg == "--help") {
+        std::cout << usage;
+        return 0;
+      } else if (arg == "-j" || arg == "--threads") {
+        threads = to_size(value());
+      } else if (arg == "-t" || arg == "--timing") {
+        timing = true;
+      } else if (arg == "-b" || arg == "--batch") {
+        const std::string path(value());
+        std::ifstream file;
+        if (path != "-") {
+          file.open(path);
+          if (!file)
+            throw std::runtime_error("cannot open " + path);
+        }
+        for (auto &batch_job : read_batch(path == "-" ? std::cin : file))
+          jobs.push_back(std::move(batch_job));
+      } else {
+        job.emplace_back(arg);
+      }
+    }
+    if (!job.empty())
+      jobs.push_back(std::move(job));
+    if (jobs.empty()) {
+      std::cerr << usage;
+      return 2;
+    }
+    // a thread count the system cannot start is reported like a bad argument
+    pool.emplace(threads);
+  } catch (const std::exception &e) {
+    std::cerr << "portal_cli: " << e.what() << '\n' << usage;
+    return 2;
+  }
+
+  if (timing)
+    std::cerr << "threads: " << pool->size() << '\n';
+  int status = 0;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    phase_timer timer;
+    try {
+      const auto what = run(jobs[i], *pool, timer);
+      if (timing)
+        std::cerr << "job " << i + 1 << ": " << what << ": " << timer.str() << '\n';
+    } catch (const std::exception &e) {
+      std::cerr << "portal_cli: job " << i + 1 << ": " << e.what() << '\n';
+      status = 1;
+    }
+  }
+  return status;
+}
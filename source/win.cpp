@@ -1,9 +0,0 @@
-#include <Windows.h>
-#include <tchar.h>
-
-int WINAPI _tWinMain([[maybe_unused]] _In_ HINSTANCE hInstance,
-                     [[maybe_unused]] _In_opt_ HINSTANCE hPrevInstance,
-                     [[maybe_unused]] _In_ LPTSTR lpCmdLine,
-                     [[maybe_unused]] _In_ int nCmdShow) {
-  return 0;
-}
\ No newline at end of file
@@ -1 +1,1470 @@
-#include <portal/drawing/image.hpp>
\ No newline at end of file
+#include <portal/drawing/image.hpp>
+#include <portal/drawing/algorithm.hpp>
+#include <portal/drawing/composite.hpp>
+#include <portal/drawing/convolution.hpp>
+#include <portal/drawing/netpbm.hpp>
+#include <portal/drawing/noise.hpp>
+#include <portal/drawing/packed.hpp>
+#include <portal/drawing/parallel.hpp>
+#include <portal/drawing/png.hpp>
+#include <portal/drawing/pyramid.hpp>
+#include <portal/drawing/qoi.hpp>
+#include <portal/drawing/resample.hpp>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace portal::drawing;
+
+namespace {
+using rgba8 = basic_rgba<std::uint8_t>;
+using rgb8  = basic_rgb<std::uint8_t>;
+
+template <typename Image>
+bool rows_aligned(const Image &img) {
+  for (std::size_t y = 0; y < img.get_height(); ++y)
+    if (reinterpret_cast<std::uintptr_t>(img.row(y)) % Image::alignment != 0)
+      return false;
+  return true;
+}
+
+std::span<const std::byte> as_bytes(const std::string &str) {
+  return std::as_bytes(std::span(str.data(), str.size()));
+}
+
+template <typename P>
+basic_image<P> round_trip(const basic_image<P> &img, const char *magic) {
+  std::ostringstream out;
+  write_netpbm(out, img);
+  const auto file = out.str();
+  EXPECT_EQ(0, file.compare(0, 2, magic));
+  return decode_netpbm<P>(as_bytes(file));
+}
+} // namespace
+
+TEST(Image, Storage) {
+  basic_image<rgba8> a(33, 5);
+  EXPECT_EQ(33U, a.get_width());
+  EXPECT_EQ(5U, a.get_height());
+  EXPECT_EQ(48U, a.get_stride());
+  EXPECT_EQ(165U, a.size());
+  EXPECT_TRUE(rows_aligned(a));
+
+  basic_image<rgb8> b(10, 3);
+  EXPECT_EQ(64U, b.get_stride());
+  EXPECT_TRUE(rows_aligned(b));
+
+  basic_image<rgb8> c(10, 3, 10);
+  EXPECT_EQ(10U, c.get_stride());
+  EXPECT_THROW((basic_image<rgb8>(10, 3, 9)), std::invalid_argument);
+
+  basic_image<rgba8> empty;
+  EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(Image, Empty) {
+  // a zero width or height leaves the image without pixels or stride
+  for (const auto &[w, h] : {std::pair<std::size_t, std::size_t>{5, 0}, {0, 5}}) {
+    basic_image<rgba8> img(w, h);
+    EXPECT_EQ(0U, img.size());
+    EXPECT_EQ(img.begin(), img.end());
+    img.fill({1, 2, 3, 4});
+    EXPECT_TRUE(img.view().empty());
+    EXPECT_EQ(w, img.view().get_width());
+    EXPECT_EQ(h, img.view().get_height());
+
+    basic_image<rgba8, aligned_allocator<rgba8>, tiled<8>> tiles(w, h);
+    EXPECT_EQ(tiles.view().begin(), tiles.view().end());
+    fill(tiles, {1, 2, 3, 4});
+
+    parallel_for_rows(img, [](auto, std::size_t) { FAIL(); });
+    parallel_for_tiles(img, 4, 4, [](auto, std::size_t, std::size_t) { FAIL(); });
+    EXPECT_EQ(0u, basic_image_pyramid<rgba8>(img).levels());
+  }
+}
+
+TEST(Image, Access) {
+  basic_image<rgba8> img(7, 3);
+  img.fill({1, 2, 3, 4});
+  img(6, 2) = {5, 6, 7, 8};
+  EXPECT_EQ((rgba8{5, 6, 7, 8}), img.at(6, 2));
+  EXPECT_EQ((rgba8{1, 2, 3, 4}), std::as_const(img)(0, 1));
+  EXPECT_EQ(&img.row(1)[0], &img(0, 1));
+  EXPECT_THROW((void)img.at(7, 0), std::out_of_range);
+  EXPECT_THROW((void)img.at(0, 3), std::out_of_range);
+
+  // iteration skips the row padding
+  EXPECT_EQ(21, std::distance(img.begin(), img.end()));
+  EXPECT_EQ(20, std::count(img.cbegin(), img.cend(), rgba8{1, 2, 3, 4}));
+  EXPECT_EQ((rgba8{5, 6, 7, 8}), *img.rbegin());
+  EXPECT_EQ(21, std::distance(img.crbegin(), img.crend()));
+}
+
+TEST(Image, CopyMove) {
+  basic_image<rgba8> a(5, 4);
+  a.fill({9, 9, 9, 9});
+  a(2, 3) = {1, 1, 1, 1};
+
+  basic_image<rgba8> b(a);
+  EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+  EXPECT_NE(a.data(), b.data());
+
+  const auto *ptr = b.data();
+  basic_image<rgba8> c(std::move(b));
+  EXPECT_EQ(ptr, c.data());
+  EXPECT_EQ(nullptr, b.data());
+
+  basic_image<rgba8> d(2, 2);
+  d = c;
+  EXPECT_TRUE(std::equal(a.begin(), a.end(), d.begin(), d.end()));
+  d = basic_image<rgba8>();
+  EXPECT_EQ(0U, d.size());
+}
+
+TEST(Image, Pool) {
+  buffer_pool pool;
+  using image = basic_image<rgba8, pool_allocator<rgba8>>;
+  const rgba8 *first = nullptr;
+  {
+    image a(640, 480, pool_allocator<rgba8>(pool));
+    first = a.data();
+    EXPECT_TRUE(rows_aligned(a));
+  }
+  EXPECT_EQ(640U * 480 * sizeof(rgba8), pool.cached());
+  {
+    image b(640, 480, pool_allocator<rgba8>(pool));
+    EXPECT_EQ(first, b.data());
+    EXPECT_EQ(0U, pool.cached());
+    image c(b);
+    EXPECT_EQ(&pool, &c.get_allocator().pool());
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool] {
+      for (int i = 0; i < 100; ++i) {
+        image img(64 + i % 3, 64, pool_allocator<rgba8>(pool));
+        img.fill({1, 2, 3, 4});
+      }
+    });
+  }
+  for (auto &th : threads)
+    th.join();
+  pool.trim();
+  EXPECT_EQ(0U, pool.cached());
+
+  // the second buffer would go over the limit and is freed
+  buffer_pool small(default_alignment, 1000);
+  void *p = small.acquire(600);
+  void *q = small.acquire(600);
+  small.release(p, 600);
+  small.release(q, 600);
+  EXPECT_EQ(1000U, small.max_cached());
+  EXPECT_EQ(600U, small.cached());
+}
+
+TEST(ImageView, Subview) {
+  basic_image<rgba8> img(16, 8);
+  img.fill({0, 0, 0, 0});
+  auto roi = img.view().subview(4, 2, 5, 3);
+  EXPECT_EQ(5U, roi.get_width());
+  EXPECT_EQ(3U, roi.get_height());
+  EXPECT_EQ(img.get_stride(), roi.get_stride());
+  EXPECT_EQ(&img(4, 2), &roi(0, 0));
+  EXPECT_EQ(&img(8, 4), &roi.at(4, 2));
+  EXPECT_THROW((void)roi.at(5, 0), std::out_of_range);
+  EXPECT_THROW((void)roi.subview(1, 0, 5, 1), std::out_of_range);
+  EXPECT_TRUE(roi.subview(5, 3, 0, 0).empty());
+
+  fill(roi, {1, 1, 1, 1});
+  EXPECT_EQ(15, std::count(img.begin(), img.end(), rgba8{1, 1, 1, 1}));
+  EXPECT_EQ((rgba8{0, 0, 0, 0}), img(3, 2));
+  EXPECT_EQ((rgba8{0, 0, 0, 0}), img(9, 2));
+
+  std::size_t rows = 0;
+  for (auto row : roi.rows()) {
+    EXPECT_EQ(5U, row.size());
+    EXPECT_EQ(&img(4, 2 + rows), row.data());
+    ++rows;
+  }
+  EXPECT_EQ(3U, rows);
+  EXPECT_EQ(15, std::distance(roi.begin(), roi.end()));
+
+  const basic_image_view<const rgba8> read_only = roi;
+  EXPECT_EQ(roi.data(), read_only.data());
+}
+
+TEST(ImageView, External) {
+  std::vector<rgba8> frame(6 * 4, rgba8{7, 7, 7, 7});
+  basic_image_view<rgba8> view(frame.data(), 5, 4, 6);
+  EXPECT_EQ(&frame[13], &view(1, 2));
+  fill(view, {2, 2, 2, 2});
+  EXPECT_EQ(20, std::count(frame.begin(), frame.end(), rgba8{2, 2, 2, 2}));
+  EXPECT_THROW((basic_image_view<rgba8>(frame.data(), 5, 4, 4)), std::invalid_argument);
+}
+
+TEST(ImageView, Empty) {
+  std::vector<rgba8> frame(4, rgba8{7, 7, 7, 7});
+  for (const auto &[w, h] : {std::pair<std::size_t, std::size_t>{5, 0}, {0, 5}}) {
+    basic_image_view<rgba8> view(frame.data(), w, h, 0);
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(nullptr, view.data());
+    EXPECT_EQ(0U, view.get_stride());
+    EXPECT_EQ(view.begin(), view.end());
+    for (auto row : view.rows())
+      FAIL() << row.size();
+    fill(view, {1, 1, 1, 1});
+    EXPECT_TRUE(view.subview(0, 0, w, h).empty());
+  }
+  EXPECT_EQ(4, std::count(frame.begin(), frame.end(), rgba8{7, 7, 7, 7}));
+}
+
+TEST(ImageView, Blit) {
+  basic_image<rgba8> src(4, 4), dst(6, 6);
+  for (std::size_t y = 0; y < 4; ++y)
+    for (std::size_t x = 0; x < 4; ++x)
+      src(x, y) = {std::uint8_t(x), std::uint8_t(y), 0, 255};
+  dst.fill({9, 9, 9, 9});
+
+  blit(src, dst, 3, -1);
+  EXPECT_EQ((rgba8{0, 1, 0, 255}), dst(3, 0));
+  EXPECT_EQ((rgba8{2, 3, 0, 255}), dst(5, 2));
+  EXPECT_EQ((rgba8{9, 9, 9, 9}), dst(2, 0));
+  EXPECT_EQ((rgba8{9, 9, 9, 9}), dst(3, 3));
+  EXPECT_EQ(9, std::count_if(dst.begin(), dst.end(), [](const rgba8 &p) { return p.alpha == 255; }));
+
+  // overlapping move within one image
+  blit(src, src.view().subview(1, 1, 3, 3));
+  EXPECT_EQ((rgba8{0, 0, 0, 255}), src(1, 1));
+  EXPECT_EQ((rgba8{1, 1, 0, 255}), src(2, 2));
+  EXPECT_EQ((rgba8{2, 2, 0, 255}), src(3, 3));
+  blit(src.view().subview(1, 1, 3, 3), src);
+  EXPECT_EQ((rgba8{0, 0, 0, 255}), src(0, 0));
+  EXPECT_EQ((rgba8{2, 1, 0, 255}), src(2, 1));
+}
+
+TEST(ImageView, Convert) {
+  basic_image<rgba8> src(3, 2);
+  src.fill({10, 20, 30, 40});
+  basic_image<basic_g<float>> dst(3, 2);
+  convert(src, dst, [](const rgba8 &p) { return basic_g<float>{(p.red + p.green + p.blue) / 3.f}; });
+  EXPECT_EQ(6, std::count(dst.begin(), dst.end(), basic_g<float>{20.f}));
+  basic_image<basic_g<float>> small(2, 2);
+  EXPECT_THROW(convert(src, small, [](const rgba8 &) { return basic_g<float>{}; }), std::invalid_argument);
+}
+
+TEST(Layout, Mapping) {
+  const tiled<8, 4>::mapping t(19, 9);
+  const morton<8>::mapping m(19, 9);
+  EXPECT_EQ(3U * 3 * 8 * 4, t.required_size());
+  EXPECT_EQ(3U * 2 * 8 * 8, m.required_size());
+  std::set<std::size_t> t_offsets, m_offsets;
+  for (std::size_t y = 0; y < 9; ++y) {
+    for (std::size_t x = 0; x < 19; ++x) {
+      EXPECT_LT(t(x, y), t.required_size());
+      EXPECT_LT(m(x, y), m.required_size());
+      t_offsets.insert(t(x, y));
+      m_offsets.insert(m(x, y));
+    }
+  }
+  EXPECT_EQ(171U, t_offsets.size());
+  EXPECT_EQ(171U, m_offsets.size());
+  EXPECT_EQ(32U, t(8, 0));
+  EXPECT_EQ(9U, t(1, 1));
+  EXPECT_EQ(3U, m(1, 1));
+  EXPECT_EQ(12U, m(2, 2));
+  EXPECT_EQ(64U, m(8, 0));
+}
+
+template <typename Layout>
+void check_layout() {
+  using image = basic_image<rgba8, aligned_allocator<rgba8>, Layout>;
+  image img(37, 21);
+  for (std::size_t y = 0; y < 21; ++y)
+    for (std::size_t x = 0; x < 37; ++x)
+      img(x, y) = {std::uint8_t(x), std::uint8_t(y), 0, 1};
+
+  // layout order visits every pixel once
+  std::set<std::pair<std::size_t, std::size_t>> seen;
+  for (auto it = img.begin(); it != img.end(); ++it) {
+    EXPECT_EQ(it.x(), it->red);
+    EXPECT_EQ(it.y(), it->green);
+    seen.emplace(it.x(), it.y());
+  }
+  EXPECT_EQ(img.size(), seen.size());
+
+  const auto roi = img.view().subview(5, 3, 20, 10);
+  EXPECT_EQ(200, std::distance(roi.begin(), roi.end()));
+  EXPECT_EQ((rgba8{6, 5, 0, 1}), roi.at(1, 2));
+  fill(roi, {0, 0, 0, 2});
+  EXPECT_EQ(200, std::count_if(img.begin(), img.end(), [](const rgba8 &p) { return p.alpha == 2; }));
+
+  // round trip through row_major
+  basic_image<rgba8> linear(37, 21);
+  blit(img, linear);
+  EXPECT_EQ((rgba8{0, 0, 0, 2}), linear(5, 3));
+  EXPECT_EQ((rgba8{36, 20, 0, 1}), linear(36, 20));
+  image back(37, 21);
+  convert(linear, back, [](const rgba8 &p) { return p; });
+  const image copy(back);
+  for (std::size_t y = 0; y < 21; ++y)
+    for (std::size_t x = 0; x < 37; ++x)
+      EXPECT_EQ(img(x, y), copy(x, y));
+}
+
+TEST(Layout, Tiled) {
+  check_layout<tiled<8>>();
+  check_layout<tiled<16, 4>>();
+}
+
+TEST(Layout, Morton) {
+  check_layout<morton<8>>();
+  check_layout<morton<64>>();
+}
+
+TEST(PixelFormat, Sample) {
+  for (unsigned v = 0; v < 256; ++v) {
+    const auto x = static_cast<std::uint8_t>(v);
+    EXPECT_EQ(x, convert_sample<std::uint8_t>(convert_sample<float>(x)));
+    EXPECT_EQ(x, convert_sample<std::uint8_t>(convert_sample<std::uint16_t>(x)));
+    EXPECT_EQ(x * 257U, convert_sample<std::uint16_t>(x));
+  }
+  for (unsigned v = 0; v < 65536; ++v)
+    EXPECT_EQ((v * 2 + 257) / 514, convert_sample<std::uint8_t>(static_cast<std::uint16_t>(v)));
+  EXPECT_FLOAT_EQ(1.f, convert_sample<float>(std::uint16_t{65535}));
+  EXPECT_EQ(0, convert_sample<std::uint8_t>(-0.5f));
+  EXPECT_EQ(255, convert_sample<std::uint8_t>(1e10f));
+  EXPECT_EQ(0, convert_sample<std::uint8_t>(std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_EQ(65535, convert_sample<std::uint16_t>(2.f));
+  EXPECT_EQ(128, convert_sample<std::uint8_t>(0.5f));
+}
+
+TEST(PixelFormat, Pixel) {
+  using bgra8 = basic_bgra<std::uint8_t>;
+  using g8    = basic_g<std::uint8_t>;
+  EXPECT_EQ((rgba8{1, 2, 3, 4}), convert_pixel<rgba8>(bgra8{3, 2, 1, 4}));
+  EXPECT_EQ((rgba8{1, 2, 3, 255}), convert_pixel<rgba8>(rgb8{1, 2, 3}));
+  EXPECT_EQ((rgb8{1, 2, 3}), convert_pixel<rgb8>(rgba8{1, 2, 3, 4}));
+  EXPECT_EQ((rgba8{9, 9, 9, 255}), convert_pixel<rgba8>(g8{9}));
+  EXPECT_EQ((basic_ga<std::uint8_t>{9, 7}), convert_pixel<basic_ga<std::uint8_t>>(rgba8{9, 9, 9, 7}));
+  EXPECT_EQ((g8{255}), convert_pixel<g8>(rgb8{255, 255, 255}));
+  EXPECT_EQ((g8{76}), convert_pixel<g8>(rgb8{255, 0, 0}));
+  EXPECT_EQ((g8{150}), convert_pixel<g8>(rgb8{0, 255, 0}));
+  EXPECT_EQ((g8{29}), convert_pixel<g8>(rgb8{0, 0, 255}));
+  EXPECT_NEAR(0.299f, convert_pixel<basic_g<float>>(rgb8{255, 0, 0}).gray, 1e-3f);
+  EXPECT_EQ((basic_rgba<std::uint16_t>{257, 0, 65535, 65535}), convert_pixel<basic_rgba<std::uint16_t>>(basic_bgr<float>{1.f, 0.f, 1.f / 255}));
+
+  static_assert(convert_pixel<rgba8>(bgra8{3, 2, 1, 4}) == rgba8{1, 2, 3, 4});
+}
+
+namespace {
+template <typename P>
+P make_pixel(std::size_t i) {
+  using S = typename P::sample_type;
+  P res;
+  auto *s = reinterpret_cast<S *>(&res);
+  for (std::size_t k = 0; k < sizeof(P) / sizeof(S); ++k) {
+    const auto v = (i * 37 + k * 101) % 300;
+    if constexpr (std::is_floating_point_v<S>)
+      s[k] = static_cast<S>(v) / 255 - 0.1f; // a few samples outside [0, 1]
+    else
+      s[k] = static_cast<S>(v * sample_max<S> / 299);
+  }
+  return res;
+}
+
+template <typename From, typename To>
+void check_row() {
+  // odd length, so that every kernel leaves a tail
+  std::vector<From> src(67);
+  for (std::size_t i = 0; i < src.size(); ++i)
+    src[i] = make_pixel<From>(i);
+  std::vector<To> dst(src.size());
+  convert_pixels(std::span<const From>(src), std::span<To>(dst));
+  for (std::size_t i = 0; i < src.size(); ++i)
+    EXPECT_EQ(convert_pixel<To>(src[i]), dst[i]) << i;
+}
+
+template <typename From, typename... To>
+void check_rows() {
+  (check_row<From, To>(), ...);
+}
+
+template <typename S>
+void check_all_from() {
+  check_rows<basic_bgra<S>, basic_bgra<std::uint8_t>, basic_rgba<std::uint8_t>, basic_bgr<std::uint8_t>, basic_rgb<std::uint8_t>, basic_ga<std::uint8_t>, basic_g<std::uint8_t>, basic_rgba<float>, basic_g<std::uint16_t>>();
+  check_rows<basic_rgba<S>, basic_bgra<std::uint8_t>, basic_rgba<std::uint8_t>, basic_bgr<std::uint8_t>, basic_rgb<std::uint8_t>, basic_ga<std::uint8_t>, basic_g<std::uint8_t>, basic_rgba<std::uint16_t>, basic_ga<float>>();
+  check_rows<basic_bgr<S>, basic_bgra<std::uint8_t>, basic_rgba<std::uint8_t>, basic_bgr<std::uint8_t>, basic_rgb<std::uint8_t>, basic_g<std::uint8_t>, basic_rgb<float>>();
+  check_rows<basic_rgb<S>, basic_bgra<std::uint8_t>, basic_rgba<std::uint8_t>, basic_bgr<std::uint8_t>, basic_rgb<std::uint8_t>, basic_ga<std::uint8_t>, basic_bgr<std::uint16_t>>();
+  check_rows<basic_ga<S>, basic_bgra<std::uint8_t>, basic_rgb<std::uint8_t>, basic_ga<std::uint8_t>, basic_g<std::uint8_t>, basic_ga<float>>();
+  check_rows<basic_g<S>, basic_bgra<std::uint8_t>, basic_rgba<std::uint8_t>, basic_bgr<std::uint8_t>, basic_ga<std::uint8_t>, basic_g<std::uint8_t>, basic_g<float>>();
+}
+} // namespace
+
+TEST(PixelFormat, Row) {
+  check_all_from<std::uint8_t>();
+  check_all_from<std::uint16_t>();
+  check_all_from<float>();
+  check_all_from<portal::half>();
+  check_rows<basic_rgba<float>, basic_rgba<portal::half>, basic_bgr<portal::half>, basic_ga<portal::half>>();
+  check_rows<basic_rgba<std::uint16_t>, basic_rgba<portal::half>, basic_g<portal::half>>();
+
+  std::vector<basic_rgba<float>> src(4, {std::numeric_limits<float>::quiet_NaN(), -1e10f, 1e10f, 0.5f});
+  std::vector<rgba8> dst(4);
+  convert_pixels(std::span<const basic_rgba<float>>(src), std::span<rgba8>(dst));
+  EXPECT_EQ((rgba8{0, 0, 255, 128}), dst[0]);
+  EXPECT_THROW(convert_pixels(std::span<const basic_rgba<float>>(src), std::span<rgba8>(dst).first(3)), std::invalid_argument);
+}
+
+TEST(PixelFormat, Image) {
+  basic_image<basic_bgra<std::uint8_t>> src(19, 7);
+  for (std::size_t y = 0; y < 7; ++y)
+    for (std::size_t x = 0; x < 19; ++x)
+      src(x, y) = {std::uint8_t(x), std::uint8_t(y), 255, 51};
+  basic_image<basic_rgba<float>> dst(19, 7);
+  convert(src, dst);
+  EXPECT_FLOAT_EQ(1.f, dst(5, 3).red);
+  EXPECT_FLOAT_EQ(3.f / 255, dst(5, 3).green);
+  EXPECT_FLOAT_EQ(5.f / 255, dst(5, 3).blue);
+  EXPECT_FLOAT_EQ(0.2f, dst(5, 3).alpha);
+
+  basic_image<basic_g<std::uint8_t>, aligned_allocator<basic_g<std::uint8_t>>, tiled<8>> gray(19, 7);
+  convert(dst, gray);
+  EXPECT_EQ(convert_pixel<basic_g<std::uint8_t>>(dst(5, 3)), gray(5, 3));
+  EXPECT_THROW(convert(src, basic_image<rgba8>(18, 7)), std::invalid_argument);
+}
+
+TEST(PixelFormat, Half) {
+  using portal::half;
+  for (unsigned v = 0; v < 256; ++v) {
+    const auto x = static_cast<std::uint8_t>(v);
+    EXPECT_EQ(x, convert_sample<std::uint8_t>(convert_sample<half>(x)));
+  }
+  EXPECT_EQ(0x3c00, convert_sample<half>(std::uint16_t{65535}).bits());
+  EXPECT_EQ(255, convert_sample<std::uint8_t>(half(2.f)));
+  EXPECT_EQ(0, convert_sample<std::uint8_t>(std::numeric_limits<half>::quiet_NaN()));
+  EXPECT_FLOAT_EQ(0.25f, convert_pixel<basic_rgba<float>>(basic_bgra<half>{half(0.5f), half(0.75f), half(0.25f), half(1.f)}).red);
+  EXPECT_EQ(1.f, sample_max<half>);
+  static_assert(convertible_color<basic_rgba<half>> && !composite_color<basic_rgba<half>>);
+}
+
+TEST(Srgb, Curve) {
+  using portal::math::fast::precision;
+  const auto decode = [](double x) { return x <= 0.04045 ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4); };
+  const auto encode = [](double x) { return x <= 0.0031308 ? x * 12.92 : 1.055 * std::pow(x, 1 / 2.4) - 0.055; };
+  static constexpr double half = srgb_to_linear(0.5);
+  EXPECT_NEAR(decode(0.5), half, 1e-15);
+  for (int i = 0; i <= 100000; ++i) {
+    const double x = i / 100000.;
+    EXPECT_NEAR(decode(x), srgb_to_linear(x), 1e-15);
+    EXPECT_NEAR(encode(x), linear_to_srgb(x), 1e-15);
+    // the two segments of the standard meet 3e-8 apart
+    EXPECT_NEAR(x, linear_to_srgb(srgb_to_linear(x)), 1e-7);
+    const float f = static_cast<float>(x);
+    EXPECT_NEAR(decode(f), srgb_to_linear<precision::medium>(f), 2e-6);
+    EXPECT_NEAR(encode(f), linear_to_srgb<precision::medium>(f), 2e-6);
+    EXPECT_NEAR(encode(f), linear_to_srgb<precision::low>(f), 1e-4);
+  }
+  EXPECT_FLOAT_EQ(1.f, srgb_to_linear<precision::medium>(2.f));
+  EXPECT_FLOAT_EQ(-0.1f / 12.92f, srgb_to_linear<precision::medium>(-0.1f));
+
+  // the batches are the medium tier
+  std::vector<float> x(1003), y(x.size()), z(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i)
+    x[i] = static_cast<float>(i) / 1000 - 0.001f;
+  srgb_to_linear(std::span<const float>(x), std::span(y));
+  linear_to_srgb(std::span<const float>(x), std::span(z));
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    EXPECT_FLOAT_EQ(srgb_to_linear<precision::medium>(x[i]), y[i]);
+    EXPECT_FLOAT_EQ(linear_to_srgb<precision::medium>(x[i]), z[i]);
+  }
+  linear_to_srgb(std::span<const float>(y), std::span(y));
+  for (std::size_t i = 1; x[i] <= 1; ++i)
+    EXPECT_NEAR(x[i], y[i], 2e-6);
+  EXPECT_THROW(srgb_to_linear(std::span<const float>(x), std::span(y).first(4)), std::invalid_argument);
+}
+
+TEST(Srgb, Sample) {
+  using enum color_encoding;
+  for (unsigned v = 0; v < 256; ++v) {
+    const auto x   = static_cast<std::uint8_t>(v);
+    const double l = srgb_to_linear(v / 255.);
+    EXPECT_FLOAT_EQ(static_cast<float>(l), (transcode_sample<float, linear, srgb>(x)));
+    EXPECT_EQ(std::lround(l * 255), (transcode_sample<std::uint8_t, linear, srgb>(x)));
+    EXPECT_EQ(std::lround(linear_to_srgb(v / 255.) * 255), (transcode_sample<std::uint8_t, srgb, linear>(x)));
+    // 16 bit linear keeps every 8 bit sRGB value apart
+    EXPECT_EQ(x, (transcode_sample<std::uint8_t, srgb, linear>(transcode_sample<std::uint16_t, linear, srgb>(x))));
+    EXPECT_EQ(x, (transcode_sample<std::uint8_t, srgb, linear>(transcode_sample<float, linear, srgb>(x))));
+  }
+  for (unsigned v = 0; v < 65536; v += 7) {
+    const auto x = static_cast<std::uint16_t>(v);
+    EXPECT_NEAR(std::lround(srgb_to_linear(v / 65535.) * 65535), (transcode_sample<std::uint16_t, linear, srgb>(x)), 1);
+    EXPECT_NEAR(std::lround(linear_to_srgb(v / 65535.) * 65535), (transcode_sample<std::uint16_t, srgb, linear>(x)), 1);
+  }
+  EXPECT_EQ(7, (transcode_sample<std::uint8_t, srgb, srgb>(std::uint8_t{7})));
+}
+
+TEST(Srgb, Pixel) {
+  using rgbaf_linear = basic_rgba<float, color_encoding::linear>;
+  static_assert(encoding_v<rgba8> == color_encoding::srgb);
+  static_assert(encoding_v<rgbaf_linear> == color_encoding::linear);
+  static_assert(std::same_as<with_encoding_t<rgba8, color_encoding::linear>, basic_rgba<std::uint8_t, color_encoding::linear>>);
+  static_assert(std::same_as<rebind_color_t<rgbaf_linear, std::uint16_t>, basic_rgba<std::uint16_t, color_encoding::linear>>);
+  static_assert(sizeof(rgbaf_linear) == 4 * sizeof(float));
+
+  // the colors cross the curve, the alpha does not
+  const auto p = convert_pixel<rgbaf_linear>(rgba8{255, 128, 0, 77});
+  EXPECT_FLOAT_EQ(1.f, p.red);
+  EXPECT_NEAR(0.2158605, p.green, 1e-6);
+  EXPECT_FLOAT_EQ(0.f, p.blue);
+  EXPECT_FLOAT_EQ(77.f / 255, p.alpha);
+  EXPECT_EQ((rgba8{255, 128, 0, 77}), convert_pixel<rgba8>(p));
+  EXPECT_EQ((basic_bgr<std::uint8_t>{0, 128, 255}), convert_pixel<basic_bgr<std::uint8_t>>(p));
+
+  // the luminance of colors of another encoding is taken on linear samples
+  const auto y = 0.587 * srgb_to_linear(128 / 255.);
+  EXPECT_NEAR(y, (convert_pixel<basic_g<float, color_encoding::linear>>(rgb8{0, 128, 0}).gray), 1e-6);
+  EXPECT_EQ(std::lround(linear_to_srgb(y) * 255), convert_pixel<basic_g<std::uint8_t>>(basic_rgb<float, color_encoding::linear>{0, static_cast<float>(y / 0.587), 0}).gray);
+  using rgb16_linear = basic_rgb<std::uint16_t, color_encoding::linear>;
+  EXPECT_EQ((rgb16_linear{65535, 65535, 65535}), convert_pixel<rgb16_linear>(basic_g<std::uint8_t>{255}));
+  EXPECT_EQ((rgb16_linear{1391, 1391, 1391}), convert_pixel<rgb16_linear>(basic_g<std::uint8_t>{40}));
+}
+
+namespace {
+template <typename From, typename To>
+void check_transcode_row() {
+  // kernel tails and both encodings of every sample type
+  std::vector<From> src(131);
+  for (std::size_t i = 0; i < src.size(); ++i)
+    src[i] = make_pixel<From>(i);
+  std::vector<To> dst(src.size());
+  convert_pixels(std::span<const From>(src), std::span<To>(dst));
+  using S = typename To::sample_type;
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    const To expected = convert_pixel<To>(src[i]);
+    const auto *e     = reinterpret_cast<const S *>(&expected);
+    const auto *d     = reinterpret_cast<const S *>(&dst[i]);
+    for (std::size_t k = 0; k < sizeof(To) / sizeof(S); ++k) {
+      // the batches may round differently where the scalar path contracts to fma
+      if constexpr (std::is_floating_point_v<S>)
+        EXPECT_NEAR(e[k], d[k], 1e-6f) << i;
+      else
+        EXPECT_NEAR(e[k], d[k], 1) << i;
+    }
+  }
+}
+} // namespace
+
+TEST(Srgb, Row) {
+  using enum color_encoding;
+  check_transcode_row<basic_rgba<std::uint8_t>, basic_rgba<float, linear>>();
+  check_transcode_row<basic_rgba<std::uint8_t>, basic_bgra<std::uint16_t, linear>>();
+  check_transcode_row<basic_rgb<std::uint8_t, linear>, basic_rgb<std::uint8_t>>();
+  check_transcode_row<basic_rgba<float, linear>, basic_rgba<std::uint8_t>>();
+  check_transcode_row<basic_rgba<float, linear>, basic_bgra<std::uint8_t>>();
+  check_transcode_row<basic_rgba<float, linear>, basic_rgb<std::uint16_t>>();
+  check_transcode_row<basic_rgba<std::uint16_t>, basic_rgba<std::uint16_t, linear>>();
+  check_transcode_row<basic_ga<std::uint16_t, linear>, basic_ga<float>>();
+  check_transcode_row<basic_g<float>, basic_rgb<float, linear>>();
+  check_transcode_row<basic_rgb<float>, basic_g<std::uint8_t, linear>>();
+  check_transcode_row<basic_rgb<std::uint16_t, linear>, basic_g<std::uint16_t>>();
+}
+
+TEST(Srgb, Image) {
+  using rgbaf_linear = basic_rgba<float, color_encoding::linear>;
+  basic_image<rgba8> src(67, 5);
+  for (std::size_t y = 0; y < 5; ++y)
+    for (std::size_t x = 0; x < 67; ++x)
+      src(x, y) = {std::uint8_t(x * 3), std::uint8_t(y * 50), std::uint8_t(255 - x), std::uint8_t(x)};
+  basic_image<rgbaf_linear> linear(67, 5);
+  convert(src, linear);
+  EXPECT_NEAR(srgb_to_linear(150 / 255.), linear(50, 3).green, 1e-6);
+  EXPECT_FLOAT_EQ(50.f / 255, linear(50, 3).alpha);
+
+  // 8 bit sRGB survives a round trip through float linear
+  basic_image<basic_bgra<std::uint8_t>, aligned_allocator<basic_bgra<std::uint8_t>>, tiled<8>> back(67, 5);
+  convert(linear, back);
+  for (std::size_t y = 0; y < 5; ++y)
+    for (std::size_t x = 0; x < 67; ++x)
+      EXPECT_EQ(src(x, y), convert_pixel<rgba8>(back(x, y)));
+}
+
+TEST(Composite, Sample) {
+  for (std::uint32_t x = 0; x <= 255 * 255; ++x)
+    EXPECT_EQ((x * 2 + 255) / 510, div_max<std::uint8_t>(x));
+  for (std::uint32_t x = 0; x <= 65535u * 65535u - 65535u; x += 65535u + 7)
+    EXPECT_EQ((std::uint64_t{x} * 2 + 65535) / 131070, div_max<std::uint16_t>(x));
+
+  using enum composite_op;
+  EXPECT_EQ(255, (composite_sample<over, std::uint8_t>(255, 100, 255, 255)));
+  EXPECT_EQ(178, (composite_sample<over, std::uint8_t>(128, 100, 128, 255)));
+  EXPECT_EQ(50, (composite_sample<in, std::uint8_t>(100, 0, 100, 128)));
+  EXPECT_EQ(255, (composite_sample<add, std::uint8_t>(200, 100, 200, 100)));
+  EXPECT_EQ(255, (composite_sample<screen, std::uint8_t>(255, 10, 255, 255)));
+  EXPECT_EQ(10, (composite_sample<multiply, std::uint8_t>(255, 10, 255, 255)));
+  EXPECT_FLOAT_EQ(0.625f, (composite_sample<over, float>(0.5f, 0.25f, 0.5f, 1.f)));
+}
+
+TEST(Composite, Pixel) {
+  using enum composite_op;
+  using rgbaf = basic_rgba<float>;
+  const rgba8 red{255, 0, 0, 255}, half_blue{0, 0, 128, 128}, clear{0, 0, 0, 0};
+  EXPECT_EQ((rgba8{127, 0, 128, 255}), composite_pixel<over>(half_blue, red));
+  EXPECT_EQ(red, composite_pixel<over>(clear, red));
+  EXPECT_EQ(half_blue, composite_pixel<over>(half_blue, clear));
+  EXPECT_EQ(clear, composite_pixel<in>(half_blue, clear));
+  EXPECT_EQ(red, composite_pixel<atop>(clear, red));
+  EXPECT_EQ(clear, composite_pixel<exclusive_or>(red, red));
+
+  // straight alpha
+  EXPECT_EQ((rgba8{127, 0, 128, 255}), (composite_pixel<over, alpha_mode::straight>(rgba8{0, 0, 255, 128}, red)));
+  EXPECT_EQ((rgba8{0, 0, 255, 128}), (composite_pixel<over, alpha_mode::straight>(rgba8{0, 0, 255, 128}, clear)));
+  EXPECT_EQ((rgba8{1, 2, 3, 0}), (composite_pixel<over, alpha_mode::straight>(rgba8{9, 9, 9, 0}, rgba8{1, 2, 3, 0})));
+  const auto s = composite_pixel<over, alpha_mode::straight>(rgbaf{1.f, 0.f, 0.f, 0.5f}, rgbaf{0.f, 0.f, 1.f, 0.5f});
+  EXPECT_FLOAT_EQ(0.75f, s.alpha);
+  EXPECT_FLOAT_EQ(2.f / 3, s.red);
+  EXPECT_FLOAT_EQ(1.f / 3, s.blue);
+
+  EXPECT_EQ((rgba8{100, 50, 0, 128}), premultiply(rgba8{199, 100, 0, 128}));
+  for (unsigned c = 0; c < 256; ++c) {
+    const auto p = premultiply(rgba8{std::uint8_t(c), 0, 0, 200});
+    EXPECT_EQ(p, premultiply(unpremultiply(p))) << c;
+  }
+  static_assert(composite_pixel<over>(rgba8{0, 0, 0, 0}, rgba8{1, 2, 3, 4}) == rgba8{1, 2, 3, 4});
+}
+
+namespace {
+template <typename P>
+std::vector<P> make_layer(std::size_t size, std::size_t seed) {
+  // runs of transparent, opaque and mixed pixels, premultiplied
+  using S = typename P::sample_type;
+  std::vector<P> res(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    const auto kind = (i / 70 + seed) % 3;
+    P p             = convert_pixel<P>(basic_rgba<std::uint8_t>{std::uint8_t(i * 7 + seed), std::uint8_t(i * 13), std::uint8_t(i * 29 + seed * 3), std::uint8_t(i * 11 + seed)});
+    p.alpha         = kind == 0 ? S(0) : kind == 1 ? sample_max<S> : p.alpha;
+    res[i]          = premultiply(p);
+  }
+  return res;
+}
+
+template <composite_op Op, alpha_mode M, typename P>
+void check_composite_row() {
+  const auto src = make_layer<P>(300, 0);
+  auto dst       = make_layer<P>(300, 1);
+  std::vector<P> expected(dst.size());
+  for (std::size_t i = 0; i < dst.size(); ++i)
+    expected[i] = composite_pixel<Op, M>(src[i], dst[i]);
+  composite_pixels<Op, M>(std::span<const P>(src), std::span<P>(dst));
+  for (std::size_t i = 0; i < dst.size(); ++i)
+    EXPECT_EQ(expected[i], dst[i]) << i;
+}
+
+template <composite_op Op>
+void check_composite_op() {
+  check_composite_row<Op, alpha_mode::premultiplied, basic_rgba<std::uint8_t>>();
+  check_composite_row<Op, alpha_mode::premultiplied, basic_bgra<std::uint8_t>>();
+  check_composite_row<Op, alpha_mode::premultiplied, basic_ga<std::uint8_t>>();
+  check_composite_row<Op, alpha_mode::premultiplied, basic_rgba<std::uint16_t>>();
+  check_composite_row<Op, alpha_mode::premultiplied, basic_rgba<float>>();
+  check_composite_row<Op, alpha_mode::straight, basic_bgra<std::uint8_t>>();
+  check_composite_row<Op, alpha_mode::straight, basic_ga<float>>();
+}
+} // namespace
+
+TEST(Composite, Row) {
+  using enum composite_op;
+  check_composite_op<over>();
+  check_composite_op<in>();
+  check_composite_op<out>();
+  check_composite_op<atop>();
+  check_composite_op<exclusive_or>();
+  check_composite_op<multiply>();
+  check_composite_op<screen>();
+  check_composite_op<add>();
+}
+
+TEST(Composite, Image) {
+  basic_image<rgba8> dst(8, 6);
+  fill(dst, {0, 0, 255, 255});
+  basic_image<rgba8> src(4, 4);
+  fill(src, {128, 0, 0, 128});
+  composite<composite_op::over>(src, dst, -1, 4);
+  EXPECT_EQ((rgba8{128, 0, 127, 255}), dst(0, 4));
+  EXPECT_EQ((rgba8{128, 0, 127, 255}), dst(2, 5));
+  EXPECT_EQ((rgba8{0, 0, 255, 255}), dst(3, 5));
+  EXPECT_EQ((rgba8{0, 0, 255, 255}), dst(0, 3));
+
+  basic_image<rgba8, aligned_allocator<rgba8>, tiled<4>> tiles(8, 6);
+  fill(tiles, {0, 0, 255, 255});
+  composite<composite_op::over>(src.view(), tiles, 6, 0);
+  EXPECT_EQ((rgba8{128, 0, 127, 255}), tiles(7, 3));
+  EXPECT_EQ((rgba8{0, 0, 255, 255}), tiles(5, 3));
+}
+
+TEST(Packed, Rgb10a2) {
+  EXPECT_EQ(1023u | 512u << 20 | 1u << 30, rgb10a2::pack({1.f, 0.f, 0.5f, 1.f / 3}).bits);
+  EXPECT_EQ(0u, rgb10a2::pack({std::numeric_limits<float>::quiet_NaN(), -1.f, -0.f, -1e10f}).bits);
+  EXPECT_EQ(~0u, rgb10a2::pack({2.f, 1e10f, std::numeric_limits<float>::infinity(), 1.f}).bits);
+  for (std::uint32_t i = 0; i < 1024; ++i) {
+    const rgb10a2 p{i | (1023 - i) << 10 | (i * 7 % 1024) << 20 | (i % 4) << 30};
+    EXPECT_EQ(p, rgb10a2::pack(p.unpack())) << i;
+  }
+  EXPECT_FLOAT_EQ(1.f / 3, rgb10a2{1u << 30}.unpack().alpha);
+}
+
+TEST(Packed, Rgb9e5) {
+  // EXT_texture_shared_exponent, in double
+  const auto reference = [](float r, float g, float b) {
+    const auto clamp = [](float v) { return v > 0 ? std::min(v, 65408.f) : 0.f; };
+    r                = clamp(r);
+    g                = clamp(g);
+    b                = clamp(b);
+    const float m    = std::max({r, g, b});
+    int e            = 0;
+    std::frexp(m, &e);
+    e            = m > 0 ? std::max(-16, e - 1) + 16 : 0;
+    const auto q = [&e](float v) { return static_cast<std::uint32_t>(std::floor(v / std::ldexp(1.0, e - 24) + 0.5)); };
+    if (q(m) == 512)
+      ++e;
+    return q(r) | q(g) << 9 | q(b) << 18 | static_cast<std::uint32_t>(e) << 27;
+  };
+  std::uint32_t seed = 1;
+  const auto next    = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return std::ldexp(static_cast<float>(seed >> 8) / (1 << 24), static_cast<int>(seed % 48) - 30);
+  };
+  for (int i = 0; i < 100000; ++i) {
+    const float r = next(), g = next(), b = next();
+    EXPECT_EQ(reference(r, g, b), rgb9e5::pack({r, g, b}).bits) << r << ' ' << g << ' ' << b;
+  }
+  EXPECT_EQ(reference(0.f, 0.f, 0.f), rgb9e5::pack({0.f, -1.f, std::numeric_limits<float>::quiet_NaN()}).bits);
+  EXPECT_EQ(reference(65408.f, 1.f, 0.f), rgb9e5::pack({1e10f, 1.f, 0.f}).bits);
+  EXPECT_EQ(reference(511.9f, 0.f, 0.f), rgb9e5::pack({511.9f, 0.f, 0.f}).bits);
+
+  const auto c = rgb9e5{1u | 511u << 9 | 256u << 18 | 16u << 27}.unpack();
+  EXPECT_EQ((rgb9e5::unpacked_type{1.f / 256, 511.f / 256, 1.f}), c);
+  EXPECT_EQ(65408.f, rgb9e5{511u | 31u << 27}.unpack().red);
+  EXPECT_EQ(c, rgb9e5::pack(c).unpack());
+}
+
+TEST(Packed, R11g11b10f) {
+  for (std::uint32_t b = 0; b < 2048; ++b) {
+    const int e   = b >> 6;
+    const int m   = b & 63;
+    const float v = e == 0 ? std::ldexp(static_cast<float>(m), -20) : std::ldexp(static_cast<float>(m | 64), e - 21);
+    const auto p  = r11g11b10f{b | b << 11 | (b >> 1) << 22};
+    const auto c  = p.unpack();
+    if (e == 31 && m != 0) {
+      EXPECT_TRUE(std::isnan(c.red) && std::isnan(c.green)) << b;
+      EXPECT_EQ(0x7e0u, r11g11b10f::pack(c).bits & 0x7e0u) << b;
+      continue;
+    }
+    EXPECT_EQ(e == 31 ? std::numeric_limits<float>::infinity() : v, c.red) << b;
+    EXPECT_EQ(c.red, c.green) << b;
+    EXPECT_EQ(p, r11g11b10f::pack(c)) << b;
+  }
+  // ties round to even
+  EXPECT_EQ(0x3c0u, r11g11b10f::pack({1 + std::ldexp(1.f, -7), 0.f, 0.f}).bits);
+  EXPECT_EQ(0x3c2u, r11g11b10f::pack({1 + 3 * std::ldexp(1.f, -7), 0.f, 0.f}).bits);
+  EXPECT_EQ(0x7bfu, r11g11b10f::pack({65279.f, 0.f, 0.f}).bits);
+  EXPECT_EQ(0x7c0u, r11g11b10f::pack({65280.f, 0.f, 0.f}).bits);
+  EXPECT_EQ(0x1e0u << 22, r11g11b10f::pack({0.f, 0.f, 1.f}).bits);
+  EXPECT_EQ(0u, r11g11b10f::pack({-1.f, -0.f, -std::numeric_limits<float>::infinity()}).bits);
+  EXPECT_TRUE(std::isnan(r11g11b10f::pack({-std::numeric_limits<float>::quiet_NaN(), 0.f, 0.f}).unpack().red));
+
+  static_assert(r11g11b10f::pack({0.5f, 2.f, 0.25f}).unpack() == r11g11b10f::unpacked_type{0.5f, 2.f, 0.25f});
+}
+
+TEST(Packed, Image) {
+  basic_image<rgba8> src(67, 5);
+  for (std::size_t y = 0; y < 5; ++y)
+    for (std::size_t x = 0; x < 67; ++x)
+      src(x, y) = {std::uint8_t(x * 3 + y), std::uint8_t(x * 3 + 2), std::uint8_t(x * 3 + y * 2), std::uint8_t(x * 5)};
+  basic_image<rgb10a2> wide(67, 5);
+  convert(src, wide);
+  EXPECT_EQ(rgb10a2::pack(convert_pixel<basic_rgba<float>>(src(30, 2))), wide(30, 2));
+  basic_image<rgba8, aligned_allocator<rgba8>, tiled<8>> back(67, 5);
+  convert(wide, back);
+  EXPECT_EQ(convert_pixel<rgb8>(src(66, 4)), convert_pixel<rgb8>(back(66, 4)));
+  EXPECT_EQ((src(3, 1).alpha * 3 + 127) / 255 * 85, back(3, 1).alpha);
+
+  // through linear light and back, 8 bit survives both packed float formats when the samples are close
+  basic_image<r11g11b10f> hdr(67, 5);
+  convert(src, hdr);
+  basic_image<rgb9e5> shared(67, 5);
+  convert(hdr, shared);
+  basic_image<rgb8> out(67, 5);
+  convert(shared, out);
+  for (std::size_t y = 0; y < 5; ++y)
+    for (std::size_t x = 0; x < 67; ++x) {
+      EXPECT_EQ(convert_pixel<r11g11b10f>(src(x, y)), hdr(x, y));
+      EXPECT_EQ(convert_pixel<rgb8>(shared(x, y)), out(x, y));
+      EXPECT_NEAR(src(x, y).red, out(x, y).red, 1);
+      EXPECT_NEAR(src(x, y).blue, out(x, y).blue, 1);
+    }
+}
+
+TEST(Parallel, For) {
+  for (const std::size_t threads : {1, 3, 8}) {
+    portal::thread_pool pool(threads);
+    EXPECT_EQ(threads, pool.size());
+    for (const std::size_t grain : {0, 1, 7, 1000}) {
+      std::vector<std::atomic<int>> hits(4099);
+      pool.parallel_for(hits.size(), grain, [&hits](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+          ++hits[i];
+      });
+      EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](const auto &h) { return h == 1; })) << threads << ' ' << grain;
+    }
+    // nested loops run on the calling thread
+    std::atomic<int> sum = 0;
+    pool.parallel_for(10, 1, [&](std::size_t first, std::size_t last) {
+      pool.parallel_for(10, 1, [&](std::size_t b, std::size_t e) { sum += static_cast<int>((last - first) * (e - b)); });
+    });
+    EXPECT_EQ(100, sum);
+    EXPECT_THROW(pool.parallel_for(100, 1, [](std::size_t first, std::size_t last) {
+      if (first <= 57 && 57 < last)
+        throw std::runtime_error("57");
+    }),
+                 std::runtime_error);
+    pool.parallel_for(0, 0, [](std::size_t, std::size_t) { FAIL(); });
+  }
+}
+
+TEST(Parallel, Rows) {
+  portal::thread_pool pool(4);
+  basic_image<rgba8, aligned_allocator<rgba8>, tiled<8>> img(67, 45);
+  std::mutex mutex;
+  std::set<std::size_t> tops;
+  parallel_for_rows(
+      img, [&](auto band, std::size_t y) {
+        {
+          std::lock_guard lock(mutex);
+          tops.insert(y);
+        }
+        EXPECT_EQ(0U, y % 8);
+        for (std::size_t j = 0; j < band.get_height(); ++j)
+          for (std::size_t x = 0; x < band.get_width(); ++x)
+            band(x, j) = {std::uint8_t(x), std::uint8_t(y + j), 0, 255};
+      },
+      8, pool);
+  EXPECT_EQ(6U, tops.size());
+  for (std::size_t y = 0; y < 45; ++y)
+    for (std::size_t x = 0; x < 67; ++x)
+      ASSERT_EQ((rgba8{std::uint8_t(x), std::uint8_t(y), 0, 255}), img(x, y));
+
+  basic_image<basic_g<float>> gray(67, 45);
+  parallel_transform(img, gray, 0, pool);
+  EXPECT_EQ(convert_pixel<basic_g<float>>(img(30, 40)), gray(30, 40));
+  basic_image<rgba8> copy(67, 45);
+  parallel_transform(img.view().subview(0, 0, 67, 45), copy, [](const rgba8 &p) { return rgba8{p.blue, p.green, p.red, p.alpha}; }, 0, pool);
+  EXPECT_EQ((rgba8{0, 40, 30, 255}), copy(30, 40));
+  EXPECT_THROW(parallel_transform(img, basic_image<rgba8>(66, 45), 0, pool), std::invalid_argument);
+}
+
+TEST(Parallel, Tiles) {
+  portal::thread_pool pool(3);
+  basic_image<basic_g<std::uint16_t>> img(100, 37);
+  fill(img, {0});
+  parallel_for_tiles(
+      img.view().subview(3, 2, 90, 33), 16, 8, [](auto tile, std::size_t x, std::size_t y) {
+        for (std::size_t j = 0; j < tile.get_height(); ++j)
+          for (std::size_t i = 0; i < tile.get_width(); ++i)
+            tile(i, j).gray += static_cast<std::uint16_t>(1 + (x + i) + (y + j) * 100);
+      },
+      0, pool);
+  for (std::size_t y = 0; y < 37; ++y)
+    for (std::size_t x = 0; x < 100; ++x) {
+      const bool inside = x >= 3 && x < 93 && y >= 2 && y < 35;
+      ASSERT_EQ(inside ? 1 + (x - 3) + (y - 2) * 100 : 0, img(x, y).gray) << x << ' ' << y;
+    }
+  EXPECT_THROW(parallel_for_tiles(img, 0, 8, [](auto, std::size_t, std::size_t) {}), std::invalid_argument);
+}
+
+TEST(Noise, Fill) {
+  basic_image<rgba8> img(301, 7);
+  portal::xoshiro128pp_x8 engine(1);
+  fill_noise(img, engine);
+  double sum = 0;
+  for (const auto &p : img) {
+    ASSERT_EQ(255, p.alpha);
+    sum += p.red;
+  }
+  EXPECT_NEAR(127.5, sum / img.size(), 5.0);
+
+  basic_image<basic_rgb<float>, aligned_allocator<basic_rgb<float>>, tiled<8>> tiles(30, 20);
+  fill(tiles, {2.0f, 2.0f, 2.0f});
+  fill_noise(tiles.view().subview(3, 3, 20, 10));
+  for (std::size_t y = 0; y < 20; ++y)
+    for (std::size_t x = 0; x < 30; ++x) {
+      const bool inside = x >= 3 && x < 23 && y >= 3 && y < 13;
+      const auto p      = tiles(x, y);
+      ASSERT_EQ(inside, p.red < 1.0f && p.green < 1.0f && p.blue < 1.0f && p.red >= 0.0f) << x << ' ' << y;
+    }
+
+  basic_image<basic_g<std::uint16_t>> gray(1, 1);
+  fill_noise(gray);
+  portal::pcg32 pcg(2);
+  basic_image<basic_rgba<portal::half>> halves(5, 5);
+  fill_noise(halves, pcg);
+  EXPECT_EQ(1.0f, static_cast<float>(halves(4, 4).alpha));
+  EXPECT_LE(static_cast<float>(halves(4, 4).red), 1.0f);
+}
+
+TEST(Netpbm, Header) {
+  const std::string pam = "P7\n# comment\nWIDTH 3\nHEIGHT 2\nDEPTH 2\nMAXVAL 1023 # ten bits\nTUPLTYPE GRAYSCALE_ALPHA\nENDHDR\n" + std::string(24, '\0');
+  const auto header     = read_netpbm_header(as_bytes(pam));
+  EXPECT_EQ(netpbm_format::pam, header.format);
+  EXPECT_EQ(3u, header.width);
+  EXPECT_EQ(2u, header.height);
+  EXPECT_EQ(2u, header.depth);
+  EXPECT_EQ(1023u, header.maxval);
+  EXPECT_TRUE(header.alpha);
+  EXPECT_EQ(pam.size() - 24, header.offset);
+  EXPECT_EQ(12u, header.row_size());
+
+  const auto pfm = read_netpbm_header(as_bytes("Pf 1 1 -1.0\n" + std::string(4, '\0')));
+  EXPECT_EQ(netpbm_format::pfm, pfm.format);
+  EXPECT_TRUE(pfm.little_endian);
+
+  for (const char *bad : {"P6 2 2 255\n", "P6 2 2 255", "P6 0 2 255\n", "P6 2 2 70000\n", "P3 1 1 255\n1 2 3", "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 5\nMAXVAL 255\nENDHDR\n00000", "Pf 1 1 0\n0000"})
+    EXPECT_THROW((void)read_netpbm_header(as_bytes(bad)), std::runtime_error) << bad;
+}
+
+TEST(Netpbm, RoundTrip) {
+  basic_image<rgb8> rgb(5, 3);
+  basic_image<basic_g<std::uint16_t>> gray(4, 2);
+  basic_image<rgba8> rgba(3, 3);
+  basic_image<basic_rgb<float, color_encoding::linear>> linear(3, 2);
+  for (std::size_t y = 0; y < 3; ++y)
+    for (std::size_t x = 0; x < 5; ++x) {
+      rgb(x, y) = {std::uint8_t(x * 50), std::uint8_t(y * 80), std::uint8_t(x + y)};
+      if (x < 4 && y < 2)
+        gray(x, y).gray = static_cast<std::uint16_t>(x * 4000 + y + 0x1234);
+      if (x < 3)
+        rgba(x, y) = {std::uint8_t(x), std::uint8_t(y), 7, std::uint8_t(x * y * 60)};
+      if (x < 3 && y < 2)
+        linear(x, y) = {float(x) * 0.25f, float(y) * 1.5f, -2.0f};
+    }
+  EXPECT_TRUE(std::equal(rgb.begin(), rgb.end(), round_trip(rgb, "P6").begin()));
+  EXPECT_TRUE(std::equal(gray.begin(), gray.end(), round_trip(gray, "P5").begin()));
+  EXPECT_TRUE(std::equal(rgba.begin(), rgba.end(), round_trip(rgba, "P7").begin()));
+  EXPECT_TRUE(std::equal(linear.begin(), linear.end(), round_trip(linear, "PF").begin()));
+
+  // converted on both ends, a tiled view is gathered row by row
+  basic_image<rgba8, aligned_allocator<rgba8>, tiled<4>> tiles(9, 6);
+  fill(tiles, {10, 20, 30, 255});
+  tiles(8, 5) = {1, 2, 3, 255};
+  std::ostringstream out;
+  write_netpbm(out, tiles.view().subview(1, 1, 8, 5));
+  const auto loaded = decode_netpbm<basic_rgb<std::uint16_t>>(as_bytes(out.str()));
+  EXPECT_EQ(8u, loaded.get_width());
+  EXPECT_EQ((basic_rgb<std::uint16_t>{0x0a0a, 0x1414, 0x1e1e}), loaded(0, 0));
+  EXPECT_EQ((basic_rgb<std::uint16_t>{0x0101, 0x0202, 0x0303}), loaded(7, 4));
+
+  // 10-bit samples in big-endian order, scaled to the full range
+  const std::string pgm = std::string("P5 2 1 1023\n") + std::string("\x03\xff\x00\x01", 4);
+  const auto ten        = decode_netpbm<basic_g<std::uint16_t>>(as_bytes(pgm));
+  EXPECT_EQ(65535, ten(0, 0).gray);
+  EXPECT_EQ(64, ten(1, 0).gray);
+  EXPECT_THROW((void)decode_netpbm<rgb8>(as_bytes(pgm.substr(0, pgm.size() - 1))), std::runtime_error);
+}
+
+TEST(Netpbm, Map) {
+  const auto dir = std::filesystem::temp_directory_path();
+  basic_image<rgb8> img(33, 17);
+  for (std::size_t y = 0; y < 17; ++y)
+    for (std::size_t x = 0; x < 33; ++x)
+      img(x, y) = {std::uint8_t(x), std::uint8_t(y), std::uint8_t(x ^ y)};
+  save_netpbm(dir / "portal_map.ppm", img);
+  {
+    const mapped_image<rgb8> mapped(dir / "portal_map.ppm");
+    EXPECT_EQ(33u, mapped.get_width());
+    EXPECT_EQ(17u, mapped.get_height());
+    for (std::size_t y = 0; y < 17; ++y)
+      ASSERT_EQ(0, std::memcmp(img.row(y), mapped.view().row(y), 33 * sizeof(rgb8))) << y;
+    basic_image<rgba8> copy(33, 17);
+    convert(mapped, copy);
+    EXPECT_EQ((rgba8{5, 6, 3, 255}), copy(5, 6));
+    EXPECT_THROW(mapped_image<rgba8>(dir / "portal_map.ppm"), std::runtime_error);
+  }
+  const auto loaded = load_netpbm<basic_g<std::uint8_t>>(dir / "portal_map.ppm");
+  EXPECT_EQ(convert_pixel<basic_g<std::uint8_t>>(img(9, 9)), loaded(9, 9));
+  std::filesystem::remove(dir / "portal_map.ppm");
+  EXPECT_THROW(mapped_image<rgb8>(dir / "portal_missing.ppm"), std::system_error);
+}
+
+TEST(Png, RoundTrip) {
+  // tall enough for several bands, each compressed on its own
+  basic_image<rgba8> rgba(301, 1200);
+  basic_image<basic_g<std::uint16_t>> gray(7, 5);
+  for (std::size_t y = 0; y < rgba.get_height(); ++y)
+    for (std::size_t x = 0; x < rgba.get_width(); ++x)
+      rgba(x, y) = {std::uint8_t(x), std::uint8_t(y / 3), std::uint8_t((x ^ y) % 7), std::uint8_t(x * y)};
+  for (std::size_t y = 0; y < 5; ++y)
+    for (std::size_t x = 0; x < 7; ++x)
+      gray(x, y).gray = static_cast<std::uint16_t>(x * 9000 + y * 7 + 0x0102);
+  portal::thread_pool pool(3);
+  for (int level : {0, 1, 6, 9}) {
+    std::ostringstream out;
+    write_png(out, rgba, level, pool);
+    const auto loaded = decode_png<rgba8>(as_bytes(out.str()));
+    EXPECT_TRUE(std::equal(rgba.begin(), rgba.end(), loaded.begin(), loaded.end())) << level;
+  }
+  std::ostringstream out;
+  write_png(out, gray);
+  const auto file = out.str();
+  EXPECT_EQ(0, file.compare(1, 3, "PNG"));
+  const auto loaded = decode_png<basic_g<std::uint16_t>>(as_bytes(file));
+  EXPECT_TRUE(std::equal(gray.begin(), gray.end(), loaded.begin(), loaded.end()));
+
+  // float is stored as 16-bit sRGB, a view is read as it is
+  basic_image<basic_rgb<float, color_encoding::linear>> linear(4, 4);
+  fill(linear, {0.25f, 0.5f, 1.0f});
+  std::ostringstream view_out;
+  write_png(view_out, linear.view().subview(1, 1, 2, 3));
+  const auto wide = decode_png<basic_rgb<std::uint16_t>>(as_bytes(view_out.str()));
+  EXPECT_EQ(2u, wide.get_width());
+  EXPECT_EQ(convert_pixel<basic_rgb<std::uint16_t>>(linear(0, 0)), wide(1, 2));
+
+  EXPECT_THROW(write_png(out, basic_image<rgb8>()), std::invalid_argument);
+  EXPECT_THROW(write_png(out, gray, 10), std::invalid_argument);
+  // the check comes before any byte, the pixels are never read
+  rgb8 pixel{};
+  std::ostringstream huge;
+  EXPECT_THROW(write_png(huge, basic_image_view<const rgb8>(&pixel, std::size_t{1} << 31, 1)), std::invalid_argument);
+  EXPECT_TRUE(huge.str().empty());
+  auto corrupt = file;
+  corrupt[40] ^= 1;
+  EXPECT_THROW((void)decode_png<rgb8>(as_bytes(corrupt)), std::runtime_error);
+  EXPECT_THROW((void)decode_png<rgb8>(as_bytes(file.substr(0, file.size() - 20))), std::runtime_error);
+}
+
+TEST(Png, Decode) {
+  // 2-bit palette with transparency, the second row with the up filter
+  const std::string file("\x89\x50\x4e\x47\x0d\x0a\x1a\x0a\x00\x00\x00\x0d\x49\x48\x44\x52\x00\x00\x00\x03\x00\x00\x00\x02\x02\x03\x00\x00\x00\xe0\x1a\x8e\x89\x00\x00\x00\x09\x50\x4c\x54\x45\xff\x00\x00\x00\xff\x00\x00\x00\xff\x2d\x4a\xcd\x8a\x00\x00\x00\x02\x74\x52\x4e\x53\xff\x80\x08\x0f\xb3\x6a\x00\x00\x00\x0c\x49\x44\x41\x54\x78\x9c\x63\x90\x60\xea\x01\x00\x00\xdc\x00\xa7\x3b\xf4\xff\x83\x00\x00\x00\x00\x49\x45\x4e\x44\xae\x42\x60\x82", 104);
+  const auto img = decode_png<rgba8>(as_bytes(file));
+  ASSERT_EQ(3u, img.get_width());
+  ASSERT_EQ(2u, img.get_height());
+  const std::vector<rgba8> expected = {{255, 0, 0, 255}, {0, 255, 0, 128}, {0, 0, 255, 255}, {0, 0, 255, 255}, {0, 0, 255, 255}, {0, 255, 0, 128}};
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), img.begin(), img.end()));
+}
+
+TEST(Qoi, RoundTrip) {
+  basic_image<rgba8> rgba(70, 30);
+  for (std::size_t y = 0; y < 30; ++y)
+    for (std::size_t x = 0; x < 70; ++x)
+      // runs, small and large differences, repeated colors and alpha changes
+      rgba(x, y) = y < 5 ? rgba8{1, 2, 3, 255} : y < 10 ? rgba8{std::uint8_t(x), std::uint8_t(x + 1), std::uint8_t(x), 255} : y < 20 ? rgba8{std::uint8_t(x * 37), std::uint8_t(y * 11), std::uint8_t(x % 3 * 90), 255} : rgba8{std::uint8_t(x % 4), 0, 0, std::uint8_t(x % 5 * 60)};
+  std::ostringstream out;
+  write_qoi(out, rgba);
+  const auto file = out.str();
+  EXPECT_EQ(0, file.compare(0, 4, "qoif"));
+  EXPECT_EQ(4, file[12]);
+  EXPECT_LT(file.size(), rgba.size() * 4);
+  const auto loaded = decode_qoi<rgba8>(as_bytes(file));
+  EXPECT_TRUE(std::equal(rgba.begin(), rgba.end(), loaded.begin(), loaded.end()));
+
+  const auto dir = std::filesystem::temp_directory_path();
+  basic_image<rgb8> rgb(5, 3);
+  fill(rgb, {9, 8, 7});
+  save_qoi(dir / "portal_round_trip.qoi", rgb.view().subview(0, 1, 5, 2));
+  const auto opaque = load_qoi<rgba8>(dir / "portal_round_trip.qoi");
+  std::filesystem::remove(dir / "portal_round_trip.qoi");
+  EXPECT_EQ(2u, opaque.get_height());
+  EXPECT_EQ((rgba8{9, 8, 7, 255}), opaque(4, 1));
+
+  EXPECT_THROW((void)decode_qoi<rgba8>(as_bytes(file.substr(0, file.size() / 2))), std::runtime_error);
+  EXPECT_THROW(write_qoi(out, basic_image<rgb8>()), std::invalid_argument);
+  rgb8 pixel{};
+  std::ostringstream huge;
+  EXPECT_THROW(write_qoi(huge, basic_image_view<const rgb8>(&pixel, 1, std::size_t{1} << 32)), std::invalid_argument);
+  EXPECT_TRUE(huge.str().empty());
+}
+
+namespace {
+// direct separable convolution, clamped, mirrored or wrapped at the edges
+template <typename P>
+basic_image<P> reference_filter(const basic_image<P> &src, const std::vector<float> &horizontal, const std::vector<float> &vertical, edge_mode edge) {
+  constexpr std::size_t C = simd::channels_v<P>;
+  const std::size_t w = src.get_width(), h = src.get_height();
+  const auto rh = static_cast<std::ptrdiff_t>(horizontal.size() / 2), rv = static_cast<std::ptrdiff_t>(vertical.size() / 2);
+  std::vector<double> mid(w * h * C);
+  for (std::size_t y = 0; y < h; ++y)
+    for (std::size_t x = 0; x < w; ++x)
+      for (std::ptrdiff_t k = -rh; k <= rh; ++k) {
+        const auto *p = reinterpret_cast<const float *>(&src(edge_index(static_cast<std::ptrdiff_t>(x) + k, w, edge), y));
+        for (std::size_t c = 0; c < C; ++c)
+          mid[(y * w + x) * C + c] += horizontal[static_cast<std::size_t>(k + rh)] * p[c];
+      }
+  basic_image<P> res(w, h);
+  for (std::size_t y = 0; y < h; ++y)
+    for (std::size_t x = 0; x < w; ++x) {
+      auto *p = reinterpret_cast<float *>(&res(x, y));
+      for (std::size_t c = 0; c < C; ++c) {
+        double sum = 0;
+        for (std::ptrdiff_t k = -rv; k <= rv; ++k)
+          sum += vertical[static_cast<std::size_t>(k + rv)] * mid[(edge_index(static_cast<std::ptrdiff_t>(y) + k, h, edge) * w + x) * C + c];
+        p[c] = static_cast<float>(sum);
+      }
+    }
+  return res;
+}
+
+template <typename P>
+float max_difference(const basic_image<P> &a, const basic_image<P> &b) {
+  float res = 0;
+  for (std::size_t y = 0; y < a.get_height(); ++y)
+    for (std::size_t x = 0; x < a.get_width(); ++x)
+      for (std::size_t c = 0; c < simd::channels_v<P>; ++c)
+        res = std::max(res, std::abs(reinterpret_cast<const float *>(&a(x, y))[c] - reinterpret_cast<const float *>(&b(x, y))[c]));
+  return res;
+}
+} // namespace
+
+TEST(Convolution, Edge) {
+  EXPECT_EQ(0u, edge_index(-3, 5, edge_mode::clamp));
+  EXPECT_EQ(4u, edge_index(7, 5, edge_mode::clamp));
+  EXPECT_EQ(2u, edge_index(-3, 5, edge_mode::mirror));
+  EXPECT_EQ(3u, edge_index(6, 5, edge_mode::mirror));
+  EXPECT_EQ(1u, edge_index(11, 5, edge_mode::mirror));
+  EXPECT_EQ(2u, edge_index(-3, 5, edge_mode::wrap));
+  EXPECT_EQ(1u, edge_index(11, 5, edge_mode::wrap));
+  EXPECT_EQ(0u, edge_index(-4, 1, edge_mode::mirror));
+}
+
+TEST(Convolution, Box) {
+  // sizes off the line groups, radii past the image
+  using rgbaf = basic_rgba<float, color_encoding::linear>;
+  basic_image<rgbaf> src(37, 23);
+  fill_noise(src);
+  portal::thread_pool pool(3);
+  for (auto edge : {edge_mode::clamp, edge_mode::mirror, edge_mode::wrap})
+    for (std::size_t radius : {0, 1, 5, 40}) {
+      basic_image<rgbaf> dst(37, 23);
+      box_blur(src, dst, radius, edge, pool);
+      const std::vector<float> box(2 * radius + 1, 1.0f / static_cast<float>(2 * radius + 1));
+      EXPECT_LT(max_difference(reference_filter(src, box, box, edge), dst), 1e-5f) << radius;
+    }
+
+  // 8 bit in place, a constant stays constant
+  basic_image<rgb8> flat(50, 9);
+  fill(flat, {12, 200, 99});
+  box_blur(flat, flat, 7);
+  EXPECT_TRUE(std::all_of(flat.begin(), flat.end(), [](auto p) { return p == rgb8{12, 200, 99}; }));
+  EXPECT_THROW(box_blur(flat, basic_image<rgb8>(50, 8), 1), std::invalid_argument);
+}
+
+TEST(Convolution, Kernel) {
+  basic_image<basic_g<float>> src(19, 41);
+  fill_noise(src);
+  const std::vector<float> horizontal = {0.1f, -0.5f, 2.0f, 0.25f, 0.3f}, vertical = {1.0f, 0.5f, -0.25f};
+  basic_image<basic_g<float>> dst(19, 41);
+  convolve(src, dst, horizontal, vertical, edge_mode::mirror);
+  EXPECT_LT(max_difference(reference_filter(src, horizontal, vertical, edge_mode::mirror), dst), 1e-5f);
+
+  // into a tiled view of another format
+  basic_image<basic_g<std::uint16_t>, aligned_allocator<basic_g<std::uint16_t>>, tiled<8>> tiles(19, 41);
+  convolve(src, tiles, std::vector<float>{1.0f}, std::vector<float>{0.5f, 0.0f, 0.5f});
+  EXPECT_EQ(convert_pixel<basic_g<std::uint16_t>>(basic_g<float>{(src(3, 4).gray + src(3, 6).gray) / 2}), tiles(3, 5));
+  EXPECT_THROW(convolve(src, dst, std::vector<float>{1.0f, 1.0f}, vertical), std::invalid_argument);
+}
+
+TEST(Convolution, Gaussian) {
+  for (float sigma : {0.0f, 0.7f, 3.0f}) {
+    const auto kernel = gaussian_kernel(sigma);
+    EXPECT_EQ(2 * static_cast<std::size_t>(std::ceil(3 * sigma)) + 1, kernel.size());
+    EXPECT_NEAR(1.0, std::accumulate(kernel.begin(), kernel.end(), 0.0), 1e-6);
+  }
+  EXPECT_THROW((void)gaussian_kernel(-1.0f), std::invalid_argument);
+
+  // the spread of an impulse, small sigmas sampled, large ones boxes
+  for (float sigma : {1.5f, 6.0f, 20.0f}) {
+    const auto radii = gaussian_boxes(sigma);
+    double variance  = 0;
+    for (auto r : radii)
+      variance += static_cast<double>(r * (r + 1)) / 3;
+    EXPECT_NEAR(sigma * sigma, variance, 0.15 * sigma * sigma) << sigma;
+
+    basic_image<basic_g<float>> img(201, 1);
+    fill(img, {0.0f});
+    img(100, 0).gray = 1.0f;
+    gaussian_blur(img, img, sigma);
+    double sum = 0, second = 0;
+    for (std::size_t x = 0; x < 201; ++x) {
+      sum += img(x, 0).gray;
+      second += img(x, 0).gray * (x - 100.0) * (x - 100.0);
+    }
+    EXPECT_NEAR(1.0, sum, 1e-4) << sigma;
+    EXPECT_NEAR(sigma * sigma, second, 0.15 * sigma * sigma) << sigma;
+    EXPECT_FLOAT_EQ(img(97, 0).gray, img(103, 0).gray) << sigma;
+  }
+}
+
+TEST(Convolution, Sharpen) {
+  basic_image<basic_g<std::uint8_t>> img(40, 4);
+  for (std::size_t y = 0; y < 4; ++y)
+    for (std::size_t x = 0; x < 40; ++x)
+      img(x, y).gray = x < 20 ? 50 : 150;
+  basic_image<basic_g<std::uint8_t>> copy(40, 4);
+  unsharp_mask(img, copy, 2.0f, 0.0f);
+  EXPECT_TRUE(std::equal(img.begin(), img.end(), copy.begin()));
+  unsharp_mask(img, img, 2.0f, 1.0f);
+  EXPECT_EQ(50, img(0, 2).gray);
+  EXPECT_LT(img(19, 2).gray, 50);
+  EXPECT_GT(img(20, 2).gray, 150);
+  EXPECT_EQ(150, img(39, 2).gray);
+}
+
+namespace {
+// each destination pixel summed directly from the filter, clipped windows renormalized
+template <typename P>
+basic_image<P> reference_resample(const basic_image<P> &src, std::size_t width, std::size_t height, resample_filter filter) {
+  constexpr std::size_t C = simd::channels_v<P>;
+  const auto weights      = [filter](std::size_t source, std::size_t size, std::size_t i) {
+    const double ratio = static_cast<double>(source) / static_cast<double>(size), scale = std::max(ratio, 1.0);
+    const double center = (static_cast<double>(i) + 0.5) * ratio;
+    std::vector<double> res(source);
+    double sum = 0;
+    for (std::size_t k = 0; k < source; ++k)
+      sum += res[k] = resample_weight(filter, static_cast<float>((static_cast<double>(k) + 0.5 - center) / scale));
+    for (auto &w : res)
+      w /= sum;
+    return res;
+  };
+  basic_image<P> res(width, height);
+  for (std::size_t y = 0; y < height; ++y) {
+    const auto wy = weights(src.get_height(), height, y);
+    for (std::size_t x = 0; x < width; ++x) {
+      const auto wx = weights(src.get_width(), width, x);
+      for (std::size_t c = 0; c < C; ++c) {
+        double sum = 0;
+        for (std::size_t j = 0; j < src.get_height(); ++j)
+          for (std::size_t i = 0; i < src.get_width(); ++i)
+            sum += wx[i] * wy[j] * reinterpret_cast<const float *>(&src(i, j))[c];
+        reinterpret_cast<float *>(&res(x, y))[c] = static_cast<float>(sum);
+      }
+    }
+  }
+  return res;
+}
+} // namespace
+
+TEST(Resample, Coefficients) {
+  for (auto filter : {resample_filter::nearest, resample_filter::bilinear, resample_filter::bicubic, resample_filter::lanczos3, resample_filter::area})
+    for (auto [source, size] : {std::pair<std::size_t, std::size_t>{1, 5}, {5, 1}, {7, 3}, {100, 37}, {37, 100}, {640, 64}}) {
+      const resample_coefficients table(source, size, filter);
+      ASSERT_EQ(size, table.size());
+      ASSERT_LE(table.taps(), source);
+      for (std::size_t i = 0; i < size; ++i) {
+        EXPECT_LE(table.first(i) + table.taps(), source);
+        EXPECT_NEAR(1.0f, std::accumulate(table.weights(i).begin(), table.weights(i).end(), 0.0f), 1e-5f);
+        EXPECT_EQ(1 << resample_coefficients::fixed_bits, std::accumulate(table.fixed_weights(i).begin(), table.fixed_weights(i).end(), 0));
+      }
+    }
+  EXPECT_EQ(1u, resample_coefficients(100, 37, resample_filter::nearest).taps());
+  EXPECT_NEAR(0.0f, resample_weight(resample_filter::lanczos3, 2.0f), 1e-6f);
+  EXPECT_FLOAT_EQ(1.0f, resample_weight(resample_filter::bicubic, 0.0f));
+  EXPECT_THROW(resample_coefficients(0, 3, resample_filter::bilinear), std::invalid_argument);
+}
+
+TEST(Resample, Reference) {
+  using rgbaf = basic_rgba<float, color_encoding::linear>;
+  basic_image<rgbaf> src(23, 17);
+  fill_noise(src);
+  portal::thread_pool pool(3);
+  for (auto filter : {resample_filter::bilinear, resample_filter::bicubic, resample_filter::lanczos3})
+    for (auto [width, height] : {std::pair<std::size_t, std::size_t>{41, 9}, {7, 30}, {23, 17}}) {
+      basic_image<rgbaf> dst(width, height);
+      resize(src, dst, filter, pool);
+      EXPECT_LT(max_difference(reference_resample(src, width, height, filter), dst), 1e-5f) << width << 'x' << height;
+    }
+}
+
+TEST(Resample, Exact) {
+  basic_image<rgba8> src(32, 24);
+  fill_noise(src);
+  for (auto filter : {resample_filter::nearest, resample_filter::bilinear, resample_filter::bicubic, resample_filter::lanczos3, resample_filter::area}) {
+    basic_image<rgba8> same(32, 24);
+    resize(src, same, filter);
+    EXPECT_TRUE(std::equal(src.begin(), src.end(), same.begin()));
+
+    // fixed-point weights sum to exactly one
+    basic_image<rgba8> flat(32, 24), down(9, 5), up(70, 61);
+    fill(flat, {12, 200, 99, 255});
+    resize(flat, down, filter);
+    resize(flat, up, filter);
+    EXPECT_TRUE(std::all_of(down.begin(), down.end(), [](auto p) { return p == rgba8{12, 200, 99, 255}; }));
+    EXPECT_TRUE(std::all_of(up.begin(), up.end(), [](auto p) { return p == rgba8{12, 200, 99, 255}; }));
+  }
+
+  // area is the mean of each 4 x 3 block, nearest repeats pixels
+  basic_image<basic_g<float>> gray(32, 24), blocks(8, 8), twice(64, 48);
+  fill_noise(gray);
+  resize(gray, blocks, resample_filter::area);
+  float mean = 0;
+  for (std::size_t y = 3; y < 6; ++y)
+    for (std::size_t x = 8; x < 12; ++x)
+      mean += gray(x, y).gray / 12;
+  EXPECT_NEAR(mean, blocks(2, 1).gray, 1e-5f);
+  resize(gray, twice, resample_filter::nearest);
+  EXPECT_EQ(gray(5, 7), twice(11, 14));
+  EXPECT_EQ(gray(5, 7), twice(10, 15));
+}
+
+TEST(Resample, Fixed) {
+  // the float result rounded, up to a rounding step of the 16 bit rows off
+  basic_image<rgba8> src(57, 31);
+  fill_noise(src);
+  basic_image<basic_rgba<float>> wide(57, 31);
+  std::transform(src.begin(), src.end(), wide.begin(), [](rgba8 p) { return convert_pixel<basic_rgba<float>>(p); });
+  for (auto filter : {resample_filter::bilinear, resample_filter::bicubic, resample_filter::lanczos3, resample_filter::area}) {
+    basic_image<rgba8> dst(20, 45);
+    basic_image<basic_rgba<float>> exact(20, 45);
+    resize(src, dst, filter);
+    resize(wide, exact, filter);
+    int diff = 0;
+    for (std::size_t y = 0; y < 45; ++y)
+      for (std::size_t x = 0; x < 20; ++x) {
+        const auto e = convert_pixel<rgba8>(exact(x, y));
+        diff         = std::max({diff, std::abs(e.red - dst(x, y).red), std::abs(e.green - dst(x, y).green), std::abs(e.blue - dst(x, y).blue),
+                                 std::abs(e.alpha - dst(x, y).alpha)});
+      }
+    EXPECT_LE(diff, 1);
+  }
+}
+
+TEST(Resample, Views) {
+  basic_image<rgb8> src(64, 40);
+  fill_noise(src);
+  const auto part = src.view().subview(8, 4, 40, 30);
+  basic_image<rgb8> crop(40, 30), direct(13, 17);
+  std::copy(part.begin(), part.end(), crop.begin());
+  resize(crop, direct, resample_filter::lanczos3);
+
+  // a subview into a tiled image of another format
+  basic_image<basic_bgra<std::uint8_t>, aligned_allocator<basic_bgra<std::uint8_t>>, tiled<8>> tiles(13, 17);
+  const resampler lanczos(40, 30, 13, 17, resample_filter::lanczos3);
+  lanczos(part, tiles);
+  for (std::size_t y = 0; y < 17; ++y)
+    for (std::size_t x = 0; x < 13; ++x)
+      EXPECT_EQ(convert_pixel<basic_bgra<std::uint8_t>>(direct(x, y)), tiles(x, y));
+  EXPECT_THROW(lanczos(src, tiles), std::invalid_argument);
+  EXPECT_THROW(resize(basic_image<rgb8>(0, 0), direct), std::invalid_argument);
+  basic_image<rgb8> none(0, 0);
+  EXPECT_NO_THROW(resize(src, none));
+
+  // resize keeps the tables of the last sizes on each thread
+  const auto a = resampler::cached(40, 30, 13, 17, resample_filter::lanczos3);
+  EXPECT_EQ(a, resampler::cached(40, 30, 13, 17, resample_filter::lanczos3));
+  EXPECT_NE(a, resampler::cached(40, 30, 13, 17, resample_filter::bicubic));
+  for (std::size_t i = 0; i < resampler::cached_count; ++i)
+    (void)resampler::cached(1, 1, i + 1, 1);
+  EXPECT_NE(a, resampler::cached(40, 30, 13, 17, resample_filter::lanczos3));
+  EXPECT_EQ(13u, a->horizontal().size());
+}
+
+TEST(Pyramid, Levels) {
+  EXPECT_EQ(0u, basic_image_pyramid<rgba8>::full_levels(0, 5));
+  EXPECT_EQ(1u, basic_image_pyramid<rgba8>::full_levels(1, 1));
+  EXPECT_EQ(4u, basic_image_pyramid<rgba8>::full_levels(8, 3));
+  EXPECT_EQ(5u, basic_image_pyramid<rgba8>::full_levels(9, 3));
+
+  basic_image_pyramid<rgb8> mips(37, 10);
+  ASSERT_EQ(7u, mips.levels());
+  const std::size_t widths[] = {37, 19, 10, 5, 3, 2, 1}, heights[] = {10, 5, 3, 2, 1, 1, 1};
+  for (std::size_t i = 0; i < mips.levels(); ++i) {
+    EXPECT_EQ(widths[i], mips.level(i).get_width());
+    EXPECT_EQ(heights[i], mips.level(i).get_height());
+    for (std::size_t y = 0; y < heights[i]; ++y)
+      EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(mips.level(i).row(y)) % decltype(mips)::alignment);
+  }
+  EXPECT_EQ(mips.data(), mips.level(0).data());
+  EXPECT_LT(mips.level(5).data(), mips.level(6).data());
+  EXPECT_EQ(3u, basic_image_pyramid<rgb8>(37, 10, 3).levels());
+  EXPECT_THROW(static_cast<void>(mips.level(7)), std::out_of_range);
+  EXPECT_EQ(0u, basic_image_pyramid<rgb8>().levels());
+}
+
+TEST(Pyramid, Build) {
+  // the SSE2 paths against the same filter through a lambda, odd sizes included
+  const auto check = [](auto img) {
+    using P = pixel_t<decltype(img)>;
+    fill_noise(img);
+    const basic_image_pyramid<P> fast(img);
+    basic_image_pyramid<P> slow(img.get_width(), img.get_height());
+    std::copy(img.begin(), img.end(), slow.level(0).begin());
+    slow.build([](const P &a, const P &b, const P &c, const P &d) { return box_reduce()(a, b, c, d); });
+    ASSERT_EQ(fast.levels(), slow.levels());
+    for (std::size_t i = 0; i < fast.levels(); ++i)
+      EXPECT_TRUE(std::equal(fast.level(i).begin(), fast.level(i).end(), slow.level(i).begin())) << i;
+  };
+  check(basic_image<rgba8>(67, 45));
+  check(basic_image<basic_g<std::uint8_t>>(131, 9));
+  check(basic_image<basic_rgba<float>>(20, 33));
+
+  // the mean of 2 x 2, the odd edge repeated
+  basic_image<basic_g<std::uint8_t>> img(3, 2);
+  const std::uint8_t values[] = {10, 20, 200, 11, 22, 100};
+  std::transform(std::begin(values), std::end(values), img.begin(), [](std::uint8_t v) { return basic_g<std::uint8_t>{v}; });
+  const basic_image_pyramid<basic_g<std::uint8_t>> mips(img);
+  EXPECT_EQ(16, mips.level(1)(0, 0).gray);
+  EXPECT_EQ(150, mips.level(1)(1, 0).gray);
+  EXPECT_EQ(83, mips.level(2)(0, 0).gray);
+}
+
+TEST(Pyramid, Update) {
+  using gray = basic_g<float>;
+  basic_image<gray> img(100, 61);
+  fill_noise(img);
+  const auto maximum = [](gray a, gray b, gray c, gray d) { return gray{std::max({a.gray, b.gray, c.gray, d.gray})}; };
+  basic_image_pyramid<gray> mips(img.get_width(), img.get_height());
+  std::copy(img.begin(), img.end(), mips.level(0).begin());
+  mips.build(maximum);
+  EXPECT_FALSE(mips.dirty());
+
+  // writes announced one by one, then the same as a rebuild
+  portal::thread_pool pool(3);
+  const std::size_t rects[][4] = {{3, 4, 5, 1}, {99, 60, 1, 1}, {40, 10, 30, 30}, {45, 20, 2, 2}, {0, 59, 100, 2}, {90, 0, 500, 500}};
+  for (const auto &r : rects) {
+    for (auto &p : mips.level(0).subview(r[0], r[1], std::min(r[2], 100 - r[0]), std::min(r[3], 61 - r[1])))
+      p.gray += 2.0f;
+    mips.invalidate(r[0], r[1], r[2], r[3]);
+  }
+  EXPECT_TRUE(mips.dirty());
+  mips.update(maximum, pool);
+  EXPECT_FALSE(mips.dirty());
+  auto rebuilt = mips;
+  rebuilt.build(maximum);
+  for (std::size_t i = 0; i < mips.levels(); ++i)
+    EXPECT_TRUE(std::equal(mips.level(i).begin(), mips.level(i).end(), rebuilt.level(i).begin())) << i;
+
+  // the default filter touches nothing outside of the rectangles
+  basic_image_pyramid<rgba8> box(basic_image<rgba8>(64, 64).fill({1, 2, 3, 4}));
+  box.level(2)(0, 0) = {9, 9, 9, 9};
+  box.level(0)(63, 63) = {255, 255, 255, 255};
+  box.invalidate(63, 63, 1, 1);
+  box.update();
+  EXPECT_EQ((rgba8{9, 9, 9, 9}), box.level(2)(0, 0));
+  EXPECT_EQ((rgba8{1, 2, 3, 4}), box.level(1)(30, 31));
+  EXPECT_EQ((rgba8{65, 65, 66, 67}), box.level(1)(31, 31));
+
+  auto moved = std::move(box);
+  EXPECT_EQ(0u, box.levels());
+  EXPECT_EQ(7u, moved.levels());
+}
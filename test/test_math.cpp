@@ -1,6 +1,26 @@
 #include <portal/math/fs_vector.hpp>
+#include <portal/math/fs_vector_soa.hpp>
+#include <portal/math/fs_vector_expr.hpp>
+#include <portal/math/fs_matrix.hpp>
+#include <portal/math/fast.hpp>
+#include <portal/math/lut.hpp>
+#include <portal/deflate.hpp>
+#include <portal/half.hpp>
+#include <portal/random.hpp>
+#include <portal/sampler.hpp>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace portal::math;
 
@@ -25,6 +45,30 @@ TEST(Math, IsZero) {
   EXPECT_TRUE(is_zero(0.00000000000001));
 }
 
+TEST(Math, SlowExpLog) {
+  // the constexpr branches against std
+  static constexpr double exps[] = {slow_exp(-700.0), slow_exp(-20.0), slow_exp(-0.5), slow_exp(0.0), slow_exp(1.0), slow_exp(30.0), slow_exp(700.0)};
+  static constexpr double logs[] = {slow_log(1e-10), slow_log(0.3), slow_log(1.0), slow_log(2.5), slow_log(1e10)};
+  static constexpr double pows[] = {slow_pow(0.5, 2.4), slow_pow(0.9, 1 / 2.4), slow_pow(2.0, 10.0), slow_pow(0.0, 2.0)};
+  const double exp_args[]        = {-700.0, -20.0, -0.5, 0.0, 1.0, 30.0, 700.0};
+  const double log_args[]        = {1e-10, 0.3, 1.0, 2.5, 1e10};
+  for (std::size_t i = 0; i < std::size(exps); ++i)
+    EXPECT_NEAR(std::exp(exp_args[i]), exps[i], std::exp(exp_args[i]) * 1e-15) << exp_args[i];
+  for (std::size_t i = 0; i < std::size(logs); ++i)
+    EXPECT_NEAR(std::log(log_args[i]), logs[i], 1e-14);
+  EXPECT_NEAR(std::pow(0.5, 2.4), pows[0], 1e-15);
+  EXPECT_NEAR(std::pow(0.9, 1 / 2.4), pows[1], 1e-15);
+  EXPECT_NEAR(1024.0, pows[2], 1e-11);
+  EXPECT_EQ(0.0, pows[3]);
+  static_assert(slow_log(0.0) == -std::numeric_limits<double>::infinity());
+  static_assert(slow_exp(std::numeric_limits<double>::infinity()) == std::numeric_limits<double>::infinity());
+  static_assert(slow_exp(-std::numeric_limits<double>::infinity()) == 0.0);
+  static_assert(slow_exp(1000.0) == std::numeric_limits<double>::infinity());
+  static constexpr float expf = slow_exp(10.f);
+  EXPECT_FLOAT_EQ(std::exp(10.f), expf);
+  EXPECT_DOUBLE_EQ(std::pow(0.5, 2.4), slow_pow(0.5, 2.4));
+}
+
 TEST(FSVec, RangeFor) {
   fs_vector<double, 3> lhs{1, 2, 3};
   for (auto &p : lhs)
@@ -111,4 +155,753 @@ TEST(FSVec, Dot) {
 TEST(FSVec, Cross) {
   constexpr fs_vector<double, 3> a{1, 2, 3}, b{4, 5, 6}, res{-3, 6, -3};
   EXPECT_EQ(res, cross(a, b));
-}
\ No newline at end of file
+}
+
+TEST(FSVec, OpSubAssign) {
+  fs_vector<double, 3> a{4, 5, 6}, res{3, 3, 3};
+  std::array<double, 3> b{1, 2, 3};
+  a -= b;
+  EXPECT_EQ(a, res);
+}
+
+TEST(FSVec, MulPeram) {
+  fs_vector<float, 4> a{1, 2, 3, 4}, b{2, 3, 4, 5}, res{2, 6, 12, 20};
+  EXPECT_EQ(res, mul_peram(a, b));
+}
+
+TEST(FSVec, MaxPeram) {
+  fs_vector<double, 3> a{1, 5, 3}, b{4, 2, 6}, res{4, 5, 6};
+  EXPECT_EQ(res, max_peram(a, b));
+}
+
+TEST(FSVec, MinPeram) {
+  fs_vector<float, 2> a{1, 5}, b{4, 2}, res{1, 2};
+  EXPECT_EQ(res, min_peram(a, b));
+}
+
+template <typename T, std::size_t N>
+constexpr fs_vector<T, N> simd_shape_expr(fs_vector<T, N> a, const fs_vector<T, N> &b) {
+  a += b;
+  a *= static_cast<T>(3);
+  a -= mul_peram(b, b);
+  a /= static_cast<T>(2);
+  return min_peram(max_peram(a, b), b * static_cast<T>(4));
+}
+
+template <typename T, std::size_t N>
+void check_simd_shape() {
+  constexpr fs_vector<T, N> a(tag::fill, static_cast<T>(1.5));
+  constexpr fs_vector<T, N> b(tag::fill, static_cast<T>(-0.25));
+  constexpr auto expected     = simd_shape_expr(a, b);
+  constexpr auto expected_dot = dot(expected, a);
+  const auto actual           = simd_shape_expr(a, b);
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(0, fpcmp(expected_dot, dot(actual, a)));
+}
+
+TEST(FSVec, SimdShapes) {
+  check_simd_shape<float, 2>();
+  check_simd_shape<float, 3>();
+  check_simd_shape<float, 4>();
+  check_simd_shape<double, 2>();
+  check_simd_shape<double, 3>();
+  check_simd_shape<double, 4>();
+  EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(fs_vector<float, 4>{}.data()) % alignof(fs_vector<float, 4>));
+}
+
+
+TEST(FSVecSoa, LoadStore) {
+  const fs_vector<float, 3> src[] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+  fs_vector_soa<float, 3, 4> a(src);
+  EXPECT_EQ(a.lane(1), src[1]);
+  EXPECT_EQ(a.lane(3), (fs_vector<float, 3>{}));
+  EXPECT_EQ(a[2], (fs_vector<float, 4>{3, 6, 9, 0}));
+
+  fs_vector<float, 3> dst[3];
+  a.store(dst);
+  for (std::size_t i = 0; i < 3; ++i)
+    EXPECT_EQ(dst[i], src[i]);
+
+  std::vector<fs_vector<float, 3>> too_many(5);
+  EXPECT_THROW(a.load(too_many), std::invalid_argument);
+}
+
+TEST(FSVecSoa, Arithmetic) {
+  const fs_vector<double, 3> a[] = {{1, 2, 3}, {-1, 0, 2}};
+  const fs_vector<double, 3> b[] = {{4, 5, 6}, {3, 1, -2}};
+  fs_vector_soa<double, 3, 2> pa(a), pb(b);
+  const auto sum  = pa + pb * 2.0 - pa / 2.0;
+  const auto dots = dot(pa, pb);
+  const auto crs  = cross(pa, pb);
+  const auto nrm  = normalized(pb);
+  for (std::size_t w = 0; w < 2; ++w) {
+    EXPECT_EQ(sum.lane(w), a[w] + b[w] * 2.0 - a[w] / 2.0);
+    EXPECT_DOUBLE_EQ(dots[w], dot(a[w], b[w]));
+    EXPECT_EQ(crs.lane(w), cross(a[w], b[w]));
+    EXPECT_EQ(nrm.lane(w), normalized(b[w]));
+    EXPECT_EQ(max_peram(pa, pb).lane(w), max_peram(a[w], b[w]));
+    EXPECT_EQ(min_peram(pa, pb).lane(w), min_peram(a[w], b[w]));
+    EXPECT_EQ(mul_peram(pa, pb).lane(w), mul_peram(a[w], b[w]));
+    EXPECT_EQ((-pa).lane(w), -a[w]);
+  }
+  EXPECT_DOUBLE_EQ(sqr_norm(pa)[1], 5.0);
+
+  const fs_vector<double, 3> c[] = {{2, 4, 8}, {-1, 0.5, 4}};
+  const fs_vector_soa<double, 3, 2> pc(c);
+  const auto quo = pb / pc;
+  pb /= pc;
+  for (std::size_t w = 0; w < 2; ++w) {
+    EXPECT_EQ(quo.lane(w), (fs_vector<double, 3>{b[w][0] / c[w][0], b[w][1] / c[w][1], b[w][2] / c[w][2]}));
+    EXPECT_EQ(pb.lane(w), quo.lane(w));
+  }
+}
+
+TEST(FSVecSoa, Select) {
+  fs_vector_soa<float, 2, 4> a(fs_vector<float, 2>{1, 2}), b(fs_vector<float, 2>{3, 4});
+  const auto res = select(fs_vector<bool, 4>{true, false, false, true}, a, b);
+  EXPECT_EQ(res[0], (fs_vector<float, 4>{1, 3, 3, 1}));
+  EXPECT_EQ(res[1], (fs_vector<float, 4>{2, 4, 4, 2}));
+}
+
+TEST(FSVecSoa, Constexpr) {
+  constexpr fs_vector<double, 3> a[] = {{1, 0, 0}, {0, 1, 0}};
+  constexpr fs_vector_soa<double, 3, 2> p(a);
+  constexpr auto d = dot(p, p);
+  EXPECT_DOUBLE_EQ(1.0, d[0]);
+  EXPECT_DOUBLE_EQ(1.0, d[1]);
+}
+
+
+TEST(FSVecExpr, Chain) {
+  fs_vector<double, 3> a{1, 2, 3}, b{4, 5, 6}, c{1, 1, 1}, r;
+  r = lazy(a) + lazy(b) * 2.0 - c;
+  EXPECT_EQ(r, a + b * 2.0 - c);
+  r = -(lazy(a) / 2.0) + 3.0 * lazy(b);
+  EXPECT_EQ(r, -(a / 2.0) + 3.0 * b);
+  r += mul_peram(lazy(a), b);
+  EXPECT_EQ(r, -(a / 2.0) + 3.0 * b + mul_peram(a, b));
+  EXPECT_EQ((fs_vector<double, 3>(max_peram(lazy(a), c * 2.0))), max_peram(a, c * 2.0));
+  EXPECT_EQ((fs_vector<double, 3>(min_peram(lazy(a), c * 2.0))), min_peram(a, c * 2.0));
+}
+
+TEST(FSVecExpr, VectorClass) {
+  fs_vector<double, 3> a{1, 2, 3};
+  std::array<double, 3> b{4, 5, 6};
+  std::vector<double> c{1, 1, 1, 1};
+  fs_vector<double, 3> r(lazy(a) + b);
+  EXPECT_EQ(r, (fs_vector<double, 3>{5, 7, 9}));
+  EXPECT_THROW((void)(lazy(a) + c), std::invalid_argument);
+}
+
+constexpr fs_vector<double, 3> lazy_axpy(const fs_vector<double, 3> &x, const fs_vector<double, 3> &y, double s) {
+  fs_vector<double, 3> r;
+  r = lazy(x) * s + y;
+  return r;
+}
+
+TEST(FSVecExpr, Constexpr) {
+  constexpr fs_vector<double, 3> x{1, 2, 3}, y{1, 1, 1};
+  constexpr auto r = lazy_axpy(x, y, 2.0);
+  EXPECT_EQ(r, (fs_vector<double, 3>{3, 5, 7}));
+}
+
+
+TEST(FSMat, Product) {
+  constexpr fs_matrix<double, 2, 3> a{fs_vector<double, 3>{1, 2, 3}, fs_vector<double, 3>{4, 5, 6}};
+  constexpr fs_matrix<double, 3, 2> b{fs_vector<double, 2>{7, 8}, fs_vector<double, 2>{9, 10}, fs_vector<double, 2>{11, 12}};
+  constexpr fs_matrix<double, 2, 2> ab{fs_vector<double, 2>{58, 64}, fs_vector<double, 2>{139, 154}};
+  EXPECT_EQ(ab, a * b);
+  EXPECT_EQ((fs_vector<double, 2>{14, 32}), (a * fs_vector<double, 3>{1, 2, 3}));
+  EXPECT_EQ(transpose(b), (fs_matrix<double, 2, 3>{fs_vector<double, 3>{7, 9, 11}, fs_vector<double, 3>{8, 10, 12}}));
+  EXPECT_EQ(a, (a * fs_matrix<double, 3, 3>::identity()));
+}
+
+TEST(FSMat, Inverse) {
+  constexpr fs_matrix<double, 3, 3> a{fs_vector<double, 3>{2, 0, 1}, fs_vector<double, 3>{1, 3, 2}, fs_vector<double, 3>{1, 1, 2}};
+  EXPECT_DOUBLE_EQ(6, determinant(a));
+  EXPECT_EQ((fs_matrix<double, 3, 3>::identity()), a * inverse(a));
+
+  const fs_matrix<float, 4, 4> b{fs_vector<float, 4>{4, 0, 0, 1}, fs_vector<float, 4>{0, 2, 1, 0}, fs_vector<float, 4>{1, 0, 3, 2}, fs_vector<float, 4>{0, 1, 0, 1}};
+  const auto id = b * inverse(b);
+  for (std::size_t i = 0; i < 4; ++i)
+    for (std::size_t j = 0; j < 4; ++j)
+      EXPECT_NEAR(i == j ? 1.f : 0.f, id(i, j), 1e-6f);
+
+  EXPECT_THROW((void)inverse(fs_matrix<double, 3, 3>{}), std::domain_error);
+  EXPECT_THROW((void)inverse(fs_matrix<double, 4, 4>{}), std::domain_error);
+}
+
+TEST(FSMat, TransformPoints) {
+  fs_matrix<float, 4, 4> m{fs_vector<float, 4>{0, -1, 0, 1}, fs_vector<float, 4>{2, 0, 0, 2}, fs_vector<float, 4>{0, 0, 1, 3}, fs_vector<float, 4>{0, 0, 0, 1}};
+  std::vector<fs_vector<float, 3>> src, points(19), normals(19);
+  for (int i = 0; i < 19; ++i)
+    src.push_back({float(i), float(i * 2), float(-i)});
+  transform_points(m, src, points);
+  transform_normals(m, src, normals);
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    const auto p = m * fs_vector<float, 4>{src[i][0], src[i][1], src[i][2], 1};
+    EXPECT_EQ(points[i], (fs_vector<float, 3>{p[0], p[1], p[2]}));
+    EXPECT_EQ(normals[i], (fs_vector<float, 3>{-src[i][1], src[i][0] / 2, src[i][2]}));
+  }
+  EXPECT_THROW(transform_points(m, src, std::span(points).first(3)), std::invalid_argument);
+}
+
+TEST(FastMath, Accuracy) {
+  using fast::precision;
+  for (float x = -10; x < 10; x += 0.01f) {
+    EXPECT_NEAR(std::sin(x), fast::sin<precision::medium>(x), 1e-4f);
+    EXPECT_NEAR(std::cos(x), fast::cos<precision::medium>(x), 1e-4f);
+    EXPECT_NEAR(std::sin(x), fast::sin<precision::low>(x), 1e-2f);
+    EXPECT_NEAR(std::exp(x), fast::exp<precision::medium>(x), std::exp(x) * 1e-4f);
+    EXPECT_NEAR(std::exp(x), fast::exp<precision::low>(x), std::exp(x) * 1e-2f);
+  }
+  for (double x = 1e-3; x < 1e3; x *= 1.1) {
+    EXPECT_NEAR(std::log(x), fast::log<precision::medium>(x), 1e-4);
+    EXPECT_NEAR(std::log(x), fast::log<precision::low>(x), 1e-2);
+    EXPECT_NEAR(1 / std::sqrt(x), fast::rsqrt<precision::medium>(x), 1e-4 / std::sqrt(x));
+    EXPECT_NEAR(std::sqrt(x), fast::sqrt<precision::low>(x), 1e-2 * std::sqrt(x));
+    EXPECT_NEAR(std::pow(x, 0.45), fast::pow<precision::medium>(x, 0.45), 1e-4 * std::pow(x, 0.45));
+  }
+  EXPECT_EQ(-std::numeric_limits<float>::infinity(), fast::log(0.f));
+  EXPECT_TRUE(std::isnan(fast::log(-1.f)));
+  EXPECT_EQ(0.f, fast::sqrt(0.f));
+  const float inf = std::numeric_limits<float>::infinity();
+  EXPECT_EQ(inf, fast::sqrt(inf));
+  EXPECT_EQ(inf, fast::sqrt<precision::low>(inf));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), fast::sqrt(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ(0.f, fast::pow(0.f, 2.f));
+  EXPECT_EQ(1.f, fast::pow(0.f, 0.f));
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), fast::pow(0.f, -2.f));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), fast::pow<precision::low>(0.0, -0.5));
+  EXPECT_EQ(std::pow(0.0, -0.5), fast::pow<precision::high>(0.0, -0.5));
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_TRUE(std::isnan(fast::exp(nan)));
+  EXPECT_TRUE(std::isnan(fast::exp<precision::low>(nan)));
+  EXPECT_TRUE(std::isnan(fast::log(nan)));
+  EXPECT_TRUE(std::isnan(fast::pow(nan, 2.f)));
+}
+
+TEST(FastMath, Overloads) {
+  std::vector<float> src, dst(100);
+  for (int i = 0; i < 100; ++i)
+    src.push_back(0.05f * static_cast<float>(i + 1));
+  fast::log(std::span<const float>(src), std::span<float>(dst));
+  for (std::size_t i = 0; i < src.size(); ++i)
+    EXPECT_EQ(fast::log(src[i]), dst[i]);
+  fast::pow(std::span<const float>(src), 2.f, std::span<float>(dst));
+  for (std::size_t i = 0; i < src.size(); ++i)
+    EXPECT_EQ(fast::pow(src[i], 2.f), dst[i]);
+  EXPECT_THROW(fast::exp(std::span<const float>(src), std::span<float>(dst).first(3)), std::invalid_argument);
+
+  const fs_vector<double, 4> vec{0.5, 1, 1.5, 2};
+  fs_vector<double, 4> s, c;
+  fast::sincos(vec, s, c);
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_EQ(fast::sin(vec[i]), s[i]);
+    EXPECT_EQ(fast::cos(vec[i]), c[i]);
+    EXPECT_EQ(fast::exp(vec)[i], fast::exp(vec[i]));
+  }
+}
+
+TEST(FastMath, Constexpr) {
+  constexpr float s = fast::sin(1.f);
+  constexpr double e = fast::exp<fast::precision::low>(1.0);
+  constexpr double l = fast::log(8.0);
+  static_assert(s > 0.8414f && s < 0.8415f);
+  EXPECT_EQ(s, fast::sin(1.f));
+  EXPECT_EQ(e, fast::exp<fast::precision::low>(1.0));
+  EXPECT_EQ(l, fast::log(8.0));
+
+  // the high tier and NaN stay usable in constant expressions
+  using fast::precision;
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  static_assert(fast::exp<precision::high>(0.0) == 1.0);
+  static_assert(fast::log<precision::high>(1.0) == 0.0);
+  static_assert(fast::pow<precision::high>(2.0, 0.0) == 1.0);
+  static_assert(fast::exp(nan) != fast::exp(nan));
+  static_assert(fast::log(nan) != fast::log(nan));
+  constexpr double p = fast::pow<precision::high>(2.0, 0.5);
+  EXPECT_NEAR(std::sqrt(2.0), p, 1e-12);
+}
+
+TEST(Lut, Interpolation) {
+  static constexpr auto linear = make_lut<256>([](double x) { return slow_sin(x); }, 0.0, std::numbers::pi / 2);
+  static constexpr auto cubic  = make_lut<256, interpolation::cubic>([](double x) { return slow_sin(x); }, 0.0, std::numbers::pi / 2);
+  static_assert(linear.error() < 1e-5 && linear.error() > 0);
+  static_assert(cubic.error() < linear.error() / 100);
+  for (double x = 0; x <= std::numbers::pi / 2; x += 1e-3) {
+    EXPECT_NEAR(std::sin(x), linear(x), linear.error() * 1.01);
+    EXPECT_NEAR(std::sin(x), cubic(x), cubic.error() * 1.01);
+  }
+  EXPECT_DOUBLE_EQ(0, linear(-1));
+  EXPECT_DOUBLE_EQ(1, linear(2));
+  EXPECT_THROW((void)make_lut<4>([](float x) { return x; }, 1.f, 1.f), std::invalid_argument);
+}
+
+TEST(Lut, Constexpr) {
+  constexpr auto sqrt_table = make_lut<64>([](float x) { return slow_sqrt(x); }, 1.f, 4.f);
+  static_assert(sqrt_table.size() == 64 && sqrt_table(4.f) == 2.f);
+  constexpr float y = sqrt_table(2.f);
+  EXPECT_NEAR(std::sqrt(2.f), y, sqrt_table.error() * 1.01f);
+}
+
+TEST(Lut, Batch) {
+  static constexpr auto linear = make_lut<100>([](float x) { return slow_sin(x); }, 0.f, 2.f);
+  static constexpr auto cubic  = make_lut<100, interpolation::cubic>([](float x) { return slow_sin(x); }, 0.f, 2.f);
+  std::vector<float> x(1003), y(x.size()), z(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i)
+    x[i] = static_cast<float>(i) / 400 - 0.2f; // both ends clamp
+  x[5] = std::numeric_limits<float>::quiet_NaN();
+  linear(std::span<const float>(x), std::span(y));
+  cubic(std::span<const float>(x), std::span(z));
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    EXPECT_FLOAT_EQ(linear(x[i]), y[i]);
+    EXPECT_FLOAT_EQ(cubic(x[i]), z[i]);
+  }
+  cubic(std::span<const float>(x), std::span(x));
+  EXPECT_TRUE(std::equal(x.begin(), x.end(), z.begin()));
+  EXPECT_THROW(cubic(std::span<const float>(x), std::span(z).first(3)), std::invalid_argument);
+}
+
+TEST(Half, Convert) {
+  using portal::half;
+  for (std::uint32_t b = 0; b < 65536; ++b) {
+    const auto h  = half::from_bits(static_cast<std::uint16_t>(b));
+    const int e   = (b >> 10) & 31;
+    const int m   = b & 1023;
+    const float v = e == 0 ? std::ldexp(static_cast<float>(m), -24) : std::ldexp(static_cast<float>(m | 1024), e - 25);
+    if (e == 31 && m != 0) {
+      EXPECT_TRUE(std::isnan(static_cast<float>(h))) << b;
+      EXPECT_TRUE(std::isnan(static_cast<float>(half(static_cast<float>(h))))) << b;
+      continue;
+    }
+    EXPECT_EQ(e == 31 ? std::numeric_limits<float>::infinity() : v, std::abs(static_cast<float>(h))) << b;
+    EXPECT_EQ(b, half(static_cast<float>(h)).bits()) << b;
+  }
+  // ties round to even
+  EXPECT_EQ(0x3c00, half(1 + std::ldexp(1.f, -11)).bits());
+  EXPECT_EQ(0x3c02, half(1 + 3 * std::ldexp(1.f, -11)).bits());
+  EXPECT_EQ(0x3c01, half(1 + std::ldexp(1.f, -11) + std::ldexp(1.f, -20)).bits());
+  EXPECT_EQ(0x7bff, half(65519.f).bits());
+  EXPECT_EQ(0x7c00, half(65520.f).bits());
+  EXPECT_EQ(0xfc00, half(-1e10f).bits());
+  EXPECT_EQ(0x0000, half(std::ldexp(1.f, -25)).bits());
+  EXPECT_EQ(0x0001, half(std::ldexp(1.5f, -25)).bits());
+  EXPECT_EQ(0x0400, half(std::ldexp(1.f, -14) - std::ldexp(1.f, -26)).bits());
+  EXPECT_EQ(0x8000, half(-0.f).bits());
+
+  static_assert(half(0.5f).bits() == 0x3800 && static_cast<float>(half::from_bits(0xc000)) == -2.f);
+  static_assert(static_cast<float>(std::numeric_limits<portal::half>::max()) == 65504.f);
+  static_assert(static_cast<float>(std::numeric_limits<portal::half>::epsilon()) == 1.f / 1024);
+  static_assert(static_cast<float>(std::numeric_limits<portal::half>::denorm_min()) == 1.f / (1 << 24));
+  static_assert(std::numeric_limits<portal::half>::has_denorm == std::denorm_present);
+  static_assert(std::numeric_limits<portal::half>::min_exponent10 == -4 && std::numeric_limits<portal::half>::max_exponent10 == 4);
+}
+
+TEST(Half, Bulk) {
+  using portal::half;
+  // odd length, so that the simd paths leave a tail
+  std::vector<float> x;
+  for (std::uint32_t b = 0; b < 0xfff00000u; b += 65521)
+    x.push_back(std::bit_cast<float>(b));
+  x.push_back(1.f);
+  std::vector<half> h(x.size());
+  portal::float_to_half(x, h);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (std::isnan(x[i]))
+      EXPECT_TRUE(std::isnan(static_cast<float>(h[i]))) << i;
+    else
+      EXPECT_EQ(half(x[i]).bits(), h[i].bits()) << x[i];
+  }
+
+  std::vector<half> all(65535);
+  for (std::size_t i = 0; i < all.size(); ++i)
+    all[i] = half::from_bits(static_cast<std::uint16_t>(i));
+  std::vector<float> y(all.size());
+  portal::half_to_float(all, y);
+  for (std::size_t i = 0; i < all.size(); ++i) {
+    const float v = all[i];
+    EXPECT_TRUE(std::bit_cast<std::uint32_t>(v) == std::bit_cast<std::uint32_t>(y[i]) || (std::isnan(v) && std::isnan(y[i]))) << i;
+  }
+  EXPECT_THROW(portal::half_to_float(all, std::span(y).first(3)), std::invalid_argument);
+}
+
+TEST(Random, Streams) {
+  auto &streams = portal::random_streams::shared();
+  streams.seed(42);
+  EXPECT_EQ(42U, streams.seed());
+  EXPECT_EQ(streams.stream<std::mt19937>(3)(), streams.stream<std::mt19937>(3)());
+  EXPECT_NE(streams.stream<std::mt19937>(3)(), streams.stream<std::mt19937>(4)());
+  EXPECT_NE(streams.key(0), streams.key(1));
+  const auto key = streams.key(7);
+  streams.seed(43);
+  EXPECT_NE(key, streams.key(7));
+
+  // each thread draws its own stream, the same again after reseeding
+  const auto draw = [](std::uint64_t seed) {
+    portal::seed_random(seed);
+    std::vector<std::vector<double>> res(4);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < res.size(); ++i)
+      threads.emplace_back([&res, i] {
+        portal::random_streams::shared().set_this_thread_stream(i + 100);
+        for (int n = 0; n < 1000; ++n)
+          res[i].push_back(portal::random<double>());
+      });
+    for (auto &th : threads)
+      th.join();
+    return res;
+  };
+  const auto a = draw(1);
+  EXPECT_EQ(a, draw(1));
+  EXPECT_NE(a, draw(2));
+  EXPECT_NE(a[0], a[1]);
+  for (const auto &v : a)
+    for (const double x : v)
+      ASSERT_TRUE(x >= 0.0 && x < 1.0);
+
+  // the calling thread restarts its stream on reseeding
+  portal::seed_random(5);
+  const double x = portal::random<double>();
+  portal::seed_random(5);
+  EXPECT_EQ(x, portal::random<double>());
+  auto own = streams.stream<portal::default_random_engine>(streams.this_thread_stream());
+  EXPECT_EQ(x, std::uniform_real_distribution<double>()(own));
+
+  const portal::uniform_int_distribution<int> dice(1, 6);
+  std::mt19937 engine(1);
+  for (int n = 0; n < 100; ++n) {
+    const int d = dice();
+    ASSERT_TRUE(d >= 1 && d <= 6);
+    ASSERT_EQ(dice.param(), portal::uniform_int_distribution<int>(dice.param()).param());
+  }
+  portal::uniform_int_distribution<int> coin(0, 1);
+  EXPECT_LE(coin(engine), 1);
+}
+
+TEST(Random, Engines) {
+  static_assert(std::uniform_random_bit_generator<portal::splitmix64>);
+  static_assert(std::uniform_random_bit_generator<portal::pcg32>);
+  static_assert(std::uniform_random_bit_generator<portal::xoshiro128p>);
+  static_assert(std::uniform_random_bit_generator<portal::xoshiro256pp>);
+  static_assert(std::uniform_random_bit_generator<portal::philox4x32>);
+
+  portal::splitmix64 sm(1234567);
+  for (const std::uint64_t x : {6457827717110365317u, 3203168211198807973u, 9817491932198370423u, 4593380528125082431u, 16408922859458223821u})
+    EXPECT_EQ(x, sm());
+
+  portal::pcg32 pcg(42, 54);
+  for (const std::uint32_t x : {0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu})
+    EXPECT_EQ(x, pcg());
+
+  using block = portal::philox4x32::counter_type;
+  EXPECT_EQ((block{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}), portal::philox4x32::block({0, 0, 0, 0}, 0));
+  EXPECT_EQ((block{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}), portal::philox4x32::block({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, 0xffffffffffffffffu));
+  EXPECT_EQ((block{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}), portal::philox4x32::block({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, 0x299f31d0a4093822u));
+  // the engine walks the counter, across the carry too
+  portal::philox4x32 philox(7, {0xfffffffeu, 0xffffffffu, 0, 0});
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(portal::philox4x32::block({0xfffffffeu, 0xffffffffu, 0, 0}, 7)[i], philox());
+  EXPECT_EQ(portal::philox4x32::block({0xffffffffu, 0xffffffffu, 0, 0}, 7)[0], philox());
+  EXPECT_EQ((block{0, 0, 1, 0}), philox.counter());
+
+  // discard matches stepping
+  const auto check_discard = [](auto engine) {
+    for (const unsigned long long n : {0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 1000ULL}) {
+      auto a = engine, b = engine;
+      a.discard(n);
+      for (unsigned long long i = 0; i < n; ++i)
+        b();
+      EXPECT_EQ(a(), b()) << n;
+      EXPECT_TRUE(a == b);
+    }
+  };
+  check_discard(portal::splitmix64(3));
+  check_discard(portal::pcg32(3, 9));
+  check_discard(portal::xoshiro128pp(3));
+  check_discard(portal::xoshiro256p(3));
+  check_discard(portal::philox4x32(3));
+  portal::philox4x32 partial(3);
+  partial();
+  check_discard(partial);
+
+  // jumped streams differ, seeds differ, every engine is uniform enough for a mean
+  portal::xoshiro256pp x(1), y(1);
+  y.jump();
+  EXPECT_NE(x(), y());
+  EXPECT_NE(portal::xoshiro128p(1)(), portal::xoshiro128p(2)());
+  const auto mean = [](auto engine) {
+    std::uniform_real_distribution<double> dist;
+    double sum = 0;
+    for (int i = 0; i < 100000; ++i)
+      sum += dist(engine);
+    return sum / 100000;
+  };
+  EXPECT_NEAR(0.5, mean(portal::splitmix64(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::pcg32(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::xoshiro128p(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::xoshiro128pp(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::xoshiro256p(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::xoshiro256pp(5)), 0.01);
+  EXPECT_NEAR(0.5, mean(portal::philox4x32(5)), 0.01);
+  const portal::uniform_real_distribution<double, portal::pcg32> pcg_dist;
+  EXPECT_NEAR(0.5, pcg_dist(), 0.5);
+}
+
+TEST(Random, Generate) {
+  // lanes are jumped xoshiro128++ engines, generate() continues operator()
+  portal::xoshiro128pp_x8 lanes(9);
+  std::vector<portal::xoshiro128pp> scalar;
+  portal::xoshiro128pp lane(9);
+  for (int i = 0; i < 8; ++i) {
+    scalar.push_back(lane);
+    lane.jump();
+  }
+  for (int step = 0; step < 3; ++step)
+    for (auto &s : scalar)
+      ASSERT_EQ(s(), lanes());
+  lanes();
+  std::vector<std::uint32_t> bulk(101), one_by_one(101);
+  lanes.generate(bulk);
+  portal::xoshiro128pp_x8 copy(9);
+  copy.discard(25);
+  for (auto &x : one_by_one)
+    x = copy();
+  EXPECT_EQ(bulk, one_by_one);
+  EXPECT_TRUE(copy == lanes);
+
+  std::mt19937_64 wide(3), wide_copy(3);
+  std::array<std::uint32_t, 5> words;
+  portal::generate_bits(wide, words);
+  const std::uint64_t first = wide_copy();
+  EXPECT_EQ(static_cast<std::uint32_t>(first), words[0]);
+  EXPECT_EQ(static_cast<std::uint32_t>(first >> 32), words[1]);
+
+  EXPECT_EQ(0.0f, portal::unit_float(0));
+  EXPECT_EQ(1.0f - 0x1p-23f, portal::unit_float(0xffffffffu));
+  EXPECT_EQ(1.0 - 0x1p-52, portal::unit_double(0xffffffffffffffffu));
+
+  // reals stay in [a, b) with the expected mean
+  portal::seed_random(11);
+  std::vector<float> floats(100003);
+  portal::uniform_real_distribution<float>(-2.0f, 6.0f).generate(floats);
+  EXPECT_TRUE(std::all_of(floats.begin(), floats.end(), [](float x) { return x >= -2.0f && x < 6.0f; }));
+  EXPECT_NEAR(2.0, std::accumulate(floats.begin(), floats.end(), 0.0) / floats.size(), 0.05);
+  std::vector<double> doubles(100003);
+  portal::pcg32 pcg(4);
+  portal::uniform_real_distribution<double>(1.0, 1.0 + 0x1p-40).generate(doubles, pcg);
+  EXPECT_TRUE(std::all_of(doubles.begin(), doubles.end(), [](double x) { return x >= 1.0 && x < 1.0 + 0x1p-40; }));
+  fs_vector<float, 8> v;
+  portal::uniform_real_distribution<float>(3.0f, 4.0f).generate(std::span(v));
+  EXPECT_TRUE(std::all_of(v.begin(), v.end(), [](float x) { return x >= 3.0f && x < 4.0f; }));
+
+  // ints cover [a, b]
+  std::vector<int> dice(6000);
+  portal::uniform_int_distribution<int>(1, 6).generate(dice);
+  for (int face = 1; face <= 6; ++face)
+    EXPECT_NEAR(1000, std::count(dice.begin(), dice.end(), face), 150) << face;
+  std::vector<std::uint32_t> full(1000);
+  portal::uniform_int_distribution<std::uint32_t>(0).generate(full);
+  EXPECT_GT(*std::max_element(full.begin(), full.end()), 0xf0000000u);
+  std::vector<std::int64_t> wide_ints(1000);
+  portal::uniform_int_distribution<std::int64_t>(-(std::int64_t{1} << 40), std::int64_t{1} << 40).generate(wide_ints);
+  EXPECT_TRUE(std::all_of(wide_ints.begin(), wide_ints.end(), [](std::int64_t x) { return x >= -(std::int64_t{1} << 40) && x <= std::int64_t{1} << 40; }));
+  EXPECT_LT(*std::min_element(wide_ints.begin(), wide_ints.end()), -(std::int64_t{1} << 38));
+  std::vector<std::int16_t> shorts(1000);
+  portal::uniform_int_distribution<std::int16_t>(-100, 100).generate(shorts);
+  EXPECT_EQ(-100, *std::min_element(shorts.begin(), shorts.end()));
+  EXPECT_EQ(100, *std::max_element(shorts.begin(), shorts.end()));
+}
+
+TEST(Sampler, Sobol) {
+  EXPECT_EQ(0x80000000u, portal::reverse_bits(1));
+  EXPECT_EQ(0x12345678u, portal::reverse_bits(portal::reverse_bits(0x12345678u)));
+  // van der Corput and x + 1
+  const std::array<std::uint32_t, 4> d0 = {0, 0x80000000u, 0x40000000u, 0xc0000000u};
+  const std::array<std::uint32_t, 4> d1 = {0, 0x80000000u, 0xc0000000u, 0x40000000u};
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(d0[i], portal::sobol_sampler::sobol_bits(i, 0));
+    EXPECT_EQ(d1[i], portal::sobol_sampler::sobol_bits(i, 1));
+  }
+
+  // scrambled points of any pixel keep the stratification, also in padded dimensions
+  const portal::sobol_sampler sampler(7);
+  constexpr std::uint32_t k = 8, n = 1u << k;
+  for (const std::uint32_t pixel : {0u, 1u, 12345u}) {
+    for (std::uint32_t dim = 0; dim < 20; ++dim) {
+      std::vector<int> strata(n);
+      for (std::uint32_t i = 0; i < n; ++i)
+        ++strata[static_cast<std::size_t>(sampler(pixel, i, dim) * n)];
+      ASSERT_TRUE(std::all_of(strata.begin(), strata.end(), [](int c) { return c == 1; })) << pixel << ' ' << dim;
+    }
+    for (std::uint32_t a = 0; a <= k; ++a) {
+      std::vector<int> boxes(n);
+      for (std::uint32_t i = 0; i < n; ++i) {
+        const auto x = static_cast<std::size_t>(sampler(pixel, i, 0) * (1u << a));
+        const auto y = static_cast<std::size_t>(sampler(pixel, i, 1) * (1u << (k - a)));
+        ++boxes[x << (k - a) | y];
+      }
+      ASSERT_TRUE(std::all_of(boxes.begin(), boxes.end(), [](int c) { return c == 1; })) << pixel << ' ' << a;
+    }
+  }
+  EXPECT_NE(sampler(0, 3, 2), sampler(1, 3, 2));
+  EXPECT_NE(sampler(0, 3, 2), portal::sobol_sampler(8)(0, 3, 2));
+
+  std::vector<float> batch(37);
+  sampler.generate(5, 11, 3, batch);
+  for (std::uint32_t i = 0; i < batch.size(); ++i)
+    ASSERT_EQ(sampler(5, 11 + i, 3), batch[i]);
+
+  // quasi-random integration beats the 1 / sqrt(N) of white noise
+  double sum = 0;
+  for (std::uint32_t i = 0; i < 1024; ++i)
+    sum += sampler(9, i, 0) * sampler(9, i, 1);
+  EXPECT_NEAR(0.25, sum / 1024, 1e-3);
+}
+
+TEST(Sampler, Halton) {
+  EXPECT_DOUBLE_EQ(0.5, portal::halton_sampler::radical_inverse(1, 0));
+  EXPECT_DOUBLE_EQ(0.75, portal::halton_sampler::radical_inverse(3, 0));
+  EXPECT_DOUBLE_EQ(1.0 / 3 + 1.0 / 9, portal::halton_sampler::radical_inverse(4, 1));
+  EXPECT_DOUBLE_EQ(2.0 / 5 + 1.0 / 25, portal::halton_sampler::radical_inverse(7, 2));
+
+  const portal::halton_sampler sampler(3);
+  for (std::uint32_t dim = 0; dim < 4; ++dim) {
+    const std::uint32_t base = std::array<std::uint32_t, 4>{2, 3, 5, 7}[dim];
+    const std::uint32_t n    = base * base * base;
+    std::vector<int> strata(n);
+    for (std::uint32_t i = 0; i < n; ++i) {
+      const float x = sampler(4, i, dim);
+      ASSERT_TRUE(x >= 0.0f && x < 1.0f);
+      ++strata[static_cast<std::size_t>(static_cast<double>(x) * n)];
+    }
+    // the rotation may move a point across a boundary by rounding to float
+    EXPECT_GE(std::count(strata.begin(), strata.end(), 1), static_cast<std::ptrdiff_t>(n) - 2) << dim;
+  }
+  std::vector<float> batch(150);
+  for (const std::uint32_t dim : {0u, 5u, 31u}) {
+    sampler.generate(4, 0xffffff00u, dim, batch);
+    for (std::uint32_t i = 0; i < batch.size(); ++i)
+      ASSERT_EQ(sampler(4, 0xffffff00u + i, dim), batch[i]) << dim << ' ' << i;
+    sampler.generate(4, 100, dim, std::span(batch).first(70));
+    for (std::uint32_t i = 0; i < 70; ++i)
+      ASSERT_EQ(sampler(4, 100 + i, dim), batch[i]) << dim << ' ' << i;
+  }
+  static_assert(portal::halton_sampler::radical_inverse(1, 0) == 0.5);
+  EXPECT_EQ(0.0, portal::halton_sampler::radical_inverse(0, 31));
+  EXPECT_DOUBLE_EQ(1.0 / 131 + 1.0 / (131 * 131), portal::halton_sampler::radical_inverse(132, 31));
+}
+
+TEST(Sampler, R2) {
+  const portal::r2_sampler r2;
+  EXPECT_EQ(2U, r2.dimensions());
+  // the points of each dimension step by g^-1 and g^-2 of the plastic number
+  constexpr double plastic = 1.324717957244746;
+  const float a0           = r2(0, 1, 0) - r2(0, 0, 0);
+  const float a1           = r2(0, 1, 1) - r2(0, 0, 1);
+  EXPECT_NEAR(1 / plastic, a0 < 0 ? a0 + 1 : a0, 1e-6);
+  EXPECT_NEAR(1 / (plastic * plastic), a1 < 0 ? a1 + 1 : a1, 1e-6);
+  const portal::r2_sampler golden(1);
+  const float g = golden(2, 1, 0) - golden(2, 0, 0);
+  EXPECT_NEAR(std::numbers::phi - 1, g < 0 ? g + 1 : g, 1e-6);
+
+  std::vector<float> batch(50);
+  r2.generate(8, 1000, 1, batch);
+  for (std::uint32_t i = 0; i < batch.size(); ++i)
+    ASSERT_EQ(r2(8, 1000 + i, 1), batch[i]);
+  double sum = 0;
+  for (std::uint32_t i = 0; i < 1024; ++i)
+    sum += r2(9, i, 0) * r2(9, i, 1);
+  EXPECT_NEAR(0.25, sum / 1024, 3e-3);
+  EXPECT_THROW(portal::r2_sampler(0), std::invalid_argument);
+}
+
+TEST(Sampler, BlueNoise) {
+  const portal::blue_noise_mask mask(32);
+  EXPECT_EQ(32U, mask.size());
+  std::vector<float> values;
+  for (std::size_t y = 0; y < 32; ++y)
+    for (std::size_t x = 0; x < 32; ++x)
+      values.push_back(mask(x, y));
+  std::sort(values.begin(), values.end());
+  for (std::size_t i = 0; i < values.size(); ++i)
+    ASSERT_FLOAT_EQ((i + 0.5f) / 1024, values[i]);
+  EXPECT_EQ(mask(3, 4), mask(35, 68));
+
+  // neighbours differ far more than in white noise, where the mean difference is 1 / 3
+  double diff = 0;
+  for (std::size_t y = 0; y < 32; ++y)
+    for (std::size_t x = 0; x < 32; ++x)
+      diff += std::abs(mask(x, y) - mask(x + 1, y)) + std::abs(mask(x, y) - mask(x, y + 1));
+  EXPECT_GT(diff / 2048, 0.4);
+
+  const float s = mask(5, 6, 3, 1);
+  EXPECT_TRUE(s >= 0.0f && s < 1.0f);
+  EXPECT_NE(s, mask(5, 6, 4, 1));
+  EXPECT_NE(s, mask(5, 6, 3, 2));
+  std::vector<float> batch(20);
+  mask.generate(5, 6, 3, 1, batch);
+  for (std::uint32_t i = 0; i < batch.size(); ++i)
+    ASSERT_EQ(mask(5, 6, 3 + i, 1), batch[i]);
+  EXPECT_THROW(portal::blue_noise_mask(0), std::invalid_argument);
+}
+
+TEST(Deflate, Checksum) {
+  const auto bytes = [](const char *str) { return std::as_bytes(std::span(str, std::char_traits<char>::length(str))); };
+  EXPECT_EQ(0xCBF43926U, portal::crc32(bytes("123456789")));
+  EXPECT_EQ(0xCBF43926U, portal::crc32(bytes("56789"), portal::crc32(bytes("1234"))));
+  EXPECT_EQ(0x11E60398U, portal::adler32(bytes("Wikipedia")));
+  EXPECT_EQ(0x11E60398U, portal::adler32_combine(portal::adler32(bytes("Wiki")), portal::adler32(bytes("pedia")), 5));
+  EXPECT_EQ(1U, portal::adler32({}));
+}
+
+TEST(Deflate, RoundTrip) {
+  // noise, long repeats and short text-like matches
+  std::vector<std::byte> data(300000);
+  portal::pcg32 engine(5);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<std::byte>(i < 100000 ? engine() : i < 200000 ? i % 251 : engine() % 6 + 'a');
+  for (int level = 0; level <= 9; ++level) {
+    const auto packed = portal::zlib_compress(data, level);
+    EXPECT_EQ(data, portal::zlib_decompress(packed, data.size())) << level;
+    if (level > 0) {
+      EXPECT_LT(packed.size(), data.size() * 3 / 4) << level;
+    }
+  }
+
+  // pieces compressed on their own join into one stream
+  portal::deflate_encoder encoder(4);
+  const auto header = portal::zlib_header(4);
+  std::vector<std::byte> stream(header.begin(), header.end());
+  const auto half = std::span(data).subspan(0, 150000);
+  const auto rest = std::span(data).subspan(150000);
+  encoder.compress(half, false, stream);
+  encoder.compress(rest, true, stream);
+  const auto adler = portal::adler32_combine(portal::adler32(half), portal::adler32(rest), rest.size());
+  for (int i = 0; i < 4; ++i)
+    stream.push_back(static_cast<std::byte>(adler >> (24 - 8 * i)));
+  EXPECT_EQ(data, portal::zlib_decompress(stream, data.size()));
+
+  // the last match runs into the end of the input, every level
+  const std::string tail = "abcdXabcdYabcd";
+  const std::vector<std::byte> short_data(reinterpret_cast<const std::byte *>(tail.data()), reinterpret_cast<const std::byte *>(tail.data()) + tail.size());
+  for (int level = 1; level <= 9; ++level)
+    EXPECT_EQ(short_data, portal::zlib_decompress(portal::zlib_compress(short_data, level), short_data.size())) << level;
+
+  EXPECT_TRUE(portal::zlib_decompress(portal::zlib_compress({}), 0).empty());
+  EXPECT_THROW(portal::deflate_encoder(10), std::invalid_argument);
+}
+
+TEST(Deflate, Decompress) {
+  // zlib.compress(b'hello hello hello hello', 9)
+  const std::array<std::uint8_t, 16> packed = {120, 218, 203, 72, 205, 201, 201, 87, 200, 64, 39, 1, 104, 3, 8, 177};
+  const auto bytes                          = std::as_bytes(std::span(packed));
+  const auto data                           = portal::zlib_decompress(bytes, 100);
+  EXPECT_EQ("hello hello hello hello", std::string(reinterpret_cast<const char *>(data.data()), data.size()));
+
+  EXPECT_THROW((void)portal::zlib_decompress(bytes, 10), std::runtime_error);
+  EXPECT_THROW((void)portal::zlib_decompress(bytes.first(12), 100), std::runtime_error);
+  auto corrupt = packed;
+  corrupt[15] ^= 1;
+  EXPECT_THROW((void)portal::zlib_decompress(std::as_bytes(std::span(corrupt)), 100), std::runtime_error);
+}